@@ -0,0 +1,306 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <wav/Fft.hpp>
+#include <wav/FrameReader.hpp>
+#include <wav/ParallelJobs.hpp>
+#include <wav/SampleConversion.hpp>
+
+namespace wav {
+
+/**
+ * @brief Settings for BandwidthAnalyzer and analyzeBandwidth()
+ */
+struct BandwidthOptions {
+  std::size_t fftSize = 4096;   // Frames per analysis window (a power of two; smaller for shorter files)
+  std::size_t numWindows = 48;  // Windows spread evenly over the data chunk; the cost does not grow with length
+  float cliffDb = 30.0f;        // Level drop that counts as a band edge...
+  double transitionHz = 2500.0; // ...when it happens within this span
+  float minContentDb = -120.0f; // Content below this level (dBFS per bin) is treated as silence
+  double sourceEdgeRatio = 0.8; // A band edge in [ratio, 1] x Nyquist of a lower standard rate marks that rate
+};
+
+/**
+ * @brief Estimated audio bandwidth of a file, see analyzeBandwidth()
+ */
+struct BandwidthEstimate {
+  uint32_t sampleRate = 0;    // Declared rate of the file (0 if it could not be analyzed)
+  double cutoffHz = 0.0;      // Upper edge of the content; the Nyquist frequency if no band edge was found
+  double cliffDb = 0.0;       // How far the level drops at cutoffHz
+  uint32_t effectiveRate = 0; // Lowest standard rate whose band edge matches cutoffHz, else sampleRate
+  std::size_t numWindows = 0; // Channel windows that went into the average
+
+  /**
+   * @brief True if the content looks like it was upsampled from effectiveRate
+   */
+  bool isUpsampled() const { return effectiveRate != 0 && effectiveRate < sampleRate; }
+};
+
+/**
+ * @brief Averaged power spectrum and band-edge detector for sample-rate QC
+ *
+ * Material upsampled from 44.1 or 48 kHz keeps the anti-aliasing filter of its
+ * original rate: a cliff of many tens of dB just below 22.05 or 24 kHz, with
+ * only resampler residue and dither above it. Real high-resolution recordings
+ * roll off gradually, if at all. The analyzer averages the Hann-windowed power
+ * spectra of every window and channel it is given, then looks for the highest
+ * frequency where the level falls by BandwidthOptions::cliffDb within
+ * transitionHz. The edge is placed where the level is half of cliffDb below
+ * the passband just under it.
+ *
+ * Windows are transformed two at a time, packed as the real and imaginary
+ * parts of one complex FFT.
+ *
+ * Usage example:
+ *   wav::BandwidthAnalyzer analyzer(96000);
+ *   std::vector<float> window(analyzer.getWindowFrames() * 2); // interleaved stereo
+ *   // for a few positions in the file: fill window, then
+ *   analyzer.process(window.data(), 2);
+ *   wav::BandwidthEstimate estimate = analyzer.getEstimate();
+ *   if (estimate.isUpsampled()) {
+ *     std::cout << "really " << estimate.effectiveRate << " Hz\n";
+ *   }
+ */
+class BandwidthAnalyzer {
+public:
+  explicit BandwidthAnalyzer(uint32_t sampleRate, const BandwidthOptions& options = BandwidthOptions{})
+      : options_(options), sampleRate_(sampleRate), fft_(fftSize(options.fftSize)) {
+    const std::size_t n = fft_.size();
+    window_.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      window_[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * 3.14159265358979323846 * i / n));
+    }
+    spectrum_.resize(n);
+    power_.assign(n / 2 + 1, 0.0);
+    pending_.reserve(n);
+  }
+
+  /**
+   * @brief Frames per window (BandwidthOptions::fftSize rounded down to a power of two)
+   */
+  std::size_t getWindowFrames() const { return fft_.size(); }
+
+  /**
+   * @brief Add one window of getWindowFrames() interleaved frames to the average
+   */
+  void process(const float* interleaved, unsigned numChannels) {
+    const std::size_t n = fft_.size();
+    for (unsigned c = 0; c < numChannels; ++c) {
+      if (pending_.empty()) {
+        for (std::size_t i = 0; i < n; ++i) {
+          pending_.push_back(interleaved[i * numChannels + c] * window_[i]);
+        }
+        continue;
+      }
+      for (std::size_t i = 0; i < n; ++i) {
+        spectrum_[i] = std::complex<float>(pending_[i], interleaved[i * numChannels + c] * window_[i]);
+      }
+      pending_.clear();
+      accumulate(2);
+    }
+  }
+
+  /**
+   * @brief Find the band edge of everything processed so far
+   */
+  BandwidthEstimate getEstimate() {
+    if (!pending_.empty()) {
+      for (std::size_t i = 0; i < pending_.size(); ++i) {
+        spectrum_[i] = std::complex<float>(pending_[i], 0.0f);
+      }
+      pending_.clear();
+      accumulate(1);
+    }
+
+    BandwidthEstimate estimate;
+    estimate.sampleRate = sampleRate_;
+    estimate.numWindows = spectra_;
+    const double nyquist = sampleRate_ / 2.0;
+    estimate.cutoffHz = nyquist;
+    estimate.effectiveRate = sampleRate_;
+    const std::size_t bins = power_.size();
+    if (spectra_ == 0 || bins < 8) {
+      return estimate;
+    }
+
+    // Smoothed level per bin in dBFS (a full-scale sine reads 0 dB), then the loudest level at or above each bin
+    const double binHz = nyquist / static_cast<double>(bins - 1);
+    const double scale = 16.0 / (static_cast<double>(fft_.size()) * fft_.size() * spectra_);
+    const std::size_t smooth = std::max<std::size_t>(1, bins / 256);
+    std::vector<double> level(bins);
+    for (std::size_t k = 0; k < bins; ++k) {
+      const std::size_t first = k >= smooth ? k - smooth : 0;
+      const std::size_t last = std::min(bins - 1, k + smooth);
+      double sum = 0.0;
+      for (std::size_t j = first; j <= last; ++j) {
+        sum += power_[j];
+      }
+      level[k] = 10.0 * std::log10(sum * scale / static_cast<double>(last - first + 1) + 1e-30);
+    }
+    std::vector<double> loudestAbove(bins + 1, -1000.0);
+    for (std::size_t k = bins; k > 0; --k) {
+      loudestAbove[k - 1] = std::max(loudestAbove[k], level[k - 1]);
+    }
+
+    const std::size_t transition = std::max<std::size_t>(1, static_cast<std::size_t>(options_.transitionHz / binHz));
+    for (std::size_t k = bins - 1; k > 0; --k) {
+      const std::size_t above = std::min(bins - 1, k + transition); // Edges close to Nyquist get a shorter span
+      if (above <= k + 2 * smooth) {
+        continue;
+      }
+      const double drop = level[k] - loudestAbove[above];
+      if (level[k] < options_.minContentDb || drop < options_.cliffDb) {
+        continue;
+      }
+      // k is the top of the window leakage below the cliff; the edge is where the passband has fallen by half the cliff
+      const double passband = *std::max_element(level.begin() + (k - std::min(k, transition)), level.begin() + k + 1);
+      std::size_t edge = k;
+      while (edge > 0 && level[edge] < passband - 0.5 * options_.cliffDb) {
+        --edge;
+      }
+      estimate.cutoffHz = edge * binHz;
+      estimate.cliffDb = passband - loudestAbove[std::min(bins - 1, edge + transition)];
+      break;
+    }
+
+    static const uint32_t kStandardRates[] = {8000,  11025, 16000, 22050, 32000,  44100,
+                                              48000, 88200, 96000, 176400, 192000};
+    for (uint32_t rate : kStandardRates) {
+      const double edge = rate / 2.0;
+      if (rate < sampleRate_ && estimate.cliffDb > 0.0 && estimate.cutoffHz >= options_.sourceEdgeRatio * edge &&
+          estimate.cutoffHz <= edge) {
+        estimate.effectiveRate = rate;
+        break;
+      }
+    }
+    return estimate;
+  }
+
+  void reset() {
+    std::fill(power_.begin(), power_.end(), 0.0);
+    pending_.clear();
+    spectra_ = 0;
+  }
+
+private:
+  static std::size_t fftSize(std::size_t frames) {
+    std::size_t size = 16;
+    while (size * 2 <= frames) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  /**
+   * @brief Transform spectrum_ (one window in the real part, another or zeros in the imaginary part) and add both
+   */
+  void accumulate(std::size_t count) {
+    fft_.transform(spectrum_.data(), false);
+    const std::size_t n = fft_.size();
+    for (std::size_t k = 0; k <= n / 2; ++k) {
+      const std::complex<float> zk = spectrum_[k];
+      const std::complex<float> zn = std::conj(spectrum_[(n - k) % n]);
+      // |A|^2 + |B|^2 with A = (zk + zn) / 2 and B = (zk - zn) / 2i
+      power_[k] += 0.5 * (static_cast<double>(std::norm(zk)) + std::norm(zn));
+    }
+    spectra_ += count;
+  }
+
+  BandwidthOptions options_;
+  uint32_t sampleRate_;
+  detail::Fft fft_;
+  std::vector<float> window_;                 // Hann window
+  std::vector<std::complex<float>> spectrum_; // FFT work area
+  std::vector<float> pending_;                // Windowed channel waiting for a partner
+  std::vector<double> power_;                 // Summed power per bin, 0..Nyquist
+  std::size_t spectra_ = 0;                   // Channel windows summed into power_
+};
+
+/**
+ * @brief Estimate the real bandwidth of a WAV file from a sparse sample of its data chunk
+ *
+ * BandwidthOptions::numWindows windows are read with positional reads at
+ * evenly spaced positions, so a three-hour file costs no more than a
+ * three-minute one. Windows that are digital silence are skipped. Files shorter
+ * than one window are analyzed with a smaller FFT.
+ *
+ * Usage example:
+ *   wav::BandwidthEstimate estimate;
+ *   if (wav::analyzeBandwidth("hires/track01.wav", estimate) && estimate.isUpsampled()) {
+ *     std::cout << "upsampled from " << estimate.effectiveRate << " Hz\n";
+ *   }
+ *
+ * @return false if the file cannot be read or its format cannot be decoded (see std::cerr)
+ */
+inline bool analyzeBandwidth(const std::string& path, BandwidthEstimate& estimate,
+                             const BandwidthOptions& options = BandwidthOptions{}) {
+  FrameReader reader;
+  if (!reader.open(path, AccessPattern::Random)) {
+    std::cerr << "Error: Cannot open " << path << "\n";
+    return false;
+  }
+  const FmtChunk& fmt = reader.getFmtChunk();
+  if (!isConvertibleFormat(fmt)) {
+    std::cerr << "Error: Unsupported sample format in " << path << "\n";
+    return false;
+  }
+  const uint64_t numFrames = reader.getNumFrames();
+  BandwidthOptions fitted = options;
+  fitted.fftSize = static_cast<std::size_t>(std::min<uint64_t>(options.fftSize, std::max<uint64_t>(numFrames, 16)));
+  BandwidthAnalyzer analyzer(static_cast<uint32_t>(fmt.sampleRate), fitted);
+  const std::size_t windowFrames = analyzer.getWindowFrames();
+  if (numFrames < windowFrames) {
+    estimate = analyzer.getEstimate();
+    return true;
+  }
+
+  const std::size_t windows = static_cast<std::size_t>(
+      std::min<uint64_t>(std::max<std::size_t>(options.numWindows, 1), numFrames / windowFrames));
+  const uint64_t spacing = windows > 1 ? (numFrames - windowFrames) / (windows - 1) : 0;
+  std::vector<uint8_t> raw(windowFrames * fmt.blockAlign);
+  std::vector<float> samples(windowFrames * fmt.numChannels);
+  for (std::size_t w = 0; w < windows; ++w) {
+    if (reader.readAt(w * spacing, raw.data(), windowFrames) != windowFrames) {
+      std::cerr << "Error: Cannot read " << path << "\n";
+      return false;
+    }
+    convertToFloat(fmt, raw.data(), samples.size(), samples.data());
+    if (std::all_of(samples.begin(), samples.end(), [](float s) { return s == 0.0f; })) {
+      continue;
+    }
+    analyzer.process(samples.data(), fmt.numChannels);
+  }
+  estimate = analyzer.getEstimate();
+  return true;
+}
+
+/**
+ * @brief analyzeBandwidth() for a batch of files, several at a time
+ *
+ * estimates receives one entry per path; files that could not be analyzed
+ * keep a default estimate (sampleRate 0).
+ *
+ * @return Number of files that were analyzed (failures are reported on std::cerr)
+ */
+inline std::size_t analyzeBandwidth(const std::vector<std::string>& paths, std::vector<BandwidthEstimate>& estimates,
+                                    const BandwidthOptions& options = BandwidthOptions{}, unsigned threads = 8) {
+  estimates.assign(paths.size(), BandwidthEstimate{});
+  std::atomic<std::size_t> analyzed{0};
+  detail::ParallelJobs jobs(threads);
+  jobs.run(paths.size(), [&](std::size_t index) {
+    if (analyzeBandwidth(paths[index], estimates[index], options)) {
+      analyzed.fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+  return analyzed.load();
+}
+
+} // namespace wav
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include <wav/FrameReader.hpp>
+#include <wav/ParallelJobs.hpp>
+#include <wav/SampleConversion.hpp>
+
+namespace wav {
+
+/**
+ * @brief Settings for splitChannels()
+ */
+struct SplitOptions {
+  std::size_t blockBytes = 8u << 20; // Input read per block; each output gets one write of blockBytes / channels
+  unsigned ioThreads = 8;            // Worker threads for deinterleaving and writing (0 = calling thread only)
+  bool copyMetadata = true;          // Copy the bext and iXML chunks into every output file
+};
+
+namespace detail {
+
+/**
+ * @brief Heap buffer aligned to the page size, so large writes never straddle a partial page
+ */
+class AlignedBuffer {
+public:
+  static constexpr std::size_t kAlignment = 4096;
+
+  AlignedBuffer() = default;
+  explicit AlignedBuffer(std::size_t size)
+      : data_(static_cast<uint8_t*>(::operator new(size, std::align_val_t(kAlignment)))), size_(size) {}
+  ~AlignedBuffer() { release(); }
+
+  AlignedBuffer(const AlignedBuffer&) = delete;
+  AlignedBuffer& operator=(const AlignedBuffer&) = delete;
+
+  AlignedBuffer(AlignedBuffer&& other) noexcept { *this = std::move(other); }
+  AlignedBuffer& operator=(AlignedBuffer&& other) noexcept {
+    if (this != &other) {
+      release();
+      data_ = other.data_;
+      size_ = other.size_;
+      other.data_ = nullptr;
+      other.size_ = 0;
+    }
+    return *this;
+  }
+
+  uint8_t* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+private:
+  void release() {
+    if (data_) {
+      ::operator delete(data_, std::align_val_t(kAlignment));
+      data_ = nullptr;
+    }
+  }
+
+  uint8_t* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+/**
+ * @brief Copy every channel of interleaved frames into its own buffer, Width bytes per sample
+ */
+template <std::size_t Width>
+inline void deinterleaveBytes(const uint8_t* src, std::size_t numFrames, unsigned numChannels, uint8_t* const* dst) {
+  if (Width == 4) {
+    // Same bit pattern either way, so the float kernel (SIMD for stereo) moves 32-bit PCM too
+    sampleKernels().deinterleave(reinterpret_cast<const float*>(src), numFrames, numChannels,
+                                 reinterpret_cast<float* const*>(dst));
+    return;
+  }
+  for (std::size_t i = 0; i < numFrames; ++i) {
+    const uint8_t* frame = src + i * numChannels * Width;
+    for (unsigned c = 0; c < numChannels; ++c) {
+      std::memcpy(dst[c] + i * Width, frame + c * Width, Width);
+    }
+  }
+}
+
+inline void deinterleaveBytes(const uint8_t* src, std::size_t numFrames, unsigned numChannels, std::size_t width,
+                              uint8_t* const* dst) {
+  switch (width) {
+  case 1:
+    deinterleaveBytes<1>(src, numFrames, numChannels, dst);
+    break;
+  case 2:
+    deinterleaveBytes<2>(src, numFrames, numChannels, dst);
+    break;
+  case 3:
+    deinterleaveBytes<3>(src, numFrames, numChannels, dst);
+    break;
+  case 4:
+    deinterleaveBytes<4>(src, numFrames, numChannels, dst);
+    break;
+  default:
+    deinterleaveBytes<8>(src, numFrames, numChannels, dst);
+    break;
+  }
+}
+
+/**
+ * @brief RIFF header, extra chunks, fmt chunk and data chunk header of a file with dataBytes of samples in format fmt
+ *
+ * The fmt chunk is the 16-byte PCM/IEEE_FLOAT form; avgBytesPerSec and blockAlign
+ * are derived from numChannels and bitsPerSample rather than taken from fmt.
+ * Non-PCM formats get the fact chunk the spec requires, holding the frame count.
+ * See wav-resources/WAVE File Format.html — fact chunk
+ */
+inline std::vector<uint8_t> wavHeader(const FmtChunk& format, const std::vector<ChunkInfo>& chunks,
+                                      const std::vector<std::vector<uint8_t>>& payloads, uint64_t dataBytes) {
+  const uint16_t blockAlign = static_cast<uint16_t>(format.numChannels * bytesPerSample(format));
+  std::vector<uint8_t> fmt;
+  putLE16(fmt, static_cast<uint16_t>(format.audioFormat));
+  putLE16(fmt, format.numChannels);
+  putLE32(fmt, static_cast<uint32_t>(format.sampleRate));
+  putLE32(fmt, static_cast<uint32_t>(format.sampleRate * blockAlign));
+  putLE16(fmt, blockAlign);
+  putLE16(fmt, format.bitsPerSample);
+
+  std::vector<uint8_t> header = {'R', 'I', 'F', 'F'};
+  putLE32(header, 0); // Patched below
+  header.insert(header.end(), {'W', 'A', 'V', 'E'});
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    putChunk(header, chunks[i].id, payloads[i]);
+  }
+  putChunk(header, Id::fromChars("fmt "), fmt);
+  if (format.audioFormat != AudioFormat::PCM) {
+    std::vector<uint8_t> fact;
+    putLE32(fact, static_cast<uint32_t>(blockAlign == 0 ? 0 : dataBytes / blockAlign));
+    putChunk(header, Id::fromChars("fact"), fact);
+  }
+  header.insert(header.end(), {'d', 'a', 't', 'a'});
+  putLE32(header, static_cast<uint32_t>(dataBytes));
+
+  const uint64_t riffSize = header.size() - 8 + dataBytes + (dataBytes & 1);
+  for (int i = 0; i < 4; ++i) {
+    header[4 + i] = static_cast<uint8_t>(riffSize >> (8 * i));
+  }
+  return header;
+}
+
+/**
+ * @brief wavHeader() for one channel of source
+ */
+inline std::vector<uint8_t> monoWavHeader(const FmtChunk& source, const std::vector<ChunkInfo>& chunks,
+                                          const std::vector<std::vector<uint8_t>>& payloads, uint64_t dataBytes) {
+  FmtChunk mono = source;
+  mono.numChannels = 1;
+  return wavHeader(mono, chunks, payloads, dataBytes);
+}
+
+} // namespace detail
+
+/**
+ * @brief Split a polyphonic WAV file into one mono WAV file per channel
+ *
+ * The input is read once, front to back, in blocks of SplitOptions::blockBytes
+ * with sequential readahead. Each block is deinterleaved in parallel frame
+ * slices into page-aligned per-channel buffers, then every output receives its
+ * part of the block in a single write while the next block is being read, so
+ * the reads and all N writes stay in flight together. Samples are copied bit
+ * for bit; the outputs keep the sample format, bit depth and rate of the input.
+ *
+ * With copyMetadata the bext (Broadcast WAV) and iXML chunks are written into
+ * every output ahead of the fmt chunk, as BWF readers expect.
+ *
+ * Usage example:
+ *   std::vector<std::string> outputs;
+ *   for (int c = 1; c <= 16; ++c) {
+ *     outputs.push_back("take12_" + std::to_string(c) + ".wav");
+ *   }
+ *   if (!wav::splitChannels("take12.wav", outputs)) {
+ *     // see std::cerr
+ *   }
+ *
+ * @param outputPaths One path per channel of the input, in channel order
+ * @return false if the input cannot be read, its format is not PCM/IEEE_FLOAT little-endian, the number of paths
+ *         does not match its channels, a mono output would exceed 4 GiB, or a write fails (see std::cerr)
+ */
+inline bool splitChannels(const std::string& inputPath, const std::vector<std::string>& outputPaths,
+                          const SplitOptions& options = SplitOptions{}) {
+  FrameReader reader;
+  if (!reader.open(inputPath, AccessPattern::Sequential, StreamingHints{2 * options.blockBytes, true})) {
+    std::cerr << "Error: Cannot open " << inputPath << "\n";
+    return false;
+  }
+  const FmtChunk& fmt = reader.getFmtChunk();
+  const unsigned channels = fmt.numChannels;
+  const std::size_t width = bytesPerSample(fmt);
+  if (!isConvertibleFormat(fmt) || fmt.bigEndian || fmt.blockAlign != channels * width) {
+    std::cerr << "Error: Unsupported sample format in " << inputPath << "\n";
+    return false;
+  }
+  if (outputPaths.size() != channels) {
+    std::cerr << "Error: " << inputPath << " has " << channels << " channels but " << outputPaths.size()
+              << " output paths were given\n";
+    return false;
+  }
+  const uint64_t numFrames = reader.getNumFrames();
+  const uint64_t dataBytes = numFrames * width;
+
+  std::vector<ChunkInfo> extraChunks;
+  std::vector<std::vector<uint8_t>> payloads;
+  if (options.copyMetadata) {
+    const WavFileUtils& metadata = reader.getMetadata();
+    const uint64_t headerSize = metadata.getContainer() == Container::Wave64 ? detail::kW64ChunkHeaderSize : 8;
+    for (const ChunkInfo& chunk : metadata.getChunkList()) {
+      if (chunk.id != Id::fromChars("bext") && chunk.id != Id::fromChars("iXML")) {
+        continue;
+      }
+      std::vector<uint8_t> payload(static_cast<std::size_t>(chunk.chunkSize));
+      if (reader.getFileHandle().readAt(chunk.offset + headerSize, payload.data(), payload.size()) != payload.size()) {
+        std::cerr << "Error: Cannot read the " << chunk.id.toString() << " chunk of " << inputPath << "\n";
+        return false;
+      }
+      extraChunks.push_back(chunk);
+      payloads.push_back(std::move(payload));
+    }
+  }
+  const std::vector<uint8_t> header = detail::monoWavHeader(fmt, extraChunks, payloads, dataBytes);
+  if (header.size() + dataBytes > 0xFFFFFFFFull) {
+    std::cerr << "Error: The channels of " << inputPath << " do not fit in 4 GiB RIFF files\n";
+    return false;
+  }
+
+  std::vector<OutputFile> outputs(channels);
+  for (unsigned c = 0; c < channels; ++c) {
+    if (!outputs[c].open(outputPaths[c]) || !outputs[c].write(header.data(), header.size())) {
+      std::cerr << "Error: Cannot write " << outputPaths[c] << "\n";
+      return false;
+    }
+  }
+
+  // Two raw input blocks (one being read while the other is written out) and one buffer per channel
+  const std::size_t blockFrames = std::max<std::size_t>(1, options.blockBytes / fmt.blockAlign);
+  detail::AlignedBuffer raw[2] = {detail::AlignedBuffer(blockFrames * fmt.blockAlign),
+                                  detail::AlignedBuffer(blockFrames * fmt.blockAlign)};
+  std::vector<detail::AlignedBuffer> planes;
+  for (unsigned c = 0; c < channels; ++c) {
+    planes.emplace_back(blockFrames * width);
+  }
+
+  const std::size_t numSlices = std::max(1u, options.ioThreads);
+  std::vector<uint8_t*> slicePlanes(numSlices * channels);
+  std::vector<char> failed(channels, 0); // Not vector<bool>: every job writes its own element
+  detail::ParallelJobs jobs(options.ioThreads);
+
+  std::size_t got[2] = {reader.read(raw[0].data(), blockFrames), 0};
+  uint64_t written = 0;
+  for (int current = 0; got[current] > 0; current ^= 1) {
+    const std::size_t frames = got[current];
+    const std::size_t sliceFrames = (frames + numSlices - 1) / numSlices;
+    jobs.run(numSlices, [&](std::size_t slice) {
+      const std::size_t first = std::min(frames, slice * sliceFrames);
+      const std::size_t count = std::min(frames, first + sliceFrames) - first;
+      uint8_t** dst = slicePlanes.data() + slice * channels;
+      for (unsigned c = 0; c < channels; ++c) {
+        dst[c] = planes[c].data() + first * width;
+      }
+      detail::deinterleaveBytes(raw[current].data() + first * fmt.blockAlign, count, channels, width, dst);
+    });
+
+    // Job `channels` reads the next block while the others write this one
+    jobs.run(channels + 1, [&](std::size_t job) {
+      if (job == channels) {
+        got[current ^ 1] = reader.read(raw[current ^ 1].data(), blockFrames);
+      } else if (!failed[job] && !outputs[job].write(planes[job].data(), frames * width)) {
+        failed[job] = 1;
+      }
+    });
+    written += frames;
+  }
+
+  bool ok = written == numFrames;
+  if (!ok) {
+    std::cerr << "Error: Read of " << inputPath << " stopped after " << written << " of " << numFrames << " frames\n";
+  }
+  const uint8_t pad = 0;
+  for (unsigned c = 0; c < channels; ++c) {
+    if (failed[c] || ((dataBytes & 1) && !outputs[c].write(&pad, 1)) || !outputs[c].close()) {
+      std::cerr << "Error: Cannot write " << outputPaths[c] << "\n";
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+} // namespace wav
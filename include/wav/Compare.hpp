@@ -0,0 +1,275 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <wav/FrameReader.hpp>
+#include <wav/SampleConversion.hpp>
+#include <wav/SampleKernels.hpp>
+
+namespace wav {
+
+/**
+ * @brief Settings for compare()
+ */
+struct CompareOptions {
+  double toleranceDb = -1000.0;       // Differences at or below this level (dBFS) count as equal...
+  double toleranceLsb = 0.0;          // ...as do differences within this many LSBs of the coarser format
+  int64_t frameOffset = 0;            // Frame i of A is compared with frame i + frameOffset of B
+  uint64_t alignSearchFrames = 0;     // If > 0, look for the best offset within +-this many frames instead
+  bool stopAtFirstDifference = true;  // Stop at the first difference rather than summarizing the whole file
+  std::size_t blockFrames = 1u << 16; // Frames compared per step
+};
+
+/**
+ * @brief Outcome of compare()
+ *
+ * Errors are differences of the decoded samples, A - B, with full scale = 1.
+ * When the comparison stops early, the statistics cover the frames compared
+ * up to and including the block with the first difference.
+ */
+struct CompareResult {
+  int64_t frameOffset = 0;                    // Offset that was used (found by the search, if enabled)
+  uint64_t framesCompared = 0;                // Frames present in both files that were compared
+  uint64_t framesOnlyInA = 0;                 // Frames of A outside the overlap with B
+  uint64_t framesOnlyInB = 0;                 // Frames of B outside the overlap with A
+  uint64_t bitExactFrames = 0;                // Compared frames whose bytes matched (raw memcmp fast path)
+  uint64_t differingSamples = 0;              // Samples whose difference exceeds the tolerance
+  uint64_t firstDifferenceFrame = UINT64_MAX; // Frame of A with the first such sample
+  unsigned firstDifferenceChannel = 0;        // Channel of that sample
+  double maxError = 0.0;                      // Largest |A - B|
+  double residualRms = 0.0;                   // RMS of A - B over the compared samples
+
+  /**
+   * @brief True if every compared sample is within tolerance and neither file has extra frames
+   */
+  bool matches() const { return differingSamples == 0 && framesOnlyInA == 0 && framesOnlyInB == 0; }
+
+  /**
+   * @brief maxError in dBFS (-inf for a perfect null)
+   */
+  double maxErrorDb() const { return maxError > 0.0 ? 20.0 * std::log10(maxError) : -INFINITY; }
+
+  /**
+   * @brief residualRms in dBFS (-inf for a perfect null)
+   */
+  double residualRmsDb() const { return residualRms > 0.0 ? 20.0 * std::log10(residualRms) : -INFINITY; }
+};
+
+namespace detail {
+
+/**
+ * @brief Size of one least significant bit at full scale 1: 2^-(bits - 1) for PCM, the 24-bit mantissa for floats
+ */
+inline double lsbSize(const FmtChunk& fmt) {
+  if (fmt.audioFormat == AudioFormat::IEEE_FLOAT) {
+    return std::ldexp(1.0, -24);
+  }
+  return std::ldexp(1.0, 1 - static_cast<int>(fmt.bitsPerSample));
+}
+
+/**
+ * @brief Channel 0 of frames [first, first + count) of a file, decoded
+ */
+inline bool readChannel0(const FrameReader& reader, uint64_t first, std::size_t count, std::vector<float>& out) {
+  const FmtChunk& fmt = reader.getFmtChunk();
+  std::vector<uint8_t> raw(count * fmt.blockAlign);
+  std::vector<float> samples(count * fmt.numChannels);
+  if (reader.readAt(first, raw.data(), count) != count) {
+    return false;
+  }
+  convertToFloat(fmt, raw.data(), samples.size(), samples.data());
+  out.resize(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    out[i] = samples[i * fmt.numChannels];
+  }
+  return true;
+}
+
+/**
+ * @brief Offset in [-range, range] that best lines B up with A, by the smallest summed |A - B| of channel 0
+ *
+ * The window is taken where A first rises above -60 dBFS, so leading silence
+ * (encoder priming, pre-roll) does not make every offset look equally good.
+ * Ties go to the offset closest to 0.
+ */
+inline int64_t findFrameOffset(const FrameReader& a, const FrameReader& b, uint64_t range) {
+  const std::size_t window = 8192;
+  const uint64_t scanFrames = std::min<uint64_t>(a.getNumFrames(), 1u << 20);
+  std::vector<float> head;
+  if (scanFrames < window || !readChannel0(a, 0, static_cast<std::size_t>(scanFrames), head)) {
+    return 0;
+  }
+  uint64_t start = 0;
+  while (start + window < scanFrames && std::fabs(head[start]) < 1e-3f) {
+    ++start;
+  }
+  start = std::min<uint64_t>(start, scanFrames - window);
+
+  const int64_t lowest = -static_cast<int64_t>(std::min<uint64_t>(range, start));
+  const uint64_t bFrames = b.getNumFrames();
+  if (bFrames < start + window) {
+    return 0;
+  }
+  const int64_t highest = static_cast<int64_t>(std::min<uint64_t>(range, bFrames - start - window));
+  std::vector<float> other;
+  if (!readChannel0(b, static_cast<uint64_t>(static_cast<int64_t>(start) + lowest),
+                    static_cast<std::size_t>(highest - lowest) + window, other)) {
+    return 0;
+  }
+  int64_t best = 0;
+  double bestCost = INFINITY;
+  for (int64_t offset = lowest; offset <= highest; ++offset) {
+    const float* x = head.data() + start;
+    const float* y = other.data() + (offset - lowest);
+    float lanes[8] = {};
+    for (std::size_t i = 0; i < window; i += 8) {
+      for (std::size_t k = 0; k < 8; ++k) {
+        lanes[k] += std::fabs(x[i + k] - y[i + k]);
+      }
+    }
+    double cost = 0.0;
+    for (float lane : lanes) {
+      cost += lane;
+    }
+    if (cost < bestCost || (cost == bestCost && std::llabs(offset) < std::llabs(best))) {
+      bestCost = cost;
+      best = offset;
+    }
+  }
+  return best;
+}
+
+} // namespace detail
+
+/**
+ * @brief Null-test the data chunks of two WAV files, sample by sample
+ *
+ * The files may differ in sample format and bit depth (e.g. a 16-bit source
+ * and its 24-bit transcode); they must have the same number of channels. Both
+ * are read block by block with positional reads. When the formats are the
+ * same, each block pair is first compared with memcmp and only decoded if the
+ * bytes differ, so unchanged regions cost no more than reading them.
+ * Otherwise the samples are decoded to float (SIMD, see SampleKernels.hpp) and
+ * the residual's peak and energy are measured with the SIMD kernels.
+ *
+ * A sample differs when |A - B| exceeds the larger of toleranceDb and
+ * toleranceLsb; with both at their defaults, same-format files must match bit
+ * for bit. Frame i of A lines up with frame i + frameOffset of B, or with the
+ * offset found by a search over +-alignSearchFrames.
+ *
+ * Usage example:
+ *   wav::CompareResult result;
+ *   if (wav::compare("master.wav", "roundtrip.wav", result) && result.matches()) {
+ *     // bit-exact (within tolerance)
+ *   } else if (result.differingSamples > 0) {
+ *     std::cout << "first difference at frame " << result.firstDifferenceFrame << "\n";
+ *   }
+ *
+ * @return false if a file cannot be read, its format cannot be decoded, or the channel counts
+ *         or sample rates differ (see std::cerr)
+ */
+inline bool compare(const std::string& pathA, const std::string& pathB, CompareResult& result,
+                    const CompareOptions& options = CompareOptions{}) {
+  result = CompareResult{};
+  FrameReader a;
+  FrameReader b;
+  if (!a.open(pathA, AccessPattern::Sequential) || !b.open(pathB, AccessPattern::Sequential)) {
+    std::cerr << "Error: Cannot open " << (a.isOpen() ? pathB : pathA) << "\n";
+    return false;
+  }
+  const FmtChunk& fmtA = a.getFmtChunk();
+  const FmtChunk& fmtB = b.getFmtChunk();
+  if (!isConvertibleFormat(fmtA) || !isConvertibleFormat(fmtB)) {
+    std::cerr << "Error: Unsupported sample format in " << (isConvertibleFormat(fmtA) ? pathB : pathA) << "\n";
+    return false;
+  }
+  if (fmtA.numChannels != fmtB.numChannels || fmtA.sampleRate != fmtB.sampleRate) {
+    std::cerr << "Error: " << pathA << " and " << pathB << " differ in channels or sample rate\n";
+    return false;
+  }
+  const unsigned channels = fmtA.numChannels;
+  const bool sameFormat = fmtA.audioFormat == fmtB.audioFormat && fmtA.bitsPerSample == fmtB.bitsPerSample &&
+                          fmtA.blockAlign == fmtB.blockAlign && fmtA.bigEndian == fmtB.bigEndian;
+  const double threshold = std::max(std::pow(10.0, options.toleranceDb / 20.0),
+                                    options.toleranceLsb * std::max(detail::lsbSize(fmtA), detail::lsbSize(fmtB)));
+  const bool exact = options.toleranceDb <= -1000.0 && options.toleranceLsb <= 0.0;
+
+  result.frameOffset = options.alignSearchFrames > 0 ? detail::findFrameOffset(a, b, options.alignSearchFrames)
+                                                     : options.frameOffset;
+  const uint64_t framesA = a.getNumFrames();
+  const uint64_t framesB = b.getNumFrames();
+  const uint64_t firstA = result.frameOffset < 0 ? static_cast<uint64_t>(-result.frameOffset) : 0;
+  const uint64_t firstB = result.frameOffset > 0 ? static_cast<uint64_t>(result.frameOffset) : 0;
+  const uint64_t overlap = std::min(framesA - std::min(framesA, firstA), framesB - std::min(framesB, firstB));
+  result.framesOnlyInA = framesA - overlap;
+  result.framesOnlyInB = framesB - overlap;
+
+  const std::size_t blockFrames = std::max<std::size_t>(1, options.blockFrames);
+  std::vector<uint8_t> rawA(blockFrames * fmtA.blockAlign);
+  std::vector<uint8_t> rawB(blockFrames * fmtB.blockAlign);
+  std::vector<float> samplesA(blockFrames * channels);
+  std::vector<float> samplesB(blockFrames * channels);
+  const SampleKernels& kernels = sampleKernels();
+  const std::size_t width = bytesPerSample(fmtA);
+  double sumOfSquares = 0.0;
+
+  for (uint64_t frame = 0; frame < overlap;) {
+    const std::size_t count = static_cast<std::size_t>(std::min<uint64_t>(blockFrames, overlap - frame));
+    if (a.readAt(firstA + frame, rawA.data(), count) != count ||
+        b.readAt(firstB + frame, rawB.data(), count) != count) {
+      std::cerr << "Error: Cannot read " << pathA << " or " << pathB << " at frame " << frame << "\n";
+      return false;
+    }
+    if (sameFormat && std::memcmp(rawA.data(), rawB.data(), count * fmtA.blockAlign) == 0) {
+      result.bitExactFrames += count;
+      result.framesCompared += count;
+      frame += count;
+      continue;
+    }
+
+    const std::size_t numSamples = count * channels;
+    convertToFloat(fmtA, rawA.data(), numSamples, samplesA.data());
+    convertToFloat(fmtB, rawB.data(), numSamples, samplesB.data());
+    float* residual = samplesA.data(); // A - B, in place
+    for (std::size_t i = 0; i < numSamples; ++i) {
+      residual[i] -= samplesB[i];
+    }
+    result.maxError = std::max(result.maxError, static_cast<double>(kernels.peakAbs(residual, numSamples)));
+    sumOfSquares += kernels.sumOfSquares(residual, numSamples);
+
+    uint64_t differing = 0;
+    std::size_t first = numSamples;
+    for (std::size_t i = 0; i < numSamples; ++i) {
+      // Bytes decide in exact mode: different bit patterns can decode to the same float (0 and -0, wide samples)
+      const bool differs = exact && sameFormat
+                               ? std::memcmp(rawA.data() + i * width, rawB.data() + i * width, width) != 0
+                               : !(std::fabs(residual[i]) <= threshold); // NaN counts as a difference
+      if (differs) {
+        first = std::min(first, i);
+        ++differing;
+      }
+    }
+    if (differing > 0 && result.differingSamples == 0) {
+      result.firstDifferenceFrame = firstA + frame + first / channels;
+      result.firstDifferenceChannel = static_cast<unsigned>(first % channels);
+    }
+    result.differingSamples += differing;
+    result.framesCompared += count;
+    frame += count;
+    if (differing > 0 && options.stopAtFirstDifference) {
+      break;
+    }
+  }
+  if (result.framesCompared > 0) {
+    result.residualRms = std::sqrt(sumOfSquares / static_cast<double>(result.framesCompared * channels));
+  }
+  return true;
+}
+
+} // namespace wav
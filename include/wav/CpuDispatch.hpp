@@ -0,0 +1,191 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+
+/**
+ * @brief Runtime detection of x86 SIMD extensions for the sample kernels
+ *
+ * One binary runs on every x86-64 machine: the kernels in SampleKernels.hpp are
+ * compiled for several instruction sets with per-function target attributes,
+ * and the best one the CPU (and OS, via XGETBV) supports is picked on first use.
+ * Other architectures and compilers without target attributes always use the
+ * portable scalar kernels; define WAV_HAVE_X86_DISPATCH to 0 to force that.
+ *
+ * The selection can be overridden for testing and benchmarking, either with
+ * forceIsa() or by setting WAV_FORCE_ISA=scalar|sse4.1|avx2|avx512 in the
+ * environment. A forced instruction set the CPU lacks is rejected.
+ *
+ * Usage example:
+ *   std::cout << "kernels: " << wav::isaName(wav::activeIsa()) << "\n";
+ *   wav::forceIsa(wav::Isa::Scalar); // compare against the reference path
+ *   ...
+ *   wav::clearForcedIsa();
+ */
+#ifndef WAV_HAVE_X86_DISPATCH
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define WAV_HAVE_X86_DISPATCH 1
+#else
+#define WAV_HAVE_X86_DISPATCH 0
+#endif
+#endif
+
+#if WAV_HAVE_X86_DISPATCH
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace wav {
+
+/**
+ * @brief Kernel instruction sets, in increasing order of capability
+ * AVX2 implies FMA and AVX512 implies AVX512F + AVX512BW on top of AVX2.
+ */
+enum class Isa : int { Scalar, SSE41, AVX2, AVX512, Count };
+
+inline const char* isaName(Isa isa) {
+  static const char* const names[] = {"scalar", "sse4.1", "avx2", "avx512"};
+  return isa < Isa::Count ? names[static_cast<int>(isa)] : "unknown";
+}
+
+/**
+ * @brief Parse the names printed by isaName() (as used by WAV_FORCE_ISA)
+ */
+inline bool parseIsa(const std::string& name, Isa& isa) {
+  for (int i = 0; i < static_cast<int>(Isa::Count); ++i) {
+    if (name == isaName(static_cast<Isa>(i))) {
+      isa = static_cast<Isa>(i);
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Extensions usable by this process (CPU support and OS register state)
+ */
+struct CpuFeatures {
+  bool sse41 = false;
+  bool avx2 = false;
+  bool fma = false;
+  bool avx512f = false;
+  bool avx512bw = false;
+
+  bool supports(Isa isa) const {
+    switch (isa) {
+    case Isa::Scalar:
+      return true;
+    case Isa::SSE41:
+      return sse41;
+    case Isa::AVX2:
+      return sse41 && avx2 && fma;
+    case Isa::AVX512:
+      return sse41 && avx2 && fma && avx512f && avx512bw;
+    default:
+      return false;
+    }
+  }
+
+  Isa best() const {
+    Isa isa = Isa::Scalar;
+    for (int i = 1; i < static_cast<int>(Isa::Count); ++i) {
+      if (supports(static_cast<Isa>(i))) {
+        isa = static_cast<Isa>(i);
+      }
+    }
+    return isa;
+  }
+};
+
+inline CpuFeatures detectCpuFeatures() {
+  CpuFeatures features;
+#if WAV_HAVE_X86_DISPATCH
+  unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+  if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+    return features;
+  }
+  features.sse41 = (ecx & (1u << 19)) != 0;
+  const bool osxsave = (ecx & (1u << 27)) != 0;
+  const bool fma = (ecx & (1u << 12)) != 0;
+
+  // The OS must save the YMM/ZMM registers on context switches, or the wide kernels would corrupt state
+  uint64_t xcr0 = 0;
+  if (osxsave) {
+    uint32_t lo = 0, hi = 0;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    xcr0 = (uint64_t(hi) << 32) | lo;
+  }
+  const bool ymmState = (xcr0 & 0x06) == 0x06;
+  const bool zmmState = (xcr0 & 0xe6) == 0xe6;
+  features.fma = fma && ymmState;
+
+  if (__get_cpuid_max(0, nullptr) >= 7) {
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    features.avx2 = (ebx & (1u << 5)) != 0 && ymmState;
+    features.avx512f = (ebx & (1u << 16)) != 0 && zmmState;
+    features.avx512bw = (ebx & (1u << 30)) != 0 && zmmState;
+  }
+#endif
+  return features;
+}
+
+/**
+ * @brief Features of the running CPU, detected once per process
+ */
+inline const CpuFeatures& cpuFeatures() {
+  static const CpuFeatures features = detectCpuFeatures();
+  return features;
+}
+
+namespace detail {
+
+inline std::atomic<int>& forcedIsa() {
+  static std::atomic<int> forced{-1};
+  return forced;
+}
+
+/**
+ * @brief Best supported ISA, or WAV_FORCE_ISA when it names a supported one
+ */
+inline Isa defaultIsa() {
+  static const Isa isa = [] {
+    Isa requested;
+    const char* env = std::getenv("WAV_FORCE_ISA");
+    if (env && parseIsa(env, requested) && cpuFeatures().supports(requested)) {
+      return requested;
+    }
+    return cpuFeatures().best();
+  }();
+  return isa;
+}
+
+} // namespace detail
+
+/**
+ * @brief Instruction set the sample kernels currently use
+ */
+inline Isa activeIsa() {
+  const int forced = detail::forcedIsa().load(std::memory_order_relaxed);
+  return forced >= 0 ? static_cast<Isa>(forced) : detail::defaultIsa();
+}
+
+/**
+ * @brief Make every kernel use one instruction set (process-wide)
+ * @return false if the CPU does not support it; the selection is left unchanged
+ */
+inline bool forceIsa(Isa isa) {
+  if (!cpuFeatures().supports(isa)) {
+    return false;
+  }
+  detail::forcedIsa().store(static_cast<int>(isa), std::memory_order_relaxed);
+  return true;
+}
+
+/**
+ * @brief Go back to the automatic selection
+ */
+inline void clearForcedIsa() { detail::forcedIsa().store(-1, std::memory_order_relaxed); }
+
+} // namespace wav
@@ -0,0 +1,498 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+#include <wav/FrameReader.hpp>
+#include <wav/SampleConversion.hpp>
+
+namespace wav {
+
+/**
+ * @brief Direct-from-disk (DFD) sample streaming for sampler voices
+ *
+ * The classic DFD scheme: at load time the first preloadFrames frames of every
+ * sample (and of every SampleLoop start in its smpl chunk) are decoded into RAM.
+ * A note-on starts playing from that preload immediately, while a background I/O
+ * thread streams the rest of the sample from disk into the voice's ring buffer.
+ * The I/O thread always services the voice closest to running dry first
+ * (earliest deadline), and a voice that does run dry plays silence and
+ * increments the underrun counter instead of blocking the audio thread.
+ *
+ * render(), noteOn() and noteOff() never allocate, lock or touch the disk, so
+ * they can be called from the audio thread; call all three for a given voice from
+ * that one thread. addSample() is not realtime-safe. A stopped voice is handed
+ * back to the I/O thread, which is the one that returns it to the free pool, so
+ * noteOn() can never rewrite a voice the I/O thread is still streaming.
+ *
+ * Usage example:
+ *   wav::DiskStreamer streamer;
+ *   int piano = streamer.addSample("piano_C4.wav");   // at startup
+ *   int voice = streamer.noteOn(piano);               // on the audio thread
+ *   std::vector<float> block(256 * streamer.getSample(piano).numChannels);
+ *   streamer.render(voice, block.data(), 256);
+ *   std::cout << "underruns: " << streamer.getUnderrunCount() << "\n";
+ */
+
+/**
+ * @brief Settings for a DiskStreamer (fixed for its lifetime)
+ */
+struct DiskStreamerOptions {
+  std::size_t preloadFrames = 32768; // Frames decoded into RAM from the start of each sample / loop
+  std::size_t ringFrames = 65536;    // Capacity of each voice's ring buffer
+  std::size_t ioBlockFrames = 8192;  // Frames read from disk per I/O request
+  std::size_t maxVoices = 64;        // Voices allocated up front
+  bool backgroundThread = true;      // false: the caller drives I/O with serviceIo() (offline rendering, tests)
+};
+
+/**
+ * @brief Decoded preload segment starting at a given frame
+ */
+struct PreloadSegment {
+  uint64_t startFrame = 0;
+  std::vector<float> samples; // Interleaved, numChannels per frame
+};
+
+/**
+ * @brief A sample registered with the streamer: its file, metadata and preloaded segments
+ */
+struct StreamedSample {
+  FrameReader reader;
+  uint16_t numChannels = 0;
+  uint32_t sampleRate = 0;
+  uint64_t numFrames = 0;
+  PreloadSegment head;                   // Frames [0, preloadFrames)
+  std::vector<PreloadSegment> loopHeads; // One per entry of loops
+  std::vector<SampleLoop> loops;         // Copy of the smpl loops (start/end are inclusive frame indices)
+};
+
+namespace detail {
+
+/**
+ * @brief Single-producer / single-consumer ring of interleaved float samples
+ * The I/O thread is the only writer and the audio thread the only reader.
+ */
+class SampleRing {
+public:
+  void allocate(std::size_t capacitySamples) { buffer_.assign(capacitySamples, 0.0f); }
+
+  std::size_t capacity() const { return buffer_.size(); }
+
+  std::size_t available() const {
+    return writeIndex_.load(std::memory_order_acquire) - readIndex_.load(std::memory_order_acquire);
+  }
+
+  std::size_t freeSpace() const { return capacity() - available(); }
+
+  /**
+   * @brief Producer: append up to count samples, returns how many fit
+   */
+  std::size_t write(const float* src, std::size_t count) {
+    const std::size_t write = writeIndex_.load(std::memory_order_relaxed);
+    const std::size_t n = std::min(count, capacity() - (write - readIndex_.load(std::memory_order_acquire)));
+    for (std::size_t i = 0; i < n; ++i) {
+      buffer_[(write + i) % buffer_.size()] = src[i];
+    }
+    writeIndex_.store(write + n, std::memory_order_release);
+    return n;
+  }
+
+  /**
+   * @brief Consumer: take up to count samples, returns how many were available
+   */
+  std::size_t read(float* dst, std::size_t count) {
+    const std::size_t read = readIndex_.load(std::memory_order_relaxed);
+    const std::size_t n = std::min(count, writeIndex_.load(std::memory_order_acquire) - read);
+    for (std::size_t i = 0; i < n; ++i) {
+      dst[i] = buffer_[(read + i) % buffer_.size()];
+    }
+    readIndex_.store(read + n, std::memory_order_release);
+    return n;
+  }
+
+  /**
+   * @brief Producer: discard everything not yet consumed (only while the consumer is not reading)
+   */
+  void clear() { writeIndex_.store(readIndex_.load(std::memory_order_acquire), std::memory_order_release); }
+
+private:
+  std::vector<float> buffer_;
+  std::atomic<std::size_t> writeIndex_{0};
+  std::atomic<std::size_t> readIndex_{0};
+};
+
+} // namespace detail
+
+class DiskStreamer {
+public:
+  explicit DiskStreamer(const DiskStreamerOptions& options = DiskStreamerOptions{})
+      : options_(options), voices_(options.maxVoices) {
+    options_.ioBlockFrames = std::max<std::size_t>(options_.ioBlockFrames, 1);
+    options_.ringFrames = std::max(options_.ringFrames, options_.ioBlockFrames);
+    if (options_.backgroundThread) {
+      ioThread_ = std::thread([this] { ioLoop(); });
+    }
+  }
+
+  ~DiskStreamer() {
+    {
+      std::lock_guard<std::mutex> lock(wakeMutex_);
+      running_ = false;
+    }
+    wake_.notify_all();
+    if (ioThread_.joinable()) {
+      ioThread_.join();
+    }
+  }
+
+  DiskStreamer(const DiskStreamer&) = delete;
+  DiskStreamer& operator=(const DiskStreamer&) = delete;
+
+  /**
+   * @brief Register a sample and preload its head and loop starts into RAM
+   * Call before any voice uses the streamer; not realtime-safe.
+   * @return Sample id, or -1 if the file cannot be opened or decoded
+   */
+  int addSample(const std::string& path) {
+    auto sample = std::make_unique<StreamedSample>();
+    // Voices jump around the file, so the I/O thread prefetches explicitly instead of kernel readahead
+    if (!sample->reader.open(path, AccessPattern::Random) || !isConvertibleFormat(sample->reader.getFmtChunk())) {
+      return -1;
+    }
+    const FmtChunk& fmt = sample->reader.getFmtChunk();
+    sample->numChannels = fmt.numChannels;
+    sample->sampleRate = static_cast<uint32_t>(fmt.sampleRate);
+    sample->numFrames = sample->reader.getNumFrames();
+
+    if (!preload(*sample, 0, sample->head)) {
+      return -1;
+    }
+    for (const SampleLoop& loop : sample->reader.getMetadata().getSamplerChunk().sampleLoops) {
+      if (loop.start < 0 || static_cast<uint64_t>(loop.start) >= sample->numFrames || loop.end < loop.start) {
+        continue; // Ignore loops that point outside the data chunk
+      }
+      sample->loops.push_back(loop);
+      sample->loopHeads.emplace_back();
+      if (!preload(*sample, static_cast<uint64_t>(loop.start), sample->loopHeads.back())) {
+        return -1;
+      }
+    }
+
+    samples_.push_back(std::move(sample));
+    return static_cast<int>(samples_.size() - 1);
+  }
+
+  const StreamedSample& getSample(int sampleId) const { return *samples_[static_cast<std::size_t>(sampleId)]; }
+  std::size_t getNumSamples() const { return samples_.size(); }
+
+  /**
+   * @brief Start a voice
+   * @param sampleId Sample returned by addSample()
+   * @param loopIndex -1 to start at frame 0 (looping loops[0] if loop is set), or the index of
+   *                  the SampleLoop to start at (and loop over)
+   * @param loop Whether to wrap at the loop end; without a loop the voice ends with the sample
+   * @return Voice index, or -1 if every voice is busy
+   */
+  int noteOn(int sampleId, int loopIndex = -1, bool loop = true) {
+    if (sampleId < 0 || static_cast<std::size_t>(sampleId) >= samples_.size()) {
+      return -1;
+    }
+    const StreamedSample& sample = *samples_[static_cast<std::size_t>(sampleId)];
+    if (loopIndex >= static_cast<int>(sample.loops.size())) {
+      return -1;
+    }
+
+    for (std::size_t v = 0; v < voices_.size(); ++v) {
+      Voice& voice = voices_[v];
+      State expected = State::Idle;
+      if (!voice.state.compare_exchange_strong(expected, State::Starting, std::memory_order_acq_rel)) {
+        continue;
+      }
+
+      voice.sample = &sample;
+      const int activeLoop = loopIndex >= 0 ? loopIndex : (loop && !sample.loops.empty() ? 0 : -1);
+      voice.looping = loop && activeLoop >= 0;
+      if (voice.looping) {
+        voice.loopStart = static_cast<uint64_t>(sample.loops[static_cast<std::size_t>(activeLoop)].start);
+        voice.loopEnd = std::min<uint64_t>(
+            static_cast<uint64_t>(sample.loops[static_cast<std::size_t>(activeLoop)].end), sample.numFrames - 1);
+      }
+      voice.preload = loopIndex >= 0 ? &sample.loopHeads[static_cast<std::size_t>(loopIndex)] : &sample.head;
+
+      // Never play preloaded frames beyond the loop end; the stream takes over from there
+      uint64_t playable = voice.preload->samples.size() / sample.numChannels;
+      if (voice.looping && voice.preload->startFrame <= voice.loopEnd) {
+        playable = std::min<uint64_t>(playable, voice.loopEnd + 1 - voice.preload->startFrame);
+      }
+      voice.preloadFrames = playable;
+      voice.preloadConsumed.store(0, std::memory_order_relaxed);
+      voice.ringReady.store(false, std::memory_order_relaxed);
+      voice.streamEnded.store(false, std::memory_order_relaxed);
+      voice.generation.fetch_add(1, std::memory_order_release);
+      voice.state.store(State::Playing, std::memory_order_release);
+      wake_.notify_one();
+      return static_cast<int>(v);
+    }
+    return -1;
+  }
+
+  /**
+   * @brief Stop a voice immediately
+   * The voice is available for noteOn() again after the next I/O pass (the next
+   * serviceIo() call when backgroundThread is false).
+   */
+  void noteOff(int voiceIndex) {
+    if (voiceIndex >= 0 && static_cast<std::size_t>(voiceIndex) < voices_.size()) {
+      release(voices_[static_cast<std::size_t>(voiceIndex)]);
+    }
+  }
+
+  bool isVoiceActive(int voiceIndex) const {
+    return voiceIndex >= 0 && static_cast<std::size_t>(voiceIndex) < voices_.size() &&
+           voices_[static_cast<std::size_t>(voiceIndex)].state.load(std::memory_order_acquire) == State::Playing;
+  }
+
+  /**
+   * @brief Produce the next frames of a voice (interleaved floats, numChannels per frame)
+   *
+   * Frames missing because the disk stream has not caught up are filled with
+   * silence and counted as underruns. Once a non-looping voice reaches the end
+   * of its sample it is released and render() returns fewer frames than asked.
+   * @return Frames written to out
+   */
+  std::size_t render(int voiceIndex, float* out, std::size_t numFrames) {
+    if (!isVoiceActive(voiceIndex)) {
+      return 0;
+    }
+    Voice& voice = voices_[static_cast<std::size_t>(voiceIndex)];
+    const std::size_t channels = voice.sample->numChannels;
+    std::size_t done = 0;
+
+    // 1. Preloaded frames straight from RAM
+    const uint64_t consumed = voice.preloadConsumed.load(std::memory_order_relaxed);
+    if (consumed < voice.preloadFrames) {
+      const std::size_t n = static_cast<std::size_t>(std::min<uint64_t>(numFrames, voice.preloadFrames - consumed));
+      std::copy_n(voice.preload->samples.data() + consumed * channels, n * channels, out);
+      voice.preloadConsumed.store(consumed + n, std::memory_order_release);
+      done = n;
+    }
+
+    // 2. Streamed frames from the ring buffer
+    if (done < numFrames && voice.ringReady.load(std::memory_order_acquire)) {
+      done += voice.ring.read(out + done * channels, (numFrames - done) * channels) / channels;
+    }
+
+    if (done < numFrames) {
+      if (voice.streamEnded.load(std::memory_order_acquire) && voice.ring.available() == 0) {
+        // The whole sample has been played
+        release(voice);
+        return done;
+      }
+      // The disk could not keep up: output silence rather than wait
+      std::fill(out + done * channels, out + numFrames * channels, 0.0f);
+      underruns_.fetch_add(1, std::memory_order_relaxed);
+      voice.underruns.fetch_add(1, std::memory_order_relaxed);
+      wake_.notify_one();
+    }
+    return numFrames;
+  }
+
+  /**
+   * @brief Number of render() calls that had to output silence because streaming fell behind
+   */
+  uint64_t getUnderrunCount() const { return underruns_.load(std::memory_order_relaxed); }
+  uint64_t getVoiceUnderrunCount(int voiceIndex) const {
+    return voices_[static_cast<std::size_t>(voiceIndex)].underruns.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Run one scheduling pass: every voice that needs data gets one block, earliest deadline first
+   * Called by the background thread; call it yourself when backgroundThread is false.
+   * @return Number of blocks read from disk
+   */
+  std::size_t serviceIo() {
+    // Deadline = microseconds of audio the voice can still play before running dry; smallest first
+    using Candidate = std::pair<uint64_t, std::size_t>;
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> queue;
+    for (std::size_t v = 0; v < voices_.size(); ++v) {
+      Voice& voice = voices_[v];
+      const State state = voice.state.load(std::memory_order_acquire);
+      if (state == State::Released) {
+        // Done with the previous note: from here on noteOn() may rewrite the voice
+        voice.state.store(State::Idle, std::memory_order_release);
+        continue;
+      }
+      if (state != State::Playing) {
+        continue;
+      }
+      if (voice.servicedGeneration != voice.generation.load(std::memory_order_acquire)) {
+        restartStream(voice);
+      }
+      if (voice.streamEnded.load(std::memory_order_relaxed)) {
+        continue;
+      }
+      const std::size_t channels = voice.sample->numChannels;
+      if (voice.ring.freeSpace() / channels < std::min<uint64_t>(options_.ioBlockFrames, framesLeft(voice))) {
+        continue; // Full enough
+      }
+      const uint64_t preloadLeft = voice.preloadFrames - voice.preloadConsumed.load(std::memory_order_acquire);
+      const uint64_t bufferedFrames = preloadLeft + voice.ring.available() / channels;
+      queue.emplace(bufferedFrames * 1000000 / std::max<uint32_t>(voice.sample->sampleRate, 1), v);
+    }
+
+    std::size_t serviced = 0;
+    while (!queue.empty()) {
+      fillVoice(voices_[queue.top().second]);
+      queue.pop();
+      ++serviced;
+    }
+    return serviced;
+  }
+
+private:
+  // Idle -> Starting -> Playing on the audio thread, Playing -> Released on the audio thread,
+  // Released -> Idle on the I/O thread once it no longer touches the voice
+  enum class State { Idle, Starting, Playing, Released };
+
+  struct Voice {
+    std::atomic<State> state{State::Idle};
+    std::atomic<uint64_t> generation{0}; // Bumped by every noteOn()
+    uint64_t servicedGeneration = 0;     // I/O thread: generation the ring was last reset for
+
+    // Written by noteOn() only while Idle; read-only until the I/O thread has acknowledged the release
+    const StreamedSample* sample = nullptr;
+    const PreloadSegment* preload = nullptr;
+    uint64_t preloadFrames = 0;
+    bool looping = false;
+    uint64_t loopStart = 0;
+    uint64_t loopEnd = 0;
+
+    std::atomic<uint64_t> preloadConsumed{0};
+    std::atomic<bool> ringReady{false};
+    std::atomic<bool> streamEnded{false};
+    std::atomic<uint64_t> underruns{0};
+
+    // I/O thread only
+    uint64_t streamFrame = 0;
+    std::vector<uint8_t> rawBlock;
+    std::vector<float> floatBlock;
+    detail::SampleRing ring;
+  };
+
+  bool preload(StreamedSample& sample, uint64_t startFrame, PreloadSegment& segment) const {
+    const std::size_t frames =
+        static_cast<std::size_t>(std::min<uint64_t>(options_.preloadFrames, sample.numFrames - startFrame));
+    std::vector<uint8_t> raw(frames * sample.reader.getFrameSize());
+    if (sample.reader.readAt(startFrame, raw.data(), frames) != frames) {
+      return false;
+    }
+    segment.startFrame = startFrame;
+    segment.samples.resize(frames * sample.numChannels);
+    return convertToFloat(sample.reader.getFmtChunk(), raw.data(), segment.samples.size(), segment.samples.data());
+  }
+
+  /**
+   * @brief I/O thread: a new note started on this voice, empty its ring and continue after the preload
+   */
+  void restartStream(Voice& voice) {
+    // noteOn() already cleared ringReady, so render() is not reading the ring while it is reset
+    const std::size_t capacity = options_.ringFrames * voice.sample->numChannels;
+    if (voice.ring.capacity() != capacity) {
+      voice.ring.allocate(capacity);
+    }
+    voice.ring.clear();
+    voice.streamFrame = voice.preload->startFrame + voice.preloadFrames;
+    wrapLoop(voice);
+    voice.streamEnded.store(!voice.looping && voice.streamFrame >= voice.sample->numFrames, std::memory_order_release);
+    voice.servicedGeneration = voice.generation.load(std::memory_order_acquire);
+    voice.ringReady.store(true, std::memory_order_release);
+  }
+
+  void wrapLoop(Voice& voice) const {
+    if (voice.looping && voice.streamFrame > voice.loopEnd) {
+      voice.streamFrame = voice.loopStart;
+    }
+  }
+
+  /**
+   * @brief Frames that can be streamed before the next loop wrap or the end of the sample
+   */
+  uint64_t framesLeft(const Voice& voice) const {
+    const uint64_t end = voice.looping ? voice.loopEnd + 1 : voice.sample->numFrames;
+    return end > voice.streamFrame ? end - voice.streamFrame : 0;
+  }
+
+  /**
+   * @brief I/O thread: read one block from disk, decode it and push it into the voice's ring
+   */
+  void fillVoice(Voice& voice) {
+    const StreamedSample& sample = *voice.sample;
+    const std::size_t channels = sample.numChannels;
+    const std::size_t frameSize = sample.reader.getFrameSize();
+    const std::size_t frames = static_cast<std::size_t>(
+        std::min<uint64_t>({options_.ioBlockFrames, voice.ring.freeSpace() / channels, framesLeft(voice)}));
+    if (frames == 0) {
+      return;
+    }
+
+    voice.rawBlock.resize(frames * frameSize);
+    voice.floatBlock.resize(frames * channels);
+    const std::size_t got = sample.reader.readAt(voice.streamFrame, voice.rawBlock.data(), frames);
+    convertToFloat(sample.reader.getFmtChunk(), voice.rawBlock.data(), got * channels, voice.floatBlock.data());
+
+    // The voice may have been released meanwhile, but noteOn() cannot reuse it before the next
+    // serviceIo() pass, and restartStream() discards whatever is written here
+    voice.ring.write(voice.floatBlock.data(), got * channels);
+    voice.streamFrame += got;
+    wrapLoop(voice);
+
+    if (!voice.looping && voice.streamFrame >= sample.numFrames) {
+      voice.streamEnded.store(true, std::memory_order_release);
+    } else {
+      // Let the kernel start on the block after this one while the voice plays this one
+      sample.reader.prefetch(voice.streamFrame, options_.ioBlockFrames);
+    }
+  }
+
+  /**
+   * @brief Audio thread: stop a playing voice and hand it back to the I/O thread
+   */
+  static void release(Voice& voice) {
+    State expected = State::Playing;
+    voice.state.compare_exchange_strong(expected, State::Released, std::memory_order_acq_rel);
+  }
+
+  void ioLoop() {
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    while (running_) {
+      lock.unlock();
+      const std::size_t serviced = serviceIo();
+      lock.lock();
+      if (serviced == 0 && running_) {
+        // Nothing to read: sleep until a note starts, a voice underruns, or a short timeout passes
+        wake_.wait_for(lock, std::chrono::milliseconds(1));
+      }
+    }
+  }
+
+  DiskStreamerOptions options_;
+  std::vector<std::unique_ptr<StreamedSample>> samples_;
+  std::vector<Voice> voices_;
+  std::atomic<uint64_t> underruns_{0};
+
+  std::mutex wakeMutex_;
+  std::condition_variable wake_;
+  bool running_ = true;
+  std::thread ioThread_;
+};
+
+} // namespace wav
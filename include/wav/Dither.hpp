@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <wav/SampleKernels.hpp>
+#include <wav/WavFileUtils.hpp>
+
+namespace wav {
+
+/**
+ * @brief Dither added before rounding to the target bit depth
+ */
+enum class DitherType {
+  None, // Plain rounding (quantization error stays correlated with the signal)
+  Tpdf  // Triangular noise of +-1 LSB peak: error becomes signal-independent white noise
+};
+
+/**
+ * @brief Error-feedback filter that moves the requantization noise towards high frequencies
+ */
+enum class NoiseShaping {
+  None,
+  FirstOrder,  // NTF = 1 - z^-1
+  SecondOrder, // NTF = (1 - z^-1)^2
+  Wannamaker3  // Wannamaker's 3-tap psychoacoustically weighted filter for 44.1 kHz
+};
+
+/**
+ * @brief Settings for a Ditherer
+ */
+struct DitherOptions {
+  DitherType type = DitherType::Tpdf;
+  NoiseShaping shaping = NoiseShaping::None;
+  uint64_t seed = 0x5eed; // Same seed + same input = bit-identical output on every CPU
+};
+
+/**
+ * @brief Float to PCM requantization with TPDF dither and optional noise shaping
+ *
+ * Writes interleaved samples in the layout described by the target FmtChunk
+ * (8-bit unsigned, 16/24-bit signed little-endian). Without noise shaping the
+ * whole path is vectorized: dither comes from 8 parallel xorshift32 lanes
+ * (SampleKernels::tpdfNoise) and scaling, rounding, clamping and byte packing
+ * are fused in one kernel. Noise shaping needs each channel's previous errors,
+ * so that path runs per sample but still draws its dither from the vector
+ * generator. 32-bit PCM has more resolution than float, so it is rounded
+ * without dither or shaping.
+ *
+ * The noise sequence is consumed in sample order whatever the block sizes
+ * passed to quantize(), so a render is reproducible from its seed alone.
+ *
+ * Usage example:
+ *   wav::FmtChunk target = reader.getFmtChunk();
+ *   target.audioFormat = wav::AudioFormat::PCM;
+ *   target.bitsPerSample = 16;
+ *   target.blockAlign = target.numChannels * 2;
+ *   wav::DitherOptions options;
+ *   options.shaping = wav::NoiseShaping::SecondOrder;
+ *   wav::Ditherer ditherer(target, options);
+ *   std::vector<uint8_t> pcm(numFrames * target.blockAlign);
+ *   ditherer.quantize(mix.data(), numFrames, pcm.data());
+ */
+class Ditherer {
+public:
+  explicit Ditherer(const FmtChunk& target, const DitherOptions& options = DitherOptions{})
+      : target_(target), options_(options) {
+    reset();
+  }
+
+  /**
+   * @brief True if the target is 8, 16, 24 or 32-bit little-endian PCM with at least one channel
+   */
+  bool isSupported() const {
+    return target_.audioFormat == AudioFormat::PCM && target_.numChannels > 0 && !target_.bigEndian &&
+           (target_.bitsPerSample == 8 || target_.bitsPerSample == 16 || target_.bitsPerSample == 24 ||
+            target_.bitsPerSample == 32);
+  }
+
+  /**
+   * @brief Restart the noise sequence from the seed and clear the noise-shaping history
+   */
+  void reset() {
+    // splitmix64 spreads one seed over the generator lanes (xorshift32 must never start at 0)
+    uint64_t x = options_.seed;
+    for (uint32_t& lane : lanes_) {
+      x += 0x9e3779b97f4a7c15ull;
+      uint64_t z = x;
+      z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+      z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+      z ^= z >> 31;
+      lane = static_cast<uint32_t>(z) | 1u;
+    }
+    noiseUsed_ = kNoiseBlock;
+    errors_.assign(std::size_t(target_.numChannels) * kMaxTaps, 0.0f);
+    channel_ = 0;
+  }
+
+  /**
+   * @brief Quantize interleaved float frames in [-1, 1) to the target PCM layout
+   * @param src numFrames * numChannels floats
+   * @param dst Room for numFrames * blockAlign bytes
+   * @return false if the target format is not supported
+   */
+  bool quantize(const float* src, std::size_t numFrames, uint8_t* dst) {
+    if (!isSupported()) {
+      return false;
+    }
+    const std::size_t numSamples = numFrames * target_.numChannels;
+    const std::size_t stride = target_.bitsPerSample / 8;
+    if (target_.bitsPerSample == 32) {
+      quantize32(src, numSamples, dst);
+      return true;
+    }
+
+    const SampleKernels& kernels = sampleKernels();
+    const QuantizeKernel kernel = target_.bitsPerSample == 8    ? kernels.quantizeToPcm8
+                                  : target_.bitsPerSample == 16 ? kernels.quantizeToPcm16
+                                                                : kernels.quantizeToPcm24;
+    const bool dither = options_.type == DitherType::Tpdf;
+    std::size_t done = 0;
+    while (done < numSamples) {
+      std::size_t count = numSamples - done;
+      const float* noise = nullptr;
+      if (dither) {
+        count = std::min(count, noiseAvailable());
+        noise = noise_.data() + noiseUsed_;
+        noiseUsed_ += count;
+      }
+      if (options_.shaping == NoiseShaping::None) {
+        kernel(src + done, noise, count, dst + done * stride);
+      } else {
+        quantizeShaped(src + done, noise, count, dst + done * stride);
+      }
+      done += count;
+    }
+    return true;
+  }
+
+  const FmtChunk& getTargetFormat() const { return target_; }
+  const DitherOptions& getOptions() const { return options_; }
+
+private:
+  static constexpr std::size_t kNoiseBlock = 1024; // Multiple of kDitherLanes
+  static constexpr std::size_t kMaxTaps = 3;
+
+  /**
+   * @brief Refill the noise block when it is used up and return how much of it is left
+   */
+  std::size_t noiseAvailable() {
+    if (noiseUsed_ == kNoiseBlock) {
+      sampleKernels().tpdfNoise(lanes_.data(), noise_.data(), kNoiseBlock);
+      noiseUsed_ = 0;
+    }
+    return kNoiseBlock - noiseUsed_;
+  }
+
+  /**
+   * @brief Error-feedback quantizer: v = x - h * e, q = round(v + d), e = q - v
+   */
+  void quantizeShaped(const float* src, const float* noise, std::size_t count, uint8_t* dst) {
+    static const float kFirstOrder[kMaxTaps] = {1.0f, 0.0f, 0.0f};
+    static const float kSecondOrder[kMaxTaps] = {2.0f, -1.0f, 0.0f};
+    static const float kWannamaker3[kMaxTaps] = {1.623f, -0.982f, 0.109f};
+    const float* h = options_.shaping == NoiseShaping::FirstOrder    ? kFirstOrder
+                     : options_.shaping == NoiseShaping::SecondOrder ? kSecondOrder
+                                                                     : kWannamaker3;
+    const unsigned bits = target_.bitsPerSample;
+    const float scale = float(1u << (bits - 1));
+    for (std::size_t i = 0; i < count; ++i) {
+      float* e = errors_.data() + channel_ * kMaxTaps;
+      const float v = src[i] * scale - (h[0] * e[0] + h[1] * e[1] + h[2] * e[2]);
+      float y = v + (noise ? noise[i] : 0.0f);
+      y = std::max(-scale, std::min(scale - 1.0f, y));
+      const int32_t q = static_cast<int32_t>(std::nearbyint(y));
+      // Clipping makes the error arbitrarily large; bound it so the feedback loop stays stable
+      const float error = std::max(-2.0f, std::min(2.0f, float(q) - v));
+      e[2] = e[1];
+      e[1] = e[0];
+      e[0] = error;
+
+      const uint32_t code = bits == 8 ? uint32_t(q + 128) : uint32_t(q);
+      for (unsigned b = 0; b < bits / 8; ++b) {
+        dst[i * (bits / 8) + b] = static_cast<uint8_t>(code >> (8 * b));
+      }
+      channel_ = channel_ + 1 == target_.numChannels ? 0 : channel_ + 1;
+    }
+  }
+
+  static void quantize32(const float* src, std::size_t numSamples, uint8_t* dst) {
+    for (std::size_t i = 0; i < numSamples; ++i) {
+      double v = double(src[i]) * 2147483648.0;
+      v = v > -2147483648.0 ? v : -2147483648.0;
+      v = v < 2147483647.0 ? v : 2147483647.0;
+      const uint32_t code = static_cast<uint32_t>(static_cast<int32_t>(std::nearbyint(v)));
+      for (unsigned b = 0; b < 4; ++b) {
+        dst[i * 4 + b] = static_cast<uint8_t>(code >> (8 * b));
+      }
+    }
+  }
+
+  FmtChunk target_;
+  DitherOptions options_;
+  std::array<uint32_t, kDitherLanes> lanes_{};
+  std::array<float, kNoiseBlock> noise_{};
+  std::size_t noiseUsed_ = kNoiseBlock;
+  std::vector<float> errors_; // kMaxTaps previous errors per channel, most recent first
+  unsigned channel_ = 0;      // Channel of the next sample, for interleaved noise shaping
+};
+
+} // namespace wav
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace wav {
+
+namespace detail {
+
+/**
+ * @brief In-place iterative radix-2 complex FFT of one fixed power-of-two size
+ */
+class Fft {
+public:
+  explicit Fft(std::size_t size) : size_(size), twiddles_(size / 2), reversed_(size) {
+    for (std::size_t k = 0; k < size / 2; ++k) {
+      const double angle = -2.0 * 3.14159265358979323846 * static_cast<double>(k) / static_cast<double>(size);
+      twiddles_[k] = std::complex<float>(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+    }
+    std::size_t bits = 0;
+    while ((std::size_t(1) << bits) < size) {
+      ++bits;
+    }
+    for (std::size_t i = 0; i < size; ++i) {
+      std::size_t r = 0;
+      for (std::size_t b = 0; b < bits; ++b) {
+        r |= ((i >> b) & 1) << (bits - 1 - b);
+      }
+      reversed_[i] = r;
+    }
+  }
+
+  std::size_t size() const { return size_; }
+
+  /**
+   * @brief Forward transform, or the unscaled inverse (the result is size() times the true inverse)
+   */
+  void transform(std::complex<float>* data, bool inverse) const {
+    for (std::size_t i = 0; i < size_; ++i) {
+      if (i < reversed_[i]) {
+        std::swap(data[i], data[reversed_[i]]);
+      }
+    }
+    for (std::size_t length = 2; length <= size_; length <<= 1) {
+      const std::size_t half = length / 2;
+      const std::size_t stride = size_ / length;
+      for (std::size_t start = 0; start < size_; start += length) {
+        for (std::size_t k = 0; k < half; ++k) {
+          const std::complex<float> w = inverse ? std::conj(twiddles_[k * stride]) : twiddles_[k * stride];
+          const std::complex<float> odd = w * data[start + k + half];
+          data[start + k + half] = data[start + k] - odd;
+          data[start + k] += odd;
+        }
+      }
+    }
+  }
+
+private:
+  std::size_t size_;
+  std::vector<std::complex<float>> twiddles_;
+  std::vector<std::size_t> reversed_;
+};
+
+} // namespace detail
+
+} // namespace wav
@@ -0,0 +1,424 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <wav/FileHandle.hpp>
+#include <wav/WavFileUtils.hpp>
+
+namespace wav {
+
+/**
+ * @brief Identity of a file on disk: the same path is only reused while inode, mtime and size are unchanged
+ */
+struct FileIdentity {
+  uint64_t device = 0;
+  uint64_t inode = 0;
+  int64_t mtimeNanos = 0;
+  uint64_t size = 0;
+
+  friend bool operator==(const FileIdentity& a, const FileIdentity& b) {
+    return a.device == b.device && a.inode == b.inode && a.mtimeNanos == b.mtimeNanos && a.size == b.size;
+  }
+  friend bool operator!=(const FileIdentity& a, const FileIdentity& b) { return !(a == b); }
+};
+
+/**
+ * @brief Look up the identity of a path (false if it cannot be stat'ed)
+ */
+inline bool statFileIdentity(const std::string& path, FileIdentity& identity) {
+#if WAV_HAVE_POSIX_IO
+  struct stat st;
+  if (::stat(path.c_str(), &st) != 0) {
+    return false;
+  }
+  identity.device = static_cast<uint64_t>(st.st_dev);
+  identity.inode = static_cast<uint64_t>(st.st_ino);
+#if defined(__APPLE__)
+  identity.mtimeNanos = int64_t(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+  identity.mtimeNanos = int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+  identity.size = static_cast<uint64_t>(st.st_size);
+  return true;
+#else
+  std::error_code ec;
+  const auto mtime = std::filesystem::last_write_time(path, ec);
+  const auto size = std::filesystem::file_size(path, ec);
+  if (ec) {
+    return false;
+  }
+  identity.mtimeNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(mtime.time_since_epoch()).count();
+  identity.size = size;
+  return true;
+#endif
+}
+
+/**
+ * @brief One parsed, read-only WAV file shared by every reader in the process
+ *
+ * The headers are parsed once (metadata-only) and the sample bytes are either
+ * memory-mapped straight from the file or loaded into a single shared buffer.
+ * Instances are immutable, so any number of threads may read them concurrently.
+ */
+class CachedWav {
+public:
+  CachedWav(const CachedWav&) = delete;
+  CachedWav& operator=(const CachedWav&) = delete;
+
+  ~CachedWav() {
+#if WAV_HAVE_POSIX_IO
+    if (mapping_) {
+      ::munmap(mapping_, mappingLength_);
+    }
+#endif
+  }
+
+  /**
+   * @brief Parsed chunks (fmt, cue, smpl, chunk list, ...); its DataChunk holds no sample bytes
+   */
+  const WavFileUtils& getMetadata() const { return metadata_; }
+  const FmtChunk& getFmtChunk() const { return metadata_.getFmtChunk(); }
+  const FileIdentity& getIdentity() const { return identity_; }
+  const std::string& getPath() const { return path_; }
+
+  /**
+   * @brief Raw bytes of the data chunk, exactly like DataChunk::sampleDataInBytes
+   */
+  const uint8_t* getSampleData() const { return samples_; }
+  std::size_t getSampleDataSize() const { return sampleBytes_; }
+
+  bool isMemoryMapped() const { return mapping_ != nullptr; }
+
+private:
+  friend class FileCache;
+  CachedWav() = default;
+
+  std::string path_;
+  FileIdentity identity_;
+  WavFileUtils metadata_;
+  const uint8_t* samples_ = nullptr;
+  std::size_t sampleBytes_ = 0;
+  void* mapping_ = nullptr;
+  std::size_t mappingLength_ = 0;
+  std::vector<uint8_t> buffer_; // Used when the file is not memory-mapped
+};
+
+/**
+ * @brief Options for a FileCache
+ */
+struct FileCacheOptions {
+  std::size_t memoryBudgetBytes = 0;                   // Sample bytes kept by the cache (0 = unlimited)
+  bool useMmap = true;                                 // Map sample data instead of copying it to the heap
+  AccessPattern accessPattern = AccessPattern::Normal; // madvise() hint for mapped sample data
+};
+
+/**
+ * @brief Process-wide, reference-counted cache of parsed WAV files
+ *
+ * Entries are keyed by path and validated against the file's device, inode,
+ * mtime and size, so a file rewritten on disk is loaded again. Concurrent
+ * acquire() calls for the same file wait for a single load. When the sample
+ * bytes held by the cache exceed the memory budget, the least recently used
+ * entries that no reader is holding any more are evicted; entries still in use
+ * stay alive through their shared_ptr and are evicted as soon as the last
+ * reader releases them, if the cache is still over budget by then.
+ *
+ * Usage example:
+ *   std::shared_ptr<const wav::CachedWav> wav = wav::FileCache::instance().acquire("piano_C4.wav");
+ *   if (wav) {
+ *     const uint8_t* bytes = wav->getSampleData();
+ *     std::cout << wav->getFmtChunk().numChannels << " channels\n";
+ *   }
+ */
+class FileCache {
+public:
+  explicit FileCache(const FileCacheOptions& options = FileCacheOptions{})
+      : options_(options), releaseHook_(std::make_shared<ReleaseHook>()) {
+    releaseHook_->cache = this;
+  }
+
+  ~FileCache() {
+    std::lock_guard<std::mutex> lock(releaseHook_->mutex);
+    releaseHook_->cache = nullptr; // Files still held by readers outlive the cache
+  }
+
+  FileCache(const FileCache&) = delete;
+  FileCache& operator=(const FileCache&) = delete;
+
+  /**
+   * @brief The shared process-wide cache
+   */
+  static FileCache& instance() {
+    static FileCache cache;
+    return cache;
+  }
+
+  /**
+   * @brief Counters for monitoring cache efficiency
+   */
+  struct Stats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+  };
+
+  /**
+   * @brief Get the cached file, loading it if needed
+   * @return nullptr if the file cannot be opened or is not a valid WAV file
+   * Exceptions thrown while loading (e.g. std::bad_alloc) reach the loading thread and every
+   * thread waiting for the same file; nothing is cached for it, so the next call tries again.
+   */
+  std::shared_ptr<const CachedWav> acquire(const std::string& path) {
+    FileIdentity identity;
+    if (!statFileIdentity(path, identity)) {
+      return nullptr;
+    }
+
+    std::promise<std::shared_ptr<const CachedWav>> promise;
+    std::shared_future<std::shared_ptr<const CachedWav>> future;
+    uint64_t generation = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = index_.find(path);
+      if (it != index_.end() && it->second->identity == identity) {
+        ++stats_.hits;
+        lru_.splice(lru_.begin(), lru_, it->second); // Mark as most recently used
+        if (isLoaded(*it->second)) {
+          return handOutLocked(*it->second, it->second->value.get());
+        }
+        future = it->second->value;
+      } else {
+        if (it != index_.end()) {
+          // The file changed on disk: forget the stale entry
+          removeLocked(it->second);
+        }
+        ++stats_.misses;
+        generation = ++nextGeneration_;
+        future = promise.get_future().share();
+        lru_.push_front(Entry{path, identity, future, {}, 0, generation});
+        index_[path] = lru_.begin();
+      }
+    }
+
+    // Another thread is loading this file: wait for its result
+    if (generation == 0) {
+      std::shared_ptr<const CachedWav> wav = future.get();
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = index_.find(path);
+      const bool cached = it != index_.end() && isLoaded(*it->second) && it->second->value.get() == wav;
+      return cached ? handOutLocked(*it->second, wav) : makeHandle(wav);
+    }
+
+    // We are the loader; parse and map outside the lock so other files are not blocked
+    std::shared_ptr<const CachedWav> wav;
+    try {
+      wav = load(path, identity);
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = index_.find(path);
+      if (it != index_.end() && it->second->generation == generation) {
+        removeLocked(it->second);
+      }
+      throw;
+    }
+    promise.set_value(wav);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = index_.find(path);
+    if (it == index_.end() || it->second->generation != generation) {
+      return makeHandle(wav); // Cleared or replaced meanwhile
+    }
+    if (!wav) {
+      removeLocked(it->second);
+      return nullptr;
+    }
+    it->second->bytes = wav->getSampleDataSize();
+    usedBytes_ += it->second->bytes;
+    std::shared_ptr<const CachedWav> handle = handOutLocked(*it->second, wav);
+    evictLocked();
+    return handle;
+  }
+
+  void setMemoryBudget(std::size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    options_.memoryBudgetBytes = bytes;
+    evictLocked();
+  }
+
+  /**
+   * @brief Sample bytes currently held by the cache
+   */
+  std::size_t memoryUsage() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return usedBytes_;
+  }
+
+  std::size_t size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return lru_.size();
+  }
+
+  Stats getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+  /**
+   * @brief Drop every entry (readers still holding files keep them alive)
+   */
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_.clear();
+    lru_.clear();
+    usedBytes_ = 0;
+  }
+
+private:
+  struct Entry {
+    std::string path;
+    FileIdentity identity;
+    std::shared_future<std::shared_ptr<const CachedWav>> value;
+    std::weak_ptr<const CachedWav> readers; // The handle shared by every reader; expired while none holds the file
+    std::size_t bytes;                      // Sample bytes accounted to this entry once loaded
+    uint64_t generation;                    // Distinguishes reloads of the same path
+  };
+  using EntryIterator = std::list<Entry>::iterator;
+
+  /**
+   * @brief Where the last reader of a file reports back; cleared when the cache is destroyed first
+   */
+  struct ReleaseHook {
+    std::mutex mutex;
+    FileCache* cache = nullptr;
+  };
+
+  static bool isLoaded(const Entry& entry) {
+    return entry.value.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+  }
+
+  /**
+   * @brief The readers' handle for a loaded entry, shared with every other reader of it
+   */
+  std::shared_ptr<const CachedWav> handOutLocked(Entry& entry, const std::shared_ptr<const CachedWav>& wav) {
+    std::shared_ptr<const CachedWav> handle = entry.readers.lock();
+    if (!handle && wav) {
+      handle = makeHandle(wav);
+      entry.readers = handle;
+    }
+    return handle;
+  }
+
+  /**
+   * @brief A handle that keeps wav alive and, once its last copy is gone, lets the cache evict it
+   */
+  std::shared_ptr<const CachedWav> makeHandle(std::shared_ptr<const CachedWav> wav) const {
+    if (!wav) {
+      return nullptr;
+    }
+    const CachedWav* raw = wav.get();
+    return std::shared_ptr<const CachedWav>(raw, [hook = releaseHook_, wav = std::move(wav)](const CachedWav*) mutable {
+      wav.reset(); // Leave only the cache's reference, so that eviction sees the file as unused
+      std::lock_guard<std::mutex> hookLock(hook->mutex);
+      if (hook->cache) {
+        std::lock_guard<std::mutex> lock(hook->cache->mutex_);
+        hook->cache->evictLocked();
+      }
+    });
+  }
+
+  std::shared_ptr<const CachedWav> load(const std::string& path, const FileIdentity& identity) const {
+    std::shared_ptr<CachedWav> wav(new CachedWav());
+    wav->path_ = path;
+    wav->identity_ = identity;
+
+    FileHandle file;
+    if (!file.open(path)) {
+      return nullptr;
+    }
+    OpenOptions openOptions;
+    openOptions.mode = ReadMode::MetadataOnly;
+    openOptions.verbose = false;
+    wav->metadata_.setOpenOptions(openOptions);
+    if (!wav->metadata_.open(file)) {
+      return nullptr;
+    }
+
+    const uint64_t dataOffset = wav->metadata_.getDataOffset();
+    const uint64_t fileSize = file.size();
+    const uint64_t available = dataOffset > 0 && fileSize > dataOffset ? fileSize - dataOffset : 0;
+    const std::size_t bytes =
+        static_cast<std::size_t>(std::min<uint64_t>(wav->metadata_.getDataChunk().chunkSize, available));
+    if (bytes == 0) {
+      return wav;
+    }
+
+#if WAV_HAVE_POSIX_IO
+    if (options_.useMmap) {
+      void* mapping = ::mmap(nullptr, static_cast<std::size_t>(fileSize), PROT_READ, MAP_SHARED, file.fd(), 0);
+      if (mapping != MAP_FAILED) {
+        wav->mapping_ = mapping;
+        wav->mappingLength_ = static_cast<std::size_t>(fileSize);
+        wav->samples_ = static_cast<const uint8_t*>(mapping) + dataOffset;
+        wav->sampleBytes_ = bytes;
+        adviseMapping(mapping, wav->mappingLength_, options_.accessPattern);
+        return wav;
+      }
+    }
+#endif
+
+    wav->buffer_.resize(bytes);
+    if (file.readAt(dataOffset, wav->buffer_.data(), bytes) != bytes) {
+      return nullptr;
+    }
+    wav->samples_ = wav->buffer_.data();
+    wav->sampleBytes_ = bytes;
+    return wav;
+  }
+
+  void removeLocked(EntryIterator it) {
+    usedBytes_ -= it->bytes;
+    index_.erase(it->path);
+    lru_.erase(it);
+  }
+
+  /**
+   * @brief Evict least recently used, unreferenced entries until usage fits the budget
+   */
+  void evictLocked() {
+    if (options_.memoryBudgetBytes == 0) {
+      return;
+    }
+    auto it = lru_.end();
+    while (usedBytes_ > options_.memoryBudgetBytes && it != lru_.begin()) {
+      --it;
+      if (isLoaded(*it) && it->value.get() && it->readers.expired()) {
+        auto victim = it++;
+        removeLocked(victim);
+        ++stats_.evictions;
+      }
+    }
+  }
+
+  FileCacheOptions options_;
+  std::shared_ptr<ReleaseHook> releaseHook_;
+  mutable std::mutex mutex_;
+  std::list<Entry> lru_; // Most recently used first
+  std::unordered_map<std::string, EntryIterator> index_;
+  std::size_t usedBytes_ = 0;
+  uint64_t nextGeneration_ = 0;
+  Stats stats_;
+};
+
+} // namespace wav
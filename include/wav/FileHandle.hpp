@@ -0,0 +1,629 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <wav/Instrumentation.hpp>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define WAV_HAVE_POSIX_IO 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define WAV_HAVE_POSIX_IO 0
+#endif
+
+namespace wav {
+
+/**
+ * @brief How a file is going to be read, used to pick kernel readahead/caching hints
+ *
+ * On Linux the hints map to posix_fadvise()/readahead()/madvise(); elsewhere they are no-ops.
+ */
+enum class AccessPattern {
+  Normal,      // No hint, kernel default readahead
+  Sequential,  // Streaming through the data chunk from start to end (aggressive readahead, drop-behind)
+  Random,      // Jumping between cue points / loops (readahead disabled, explicit prefetch only)
+  MetadataOnly // Only the headers are read; never pull sample data into the page cache
+};
+
+/**
+ * @brief Read-only file with positional reads and access-pattern hints
+ *
+ * readAt() never moves a shared file position (pread on POSIX), so one handle
+ * can be shared between threads. The handle is move-only and closes the file
+ * when destroyed.
+ *
+ * Usage example:
+ *   wav::FileHandle file;
+ *   if (file.open("audio.wav")) {
+ *     file.advise(wav::AccessPattern::Sequential, 0, file.size());
+ *     char header[12];
+ *     file.readAt(0, header, sizeof(header));
+ *   }
+ */
+class FileHandle {
+public:
+  FileHandle() = default;
+  ~FileHandle() { close(); }
+
+  FileHandle(const FileHandle&) = delete;
+  FileHandle& operator=(const FileHandle&) = delete;
+
+  FileHandle(FileHandle&& other) noexcept { *this = std::move(other); }
+  FileHandle& operator=(FileHandle&& other) noexcept {
+    if (this != &other) {
+      close();
+      path_ = std::move(other.path_);
+#if WAV_HAVE_POSIX_IO
+      fd_ = other.fd_;
+      other.fd_ = -1;
+#else
+      file_ = other.file_;
+      other.file_ = nullptr;
+      mutex_ = std::move(other.mutex_);
+#endif
+    }
+    return *this;
+  }
+
+  bool open(const std::string& path) {
+    close();
+#if WAV_HAVE_POSIX_IO
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+      return false;
+    }
+#else
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+      return false;
+    }
+    mutex_ = std::make_unique<std::mutex>();
+#endif
+    path_ = path;
+    return true;
+  }
+
+  void close() {
+#if WAV_HAVE_POSIX_IO
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+#else
+    if (file_) {
+      std::fclose(file_);
+      file_ = nullptr;
+    }
+#endif
+    path_.clear();
+  }
+
+#if WAV_HAVE_POSIX_IO
+  bool isOpen() const { return fd_ >= 0; }
+
+  /**
+   * @brief Underlying file descriptor (-1 if closed), for mmap()/sendfile() and similar
+   */
+  int fd() const { return fd_; }
+#else
+  bool isOpen() const { return file_ != nullptr; }
+#endif
+
+  const std::string& path() const { return path_; }
+
+  /**
+   * @brief Current size of the file in bytes (0 on error)
+   */
+  uint64_t size() const {
+#if WAV_HAVE_POSIX_IO
+    struct stat st;
+    if (fd_ < 0 || ::fstat(fd_, &st) != 0) {
+      return 0;
+    }
+    return static_cast<uint64_t>(st.st_size);
+#else
+    if (!file_) {
+      return 0;
+    }
+    std::lock_guard<std::mutex> lock(*mutex_);
+    std::fseek(file_, 0, SEEK_END);
+    return static_cast<uint64_t>(std::ftell(file_));
+#endif
+  }
+
+  /**
+   * @brief Read up to count bytes starting at offset, without touching any shared file position
+   * @return Number of bytes read; less than count only at end of file or on error
+   */
+  std::size_t readAt(uint64_t offset, void* dst, std::size_t count) const {
+    char* out = static_cast<char*>(dst);
+    std::size_t total = 0;
+#if WAV_HAVE_POSIX_IO
+    while (total < count) {
+      const ssize_t n = ::pread(fd_, out + total, count - total, static_cast<off_t>(offset + total));
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        break;
+      }
+      total += static_cast<std::size_t>(n);
+    }
+#else
+    std::lock_guard<std::mutex> lock(*mutex_);
+    if (std::fseek(file_, static_cast<long>(offset), SEEK_SET) == 0) {
+      total = std::fread(out, 1, count, file_);
+    }
+#endif
+    return total;
+  }
+
+  /**
+   * @brief Tell the kernel how [offset, offset + length) will be accessed
+   * A length of 0 means "to the end of the file".
+   */
+  void advise(AccessPattern pattern, uint64_t offset, uint64_t length) const {
+#if defined(__linux__)
+    int advice = POSIX_FADV_NORMAL;
+    switch (pattern) {
+    case AccessPattern::Normal:
+      advice = POSIX_FADV_NORMAL;
+      break;
+    case AccessPattern::Sequential:
+      advice = POSIX_FADV_SEQUENTIAL;
+      break;
+    case AccessPattern::Random:
+    case AccessPattern::MetadataOnly:
+      advice = POSIX_FADV_RANDOM;
+      break;
+    }
+    ::posix_fadvise(fd_, static_cast<off_t>(offset), static_cast<off_t>(length), advice);
+#else
+    (void)pattern;
+    (void)offset;
+    (void)length;
+#endif
+  }
+
+  /**
+   * @brief Start reading [offset, offset + length) into the page cache in the background
+   */
+  void willNeed(uint64_t offset, uint64_t length) const {
+#if defined(__linux__)
+    ::posix_fadvise(fd_, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+#else
+    (void)offset;
+    (void)length;
+#endif
+  }
+
+  /**
+   * @brief Drop [offset, offset + length) from the page cache (data already consumed by a stream)
+   */
+  void dontNeed(uint64_t offset, uint64_t length) const {
+#if defined(__linux__)
+    ::posix_fadvise(fd_, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_DONTNEED);
+#else
+    (void)offset;
+    (void)length;
+#endif
+  }
+
+private:
+  std::string path_;
+#if WAV_HAVE_POSIX_IO
+  int fd_ = -1;
+#else
+  std::FILE* file_ = nullptr;
+  std::unique_ptr<std::mutex> mutex_;
+#endif
+};
+
+/**
+ * @brief Write-only counterpart of FileHandle: creates (or truncates) a file and appends to it
+ *
+ * write() loops until every byte is written, so one call per block is one
+ * write() syscall in the common case. writeAt() patches bytes already written
+ * (e.g. size fields once the final length is known).
+ *
+ * Usage example:
+ *   wav::OutputFile out;
+ *   if (out.open("mono.wav") && out.write(header.data(), header.size()) && out.close()) {
+ *     // done
+ *   }
+ */
+class OutputFile {
+public:
+  OutputFile() = default;
+  ~OutputFile() { close(); }
+
+  OutputFile(const OutputFile&) = delete;
+  OutputFile& operator=(const OutputFile&) = delete;
+
+  bool open(const std::string& path) {
+    close();
+#if WAV_HAVE_POSIX_IO
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+      return false;
+    }
+#else
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+      return false;
+    }
+#endif
+    path_ = path;
+    return true;
+  }
+
+  /**
+   * @brief Open an existing file for editing in place: write() appends at its end, writeAt() patches earlier bytes
+   */
+  bool openExisting(const std::string& path) {
+    close();
+#if WAV_HAVE_POSIX_IO
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+      return false;
+    }
+    if (::lseek(fd_, 0, SEEK_END) < 0) {
+      close();
+      return false;
+    }
+#else
+    file_ = std::fopen(path.c_str(), "r+b");
+    if (!file_) {
+      return false;
+    }
+    if (std::fseek(file_, 0, SEEK_END) != 0) {
+      close();
+      return false;
+    }
+#endif
+    path_ = path;
+    return true;
+  }
+
+  /**
+   * @brief Cut the file (or extend it with zeros) to size bytes; the append position moves to the new end
+   */
+  bool truncate(uint64_t size) {
+#if WAV_HAVE_POSIX_IO
+    return ::ftruncate(fd_, static_cast<off_t>(size)) == 0 && ::lseek(fd_, 0, SEEK_END) >= 0;
+#else
+    (void)size;
+    return false; // No portable truncation through stdio
+#endif
+  }
+
+  /**
+   * @brief Close the file
+   * @return false if the file was not open or the final flush failed
+   */
+  bool close() {
+    bool ok = false;
+#if WAV_HAVE_POSIX_IO
+    if (fd_ >= 0) {
+      ok = ::close(fd_) == 0;
+      fd_ = -1;
+    }
+#else
+    if (file_) {
+      ok = std::fclose(file_) == 0;
+      file_ = nullptr;
+    }
+#endif
+    path_.clear();
+    return ok;
+  }
+
+#if WAV_HAVE_POSIX_IO
+  bool isOpen() const { return fd_ >= 0; }
+#else
+  bool isOpen() const { return file_ != nullptr; }
+#endif
+
+  const std::string& path() const { return path_; }
+
+  /**
+   * @brief Append count bytes
+   * @return false on a write error (e.g. disk full)
+   */
+  bool write(const void* src, std::size_t count) {
+    const char* in = static_cast<const char*>(src);
+#if WAV_HAVE_POSIX_IO
+    std::size_t total = 0;
+    while (total < count) {
+      const ssize_t n = ::write(fd_, in + total, count - total);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return false;
+      }
+      total += static_cast<std::size_t>(n);
+    }
+    return true;
+#else
+    return std::fwrite(in, 1, count, file_) == count;
+#endif
+  }
+
+  /**
+   * @brief Overwrite count bytes at offset without moving the append position
+   */
+  bool writeAt(uint64_t offset, const void* src, std::size_t count) {
+    const char* in = static_cast<const char*>(src);
+#if WAV_HAVE_POSIX_IO
+    std::size_t total = 0;
+    while (total < count) {
+      const ssize_t n = ::pwrite(fd_, in + total, count - total, static_cast<off_t>(offset + total));
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return false;
+      }
+      total += static_cast<std::size_t>(n);
+    }
+    return true;
+#else
+    const long end = std::ftell(file_);
+    const bool ok = std::fseek(file_, static_cast<long>(offset), SEEK_SET) == 0 &&
+                    std::fwrite(in, 1, count, file_) == count;
+    return std::fseek(file_, end, SEEK_SET) == 0 && ok;
+#endif
+  }
+
+private:
+  std::string path_;
+#if WAV_HAVE_POSIX_IO
+  int fd_ = -1;
+#else
+  std::FILE* file_ = nullptr;
+#endif
+};
+
+/**
+ * @brief Apply an access pattern to a memory-mapped file range with madvise()
+ * Use this when sample data is accessed through mmap() instead of FileHandle::readAt().
+ */
+inline void adviseMapping(void* address, std::size_t length, AccessPattern pattern) {
+#if WAV_HAVE_POSIX_IO
+  int advice = MADV_NORMAL;
+  switch (pattern) {
+  case AccessPattern::Normal:
+    advice = MADV_NORMAL;
+    break;
+  case AccessPattern::Sequential:
+    advice = MADV_SEQUENTIAL;
+    break;
+  case AccessPattern::Random:
+  case AccessPattern::MetadataOnly:
+    advice = MADV_RANDOM;
+    break;
+  }
+  ::madvise(address, length, advice);
+#else
+  (void)address;
+  (void)length;
+  (void)pattern;
+#endif
+}
+
+/**
+ * @brief Read-only shared mapping of a byte range of an open FileHandle
+ *
+ * The range does not have to start on a page boundary; data() points at its
+ * first byte. Reads through data() are plain memory loads, so any number of
+ * threads can use one mapping at the same time without locks or system calls.
+ * If the file is truncated while mapped, touching the lost pages raises SIGBUS.
+ * The mapping is move-only and unmapped when destroyed.
+ *
+ * Usage example:
+ *   wav::FileMapping samples;
+ *   if (samples.map(file, dataOffset, dataBytes, wav::AccessPattern::Random)) {
+ *     const uint8_t* frame = samples.data() + index * blockAlign;
+ *   }
+ */
+class FileMapping {
+public:
+  FileMapping() = default;
+  ~FileMapping() { unmap(); }
+
+  FileMapping(const FileMapping&) = delete;
+  FileMapping& operator=(const FileMapping&) = delete;
+
+  FileMapping(FileMapping&& other) noexcept { *this = std::move(other); }
+  FileMapping& operator=(FileMapping&& other) noexcept {
+    if (this != &other) {
+      unmap();
+      std::swap(base_, other.base_);
+      std::swap(baseLength_, other.baseLength_);
+      std::swap(data_, other.data_);
+      std::swap(size_, other.size_);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Map [offset, offset + length) of the file
+   * @return false if length is 0, the file is not open, or mmap() is unavailable or fails
+   */
+  bool map(const FileHandle& file, uint64_t offset, std::size_t length,
+           AccessPattern pattern = AccessPattern::Normal) {
+    unmap();
+#if WAV_HAVE_POSIX_IO
+    if (length == 0 || !file.isOpen()) {
+      return false;
+    }
+    const uint64_t pageSize = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    const uint64_t start = offset / pageSize * pageSize;
+    const std::size_t mapLength = static_cast<std::size_t>(offset - start) + length;
+    void* base = ::mmap(nullptr, mapLength, PROT_READ, MAP_SHARED, file.fd(), static_cast<off_t>(start));
+    if (base == MAP_FAILED) {
+      return false;
+    }
+    adviseMapping(base, mapLength, pattern);
+    base_ = base;
+    baseLength_ = mapLength;
+    data_ = static_cast<const uint8_t*>(base) + (offset - start);
+    size_ = length;
+    return true;
+#else
+    (void)file;
+    (void)offset;
+    (void)length;
+    (void)pattern;
+    return false;
+#endif
+  }
+
+  void unmap() {
+#if WAV_HAVE_POSIX_IO
+    if (base_) {
+      ::munmap(base_, baseLength_);
+    }
+#endif
+    base_ = nullptr;
+    baseLength_ = 0;
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  bool isMapped() const { return data_ != nullptr; }
+  const uint8_t* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+private:
+  void* base_ = nullptr;
+  std::size_t baseLength_ = 0;
+  const uint8_t* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+namespace detail {
+
+/**
+ * @brief Buffered sequential read position over a FileHandle
+ *
+ * Mirrors the small subset of std::istream that the chunk parsers use
+ * (read/gcount/seekg/tellg/good) so they can walk a file through positional reads.
+ * Small reads are served from an internal buffer refilled with one readAt() call,
+ * reads at least as large as the read-ahead window go straight to the file.
+ *
+ * The first refill reads only bufferSize bytes, which covers the header chunks of
+ * most files. Later refills read readAheadSize bytes, so a run of metadata chunks
+ * (e.g. cue, LIST and smpl after the sample data) arrives in one call. Refills never
+ * extend past the end of the file.
+ */
+class FileCursor {
+public:
+  explicit FileCursor(const FileHandle& file, ReadStats* stats = nullptr, std::size_t bufferSize = 4096,
+                      std::size_t readAheadSize = 0)
+      : file_(file), stats_(stats), size_(file.size()), probeSize_(std::max<std::size_t>(bufferSize, 1)),
+        windowSize_(std::max(probeSize_, readAheadSize)) {}
+
+  FileCursor& read(char* dst, std::streamsize count) {
+    lastCount_ = 0;
+    if (!good_) {
+      return *this;
+    }
+
+    std::size_t remaining = static_cast<std::size_t>(count);
+    while (remaining > 0) {
+      // Serve what we can from the buffer
+      if (pos_ >= bufferStart_ && pos_ < bufferStart_ + bufferLength_) {
+        const std::size_t offset = static_cast<std::size_t>(pos_ - bufferStart_);
+        const std::size_t n = std::min(remaining, bufferLength_ - offset);
+        std::memcpy(dst, buffer_.data() + offset, n);
+        dst += n;
+        pos_ += n;
+        remaining -= n;
+        lastCount_ += static_cast<std::streamsize>(n);
+        continue;
+      }
+
+      // Large reads bypass the buffer, small ones refill it
+      if (remaining >= windowSize_) {
+        const std::size_t n = fileRead(pos_, dst, remaining);
+        pos_ += n;
+        lastCount_ += static_cast<std::streamsize>(n);
+        remaining -= n;
+        break;
+      }
+      const std::size_t wanted = std::max(remaining, refills_ == 0 ? probeSize_ : windowSize_);
+      const std::size_t fill = pos_ < size_ ? static_cast<std::size_t>(std::min<uint64_t>(wanted, size_ - pos_)) : 0;
+      if (buffer_.size() < fill) {
+        buffer_.resize(fill);
+      }
+      bufferStart_ = pos_;
+      bufferLength_ = fill == 0 ? 0 : fileRead(pos_, buffer_.data(), fill);
+      ++refills_;
+      if (bufferLength_ == 0) {
+        break;
+      }
+    }
+
+    if (remaining > 0) {
+      good_ = false; // Like an istream hitting end of file
+    }
+    return *this;
+  }
+
+  std::streamsize gcount() const { return lastCount_; }
+
+  void seekg(std::streamoff offset, std::ios_base::seekdir dir) {
+    const int64_t base = dir == std::ios::beg ? 0 : dir == std::ios::end ? static_cast<int64_t>(size_) : int64_t(pos_);
+    pos_ = static_cast<uint64_t>(base + offset);
+  }
+
+  void seekg(uint64_t position) { pos_ = position; }
+
+  uint64_t tellg() const { return pos_; }
+
+  bool good() const { return good_; }
+
+  uint64_t size() const { return size_; }
+
+  const FileHandle& handle() const { return file_; }
+
+private:
+  std::size_t fileRead(uint64_t offset, void* dst, std::size_t count) {
+    const std::size_t n = file_.readAt(offset, dst, count);
+    if (stats_) {
+      countRead(*stats_, n);
+    }
+    return n;
+  }
+
+  const FileHandle& file_;
+  ReadStats* stats_;
+  uint64_t size_;
+  uint64_t pos_ = 0;
+  std::size_t probeSize_;  // Size of the first refill
+  std::size_t windowSize_; // Size of every later refill
+  std::vector<char> buffer_;
+  unsigned refills_ = 0;
+  uint64_t bufferStart_ = 0;
+  std::size_t bufferLength_ = 0;
+  std::streamsize lastCount_ = 0;
+  bool good_ = true;
+};
+
+} // namespace detail
+} // namespace wav
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <wav/SampleConversion.hpp>
+#include <wav/SampleKernels.hpp>
+#include <wav/WavFileUtils.hpp>
+
+namespace wav {
+
+/**
+ * @brief Detection and repair of NaN, Inf and denormal samples in IEEE_FLOAT data
+ *
+ * Buggy plugins leave NaN/Inf in float files, and denormals (subnormals) make
+ * most DSP code run many times slower. The scan is a few vector compares per
+ * block on clean data (the common case); only blocks with bad samples are
+ * rewritten. Samples are classified by their bit patterns, so the result does
+ * not depend on the caller's FTZ/DAZ floating-point mode.
+ *
+ * Three ways to use it:
+ *   - sanitizeFloatSamples(): in place over raw IEEE_FLOAT data chunk bytes
+ *   - convertToFloatSanitized(): fused with decoding, one cache-sized block at a time
+ *   - FloatSanitizer: a streaming stage that accumulates statistics over many blocks
+ *
+ * Usage example:
+ *   wav::FrameReader stream;
+ *   wav::FloatSanitizer sanitizer;
+ *   if (stream.open("mix.wav")) {
+ *     std::vector<uint8_t> block(4096 * stream.getFrameSize());
+ *     while (std::size_t frames = stream.read(block.data(), 4096)) {
+ *       sanitizer.process(stream.getFmtChunk(), block.data(), frames * stream.getFmtChunk().numChannels);
+ *       // process clean frames...
+ *     }
+ *     std::cout << sanitizer.getStats().nans << " NaN samples replaced\n";
+ *   }
+ */
+
+/**
+ * @brief Sanitize raw IEEE_FLOAT samples in place
+ * The bytes are little-endian as stored in the data chunk, which matches every host with SIMD kernels.
+ * Big-endian (RIFX) data is not rewritten in place; use convertToFloatSanitized() for it.
+ * @return false if fmt is not 32- or 64-bit little-endian IEEE_FLOAT
+ */
+inline bool sanitizeFloatSamples(const FmtChunk& fmt, uint8_t* bytes, std::size_t numSamples,
+                                 const SanitizeOptions& options, SanitizeStats& stats) {
+  if (fmt.audioFormat != AudioFormat::IEEE_FLOAT || fmt.bigEndian) {
+    return false;
+  }
+  const SampleKernels& kernels = sampleKernels();
+  if (fmt.bitsPerSample == 32) {
+    kernels.sanitizeFloat32(bytes, numSamples, options, stats);
+    return true;
+  }
+  if (fmt.bitsPerSample == 64) {
+    kernels.sanitizeFloat64(bytes, numSamples, options, stats);
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Sanitize decoded float samples in place
+ */
+inline void sanitizeFloats(float* samples, std::size_t numSamples, const SanitizeOptions& options,
+                           SanitizeStats& stats) {
+  sampleKernels().sanitizeFloat32(samples, numSamples, options, stats);
+}
+
+/**
+ * @brief convertToFloat() followed by sanitizing, done block by block while the output is still in L1
+ *
+ * PCM sources cannot produce bad values and are only converted. A float64
+ * source is checked after narrowing, so values that overflow or underflow
+ * float are caught as well.
+ * @return false if the format is not supported
+ */
+inline bool convertToFloatSanitized(const FmtChunk& fmt, const uint8_t* src, std::size_t numSamples, float* dst,
+                                    const SanitizeOptions& options, SanitizeStats& stats) {
+  const SampleKernels& kernels = sampleKernels();
+  const DecodeKernel decode = kernels.decoderFor(fmt);
+  if (!decode) {
+    return false;
+  }
+  if (fmt.audioFormat != AudioFormat::IEEE_FLOAT) {
+    decode(src, numSamples, dst);
+    return true;
+  }
+  constexpr std::size_t kBlockSamples = 4096; // 16 KiB of output per block
+  const std::size_t stride = bytesPerSample(fmt);
+  for (std::size_t first = 0; first < numSamples; first += kBlockSamples) {
+    const std::size_t count = std::min(kBlockSamples, numSamples - first);
+    decode(src + first * stride, count, dst + first);
+    kernels.sanitizeFloat32(dst + first, count, options, stats);
+  }
+  return true;
+}
+
+/**
+ * @brief Streaming sanitizer stage; statistics accumulate until reset()
+ */
+class FloatSanitizer {
+public:
+  explicit FloatSanitizer(const SanitizeOptions& options = SanitizeOptions{}) : options_(options) {}
+
+  /**
+   * @brief Sanitize one block of raw data chunk bytes in place
+   * @return false if fmt is not 32- or 64-bit IEEE_FLOAT (the block is left untouched)
+   */
+  bool process(const FmtChunk& fmt, uint8_t* bytes, std::size_t numSamples) {
+    return sanitizeFloatSamples(fmt, bytes, numSamples, options_, stats_);
+  }
+
+  /**
+   * @brief Sanitize one block of decoded float samples in place
+   */
+  void process(float* samples, std::size_t numSamples) { sanitizeFloats(samples, numSamples, options_, stats_); }
+
+  const SanitizeOptions& getOptions() const { return options_; }
+  const SanitizeStats& getStats() const { return stats_; }
+  void reset() { stats_ = SanitizeStats{}; }
+
+private:
+  SanitizeOptions options_;
+  SanitizeStats stats_;
+};
+
+} // namespace wav
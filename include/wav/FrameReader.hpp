@@ -0,0 +1,253 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <wav/FileHandle.hpp>
+#include <wav/WavFileUtils.hpp>
+
+namespace wav {
+
+/**
+ * @brief Tuning for AccessPattern::Sequential streaming
+ */
+struct StreamingHints {
+  uint64_t readAheadBytes = 4u << 20; // Size of each POSIX_FADV_WILLNEED window issued ahead of the cursor
+  bool dropBehind = true;             // POSIX_FADV_DONTNEED pages the cursor has already consumed
+};
+
+/**
+ * @brief Reads raw frames from the data chunk without loading the whole file
+ *
+ * The headers are parsed once in metadata-only mode (see WavFileUtils) through
+ * the same file handle that later serves sample reads, and the access pattern
+ * given to open() is turned into kernel hints on the data chunk range:
+ *   - Sequential:   fadvise(SEQUENTIAL) + WILLNEED windows ahead of the cursor
+ *                   + DONTNEED behind it, so long streams do not evict the rest of the cache
+ *   - Random:       fadvise(RANDOM); call prefetch() for cue/loop targets you are about to hit
+ *   - MetadataOnly: fadvise(RANDOM) on the whole file; sample reads still work but get no readahead
+ *
+ * Frames are returned as raw interleaved bytes, exactly as stored in the data
+ * chunk (use SampleConversion.hpp to decode them).
+ *
+ * Thread safety: once open() has returned, the const members (readAt(),
+ * prefetch() and the getters) may be called from any number of threads at
+ * once. readAt() uses positional reads (pread) and never touches the cursor,
+ * so concurrent calls neither lock nor see each other's data; after mapData()
+ * it copies straight out of the mapped data chunk without a system call.
+ * read() and seek() move the cursor and belong to a single thread, which may
+ * stream while other threads call readAt(). open(), close() and mapData()
+ * must not overlap any other call. (Without POSIX I/O, FileHandle serializes
+ * reads with a mutex: still safe, but not lock-free.)
+ *
+ * Usage example:
+ *   wav::FrameReader stream;
+ *   if (stream.open("audio.wav", wav::AccessPattern::Sequential)) {
+ *     std::vector<uint8_t> block(4096 * stream.getFrameSize());
+ *     while (std::size_t frames = stream.read(block.data(), 4096)) {
+ *       // process frames...
+ *     }
+ *   }
+ */
+class FrameReader {
+public:
+  FrameReader() = default;
+
+  /**
+   * @brief Open a WAV file for frame access
+   * @return false if the file cannot be opened, is not a valid WAV file or has no data chunk
+   */
+  bool open(const std::string& path, AccessPattern pattern = AccessPattern::Sequential,
+            const StreamingHints& hints = StreamingHints{}) {
+    close();
+    if (!file_.open(path)) {
+      return false;
+    }
+
+    OpenOptions options;
+    options.mode = ReadMode::MetadataOnly;
+    options.verbose = false;
+    metadata_.setOpenOptions(options);
+    if (!metadata_.open(file_) || metadata_.getDataOffset() == 0 || metadata_.getFmtChunk().blockAlign == 0) {
+      close();
+      return false;
+    }
+
+    pattern_ = pattern;
+    hints_ = hints;
+    frameSize_ = metadata_.getFmtChunk().blockAlign;
+    dataOffset_ = metadata_.getDataOffset();
+
+    // Only whole frames on disk are counted, so a file a recorder has not finished is never read past its end
+    numFrames_ = metadata_.getNumFrames();
+
+    applyPatternHints();
+    return true;
+  }
+
+  void close() {
+    mapping_.unmap();
+    file_.close();
+    numFrames_ = 0;
+    position_ = 0;
+    dataOffset_ = 0;
+    frameSize_ = 0;
+    prefetchedUntil_ = 0;
+    droppedUntil_ = 0;
+  }
+
+  bool isOpen() const { return file_.isOpen(); }
+
+  const WavFileUtils& getMetadata() const { return metadata_; }
+  const FmtChunk& getFmtChunk() const { return metadata_.getFmtChunk(); }
+  const FileHandle& getFileHandle() const { return file_; }
+  AccessPattern getAccessPattern() const { return pattern_; }
+
+  uint64_t getNumFrames() const { return numFrames_; }
+  uint32_t getFrameSize() const { return frameSize_; }
+
+  /**
+   * @brief Byte offset of frame 0 in the file
+   */
+  uint64_t getDataOffset() const { return dataOffset_; }
+
+  /**
+   * @brief Map the data chunk into memory so readAt() and read() copy from the page cache without a system call
+   *
+   * Worth it for many small concurrent reads (e.g. a voice pool reading grains of one file);
+   * long sequential reads are as fast through pread. The access pattern given to open() is
+   * applied to the mapping as well. Do not use on files that may be truncated while open.
+   * @return false if there are no frames or the platform cannot map files (readAt() keeps using pread)
+   */
+  bool mapData() {
+    return numFrames_ > 0 && mapping_.map(file_, dataOffset_, static_cast<std::size_t>(dataEnd() - dataOffset_),
+                                          pattern_ == AccessPattern::MetadataOnly ? AccessPattern::Random : pattern_);
+  }
+
+  bool isDataMapped() const { return mapping_.isMapped(); }
+
+  /**
+   * @brief Read the next numFrames frames at the cursor and advance it
+   * @param dst Buffer with room for numFrames * getFrameSize() bytes
+   * @return Frames actually read (0 at the end of the data chunk)
+   */
+  std::size_t read(void* dst, std::size_t numFrames) {
+    const std::size_t got = readAt(position_, dst, numFrames);
+    position_ += got;
+    if (pattern_ == AccessPattern::Sequential) {
+      updateStreamingHints();
+    }
+    return got;
+  }
+
+  /**
+   * @brief Move the cursor to an absolute frame index; getNumFrames() moves it to the end of the data
+   * @return false, leaving the cursor where it was, if frame is past the end of the data
+   */
+  bool seek(uint64_t frame) {
+    if (frame > numFrames_) {
+      return false;
+    }
+    position_ = frame;
+    if (pattern_ == AccessPattern::Sequential) {
+      // Restart the readahead and drop-behind windows at the new position
+      prefetchedUntil_ = byteOffset(frame);
+      droppedUntil_ = prefetchedUntil_;
+      updateStreamingHints();
+    }
+    return true;
+  }
+
+  uint64_t tell() const { return position_; }
+
+  /**
+   * @brief Read numFrames frames starting at an absolute frame index; the cursor is not moved
+   * @return Frames actually read
+   */
+  std::size_t readAt(uint64_t frame, void* dst, std::size_t numFrames) const {
+    if (frame >= numFrames_) {
+      return 0;
+    }
+    const std::size_t count = static_cast<std::size_t>(std::min<uint64_t>(numFrames, numFrames_ - frame));
+    if (mapping_.isMapped()) {
+      std::memcpy(dst, mapping_.data() + frame * frameSize_, count * frameSize_);
+      return count;
+    }
+    const std::size_t bytes = file_.readAt(byteOffset(frame), dst, count * frameSize_);
+    return bytes / frameSize_;
+  }
+
+  /**
+   * @brief Ask the kernel to start loading a frame range (e.g. the next cue point) in the background
+   */
+  void prefetch(uint64_t frame, std::size_t numFrames) const {
+    if (frame >= numFrames_) {
+      return;
+    }
+    const uint64_t count = std::min<uint64_t>(numFrames, numFrames_ - frame);
+    file_.willNeed(byteOffset(frame), count * frameSize_);
+  }
+
+private:
+  uint64_t byteOffset(uint64_t frame) const { return dataOffset_ + frame * frameSize_; }
+  uint64_t dataEnd() const { return byteOffset(numFrames_); }
+
+  void applyPatternHints() {
+    switch (pattern_) {
+    case AccessPattern::Normal:
+      break;
+    case AccessPattern::Sequential:
+      file_.advise(AccessPattern::Sequential, dataOffset_, dataEnd() - dataOffset_);
+      prefetchedUntil_ = dataOffset_;
+      droppedUntil_ = dataOffset_;
+      updateStreamingHints();
+      break;
+    case AccessPattern::Random:
+      file_.advise(AccessPattern::Random, dataOffset_, dataEnd() - dataOffset_);
+      break;
+    case AccessPattern::MetadataOnly:
+      // Already applied to the whole file while parsing the headers
+      break;
+    }
+  }
+
+  /**
+   * @brief Keep one readahead window in flight ahead of the cursor and release pages behind it
+   */
+  void updateStreamingHints() {
+    const uint64_t cursor = byteOffset(position_);
+    const uint64_t window = std::max<uint64_t>(hints_.readAheadBytes, 64 * 1024);
+
+    // Issue the next window once the cursor is within half a window of the prefetched end
+    while (prefetchedUntil_ < dataEnd() && cursor + window / 2 >= prefetchedUntil_) {
+      const uint64_t length = std::min(window, dataEnd() - prefetchedUntil_);
+      file_.willNeed(prefetchedUntil_, length);
+      prefetchedUntil_ += length;
+    }
+
+    // Drop consumed data in whole windows so the number of fadvise calls stays small
+    if (hints_.dropBehind && cursor >= droppedUntil_ + window) {
+      file_.dontNeed(droppedUntil_, cursor - droppedUntil_);
+      droppedUntil_ = cursor;
+    }
+  }
+
+  FileHandle file_;
+  FileMapping mapping_; // Data chunk, after mapData()
+  WavFileUtils metadata_;
+  AccessPattern pattern_ = AccessPattern::Sequential;
+  StreamingHints hints_;
+
+  uint64_t numFrames_ = 0;
+  uint64_t position_ = 0; // Cursor, in frames
+  uint64_t dataOffset_ = 0;
+  uint32_t frameSize_ = 0;
+
+  // Byte offsets (absolute in the file) of the streaming hint windows
+  uint64_t prefetchedUntil_ = 0;
+  uint64_t droppedUntil_ = 0;
+};
+
+} // namespace wav
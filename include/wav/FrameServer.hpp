@@ -0,0 +1,627 @@
+#pragma once
+
+#include <wav/FrameReader.hpp>
+
+#if WAV_HAVE_POSIX_IO
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <poll.h>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/sendfile.h>
+#endif
+
+namespace wav {
+
+namespace detail {
+
+/**
+ * @brief Wire protocol between FrameServer and RemoteFrameReader (little-endian, one file per connection)
+ *
+ * Request (24 bytes):  u32 type, u32 pathLength, u64 firstFrame, u64 numFrames
+ *   Open: followed by pathLength bytes of path; frame fields unused
+ *   Read: pathLength unused; frames [firstFrame, firstFrame + numFrames) of the open file
+ * Open response (32 bytes): u32 status, u16 audioFormat, u16 numChannels, u32 sampleRate,
+ *   u16 bitsPerSample, u16 blockAlign, u8 bigEndian, 3 bytes padding, 4 bytes padding, u64 numFrames
+ * Read response (16 bytes): u32 status, u32 padding, u64 byteCount, then byteCount bytes of raw frames
+ */
+enum FrameRequestType : uint32_t { FrameRequestOpen = 1, FrameRequestRead = 2 };
+enum FrameStatus : uint32_t { FrameStatusOk = 0, FrameStatusNotFound = 1, FrameStatusBadRequest = 2 };
+constexpr std::size_t kFrameRequestSize = 24;
+constexpr std::size_t kFrameOpenResponseSize = 32;
+constexpr std::size_t kFrameReadResponseSize = 16;
+constexpr uint32_t kFrameMaxPathLength = 4096;
+
+#if defined(MSG_NOSIGNAL)
+constexpr int kSendFlags = MSG_NOSIGNAL; // EPIPE instead of SIGPIPE when the peer is gone
+#else
+constexpr int kSendFlags = 0; // SO_NOSIGPIPE is set on the socket instead
+#endif
+
+/**
+ * @brief Close-on-exec stream socket that reports a vanished peer as EPIPE, not SIGPIPE where the OS allows
+ * Wraps an accepted descriptor when fd >= 0, creates a new AF_UNIX socket otherwise.
+ */
+inline int prepareSocket(int fd = -1) {
+  if (fd < 0) {
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  }
+  if (fd >= 0) {
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+#if defined(SO_NOSIGPIPE)
+    const int on = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+  }
+  return fd;
+}
+
+inline bool sendAll(int fd, const void* src, std::size_t count) {
+  const char* p = static_cast<const char*>(src);
+  while (count > 0) {
+    const ssize_t n = ::send(fd, p, count, kSendFlags);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    count -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+inline bool recvAll(int fd, void* dst, std::size_t count) {
+  char* p = static_cast<char*>(dst);
+  while (count > 0) {
+    const ssize_t n = ::recv(fd, p, count, 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    count -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+/**
+ * @brief Send [offset, offset + count) of a file: zero-copy sendfile() on Linux, pread + send elsewhere
+ */
+inline bool sendFileRange(int socket, const FileHandle& file, uint64_t offset, uint64_t count) {
+#if defined(__linux__)
+  off_t position = static_cast<off_t>(offset);
+  while (count > 0) {
+    const std::size_t chunk = static_cast<std::size_t>(std::min<uint64_t>(count, 1u << 30));
+    const ssize_t n = ::sendfile(socket, file.fd(), &position, chunk);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false; // Socket closed, or the file shrank under us
+    }
+    count -= static_cast<uint64_t>(n);
+  }
+  return true;
+#else
+  std::vector<char> buffer(1u << 16);
+  while (count > 0) {
+    const std::size_t chunk = static_cast<std::size_t>(std::min<uint64_t>(count, buffer.size()));
+    if (file.readAt(offset, buffer.data(), chunk) != chunk || !sendAll(socket, buffer.data(), chunk)) {
+      return false;
+    }
+    offset += chunk;
+    count -= chunk;
+  }
+  return true;
+#endif
+}
+
+inline bool makeSocketAddress(const std::string& path, sockaddr_un& address) {
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  return true;
+}
+
+} // namespace detail
+
+/**
+ * @brief Settings for a FrameServer
+ */
+struct FrameServerOptions {
+  std::string libraryRoot;   // If set, request paths are resolved against it and may not leave it
+  bool ignoreSigpipe = true; // Ignore SIGPIPE process-wide so a client hanging up mid-sendfile() cannot kill us
+};
+
+/**
+ * @brief Serves raw frame ranges of WAV files to other local processes over a Unix domain socket
+ *
+ * Each client connection opens one file and then asks for frame ranges. Files are
+ * opened through FrameReader and shared between all connections asking for the
+ * same path, so every file is parsed once; frames go from the page cache to the
+ * socket with sendfile() and never pass through user space. Every connection is
+ * served by its own thread.
+ *
+ * Use RemoteFrameReader on the client side.
+ *
+ * Usage example:
+ *   wav::FrameServer server;
+ *   wav::FrameServerOptions options;
+ *   options.libraryRoot = "/srv/samples";
+ *   if (server.start("/run/wav-frames.sock", options)) {
+ *     // ... serve until shutdown
+ *     server.stop();
+ *   }
+ */
+class FrameServer {
+public:
+  FrameServer() = default;
+  ~FrameServer() { stop(); }
+
+  FrameServer(const FrameServer&) = delete;
+  FrameServer& operator=(const FrameServer&) = delete;
+
+  /**
+   * @brief Bind socketPath (replacing a stale socket file) and start accepting clients
+   * @return false if the socket cannot be created or bound (see std::cerr)
+   */
+  bool start(const std::string& socketPath, const FrameServerOptions& options = FrameServerOptions{}) {
+    stop();
+    sockaddr_un address;
+    if (!detail::makeSocketAddress(socketPath, address)) {
+      std::cerr << "Error: Invalid socket path " << socketPath << "\n";
+      return false;
+    }
+    if (options.ignoreSigpipe) {
+      std::signal(SIGPIPE, SIG_IGN);
+    }
+    listenFd_ = detail::prepareSocket();
+    if (listenFd_ < 0 || ::pipe(wakePipe_) != 0) {
+      std::cerr << "Error: Cannot create socket for " << socketPath << "\n";
+      stop();
+      return false;
+    }
+    struct stat st;
+    if (::lstat(socketPath.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+      ::unlink(socketPath.c_str()); // Left behind by a server that did not shut down cleanly
+    }
+    if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listenFd_, SOMAXCONN) != 0) {
+      std::cerr << "Error: Cannot listen on " << socketPath << ": " << std::strerror(errno) << "\n";
+      stop();
+      return false;
+    }
+    socketPath_ = socketPath;
+    options_ = options;
+    acceptThread_ = std::thread([this] { acceptLoop(); });
+    return true;
+  }
+
+  /**
+   * @brief Stop accepting, disconnect every client, wait for their threads and remove the socket file
+   */
+  void stop() {
+    if (acceptThread_.joinable()) {
+      const char wake = 1;
+      (void)!::write(wakePipe_[1], &wake, 1);
+      acceptThread_.join();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (Connection& connection : connections_) {
+        ::shutdown(connection.fd, SHUT_RDWR);
+      }
+    }
+    for (Connection& connection : connections_) {
+      connection.thread.join();
+      ::close(connection.fd);
+    }
+    connections_.clear();
+    for (int* fd : {&listenFd_, &wakePipe_[0], &wakePipe_[1]}) {
+      if (*fd >= 0) {
+        ::close(*fd);
+        *fd = -1;
+      }
+    }
+    if (!socketPath_.empty()) {
+      ::unlink(socketPath_.c_str());
+      socketPath_.clear();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    files_.clear();
+  }
+
+  bool isRunning() const { return acceptThread_.joinable(); }
+
+  /**
+   * @brief Connections currently being served
+   */
+  std::size_t getNumConnections() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::count_if(connections_.begin(), connections_.end(),
+                         [](const Connection& connection) { return !connection.finished; });
+  }
+
+private:
+  struct Connection {
+    int fd = -1;
+    std::thread thread;
+    std::atomic<bool> finished{false};
+  };
+
+  /**
+   * @brief A file shared by the connections that opened it; the reader is ready once its opener has parsed it
+   */
+  struct OpenFile {
+    std::shared_future<std::weak_ptr<const FrameReader>> reader;
+    uint64_t generation = 0; // Tells the opener's entry apart from one that replaced it
+
+    // Opened, and no connection uses it any more (or the open failed)
+    bool unused() const {
+      return reader.wait_for(std::chrono::seconds(0)) == std::future_status::ready && reader.get().expired();
+    }
+  };
+
+  void acceptLoop() {
+    pollfd fds[2] = {{listenFd_, POLLIN, 0}, {wakePipe_[0], POLLIN, 0}};
+    for (;;) {
+      if (::poll(fds, 2, -1) < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return;
+      }
+      if (fds[1].revents != 0) {
+        return; // stop()
+      }
+      const int fd = detail::prepareSocket(::accept(listenFd_, nullptr, nullptr));
+      if (fd < 0) {
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(mutex_);
+      reapFinished();
+      connections_.emplace_back();
+      Connection& connection = connections_.back();
+      connection.fd = fd;
+      connection.thread = std::thread([this, &connection] {
+        serve(connection.fd);
+        connection.finished = true;
+      });
+    }
+  }
+
+  // Called with mutex_ held
+  void reapFinished() {
+    for (auto it = connections_.begin(); it != connections_.end();) {
+      if (it->finished) {
+        it->thread.join();
+        ::close(it->fd);
+        it = connections_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  void serve(int fd) {
+    std::shared_ptr<const FrameReader> file;
+    uint8_t request[detail::kFrameRequestSize];
+    while (detail::recvAll(fd, request, sizeof(request))) {
+      const uint32_t type = detail::loadLE32(request);
+      if (type == detail::FrameRequestOpen) {
+        const uint32_t pathLength = detail::loadLE32(request + 4);
+        if (pathLength == 0 || pathLength > detail::kFrameMaxPathLength) {
+          return;
+        }
+        std::string path(pathLength, '\0');
+        if (!detail::recvAll(fd, &path[0], pathLength)) {
+          return;
+        }
+        file = acquire(path);
+        if (!sendOpenResponse(fd, file.get())) {
+          return;
+        }
+      } else if (type == detail::FrameRequestRead) {
+        if (!sendFrames(fd, file.get(), detail::loadLE64(request + 8), detail::loadLE64(request + 16))) {
+          return;
+        }
+      } else {
+        return;
+      }
+    }
+  }
+
+  static bool sendOpenResponse(int fd, const FrameReader* file) {
+    std::vector<uint8_t> response;
+    detail::putLE32(response, file ? detail::FrameStatusOk : detail::FrameStatusNotFound);
+    const FmtChunk fmt = file ? file->getFmtChunk() : FmtChunk{};
+    detail::putLE16(response, static_cast<uint16_t>(fmt.audioFormat));
+    detail::putLE16(response, fmt.numChannels);
+    detail::putLE32(response, static_cast<uint32_t>(fmt.sampleRate));
+    detail::putLE16(response, fmt.bitsPerSample);
+    detail::putLE16(response, fmt.blockAlign);
+    response.push_back(fmt.bigEndian ? 1 : 0);
+    response.resize(24, 0);
+    detail::putLE64(response, file ? file->getNumFrames() : 0);
+    return detail::sendAll(fd, response.data(), response.size());
+  }
+
+  static bool sendFrames(int fd, const FrameReader* file, uint64_t firstFrame, uint64_t numFrames) {
+    std::vector<uint8_t> response;
+    if (!file) {
+      detail::putLE32(response, detail::FrameStatusBadRequest);
+      response.resize(detail::kFrameReadResponseSize, 0);
+      return detail::sendAll(fd, response.data(), response.size());
+    }
+    const uint64_t first = std::min(firstFrame, file->getNumFrames());
+    const uint64_t count = std::min(numFrames, file->getNumFrames() - first);
+    const uint64_t bytes = count * file->getFrameSize();
+    detail::putLE32(response, detail::FrameStatusOk);
+    detail::putLE32(response, 0);
+    detail::putLE64(response, bytes);
+    return detail::sendAll(fd, response.data(), response.size()) &&
+           detail::sendFileRange(fd, file->getFileHandle(), file->getDataOffset() + first * file->getFrameSize(),
+                                 bytes);
+  }
+
+  /**
+   * @brief Shared reader for a requested path, or nullptr if it is outside the library or not a readable WAV file
+   */
+  std::shared_ptr<const FrameReader> acquire(const std::string& requested) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::path path(requested);
+    if (!options_.libraryRoot.empty()) {
+      const fs::path root = fs::weakly_canonical(options_.libraryRoot, ec);
+      path = fs::weakly_canonical(root / path.relative_path(), ec);
+      const auto mismatch = std::mismatch(root.begin(), root.end(), path.begin(), path.end());
+      if (ec || mismatch.first != root.end()) {
+        return nullptr; // Escapes the library (.. or a symlink pointing outside)
+      }
+    }
+
+    // The first connection to ask for a file opens it outside the lock, so a slow or cold open does not hold
+    // up other files or the accept loop; connections asking for the same file meanwhile wait for that open
+    const std::string key = path.string();
+    for (int attempt = 0;; ++attempt) {
+      std::promise<std::weak_ptr<const FrameReader>> promise;
+      std::shared_future<std::weak_ptr<const FrameReader>> future;
+      uint64_t generation = 0;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = files_.find(key);
+        if (it != files_.end() && !it->second.unused()) {
+          future = it->second.reader;
+        } else {
+          for (auto other = files_.begin(); other != files_.end();) {
+            other = other->second.unused() ? files_.erase(other) : std::next(other);
+          }
+          generation = ++nextGeneration_;
+          future = promise.get_future().share();
+          files_[key] = OpenFile{future, generation};
+        }
+      }
+
+      if (generation == 0) {
+        if (std::shared_ptr<const FrameReader> reader = future.get().lock()) {
+          return reader;
+        }
+        if (attempt > 0) {
+          return nullptr;
+        }
+        continue; // The open failed, or every connection closed the file already: try it once ourselves
+      }
+
+      std::shared_ptr<FrameReader> reader = std::make_shared<FrameReader>();
+      bool opened = false;
+      try {
+        opened = reader->open(key, AccessPattern::Normal);
+      } catch (...) {
+        promise.set_value({});
+        forget(key, generation);
+        throw;
+      }
+      if (!opened) {
+        promise.set_value({});
+        forget(key, generation);
+        return nullptr;
+      }
+      promise.set_value(reader);
+      return reader;
+    }
+  }
+
+  /**
+   * @brief Drop a file entry whose open failed, unless it has been replaced meanwhile
+   */
+  void forget(const std::string& key, uint64_t generation) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = files_.find(key);
+    if (it != files_.end() && it->second.generation == generation) {
+      files_.erase(it);
+    }
+  }
+
+  FrameServerOptions options_;
+  std::string socketPath_;
+  int listenFd_ = -1;
+  int wakePipe_[2] = {-1, -1};
+  std::thread acceptThread_;
+
+  mutable std::mutex mutex_;
+  std::list<Connection> connections_; // std::list: serving threads hold references to their entry
+  std::map<std::string, OpenFile> files_;
+  uint64_t nextGeneration_ = 0;
+};
+
+/**
+ * @brief Client for a FrameServer with the frame access interface of FrameReader
+ *
+ * Each reader holds one connection and one open file. readAt() is one request
+ * and the frames are received straight into the caller's buffer. Calls on one
+ * reader are serialized; use one reader per thread for parallel reads.
+ *
+ * Usage example:
+ *   wav::RemoteFrameReader stream("/run/wav-frames.sock");
+ *   if (stream.open("drums/kick.wav")) {
+ *     std::vector<uint8_t> block(4096 * stream.getFrameSize());
+ *     while (std::size_t frames = stream.read(block.data(), 4096)) {
+ *       // process frames...
+ *     }
+ *   }
+ */
+class RemoteFrameReader {
+public:
+  explicit RemoteFrameReader(std::string socketPath) : socketPath_(std::move(socketPath)) {}
+  ~RemoteFrameReader() { close(); }
+
+  RemoteFrameReader(const RemoteFrameReader&) = delete;
+  RemoteFrameReader& operator=(const RemoteFrameReader&) = delete;
+
+  /**
+   * @brief Connect to the server and open a file there
+   * @return false if the server is unreachable or cannot open the file
+   */
+  bool open(const std::string& path) {
+    close();
+    sockaddr_un address;
+    if (!detail::makeSocketAddress(socketPath_, address) || path.empty() || path.size() > detail::kFrameMaxPathLength) {
+      return false;
+    }
+    fd_ = detail::prepareSocket();
+    if (fd_ < 0 || ::connect(fd_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+      close();
+      return false;
+    }
+    std::vector<uint8_t> request;
+    detail::putLE32(request, detail::FrameRequestOpen);
+    detail::putLE32(request, static_cast<uint32_t>(path.size()));
+    request.resize(detail::kFrameRequestSize, 0);
+    request.insert(request.end(), path.begin(), path.end());
+    uint8_t response[detail::kFrameOpenResponseSize];
+    if (!detail::sendAll(fd_, request.data(), request.size()) || !detail::recvAll(fd_, response, sizeof(response)) ||
+        detail::loadLE32(response) != detail::FrameStatusOk) {
+      close();
+      return false;
+    }
+    fmt_.audioFormat = static_cast<AudioFormat>(detail::loadLE16(response + 4));
+    fmt_.numChannels = detail::loadLE16(response + 6);
+    fmt_.sampleRate = detail::loadLE32(response + 8);
+    fmt_.bitsPerSample = detail::loadLE16(response + 12);
+    fmt_.blockAlign = detail::loadLE16(response + 14);
+    fmt_.avgBytesPerSec = fmt_.sampleRate * fmt_.blockAlign;
+    fmt_.bigEndian = response[16] != 0;
+    numFrames_ = detail::loadLE64(response + 24);
+    position_ = 0;
+    return true;
+  }
+
+  void close() {
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+    fmt_ = FmtChunk{};
+    numFrames_ = 0;
+    position_ = 0;
+  }
+
+  bool isOpen() const { return fd_ >= 0; }
+
+  const FmtChunk& getFmtChunk() const { return fmt_; }
+  uint64_t getNumFrames() const { return numFrames_; }
+  uint32_t getFrameSize() const { return fmt_.blockAlign; }
+
+  /**
+   * @brief Read up to numFrames frames at the cursor and advance it
+   * @return Number of frames read (0 at the end of the data chunk or if the connection failed)
+   */
+  std::size_t read(void* dst, std::size_t numFrames) {
+    const std::size_t got = readAt(position_, dst, numFrames);
+    position_ += got;
+    return got;
+  }
+
+  bool seek(uint64_t frame) {
+    if (frame > numFrames_) {
+      return false;
+    }
+    position_ = frame;
+    return true;
+  }
+
+  uint64_t tell() const { return position_; }
+
+  /**
+   * @brief Read up to numFrames frames starting at frame without moving the cursor
+   * A broken connection closes the reader; call open() again to reconnect.
+   */
+  std::size_t readAt(uint64_t frame, void* dst, std::size_t numFrames) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (fd_ < 0 || fmt_.blockAlign == 0) {
+      return 0;
+    }
+    std::vector<uint8_t> request;
+    detail::putLE32(request, detail::FrameRequestRead);
+    detail::putLE32(request, 0);
+    detail::putLE64(request, frame);
+    detail::putLE64(request, numFrames);
+    uint8_t response[detail::kFrameReadResponseSize];
+    if (!detail::sendAll(fd_, request.data(), request.size()) || !detail::recvAll(fd_, response, sizeof(response))) {
+      disconnect();
+      return 0;
+    }
+    const uint64_t bytes = detail::loadLE64(response + 8);
+    if (detail::loadLE32(response) != detail::FrameStatusOk || bytes > uint64_t(numFrames) * fmt_.blockAlign ||
+        bytes % fmt_.blockAlign != 0 || !detail::recvAll(fd_, dst, static_cast<std::size_t>(bytes))) {
+      disconnect();
+      return 0;
+    }
+    return static_cast<std::size_t>(bytes / fmt_.blockAlign);
+  }
+
+private:
+  // Called with mutex_ held; the stream position is unknown after a failed exchange
+  void disconnect() const {
+    ::close(fd_);
+    fd_ = -1;
+  }
+
+  std::string socketPath_;
+  mutable int fd_ = -1;
+  mutable std::mutex mutex_;
+  FmtChunk fmt_;
+  uint64_t numFrames_ = 0;
+  uint64_t position_ = 0;
+};
+
+} // namespace wav
+
+#endif // WAV_HAVE_POSIX_IO
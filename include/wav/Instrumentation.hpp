@@ -0,0 +1,266 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Optional instrumentation of the reader hot path
+ *
+ * Instrumentation is compiled out unless WAV_ENABLE_INSTRUMENTATION is defined
+ * to 1 before including any wav header (or passed as -DWAV_ENABLE_INSTRUMENTATION=1).
+ * When it is disabled every hook below is an empty inline function, so the
+ * reader pays nothing and ReadStats simply stays zero.
+ *
+ * Only function bodies depend on the setting: ReadStats, ScopedPhase and the
+ * classes that hold them have the same layout either way, so objects passed
+ * between translation units built with and without it stay compatible.
+ * Define it the same way across a program all the same; the linker keeps one
+ * copy of each inline hook, so a mixed build counts in all or none of them.
+ *
+ * Usage example:
+ *   #define WAV_ENABLE_INSTRUMENTATION 1
+ *   #include <wav/WavFileUtils.hpp>
+ *
+ *   wav::TraceRecorder::instance().setEnabled(true);
+ *   wav::WavFileUtils reader("audio.wav");
+ *   reader.open();
+ *   const wav::ReadStats& stats = reader.getReadStats();
+ *   std::cout << "bytes read: " << stats.bytesRead << "\n";
+ *   std::ofstream trace("trace.json");
+ *   wav::TraceRecorder::instance().writeChromeTrace(trace); // open in chrome://tracing or ui.perfetto.dev
+ */
+#ifndef WAV_ENABLE_INSTRUMENTATION
+#define WAV_ENABLE_INSTRUMENTATION 0
+#endif
+
+namespace wav {
+
+constexpr bool kInstrumentationEnabled = WAV_ENABLE_INSTRUMENTATION != 0;
+
+/**
+ * @brief Phases of open() that are timed separately
+ * Phases nest: Open covers the whole call and ChunkWalk covers every per-chunk phase.
+ */
+enum class ReadPhase : std::size_t { Open, Header, ChunkWalk, Fmt, Fact, Cue, Sampler, Data, Skip, Count };
+
+inline const char* readPhaseName(ReadPhase phase) {
+  static const char* const names[] = {"open", "header", "chunk_walk", "fmt", "fact", "cue", "smpl", "data", "skip"};
+  return phase < ReadPhase::Count ? names[static_cast<std::size_t>(phase)] : "unknown";
+}
+
+/**
+ * @brief Counters collected by one reader during its last open()
+ */
+struct ReadStats {
+  std::array<uint64_t, static_cast<std::size_t>(ReadPhase::Count)> phaseNanos{}; // Wall time per phase
+  uint64_t bytesRead = 0;      // Bytes returned by read calls
+  uint64_t readCalls = 0;      // Number of read calls issued to the stream / file descriptor
+  uint64_t seekCalls = 0;      // Number of seeks (including skips over chunk payloads)
+  uint64_t allocations = 0;    // Heap allocations made for chunk storage
+  uint64_t allocatedBytes = 0; // Bytes requested by those allocations
+
+  uint64_t nanos(ReadPhase phase) const { return phaseNanos[static_cast<std::size_t>(phase)]; }
+
+  void reset() { *this = ReadStats{}; }
+};
+
+/**
+ * @brief One complete ("ph":"X") event in the Chrome trace event format
+ */
+struct TraceEvent {
+  const char* name = "";
+  std::string file;
+  uint64_t startMicros = 0;
+  uint64_t durationMicros = 0;
+  uint64_t threadId = 0;
+};
+
+namespace detail {
+
+/**
+ * @brief Text as the contents of a JSON string: quotes, backslashes and control characters escaped
+ */
+inline std::string jsonEscape(const std::string& text) {
+  std::string out;
+  out.reserve(text.size() + 2);
+  for (char c : text) {
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        char buf[8];
+        std::snprintf(buf, sizeof(buf), "\\u%04x", static_cast<unsigned>(c));
+        out += buf;
+      } else {
+        out += c;
+      }
+    }
+  }
+  return out;
+}
+
+} // namespace detail
+
+/**
+ * @brief Process-wide collector of trace events
+ *
+ * Disabled by default; while disabled, timed phases only update ReadStats.
+ * The output of writeChromeTrace() loads directly in chrome://tracing and Perfetto.
+ */
+class TraceRecorder {
+public:
+  static TraceRecorder& instance() {
+    static TraceRecorder recorder;
+    return recorder;
+  }
+
+  void setEnabled(bool enabled) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_ = enabled;
+  }
+
+  bool isEnabled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return enabled_;
+  }
+
+  void record(TraceEvent event) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (enabled_) {
+      events_.push_back(std::move(event));
+    }
+  }
+
+  std::vector<TraceEvent> events() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_;
+  }
+
+  void clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.clear();
+  }
+
+  /**
+   * @brief Write all recorded events as a Chrome trace JSON document
+   */
+  void writeChromeTrace(std::ostream& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out << "{\"traceEvents\":[";
+    for (std::size_t i = 0; i < events_.size(); ++i) {
+      const TraceEvent& e = events_[i];
+      out << (i ? ",\n" : "\n") << "{\"name\":\"" << detail::jsonEscape(e.name) << "\",\"cat\":\"wav\",\"ph\":\"X\"";
+      out << ",\"ts\":" << e.startMicros << ",\"dur\":" << e.durationMicros << ",\"pid\":1,\"tid\":" << e.threadId;
+      out << ",\"args\":{\"file\":\"" << detail::jsonEscape(e.file) << "\"}}";
+    }
+    out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+  }
+
+private:
+  TraceRecorder() = default;
+
+  mutable std::mutex mutex_;
+  bool enabled_ = false;
+  std::vector<TraceEvent> events_;
+};
+
+namespace detail {
+
+inline uint64_t nowNanos() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+/**
+ * @brief RAII timer that adds its lifetime to one ReadStats phase (and emits a trace event)
+ */
+class ScopedPhase {
+public:
+  ScopedPhase(ReadStats& stats, ReadPhase phase, const std::string& file)
+      : stats_(stats), phase_(phase), file_(file), start_(kInstrumentationEnabled ? nowNanos() : 0) {}
+
+  ~ScopedPhase() {
+#if WAV_ENABLE_INSTRUMENTATION
+    const uint64_t end = nowNanos();
+    stats_.phaseNanos[static_cast<std::size_t>(phase_)] += end - start_;
+    TraceRecorder& recorder = TraceRecorder::instance();
+    if (recorder.isEnabled()) {
+      TraceEvent event;
+      event.name = readPhaseName(phase_);
+      event.file = file_;
+      event.startMicros = start_ / 1000;
+      event.durationMicros = (end - start_) / 1000;
+      event.threadId = std::hash<std::thread::id>{}(std::this_thread::get_id()) & 0xffffffffu;
+      recorder.record(std::move(event));
+    }
+#else
+    (void)stats_;
+    (void)phase_;
+    (void)file_;
+    (void)start_;
+#endif
+  }
+
+  ScopedPhase(const ScopedPhase&) = delete;
+  ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+private:
+  // Kept when instrumentation is compiled out too, so the layout does not depend on the setting
+  ReadStats& stats_;
+  ReadPhase phase_;
+  const std::string& file_;
+  uint64_t start_;
+};
+
+// Counter hooks; empty when instrumentation is compiled out
+
+inline void countRead(ReadStats& stats, uint64_t bytes) {
+#if WAV_ENABLE_INSTRUMENTATION
+  ++stats.readCalls;
+  stats.bytesRead += bytes;
+#else
+  (void)stats;
+  (void)bytes;
+#endif
+}
+
+inline void countSeek(ReadStats& stats) {
+#if WAV_ENABLE_INSTRUMENTATION
+  ++stats.seekCalls;
+#else
+  (void)stats;
+#endif
+}
+
+inline void countAllocation(ReadStats& stats, uint64_t bytes) {
+#if WAV_ENABLE_INSTRUMENTATION
+  ++stats.allocations;
+  stats.allocatedBytes += bytes;
+#else
+  (void)stats;
+  (void)bytes;
+#endif
+}
+
+} // namespace detail
+} // namespace wav
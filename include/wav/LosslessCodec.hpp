@@ -0,0 +1,1045 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <wav/FileHandle.hpp>
+#include <wav/FrameReader.hpp>
+#include <wav/ParallelJobs.hpp>
+#include <wav/SampleConversion.hpp>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace wav {
+
+/**
+ * @brief Settings for compressWav()
+ */
+struct CodecOptions {
+  uint32_t blockFrames = 4096; // Frames per independently decodable block (the seek granularity)
+  unsigned maxLpcOrder = 12;   // Highest linear prediction order tried per channel (at most 31)
+  unsigned threads = 8;        // Worker threads encoding blocks in parallel (0 = calling thread only)
+};
+
+namespace detail {
+
+/**
+ * @brief Archive layout
+ *   0   "WLPC" magic, u16 version, u16 reserved
+ *   8   u16 audioFormat, u16 numChannels, u32 sampleRate
+ *   16  u16 bitsPerSample, u16 blockAlign, u8 bigEndian, u8 coded, u16 reserved
+ *   24  u32 blockFrames, u32 reserved
+ *   32  u64 numFrames, u64 prefixSize, u64 suffixSize, u64 numBlocks
+ *   64  prefix: original file bytes before the samples (every chunk header and chunk in front of them)
+ *       suffix: original file bytes after the last whole frame (partial frame, padding, trailing chunks)
+ *       seek table: numBlocks + 1 absolute u64 offsets (the last one is the end of the final block)
+ *       blocks
+ *
+ * A block starts with one byte: kRawBlock (the original frames follow verbatim) or
+ * kCodedBlock (one bit-packed subframe per channel follows).
+ */
+constexpr uint8_t kCodecMagic[4] = {'W', 'L', 'P', 'C'};
+constexpr uint16_t kCodecVersion = 1;
+constexpr std::size_t kCodecHeaderSize = 64;
+constexpr uint8_t kRawBlock = 0;
+constexpr uint8_t kCodedBlock = 1;
+
+constexpr unsigned kLpcMaxOrder = 31;
+constexpr std::size_t kRicePartition = 256; // Residuals per Rice parameter
+constexpr unsigned kRiceEscape = 31;        // Rice parameter code for "stored as fixed-width values"
+
+enum SubframeType : unsigned { SubframeConstant = 0, SubframeVerbatim = 1, SubframeLpc = 2 };
+
+inline unsigned countLeadingZeros64(uint64_t x) {
+#if defined(_MSC_VER)
+  unsigned long index = 0;
+  _BitScanReverse64(&index, x);
+  return 63u - unsigned(index);
+#else
+  return unsigned(__builtin_clzll(x));
+#endif
+}
+
+/**
+ * @brief MSB-first bit packer appending to a byte vector
+ */
+class BitWriter {
+public:
+  explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+  void put(uint64_t value, unsigned bits) {
+    if (bits > 32) {
+      put(value >> 32, bits - 32);
+      put(value & 0xffffffffu, 32);
+      return;
+    }
+    acc_ = (acc_ << bits) | (value & ((uint64_t(1) << bits) - 1));
+    count_ += bits;
+    while (count_ >= 8) {
+      count_ -= 8;
+      out_.push_back(static_cast<uint8_t>(acc_ >> count_));
+    }
+  }
+
+  void putSigned(int64_t value, unsigned bits) { put(static_cast<uint64_t>(value), bits); }
+
+  void putUnary(uint64_t zeros) {
+    for (; zeros >= 32; zeros -= 32) {
+      put(0, 32);
+    }
+    put(1, unsigned(zeros) + 1);
+  }
+
+  void flush() {
+    if (count_ > 0) {
+      put(0, 8 - count_);
+    }
+  }
+
+private:
+  std::vector<uint8_t>& out_;
+  uint64_t acc_ = 0;
+  unsigned count_ = 0;
+};
+
+/**
+ * @brief MSB-first bit reader over a byte range
+ * Reading past the end yields zero bits and sets overrun(), so corrupt blocks fail instead of running away.
+ */
+class BitReader {
+public:
+  BitReader(const uint8_t* data, std::size_t size) : p_(data), end_(data + size) {}
+
+  uint64_t get(unsigned bits) {
+    if (bits == 0) {
+      return 0;
+    }
+    if (bits > 32) {
+      const uint64_t high = get(bits - 32);
+      return (high << 32) | get(32);
+    }
+    refill();
+    const uint64_t value = cache_ >> (64 - bits);
+    cache_ <<= bits;
+    count_ -= bits;
+    return value;
+  }
+
+  int64_t getSigned(unsigned bits) {
+    const uint64_t value = get(bits);
+    if (bits < 64 && bits > 0 && ((value >> (bits - 1)) & 1)) {
+      return static_cast<int64_t>(value | (~uint64_t(0) << bits));
+    }
+    return static_cast<int64_t>(value);
+  }
+
+  /**
+   * @brief Number of 0 bits before the next 1 bit (which is consumed too)
+   */
+  uint64_t getUnary() {
+    uint64_t zeros = 0;
+    for (;;) {
+      refill();
+      if (cache_ != 0) {
+        const unsigned z = countLeadingZeros64(cache_);
+        if (z < count_) {
+          cache_ <<= z + 1;
+          count_ -= z + 1;
+          return zeros + z;
+        }
+      }
+      zeros += count_;
+      cache_ = 0;
+      count_ = 0;
+      if (overrun()) {
+        return 0;
+      }
+    }
+  }
+
+  /**
+   * @brief One Rice code with parameter k: unary quotient, then k low bits
+   */
+  uint64_t getRice(unsigned k) {
+    refill();
+    if (cache_ != 0) {
+      const unsigned z = countLeadingZeros64(cache_);
+      if (z + 1 + k <= count_) { // Whole code already in the cache
+        cache_ <<= z + 1;
+        const uint64_t low = k ? cache_ >> (64 - k) : 0;
+        cache_ <<= k;
+        count_ -= z + 1 + k;
+        return (uint64_t(z) << k) | low;
+      }
+    }
+    const uint64_t q = getUnary();
+    return (q << k) | get(k);
+  }
+
+  bool overrun() const { return past_ > 8; }
+
+private:
+  void refill() {
+    if (count_ > 32) {
+      return;
+    }
+    if (end_ - p_ >= 8) {
+      // Bits past count_ are the stream's own next bits, so or-ing the same word again later is harmless
+      uint64_t word;
+      std::memcpy(&word, p_, 8);
+      cache_ |= byteSwapToBig(word) >> count_;
+      const unsigned bytes = (63 - count_) >> 3;
+      p_ += bytes;
+      count_ += bytes * 8;
+      return;
+    }
+    while (count_ <= 56) {
+      uint64_t byte = 0;
+      if (p_ < end_) {
+        byte = *p_++;
+      } else {
+        ++past_;
+      }
+      cache_ |= byte << (56 - count_);
+      count_ += 8;
+    }
+  }
+
+  static uint64_t byteSwapToBig(uint64_t v) {
+    uint8_t bytes[8];
+    std::memcpy(bytes, &v, 8);
+    uint64_t out = 0;
+    for (int i = 0; i < 8; ++i) {
+      out = (out << 8) | bytes[i];
+    }
+    return out;
+  }
+
+  const uint8_t* p_;
+  const uint8_t* end_;
+  uint64_t cache_ = 0; // Left-aligned
+  unsigned count_ = 0; // Valid bits in cache_
+  std::size_t past_ = 0;
+};
+
+inline uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+inline int64_t unzigzag(uint64_t u) { return static_cast<int64_t>(u >> 1) ^ -static_cast<int64_t>(u & 1); }
+
+/**
+ * @brief Layout of the frames a block holds
+ */
+struct BlockLayout {
+  unsigned channels = 0;
+  unsigned bits = 0;       // 8, 16, 24 or 32 (little-endian PCM)
+  unsigned blockAlign = 0; // channels * bits / 8
+};
+
+/**
+ * @brief One channel of raw frames as signed integers (8-bit PCM is re-centred around 0)
+ */
+inline void loadChannel(const uint8_t* raw, std::size_t numFrames, const BlockLayout& layout, unsigned channel,
+                        int32_t* out) {
+  const unsigned width = layout.bits / 8;
+  const uint8_t* p = raw + channel * width;
+  for (std::size_t i = 0; i < numFrames; ++i, p += layout.blockAlign) {
+    switch (width) {
+    case 1:
+      out[i] = int32_t(p[0]) - 128;
+      break;
+    case 2:
+      out[i] = static_cast<int16_t>(loadLE16(p));
+      break;
+    case 3:
+      out[i] = static_cast<int32_t>((uint32_t(p[0]) << 8) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 24)) >> 8;
+      break;
+    default:
+      out[i] = static_cast<int32_t>(loadLE32(p));
+      break;
+    }
+  }
+}
+
+inline void storeChannel(const int32_t* in, std::size_t numFrames, const BlockLayout& layout, unsigned channel,
+                         uint8_t* raw) {
+  const unsigned width = layout.bits / 8;
+  uint8_t* p = raw + channel * width;
+  for (std::size_t i = 0; i < numFrames; ++i, p += layout.blockAlign) {
+    const uint32_t v = width == 1 ? static_cast<uint32_t>(in[i] + 128) : static_cast<uint32_t>(in[i]);
+    for (unsigned b = 0; b < width; ++b) {
+      p[b] = static_cast<uint8_t>(v >> (8 * b));
+    }
+  }
+}
+
+/**
+ * @brief Integer predictor: x[i] ~ (sum_j coefs[j] * x[i - 1 - j]) >> shift
+ */
+struct Predictor {
+  unsigned order = 0;
+  unsigned precision = 4; // Bits per stored coefficient (signed)
+  unsigned shift = 0;
+  int32_t coefs[kLpcMaxOrder] = {};
+};
+
+/**
+ * @brief Run a predictor over x[order, n): Restore = false writes residual[i] = x[i] - prediction,
+ * Restore = true rebuilds x[i] = residual[i] + prediction (the decoder's direction)
+ * Order is a template argument for orders up to 12 so the inner loop is fully unrolled (0 = use p.order).
+ */
+template <bool Restore, unsigned Order>
+inline void runPredictor(int32_t* x, int64_t* residual, std::size_t n, const Predictor& p) {
+  const unsigned order = Order ? Order : p.order;
+  if (order == 0) {
+    for (std::size_t i = 0; i < n; ++i) {
+      if (Restore) {
+        x[i] = static_cast<int32_t>(residual[i]);
+      } else {
+        residual[i] = x[i];
+      }
+    }
+    return;
+  }
+  // The newest sample stays in a register: restoring x[i] only waits for one multiply-add on x[i - 1]
+  int64_t previous = x[order - 1];
+  for (std::size_t i = order; i < n; ++i) {
+    int64_t sum = 0;
+    for (unsigned j = 1; j < order; ++j) {
+      sum += int64_t(p.coefs[j]) * x[i - 1 - j];
+    }
+    sum += int64_t(p.coefs[0]) * previous;
+    if (Restore) {
+      x[i] = static_cast<int32_t>(residual[i] + (sum >> p.shift));
+      previous = x[i];
+    } else {
+      residual[i] = x[i] - (sum >> p.shift);
+      previous = x[i];
+    }
+  }
+}
+
+template <bool Restore>
+inline void runPredictor(int32_t* x, int64_t* residual, std::size_t n, const Predictor& p) {
+  using Kernel = void (*)(int32_t*, int64_t*, std::size_t, const Predictor&);
+  static const Kernel kUnrolled[] = {runPredictor<Restore, 0>, runPredictor<Restore, 1>, runPredictor<Restore, 2>,
+                                     runPredictor<Restore, 3>, runPredictor<Restore, 4>, runPredictor<Restore, 5>,
+                                     runPredictor<Restore, 6>, runPredictor<Restore, 7>, runPredictor<Restore, 8>,
+                                     runPredictor<Restore, 9>, runPredictor<Restore, 10>, runPredictor<Restore, 11>,
+                                     runPredictor<Restore, 12>};
+  const Kernel kernel = p.order < std::size(kUnrolled) ? kUnrolled[p.order] : runPredictor<Restore, 0>;
+  kernel(x, residual, n, p);
+}
+
+inline void computeResidual(const int32_t* x, std::size_t n, const Predictor& p, int64_t* residual) {
+  runPredictor<false>(const_cast<int32_t*>(x), residual, n, p); // Only reads x
+}
+
+/**
+ * @brief Best Rice parameter for one partition and its cost in bits (including the parameter itself)
+ */
+inline uint64_t chooseRice(const int64_t* residual, std::size_t count, unsigned& parameter) {
+  uint64_t sum = 0;
+  uint64_t maxValue = 0;
+  for (std::size_t i = 0; i < count; ++i) {
+    const uint64_t u = zigzag(residual[i]);
+    sum += u;
+    maxValue = std::max(maxValue, u);
+  }
+  const unsigned escapeWidth = maxValue ? 64 - countLeadingZeros64(maxValue) : 0;
+  uint64_t best = 5 + 6 + count * escapeWidth;
+  parameter = kRiceEscape;
+
+  const uint64_t mean = count ? sum / count : 0;
+  const unsigned guess = mean ? 63 - countLeadingZeros64(mean) : 0;
+  for (unsigned k = guess > 0 ? guess - 1 : 0; k <= std::min(guess + 1, kRiceEscape - 1); ++k) {
+    uint64_t cost = 5 + count * (k + 1);
+    for (std::size_t i = 0; i < count && cost < best; ++i) {
+      cost += zigzag(residual[i]) >> k;
+    }
+    if (cost < best) {
+      best = cost;
+      parameter = k;
+    }
+  }
+  return best;
+}
+
+inline uint64_t residualCost(const int64_t* residual, std::size_t order, std::size_t n) {
+  uint64_t cost = 0;
+  unsigned parameter;
+  for (std::size_t first = 0; first < n; first += kRicePartition) {
+    const std::size_t begin = std::max(first, order);
+    const std::size_t end = std::min(n, first + kRicePartition);
+    if (begin < end) {
+      cost += chooseRice(residual + begin, end - begin, parameter);
+    }
+  }
+  return cost;
+}
+
+inline void writeResidual(BitWriter& out, const int64_t* residual, std::size_t order, std::size_t n) {
+  for (std::size_t first = 0; first < n; first += kRicePartition) {
+    const std::size_t begin = std::max(first, order);
+    const std::size_t end = std::min(n, first + kRicePartition);
+    if (begin >= end) {
+      continue;
+    }
+    unsigned k;
+    chooseRice(residual + begin, end - begin, k);
+    out.put(k, 5);
+    if (k == kRiceEscape) {
+      uint64_t maxValue = 0;
+      for (std::size_t i = begin; i < end; ++i) {
+        maxValue = std::max(maxValue, zigzag(residual[i]));
+      }
+      const unsigned width = maxValue ? 64 - countLeadingZeros64(maxValue) : 0;
+      out.put(width, 6);
+      for (std::size_t i = begin; i < end; ++i) {
+        out.put(zigzag(residual[i]), width);
+      }
+    } else {
+      for (std::size_t i = begin; i < end; ++i) {
+        const uint64_t u = zigzag(residual[i]);
+        out.putUnary(u >> k);
+        out.put(u, k);
+      }
+    }
+  }
+}
+
+/**
+ * @brief Quantize floating-point LPC coefficients to precision-bit integers with a common shift
+ */
+inline bool quantizeLpc(const double* lpc, unsigned order, unsigned precision, Predictor& out) {
+  double maxCoef = 0.0;
+  for (unsigned j = 0; j < order; ++j) {
+    maxCoef = std::max(maxCoef, std::fabs(lpc[j]));
+  }
+  if (!(maxCoef > 0.0)) {
+    return false;
+  }
+  int exponent;
+  std::frexp(maxCoef, &exponent);
+  const int shift = std::min(int(precision) - 1 - exponent, 31);
+  if (shift < 0) {
+    return false;
+  }
+  const int32_t limit = (int32_t(1) << (precision - 1)) - 1;
+  double error = 0.0; // Carry each rounding error into the next coefficient
+  for (unsigned j = 0; j < order; ++j) {
+    error += lpc[j] * double(int64_t(1) << shift);
+    const int32_t q = static_cast<int32_t>(std::max<double>(-limit, std::min<double>(limit, std::lround(error))));
+    out.coefs[j] = q;
+    error -= q;
+  }
+  out.order = order;
+  out.precision = precision;
+  out.shift = unsigned(shift);
+  return true;
+}
+
+/**
+ * @brief Linear prediction coefficients of the windowed channel (autocorrelation + Levinson-Durbin)
+ * @return The order whose estimated size (residual bits + coefficients) is smallest, 0 if none helps
+ */
+inline unsigned analyzeLpc(const int32_t* x, std::size_t n, unsigned maxOrder, unsigned precision,
+                           std::vector<double>& scratch, double (*lpcOut)[kLpcMaxOrder]) {
+  maxOrder = unsigned(std::min<std::size_t>(maxOrder, n > 1 ? n - 1 : 0));
+  if (maxOrder == 0) {
+    return 0;
+  }
+  scratch.resize(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const double t = (2.0 * double(i) - double(n - 1)) / double(n + 1); // Welch window
+    scratch[i] = double(x[i]) * (1.0 - t * t);
+  }
+  double autoc[kLpcMaxOrder + 1];
+  for (unsigned lag = 0; lag <= maxOrder; ++lag) {
+    double sum = 0.0;
+    for (std::size_t i = lag; i < n; ++i) {
+      sum += scratch[i] * scratch[i - lag];
+    }
+    autoc[lag] = sum;
+  }
+  if (!(autoc[0] > 0.0)) {
+    return 0;
+  }
+
+  double lpc[kLpcMaxOrder] = {};
+  double error = autoc[0] * (1.0 + 1e-9);
+  unsigned bestOrder = 0;
+  double bestBits = 0.0;
+  for (unsigned m = 0; m < maxOrder; ++m) {
+    double acc = autoc[m + 1];
+    for (unsigned j = 0; j < m; ++j) {
+      acc -= lpc[j] * autoc[m - j];
+    }
+    const double k = acc / error;
+    double previous[kLpcMaxOrder];
+    std::copy(lpc, lpc + m, previous);
+    for (unsigned j = 0; j < m; ++j) {
+      lpc[j] = previous[j] - k * previous[m - 1 - j];
+    }
+    lpc[m] = k;
+    error *= 1.0 - k * k;
+    std::copy(lpc, lpc + m + 1, lpcOut[m]);
+
+    // Rice-coded Laplacian residual costs about 0.5 * log2(variance) + 1 bits per sample
+    const double variance = std::max(error / double(n), 1e-9);
+    const double bits = double(n - m - 1) * std::max(0.0, 0.5 * std::log2(variance) + 1.0) + double(m + 1) * precision;
+    if (bestOrder == 0 || bits < bestBits) {
+      bestOrder = m + 1;
+      bestBits = bits;
+    }
+    if (!(error > 0.0)) {
+      break;
+    }
+  }
+  return bestOrder;
+}
+
+/**
+ * @brief Scratch buffers reused across the blocks a worker encodes or decodes
+ */
+struct CodecScratch {
+  std::vector<int32_t> samples;
+  std::vector<int64_t> residual;
+  std::vector<int64_t> bestResidual;
+  std::vector<double> window;
+};
+
+inline void encodeChannel(BitWriter& out, const int32_t* x, std::size_t n, unsigned bits, unsigned maxOrder,
+                          CodecScratch& scratch) {
+  if (std::all_of(x, x + n, [&](int32_t v) { return v == x[0]; })) {
+    out.put(SubframeConstant, 2);
+    out.putSigned(x[0], bits);
+    return;
+  }
+
+  // Fixed polynomial predictors of order 0-4, plus the best LPC order, all expressed as one Predictor
+  static const int32_t kFixed[5][4] = {{0}, {1}, {2, -1}, {3, -3, 1}, {4, -6, 4, -1}};
+  std::vector<Predictor> candidates;
+  for (unsigned order = 0; order <= std::min<std::size_t>(4, n - 1); ++order) {
+    Predictor p;
+    p.order = order;
+    std::copy(kFixed[order], kFixed[order] + order, p.coefs);
+    candidates.push_back(p);
+  }
+  const unsigned precision = bits <= 16 ? 13 : 15;
+  double lpc[kLpcMaxOrder][kLpcMaxOrder];
+  const unsigned lpcOrder = analyzeLpc(x, n, maxOrder, precision, scratch.window, lpc);
+  Predictor quantized;
+  if (lpcOrder > 0 && quantizeLpc(lpc[lpcOrder - 1], lpcOrder, precision, quantized)) {
+    candidates.push_back(quantized);
+  }
+
+  scratch.residual.resize(n);
+  scratch.bestResidual.resize(n);
+  uint64_t bestCost = 2 + uint64_t(n) * bits; // Verbatim
+  const Predictor* best = nullptr;
+  for (const Predictor& p : candidates) {
+    computeResidual(x, n, p, scratch.residual.data());
+    const uint64_t header = 2 + 5 + (p.order ? 4 + 5 + uint64_t(p.order) * p.precision : 0) + uint64_t(p.order) * bits;
+    const uint64_t cost = header + residualCost(scratch.residual.data(), p.order, n);
+    if (cost < bestCost) {
+      bestCost = cost;
+      best = &p;
+      scratch.residual.swap(scratch.bestResidual);
+    }
+  }
+
+  if (!best) {
+    out.put(SubframeVerbatim, 2);
+    for (std::size_t i = 0; i < n; ++i) {
+      out.putSigned(x[i], bits);
+    }
+    return;
+  }
+  out.put(SubframeLpc, 2);
+  out.put(best->order, 5);
+  if (best->order > 0) {
+    out.put(best->precision - 1, 4);
+    out.put(best->shift, 5);
+    for (unsigned j = 0; j < best->order; ++j) {
+      out.putSigned(best->coefs[j], best->precision);
+    }
+  }
+  for (unsigned j = 0; j < best->order; ++j) {
+    out.putSigned(x[j], bits);
+  }
+  writeResidual(out, scratch.bestResidual.data(), best->order, n);
+}
+
+inline bool decodeChannel(BitReader& in, int32_t* x, std::size_t n, unsigned bits, CodecScratch& scratch) {
+  const unsigned type = unsigned(in.get(2));
+  if (type == SubframeConstant) {
+    std::fill(x, x + n, static_cast<int32_t>(in.getSigned(bits)));
+    return !in.overrun();
+  }
+  if (type == SubframeVerbatim) {
+    for (std::size_t i = 0; i < n; ++i) {
+      x[i] = static_cast<int32_t>(in.getSigned(bits));
+    }
+    return !in.overrun();
+  }
+  if (type != SubframeLpc) {
+    return false;
+  }
+
+  Predictor p;
+  p.order = unsigned(in.get(5));
+  if (p.order > n) {
+    return false;
+  }
+  if (p.order > 0) {
+    p.precision = unsigned(in.get(4)) + 1;
+    p.shift = unsigned(in.get(5));
+    for (unsigned j = 0; j < p.order; ++j) {
+      p.coefs[j] = static_cast<int32_t>(in.getSigned(p.precision));
+    }
+  }
+  for (unsigned j = 0; j < p.order; ++j) {
+    x[j] = static_cast<int32_t>(in.getSigned(bits));
+  }
+  std::vector<int64_t>& residual = scratch.residual;
+  residual.resize(n);
+  for (std::size_t first = 0; first < n; first += kRicePartition) {
+    const std::size_t begin = std::max<std::size_t>(first, p.order);
+    const std::size_t end = std::min(n, first + kRicePartition);
+    if (begin >= end) {
+      continue;
+    }
+    const unsigned k = unsigned(in.get(5));
+    if (k == kRiceEscape) {
+      const unsigned width = unsigned(in.get(6));
+      for (std::size_t i = begin; i < end; ++i) {
+        residual[i] = unzigzag(in.get(width));
+      }
+    } else {
+      for (std::size_t i = begin; i < end; ++i) {
+        residual[i] = unzigzag(in.getRice(k));
+      }
+    }
+    if (in.overrun()) {
+      return false;
+    }
+  }
+  runPredictor<true>(x, residual.data(), n, p);
+  return true;
+}
+
+/**
+ * @brief Decode one block (raw or coded) back into numFrames original frames
+ */
+inline bool decodeBlock(const uint8_t* in, std::size_t size, std::size_t numFrames, const BlockLayout& layout,
+                        CodecScratch& scratch, uint8_t* raw) {
+  if (size == 0) {
+    return false;
+  }
+  const std::size_t rawSize = numFrames * layout.blockAlign;
+  if (in[0] == kRawBlock) {
+    if (size - 1 != rawSize) {
+      return false;
+    }
+    std::memcpy(raw, in + 1, rawSize);
+    return true;
+  }
+  if (in[0] != kCodedBlock) {
+    return false;
+  }
+  BitReader reader(in + 1, size - 1);
+  scratch.samples.resize(numFrames);
+  for (unsigned c = 0; c < layout.channels; ++c) {
+    if (!decodeChannel(reader, scratch.samples.data(), numFrames, layout.bits, scratch)) {
+      return false;
+    }
+    storeChannel(scratch.samples.data(), numFrames, layout, c, raw);
+  }
+  return true;
+}
+
+/**
+ * @brief Encode one block; falls back to storing it raw when coding does not help or does not round-trip
+ */
+inline void encodeBlock(const uint8_t* raw, std::size_t numFrames, const BlockLayout& layout, bool coded,
+                        unsigned maxOrder, CodecScratch& scratch, std::vector<uint8_t>& out) {
+  const std::size_t rawSize = numFrames * layout.blockAlign;
+  out.clear();
+  if (coded) {
+    out.push_back(kCodedBlock);
+    BitWriter writer(out);
+    scratch.samples.resize(numFrames);
+    for (unsigned c = 0; c < layout.channels; ++c) {
+      loadChannel(raw, numFrames, layout, c, scratch.samples.data());
+      encodeChannel(writer, scratch.samples.data(), numFrames, layout.bits, maxOrder, scratch);
+    }
+    writer.flush();
+    if (out.size() < rawSize + 1) {
+      std::vector<uint8_t> check(rawSize);
+      if (decodeBlock(out.data(), out.size(), numFrames, layout, scratch, check.data()) &&
+          std::memcmp(check.data(), raw, rawSize) == 0) {
+        return;
+      }
+    }
+    out.clear();
+  }
+  out.push_back(kRawBlock);
+  out.insert(out.end(), raw, raw + rawSize);
+}
+
+} // namespace detail
+
+/**
+ * @brief Random access to the frames of a compressed archive written by compressWav()
+ *
+ * open() reads the fixed header, the original header/trailer bytes and the seek
+ * table; frames are then decoded one block at a time on demand, so a seek costs
+ * at most one block of decoding. The most recently decoded block is kept, so
+ * small sequential reads decode each block once.
+ *
+ * Usage example:
+ *   wav::CompressedWavReader archive;
+ *   if (archive.open("take.wlpc")) {
+ *     std::vector<uint8_t> frames(1024 * archive.getFrameSize());
+ *     archive.readAt(48000 * 60, frames.data(), 1024); // raw frames from the one-minute mark
+ *   }
+ */
+class CompressedWavReader {
+public:
+  bool open(const std::string& path) {
+    close();
+    if (!file_.open(path)) {
+      return false;
+    }
+    uint8_t header[detail::kCodecHeaderSize];
+    if (file_.readAt(0, header, sizeof(header)) != sizeof(header) ||
+        !detail::equalBytes(header, detail::kCodecMagic, 4) || detail::loadLE16(header + 4) != detail::kCodecVersion) {
+      std::cerr << "Error: " << path << " is not a compressed WAV archive\n";
+      close();
+      return false;
+    }
+    fmt_.audioFormat = static_cast<AudioFormat>(detail::loadLE16(header + 8));
+    fmt_.numChannels = detail::loadLE16(header + 10);
+    fmt_.sampleRate = detail::loadLE32(header + 12);
+    fmt_.bitsPerSample = detail::loadLE16(header + 16);
+    fmt_.blockAlign = detail::loadLE16(header + 18);
+    fmt_.avgBytesPerSec = fmt_.sampleRate * fmt_.blockAlign;
+    fmt_.bigEndian = header[20] != 0;
+    coded_ = header[21] == 1;
+    blockFrames_ = detail::loadLE32(header + 24);
+    numFrames_ = detail::loadLE64(header + 32);
+    const uint64_t prefixSize = detail::loadLE64(header + 40);
+    const uint64_t suffixSize = detail::loadLE64(header + 48);
+    const uint64_t numBlocks = detail::loadLE64(header + 56);
+    layout_ = detail::BlockLayout{fmt_.numChannels, fmt_.bitsPerSample, fmt_.blockAlign};
+
+    // Coded blocks are written per channel at bits / 8 bytes a sample, so their layout must match blockAlign
+    // exactly. Each size is checked against the file on its own first so that their sum cannot wrap.
+    const uint64_t fileSize = file_.size();
+    const bool layoutValid = fmt_.numChannels > 0 && fmt_.blockAlign > 0 && header[21] <= 1 &&
+                             (!coded_ || ((fmt_.bitsPerSample == 8 || fmt_.bitsPerSample == 16 ||
+                                           fmt_.bitsPerSample == 24 || fmt_.bitsPerSample == 32) &&
+                                          fmt_.blockAlign == fmt_.numChannels * fmt_.bitsPerSample / 8));
+    const bool sizesValid = blockFrames_ > 0 && prefixSize <= fileSize && suffixSize <= fileSize &&
+                            numBlocks < fileSize / 8 &&
+                            numBlocks == numFrames_ / blockFrames_ + (numFrames_ % blockFrames_ != 0 ? 1 : 0) &&
+                            detail::kCodecHeaderSize + prefixSize + suffixSize + (numBlocks + 1) * 8 <= fileSize;
+    if (!layoutValid || !sizesValid) {
+      std::cerr << "Error: Corrupt archive header in " << path << "\n";
+      close();
+      return false;
+    }
+    const uint64_t tableOffset = detail::kCodecHeaderSize + prefixSize + suffixSize;
+    prefix_.resize(static_cast<std::size_t>(prefixSize));
+    suffix_.resize(static_cast<std::size_t>(suffixSize));
+    std::vector<uint8_t> table(static_cast<std::size_t>((numBlocks + 1) * 8));
+    if (file_.readAt(detail::kCodecHeaderSize, prefix_.data(), prefix_.size()) != prefix_.size() ||
+        file_.readAt(detail::kCodecHeaderSize + prefixSize, suffix_.data(), suffix_.size()) != suffix_.size() ||
+        file_.readAt(tableOffset, table.data(), table.size()) != table.size()) {
+      std::cerr << "Error: Truncated archive " << path << "\n";
+      close();
+      return false;
+    }
+    blockOffsets_.resize(static_cast<std::size_t>(numBlocks + 1));
+    for (std::size_t i = 0; i < blockOffsets_.size(); ++i) {
+      blockOffsets_[i] = detail::loadLE64(table.data() + i * 8);
+      if (blockOffsets_[i] > fileSize || (i > 0 && blockOffsets_[i] < blockOffsets_[i - 1])) {
+        std::cerr << "Error: Corrupt seek table in " << path << "\n";
+        close();
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void close() {
+    file_.close();
+    prefix_.clear();
+    suffix_.clear();
+    blockOffsets_.clear();
+    numFrames_ = 0;
+    cachedBlock_ = kNoBlock;
+  }
+
+  bool isOpen() const { return file_.isOpen(); }
+
+  /**
+   * @brief Format of the original data chunk (fmt fields as they were, numbers in native order)
+   */
+  const FmtChunk& getFmtChunk() const { return fmt_; }
+  uint64_t getNumFrames() const { return numFrames_; }
+  uint32_t getFrameSize() const { return fmt_.blockAlign; }
+  uint32_t getBlockFrames() const { return blockFrames_; }
+  std::size_t getNumBlocks() const { return blockOffsets_.empty() ? 0 : blockOffsets_.size() - 1; }
+
+  /**
+   * @brief Original file bytes in front of the samples (RIFF header, fmt and every other leading chunk)
+   * Parse it with WavFileUtils' chunk layout if you need bext, iXML or LIST contents without decompressing.
+   */
+  const std::vector<uint8_t>& getHeaderBytes() const { return prefix_; }
+
+  /**
+   * @brief Original file bytes after the last whole frame (padding and trailing chunks such as cue or smpl)
+   */
+  const std::vector<uint8_t>& getTrailerBytes() const { return suffix_; }
+
+  /**
+   * @brief Decode up to numFrames raw frames starting at frame, exactly as stored in the original data chunk
+   * @return Frames decoded; less than numFrames at the end of the data or if a block is corrupt
+   */
+  std::size_t readAt(uint64_t frame, void* dst, std::size_t numFrames) {
+    uint8_t* out = static_cast<uint8_t*>(dst);
+    std::size_t done = 0;
+    while (done < numFrames && frame + done < numFrames_) {
+      const uint64_t position = frame + done;
+      const std::size_t block = static_cast<std::size_t>(position / blockFrames_);
+      if (block != cachedBlock_) {
+        cached_.resize(blockSize(block) * fmt_.blockAlign);
+        if (!decodeBlock(block, scratch_, compressed_, cached_.data())) {
+          cachedBlock_ = kNoBlock;
+          break;
+        }
+        cachedBlock_ = block;
+      }
+      const std::size_t offset = static_cast<std::size_t>(position - uint64_t(block) * blockFrames_);
+      const std::size_t count = std::min(numFrames - done, blockSize(block) - offset);
+      std::memcpy(out + done * fmt_.blockAlign, cached_.data() + offset * fmt_.blockAlign, count * fmt_.blockAlign);
+      done += count;
+    }
+    return done;
+  }
+
+  /**
+   * @brief Frames in a block (blockFrames, except for a shorter last block)
+   */
+  std::size_t blockSize(std::size_t block) const {
+    return static_cast<std::size_t>(std::min<uint64_t>(blockFrames_, numFrames_ - uint64_t(block) * blockFrames_));
+  }
+
+  /**
+   * @brief Decode one whole block into dst (room for blockSize(block) frames); safe to call from several threads
+   * with separate scratch and compressed buffers
+   */
+  bool decodeBlock(std::size_t block, detail::CodecScratch& scratch, std::vector<uint8_t>& compressed,
+                   uint8_t* dst) const {
+    if (block + 1 >= blockOffsets_.size()) {
+      return false;
+    }
+    compressed.resize(static_cast<std::size_t>(blockOffsets_[block + 1] - blockOffsets_[block]));
+    return file_.readAt(blockOffsets_[block], compressed.data(), compressed.size()) == compressed.size() &&
+           (coded_ || compressed.empty() || compressed[0] == detail::kRawBlock) &&
+           detail::decodeBlock(compressed.data(), compressed.size(), blockSize(block), layout_, scratch, dst);
+  }
+
+private:
+  static constexpr std::size_t kNoBlock = ~std::size_t(0);
+
+  FileHandle file_;
+  FmtChunk fmt_;
+  detail::BlockLayout layout_;
+  bool coded_ = false; // Blocks may be coded; otherwise every block must be raw
+  uint32_t blockFrames_ = 0;
+  uint64_t numFrames_ = 0;
+  std::vector<uint8_t> prefix_;
+  std::vector<uint8_t> suffix_;
+  std::vector<uint64_t> blockOffsets_;
+
+  // Block cache for readAt()
+  std::size_t cachedBlock_ = kNoBlock;
+  std::vector<uint8_t> cached_;
+  std::vector<uint8_t> compressed_;
+  detail::CodecScratch scratch_;
+};
+
+/**
+ * @brief Losslessly compress a WAV file into a seekable archive
+ *
+ * The samples of little-endian 8/16/24/32-bit PCM files are coded per block and
+ * channel with the cheapest of a fixed polynomial predictor or a quantized LPC
+ * predictor (autocorrelation + Levinson-Durbin), and the residual is Rice coded
+ * in partitions of 256 with an escape for outliers. Blocks are encoded in
+ * parallel, and each one is decoded again and compared before it is written, so
+ * a block that would not round-trip (or would grow) is stored raw instead. Other
+ * sample formats are stored raw, which still gives them the seek table.
+ *
+ * Every byte outside the sample frames (RIFF/RIFX/Wave64 headers, all chunks
+ * before and after the data, padding) is kept verbatim, so decompressWav()
+ * reproduces the original file bit for bit.
+ *
+ * Usage example:
+ *   if (wav::compressWav("take.wav", "take.wlpc")) {
+ *     wav::decompressWav("take.wlpc", "restored.wav"); // identical to take.wav
+ *   }
+ *
+ * @return false if the input is not a readable WAV file or the archive cannot be written (see std::cerr)
+ */
+inline bool compressWav(const std::string& wavPath, const std::string& archivePath,
+                        const CodecOptions& options = CodecOptions{}) {
+  FrameReader reader;
+  if (!reader.open(wavPath, AccessPattern::Sequential)) {
+    std::cerr << "Error: Cannot open " << wavPath << "\n";
+    return false;
+  }
+  const FmtChunk& fmt = reader.getFmtChunk();
+  const uint32_t blockFrames = std::max<uint32_t>(1, options.blockFrames);
+  const detail::BlockLayout layout{fmt.numChannels, fmt.bitsPerSample, fmt.blockAlign};
+  const bool coded = fmt.audioFormat == AudioFormat::PCM && !fmt.bigEndian && fmt.bitsPerSample % 8 == 0 &&
+                     fmt.bitsPerSample >= 8 && fmt.bitsPerSample <= 32 &&
+                     fmt.blockAlign == fmt.numChannels * fmt.bitsPerSample / 8;
+
+  const uint64_t numFrames = reader.getNumFrames();
+  const uint64_t numBlocks = (numFrames + blockFrames - 1) / blockFrames;
+  const uint64_t dataEnd = reader.getDataOffset() + numFrames * fmt.blockAlign;
+  const FileHandle& input = reader.getFileHandle();
+  std::vector<uint8_t> prefix(static_cast<std::size_t>(reader.getDataOffset()));
+  std::vector<uint8_t> suffix(static_cast<std::size_t>(input.size() - dataEnd));
+  if (input.readAt(0, prefix.data(), prefix.size()) != prefix.size() ||
+      input.readAt(dataEnd, suffix.data(), suffix.size()) != suffix.size()) {
+    std::cerr << "Error: Cannot read " << wavPath << "\n";
+    return false;
+  }
+
+  std::vector<uint8_t> header(detail::kCodecMagic, detail::kCodecMagic + 4);
+  detail::putLE16(header, detail::kCodecVersion);
+  detail::putLE16(header, 0);
+  detail::putLE16(header, static_cast<uint16_t>(fmt.audioFormat));
+  detail::putLE16(header, fmt.numChannels);
+  detail::putLE32(header, static_cast<uint32_t>(fmt.sampleRate));
+  detail::putLE16(header, fmt.bitsPerSample);
+  detail::putLE16(header, fmt.blockAlign);
+  header.push_back(fmt.bigEndian ? 1 : 0);
+  header.push_back(coded ? 1 : 0);
+  detail::putLE16(header, 0);
+  detail::putLE32(header, blockFrames);
+  detail::putLE32(header, 0);
+  detail::putLE64(header, numFrames);
+  detail::putLE64(header, prefix.size());
+  detail::putLE64(header, suffix.size());
+  detail::putLE64(header, numBlocks);
+  header.insert(header.end(), prefix.begin(), prefix.end());
+  header.insert(header.end(), suffix.begin(), suffix.end());
+  const uint64_t tableOffset = header.size();
+  std::vector<uint8_t> table;
+  header.resize(header.size() + static_cast<std::size_t>((numBlocks + 1) * 8)); // Filled in once the blocks are written
+
+  OutputFile out;
+  if (!out.open(archivePath) || !out.write(header.data(), header.size())) {
+    std::cerr << "Error: Cannot write " << archivePath << "\n";
+    return false;
+  }
+
+  // Read a batch of blocks, encode them in parallel, append them in order
+  const std::size_t batch = std::max(1u, options.threads) * 4;
+  const unsigned maxOrder = std::min(options.maxLpcOrder, detail::kLpcMaxOrder);
+  std::vector<uint8_t> raw(batch * blockFrames * fmt.blockAlign);
+  std::vector<std::vector<uint8_t>> encoded(batch);
+  std::vector<detail::CodecScratch> scratch(batch);
+  detail::ParallelJobs jobs(options.threads);
+  uint64_t offset = header.size();
+  for (uint64_t firstFrame = 0; firstFrame < numFrames;) {
+    const uint64_t wanted = std::min<uint64_t>(batch * blockFrames, numFrames - firstFrame);
+    const std::size_t frames = reader.read(raw.data(), static_cast<std::size_t>(wanted));
+    if (frames == 0) {
+      std::cerr << "Error: Cannot read " << wavPath << "\n";
+      return false;
+    }
+    const std::size_t blocks = (frames + blockFrames - 1) / blockFrames;
+    jobs.run(blocks, [&](std::size_t b) {
+      const std::size_t count = std::min<std::size_t>(blockFrames, frames - b * blockFrames);
+      detail::encodeBlock(raw.data() + b * blockFrames * fmt.blockAlign, count, layout, coded, maxOrder, scratch[b],
+                          encoded[b]);
+    });
+    for (std::size_t b = 0; b < blocks; ++b) {
+      detail::putLE64(table, offset);
+      if (!out.write(encoded[b].data(), encoded[b].size())) {
+        std::cerr << "Error: Cannot write " << archivePath << "\n";
+        return false;
+      }
+      offset += encoded[b].size();
+    }
+    firstFrame += frames;
+  }
+  detail::putLE64(table, offset);
+  if (!out.writeAt(tableOffset, table.data(), table.size()) || !out.close()) {
+    std::cerr << "Error: Cannot write " << archivePath << "\n";
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Restore the original WAV file from an archive written by compressWav()
+ * Blocks are decoded in parallel batches and written in order between the original header and trailer bytes.
+ * @return false if the archive is unreadable or corrupt, or the output cannot be written (see std::cerr)
+ */
+inline bool decompressWav(const std::string& archivePath, const std::string& wavPath, unsigned threads = 8) {
+  CompressedWavReader archive;
+  if (!archive.open(archivePath)) {
+    return false;
+  }
+  OutputFile out;
+  const std::vector<uint8_t>& prefix = archive.getHeaderBytes();
+  if (!out.open(wavPath) || !out.write(prefix.data(), prefix.size())) {
+    std::cerr << "Error: Cannot write " << wavPath << "\n";
+    return false;
+  }
+
+  const std::size_t batch = std::max(1u, threads) * 4;
+  const std::size_t blockBytes = std::size_t(archive.getBlockFrames()) * archive.getFrameSize();
+  std::vector<uint8_t> raw(batch * blockBytes);
+  std::vector<std::vector<uint8_t>> compressed(batch);
+  std::vector<detail::CodecScratch> scratch(batch);
+  std::vector<char> ok(batch); // Not vector<bool>: every job writes its own element
+  detail::ParallelJobs jobs(threads);
+  for (std::size_t first = 0; first < archive.getNumBlocks(); first += batch) {
+    const std::size_t blocks = std::min(batch, archive.getNumBlocks() - first);
+    jobs.run(blocks, [&](std::size_t b) {
+      ok[b] = archive.decodeBlock(first + b, scratch[b], compressed[b], raw.data() + b * blockBytes);
+    });
+    for (std::size_t b = 0; b < blocks; ++b) {
+      if (!ok[b]) {
+        std::cerr << "Error: Corrupt block " << first + b << " in " << archivePath << "\n";
+        return false;
+      }
+      if (!out.write(raw.data() + b * blockBytes, archive.blockSize(first + b) * archive.getFrameSize())) {
+        std::cerr << "Error: Cannot write " << wavPath << "\n";
+        return false;
+      }
+    }
+  }
+  const std::vector<uint8_t>& suffix = archive.getTrailerBytes();
+  if (!out.write(suffix.data(), suffix.size()) || !out.close()) {
+    std::cerr << "Error: Cannot write " << wavPath << "\n";
+    return false;
+  }
+  return true;
+}
+
+} // namespace wav
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <wav/FileHandle.hpp>
+#include <wav/WavFileUtils.hpp>
+
+namespace wav {
+
+namespace detail {
+
+/**
+ * @brief Swap metadata chunks of a RIFF WAV file without touching its sample data
+ *
+ * Chunks selected by drop(id, listType) are removed (listType is the first four
+ * payload bytes of a LIST chunk, zero for other chunks) and the serialized
+ * newChunks are added at the end of the file:
+ *   - dropped chunks that follow the last kept chunk are cut off, and the new chunks
+ *     take their place, so rewriting the same metadata again does not grow the file;
+ *   - dropped chunks before a kept one are renamed JUNK in place (4-byte write) rather
+ *     than moving the data chunk.
+ * The RIFF size field is updated last. The edit is not atomic: a crash midway can
+ * leave the file without the new chunks, but never with damaged samples.
+ *
+ * @return false for Wave64 and RIFX files, files that would exceed 4 GiB, or I/O errors (see std::cerr)
+ */
+inline bool replaceMetadataChunks(const std::string& path, const std::function<bool(Id, Id)>& drop,
+                                  const std::vector<uint8_t>& newChunks) {
+  FileHandle file;
+  WavFileUtils metadata;
+  OpenOptions options;
+  options.mode = ReadMode::MetadataOnly;
+  options.verbose = false;
+  metadata.setOpenOptions(options);
+  if (!file.open(path) || !metadata.open(file)) {
+    std::cerr << "Error: Cannot open " << path << "\n";
+    return false;
+  }
+  if (metadata.getContainer() != Container::Riff) {
+    std::cerr << "Error: Metadata can only be written to RIFF files, not " << path << "\n";
+    return false;
+  }
+
+  std::vector<ChunkInfo> chunks = metadata.getChunkList();
+  std::sort(chunks.begin(), chunks.end(), [](const ChunkInfo& a, const ChunkInfo& b) { return a.offset < b.offset; });
+  std::vector<char> dropped(chunks.size(), 0);
+  uint64_t end = 12; // After "RIFF", size and "WAVE"
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    Id listType;
+    if (chunks[i].id == Id::fromChars("LIST") && chunks[i].chunkSize >= 4) {
+      file.readAt(chunks[i].offset + 8, listType.b.data(), 4);
+    }
+    dropped[i] = chunks[i].id != Id::fromChars("data") && chunks[i].id != Id::fromChars("fmt ") &&
+                 drop(chunks[i].id, listType);
+    end = std::max(end, chunks[i].offset + 8 + chunks[i].chunkSize + (chunks[i].chunkSize & 1));
+  }
+  uint64_t writeOffset = end;
+  for (std::size_t i = chunks.size(); i > 0 && dropped[i - 1]; --i) {
+    writeOffset = chunks[i - 1].offset;
+  }
+  const uint64_t newEnd = writeOffset + newChunks.size();
+  if (newEnd - 8 > 0xFFFFFFFFull) {
+    std::cerr << "Error: " << path << " would exceed 4 GiB\n";
+    return false;
+  }
+  file.close();
+
+  OutputFile out;
+  if (!out.openExisting(path)) {
+    std::cerr << "Error: Cannot open " << path << " for writing\n";
+    return false;
+  }
+  bool ok = true;
+  const uint8_t junk[4] = {'J', 'U', 'N', 'K'};
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    if (dropped[i] && chunks[i].offset < writeOffset) {
+      ok = ok && out.writeAt(chunks[i].offset, junk, 4);
+    }
+  }
+  std::vector<uint8_t> riffSize;
+  putLE32(riffSize, static_cast<uint32_t>(newEnd - 8));
+  ok = ok && (newChunks.empty() || out.writeAt(writeOffset, newChunks.data(), newChunks.size())) &&
+       out.truncate(newEnd) && out.writeAt(4, riffSize.data(), riffSize.size());
+  ok = out.close() && ok;
+  if (!ok) {
+    std::cerr << "Error: Cannot write the metadata of " << path << "\n";
+  }
+  return ok;
+}
+
+} // namespace detail
+
+/**
+ * @brief Serialize a cue chunk (header included) for the given cue points
+ */
+inline std::vector<uint8_t> encodeCueChunk(const std::vector<CuePoint>& cuePoints) {
+  std::vector<uint8_t> payload;
+  detail::putLE32(payload, static_cast<uint32_t>(cuePoints.size()));
+  for (const CuePoint& cue : cuePoints) {
+    detail::putLE32(payload, cue.identifier);
+    detail::putLE32(payload, cue.position);
+    payload.insert(payload.end(), cue.fccChunk.b.begin(), cue.fccChunk.b.end());
+    detail::putLE32(payload, cue.chunkStart);
+    detail::putLE32(payload, cue.blockStart);
+    detail::putLE32(payload, cue.sampleOffset);
+  }
+  std::vector<uint8_t> chunk;
+  detail::putChunk(chunk, Id::fromChars("cue "), payload);
+  return chunk;
+}
+
+/**
+ * @brief Serialize a LIST/adtl chunk (header included) holding one labl entry per label
+ */
+inline std::vector<uint8_t> encodeLabelList(const std::vector<LabelChunk>& labels) {
+  std::vector<uint8_t> payload = {'a', 'd', 't', 'l'};
+  for (const LabelChunk& label : labels) {
+    std::vector<uint8_t> labl;
+    detail::putLE32(labl, static_cast<uint32_t>(label.cuePointId));
+    labl.insert(labl.end(), label.text.begin(), label.text.end());
+    labl.push_back(0);
+    detail::putChunk(payload, Id::fromChars("labl"), labl);
+  }
+  std::vector<uint8_t> chunk;
+  detail::putChunk(chunk, Id::fromChars("LIST"), payload);
+  return chunk;
+}
+
+/**
+ * @brief Replace the cue points of a RIFF WAV file, and their labl names, in place
+ *
+ * The existing cue chunk and LIST/adtl chunk (labels, notes and labelled text)
+ * are removed, then a new cue chunk and, if labels are given, a new LIST/adtl
+ * chunk are written at the end of the file. Only metadata bytes are written;
+ * see detail::replaceMetadataChunks() for how the old chunks are disposed of.
+ * Cue points for chunks other than data are written as given.
+ *
+ * Usage example:
+ *   wav::CuePoint cue;
+ *   cue.identifier = 1;
+ *   cue.position = cue.sampleOffset = 22050;
+ *   cue.fccChunk = wav::Id::fromChars("data");
+ *   wav::LabelChunk label;
+ *   label.cuePointId = 1;
+ *   label.text = "Snare";
+ *   wav::writeCuePoints("loop.wav", {cue}, {label});
+ *
+ * @return false if the file is not a RIFF WAV file or cannot be written (see std::cerr)
+ */
+inline bool writeCuePoints(const std::string& path, const std::vector<CuePoint>& cuePoints,
+                           const std::vector<LabelChunk>& labels = {}) {
+  std::vector<uint8_t> chunks;
+  if (!cuePoints.empty()) {
+    chunks = encodeCueChunk(cuePoints);
+  }
+  if (!labels.empty()) {
+    const std::vector<uint8_t> list = encodeLabelList(labels);
+    chunks.insert(chunks.end(), list.begin(), list.end());
+  }
+  return detail::replaceMetadataChunks(
+      path,
+      [](Id id, Id listType) {
+        return id == Id::fromChars("cue ") || (id == Id::fromChars("LIST") && listType == Id::fromChars("adtl"));
+      },
+      chunks);
+}
+
+/**
+ * @brief Set the MIDI unity note and pitch fraction of a RIFF WAV file's smpl chunk in place
+ *
+ * An existing smpl chunk keeps everything else (loops, SMPTE fields and any
+ * sampler-specific data); only its unity note and pitch fraction change, plus
+ * its sample period if that was 0. Without one, a smpl chunk with no loops is
+ * added. The chunk is rewritten as described for detail::replaceMetadataChunks().
+ *
+ * Usage example:
+ *   // A sample that plays middle C 25 cents sharp
+ *   wav::writeSamplerPitch("piano_C4.wav", 60, 0x40000000u);
+ *
+ * @param midiPitchFraction Fraction of a semitone above midiUnityNote, in units of 2^-32 semitones
+ * @return false if the file is not a RIFF WAV file or cannot be written (see std::cerr)
+ */
+inline bool writeSamplerPitch(const std::string& path, uint32_t midiUnityNote, uint32_t midiPitchFraction) {
+  FileHandle file;
+  WavFileUtils metadata;
+  OpenOptions options;
+  options.mode = ReadMode::MetadataOnly;
+  options.verbose = false;
+  metadata.setOpenOptions(options);
+  if (!file.open(path) || !metadata.open(file)) {
+    std::cerr << "Error: Cannot open " << path << "\n";
+    return false;
+  }
+
+  std::vector<uint8_t> payload;
+  for (const ChunkInfo& chunk : metadata.getChunkList()) {
+    if (chunk.id == Id::fromChars("smpl") && chunk.chunkSize >= 36 && chunk.chunkSize <= (1u << 24) &&
+        metadata.getContainer() == Container::Riff) {
+      payload.resize(static_cast<std::size_t>(chunk.chunkSize));
+      if (file.readAt(chunk.offset + 8, payload.data(), payload.size()) != payload.size()) {
+        payload.clear();
+      }
+    }
+  }
+  if (payload.empty()) {
+    payload.assign(36, 0); // Manufacturer and product 0 ("no specific sampler"), no loops
+  }
+  const uint32_t sampleRate = metadata.getFmtChunk().sampleRate;
+  uint32_t fields[3] = {detail::loadLE32(payload.data() + 8), midiUnityNote, midiPitchFraction};
+  if (fields[0] == 0 && sampleRate > 0) {
+    fields[0] = static_cast<uint32_t>((1000000000ull + sampleRate / 2) / sampleRate); // Nanoseconds per sample
+  }
+  for (int i = 0; i < 3; ++i) {
+    std::vector<uint8_t> bytes;
+    detail::putLE32(bytes, fields[i]);
+    std::copy(bytes.begin(), bytes.end(), payload.begin() + 8 + 4 * i);
+  }
+  file.close();
+
+  std::vector<uint8_t> chunk;
+  detail::putChunk(chunk, Id::fromChars("smpl"), payload);
+  return detail::replaceMetadataChunks(path, [](Id id, Id) { return id == Id::fromChars("smpl"); }, chunk);
+}
+
+} // namespace wav
@@ -0,0 +1,226 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <wav/FrameReader.hpp>
+#include <wav/ParallelJobs.hpp>
+#include <wav/SampleConversion.hpp>
+
+namespace wav {
+
+/**
+ * @brief Settings for a MultitrackReader
+ */
+struct MultitrackOptions {
+  unsigned ioThreads = 8; // Worker threads that read and decode tracks in parallel (0 = calling thread only)
+  StreamingHints hints{1u << 20, true}; // Readahead per track; kept smaller than a single stream's default
+};
+
+/**
+ * @brief Streams several WAV files (e.g. one mono file per DAW track) as one synchronized multichannel source
+ *
+ * Every track is opened as a FrameReader with AccessPattern::Sequential, so the
+ * kernel keeps a readahead window in flight for each file at the same time. A
+ * read call then fetches and decodes the same frame range of every track on a
+ * pool of worker threads and assembles one interleaved or planar float block;
+ * a 64-track session costs one call per block instead of 64 independent reads.
+ *
+ * All tracks must share sample format, bit depth, sample rate and byte order.
+ * Channel counts may differ: output channels are the tracks' channels in the
+ * order the files were given. Tracks shorter than the longest one read as silence
+ * past their end.
+ *
+ * Usage example:
+ *   wav::MultitrackReader session;
+ *   if (session.open({"kick.wav", "snare.wav", "bass.wav", "vox.wav"})) {
+ *     std::vector<float> block(1024 * session.getNumChannels());
+ *     while (std::size_t frames = session.readInterleaved(block.data(), 1024)) {
+ *       // mix frames...
+ *     }
+ *   }
+ */
+class MultitrackReader {
+public:
+  explicit MultitrackReader(const MultitrackOptions& options = MultitrackOptions{})
+      : options_(options), jobs_(std::make_unique<detail::ParallelJobs>(options.ioThreads)) {}
+
+  /**
+   * @brief Open every track; all must be valid WAV files with compatible formats
+   * @return false if a file cannot be opened or does not match the first one (see std::cerr for which)
+   */
+  bool open(const std::vector<std::string>& paths) {
+    close();
+    if (paths.empty()) {
+      return false;
+    }
+    for (const std::string& path : paths) {
+      auto track = std::make_unique<Track>();
+      if (!track->reader.open(path, AccessPattern::Sequential, options_.hints)) {
+        std::cerr << "Error: Cannot open track " << path << "\n";
+        close();
+        return false;
+      }
+      const FmtChunk& fmt = track->reader.getFmtChunk();
+      if (!isConvertibleFormat(fmt)) {
+        std::cerr << "Error: Unsupported sample format in track " << path << "\n";
+        close();
+        return false;
+      }
+      if (!tracks_.empty() && !isCompatible(tracks_.front()->reader.getFmtChunk(), fmt)) {
+        std::cerr << "Error: Track " << path << " does not match the format of " << paths.front() << "\n";
+        close();
+        return false;
+      }
+      track->firstChannel = numChannels_;
+      numChannels_ += fmt.numChannels;
+      numFrames_ = std::max(numFrames_, track->reader.getNumFrames());
+      tracks_.push_back(std::move(track));
+    }
+    return true;
+  }
+
+  void close() {
+    tracks_.clear();
+    numChannels_ = 0;
+    numFrames_ = 0;
+    position_ = 0;
+  }
+
+  bool isOpen() const { return !tracks_.empty(); }
+
+  std::size_t getNumTracks() const { return tracks_.size(); }
+
+  /**
+   * @brief Channels in an output frame (the sum over all tracks)
+   */
+  unsigned getNumChannels() const { return numChannels_; }
+
+  /**
+   * @brief Length of the longest track, in frames
+   */
+  uint64_t getNumFrames() const { return numFrames_; }
+
+  uint32_t getSampleRate() const { return isOpen() ? tracks_.front()->reader.getFmtChunk().sampleRate : 0; }
+
+  /**
+   * @brief The reader behind one track (metadata, cue points, ...)
+   */
+  const FrameReader& getTrack(std::size_t index) const { return tracks_[index]->reader; }
+
+  /**
+   * @brief Move every track to the same frame
+   */
+  bool seek(uint64_t frame) {
+    if (frame > numFrames_) {
+      return false;
+    }
+    for (auto& track : tracks_) {
+      track->reader.seek(std::min(frame, track->reader.getNumFrames()));
+    }
+    position_ = frame;
+    return true;
+  }
+
+  uint64_t tell() const { return position_; }
+
+  /**
+   * @brief Read the next numFrames frames of every track into one interleaved block
+   * @param dst Room for numFrames * getNumChannels() floats
+   * @return Frames read (0 once the longest track has ended)
+   */
+  std::size_t readInterleaved(float* dst, std::size_t numFrames) {
+    const std::size_t count = framesLeft(numFrames);
+    if (count == 0) {
+      return 0;
+    }
+    planes_.resize(numChannels_);
+    planePointers_.resize(numChannels_);
+    planeSources_.resize(numChannels_);
+    for (unsigned c = 0; c < numChannels_; ++c) {
+      planes_[c].resize(std::max(planes_[c].size(), count));
+      planePointers_[c] = planes_[c].data();
+      planeSources_[c] = planes_[c].data();
+    }
+    readTracks(planePointers_.data(), count);
+    sampleKernels().interleave(planeSources_.data(), count, numChannels_, dst);
+    return count;
+  }
+
+  /**
+   * @brief Read the next numFrames frames with one output buffer per channel
+   * @param dst getNumChannels() pointers, each with room for numFrames floats
+   * @return Frames read (0 once the longest track has ended)
+   */
+  std::size_t readPlanar(float* const* dst, std::size_t numFrames) {
+    const std::size_t count = framesLeft(numFrames);
+    if (count > 0) {
+      readTracks(dst, count);
+    }
+    return count;
+  }
+
+private:
+  struct Track {
+    FrameReader reader;
+    unsigned firstChannel = 0;  // Index of this track's first channel in an output frame
+    std::vector<uint8_t> raw;   // Raw frames of the current block
+    std::vector<float> decoded; // Interleaved floats, for tracks with more than one channel
+  };
+
+  static bool isCompatible(const FmtChunk& a, const FmtChunk& b) {
+    return a.audioFormat == b.audioFormat && a.bitsPerSample == b.bitsPerSample && a.sampleRate == b.sampleRate &&
+           a.bigEndian == b.bigEndian;
+  }
+
+  std::size_t framesLeft(std::size_t numFrames) const {
+    return position_ >= numFrames_ ? 0
+                                   : static_cast<std::size_t>(std::min<uint64_t>(numFrames, numFrames_ - position_));
+  }
+
+  /**
+   * @brief Read and decode count frames of every track into its output planes, one job per track
+   */
+  void readTracks(float* const* planes, std::size_t count) {
+    jobs_->run(tracks_.size(), [&](std::size_t index) { readTrack(*tracks_[index], planes, count); });
+    position_ += count;
+  }
+
+  static void readTrack(Track& track, float* const* planes, std::size_t count) {
+    const FmtChunk& fmt = track.reader.getFmtChunk();
+    const unsigned channels = fmt.numChannels;
+    track.raw.resize(std::max(track.raw.size(), count * fmt.blockAlign));
+    const std::size_t got = track.reader.read(track.raw.data(), count);
+
+    float* const* out = planes + track.firstChannel;
+    if (channels == 1) {
+      convertToFloat(fmt, track.raw.data(), got, out[0]);
+    } else {
+      track.decoded.resize(std::max(track.decoded.size(), got * channels));
+      convertToFloat(fmt, track.raw.data(), got * channels, track.decoded.data());
+      sampleKernels().deinterleave(track.decoded.data(), got, channels, out);
+    }
+    // Past the end of a shorter track (or after a failed read): silence
+    for (unsigned c = 0; c < channels; ++c) {
+      std::fill(out[c] + got, out[c] + count, 0.0f);
+    }
+  }
+
+  MultitrackOptions options_;
+  std::unique_ptr<detail::ParallelJobs> jobs_;
+  std::vector<std::unique_ptr<Track>> tracks_;
+  unsigned numChannels_ = 0;
+  uint64_t numFrames_ = 0;
+  uint64_t position_ = 0; // Cursor, in frames
+
+  // Planar scratch for readInterleaved()
+  std::vector<std::vector<float>> planes_;
+  std::vector<float*> planePointers_;
+  std::vector<const float*> planeSources_;
+};
+
+} // namespace wav
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <wav/FrameReader.hpp>
+#include <wav/MetadataWriter.hpp>
+#include <wav/ParallelJobs.hpp>
+#include <wav/SampleConversion.hpp>
+
+namespace wav {
+
+/**
+ * @brief Settings for OnsetDetector and addOnsetCues()
+ */
+struct OnsetOptions {
+  std::size_t hopFrames = 256;        // Analysis step; onsets are located to a frame inside the hop
+  float riseDb = 9.0f;                // Energy jump over the previous hop that counts as an onset
+  float floorDb = -50.0f;             // Hops quieter than this (dBFS) never start an onset
+  double minGapSeconds = 0.05;        // Onsets closer than this to the previous one are ignored
+  bool writeLabels = true;            // addOnsetCues(): also write a labl name per cue point
+  std::string labelPrefix = "Onset "; // Label text is labelPrefix + 1-based onset number
+};
+
+/**
+ * @brief Streaming transient detector for drum loops and other percussive material
+ *
+ * The channels are mixed to mono and differentiated (a first-order high-pass
+ * that favours attacks over sustained low end). The energy of each hop of
+ * OnsetOptions::hopFrames frames, in dB, is compared with the hop before it
+ * (spectral flux reduced to a single high band): a hop above floorDb whose
+ * energy rises by at least riseDb, and by more than the next hop's does,
+ * starts an onset.
+ * The onset is placed on the first frame of that hop whose high-passed
+ * amplitude reaches half of the hop's peak, so it lands on the attack rather
+ * than on the hop grid.
+ *
+ * Samples can be fed in blocks of any size; the result does not depend on
+ * how the stream is split. Decisions lag by one hop, so call finish() after
+ * the last block.
+ *
+ * Usage example:
+ *   wav::OnsetDetector detector(44100, 2);
+ *   while (std::size_t frames = source.read(block.data(), 4096)) {
+ *     detector.process(block.data(), frames); // interleaved floats
+ *   }
+ *   detector.finish();
+ *   for (uint64_t frame : detector.getOnsets()) {
+ *     // slice at frame...
+ *   }
+ */
+class OnsetDetector {
+public:
+  OnsetDetector(uint32_t sampleRate, unsigned numChannels, const OnsetOptions& options = OnsetOptions{})
+      : options_(options), numChannels_(std::max(1u, numChannels)),
+        hop_(std::max<std::size_t>(options.hopFrames, 16)),
+        minGap_(static_cast<uint64_t>(options.minGapSeconds * sampleRate)) {
+    mono_.resize(hop_);
+    diff_[0].resize(hop_);
+    diff_[1].resize(hop_);
+  }
+
+  /**
+   * @brief Analyze the next numFrames interleaved frames
+   */
+  void process(const float* interleaved, std::size_t numFrames) {
+    const float scale = 1.0f / static_cast<float>(numChannels_);
+    while (numFrames > 0) {
+      const std::size_t count = std::min(numFrames, hop_ - filled_);
+      float* mono = mono_.data() + filled_;
+      if (numChannels_ == 1) {
+        std::copy(interleaved, interleaved + count, mono);
+      } else {
+        for (std::size_t i = 0; i < count; ++i) {
+          float sum = 0.0f;
+          for (unsigned c = 0; c < numChannels_; ++c) {
+            sum += interleaved[i * numChannels_ + c];
+          }
+          mono[i] = sum * scale;
+        }
+      }
+      interleaved += count * numChannels_;
+      numFrames -= count;
+      filled_ += count;
+      if (filled_ == hop_) {
+        analyzeHop(hop_);
+      }
+    }
+  }
+
+  /**
+   * @brief Analyze the final partial hop and decide on the last candidate
+   */
+  void finish() {
+    if (filled_ > 0) {
+      analyzeHop(filled_);
+    }
+    decide(-1000.0f); // Nothing follows: the last candidate only has to beat its predecessors
+  }
+
+  /**
+   * @brief Frame indices of the onsets found so far, ascending
+   */
+  const std::vector<uint64_t>& getOnsets() const { return onsets_; }
+
+  void reset() {
+    filled_ = 0;
+    hopIndex_ = 0;
+    previousSample_ = 0.0f;
+    previousDb_ = kSilenceDb;
+    candidateRise_ = -1000.0f;
+    candidateCount_ = 0;
+    onsets_.clear();
+  }
+
+private:
+  static constexpr float kSilenceDb = -200.0f;
+
+  /**
+   * @brief High-pass and measure one hop of `count` mono frames, then judge the previous hop
+   */
+  void analyzeHop(std::size_t count) {
+    float* diff = diff_[hopIndex_ & 1].data();
+    diff[0] = mono_[0] - previousSample_;
+    for (std::size_t i = 1; i < count; ++i) {
+      diff[i] = mono_[i] - mono_[i - 1];
+    }
+    previousSample_ = mono_[count - 1];
+
+    // Eight independent partial sums, so the compiler can keep them in one SIMD register
+    float lanes[8] = {};
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+      for (std::size_t k = 0; k < 8; ++k) {
+        lanes[k] += diff[i + k] * diff[i + k];
+      }
+    }
+    for (; i < count; ++i) {
+      lanes[0] += diff[i] * diff[i];
+    }
+    const float sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    const float db = 10.0f * std::log10(sum / static_cast<float>(count) + 1e-20f);
+
+    const float rise = db - previousDb_;
+    decide(rise);
+    previousDb_ = db;
+    candidateRise_ = db >= options_.floorDb ? rise : -1000.0f;
+    candidateCount_ = count;
+    ++hopIndex_;
+    filled_ = 0;
+  }
+
+  /**
+   * @brief Accept the pending candidate hop if its rise is big enough and not beaten by the next hop's
+   */
+  void decide(float nextRise) {
+    if (hopIndex_ == 0 || candidateRise_ < options_.riseDb || nextRise > candidateRise_) {
+      candidateRise_ = -1000.0f;
+      return;
+    }
+    const uint64_t hopStart = (hopIndex_ - 1) * hop_;
+    const float* diff = diff_[(hopIndex_ - 1) & 1].data();
+    float peak = 0.0f;
+    for (std::size_t i = 0; i < candidateCount_; ++i) {
+      peak = std::max(peak, std::fabs(diff[i]));
+    }
+    std::size_t attack = 0;
+    while (attack < candidateCount_ && std::fabs(diff[attack]) < 0.5f * peak) {
+      ++attack;
+    }
+    const uint64_t frame = hopStart + attack;
+    if (onsets_.empty() || frame >= onsets_.back() + minGap_) {
+      onsets_.push_back(frame);
+    }
+    candidateRise_ = -1000.0f;
+  }
+
+  OnsetOptions options_;
+  unsigned numChannels_;
+  std::size_t hop_;
+  uint64_t minGap_;
+
+  std::vector<float> mono_;    // Current hop, mixed to mono
+  std::vector<float> diff_[2]; // High-passed current and previous hop
+  std::size_t filled_ = 0;     // Frames of the current hop received so far
+  uint64_t hopIndex_ = 0;      // Hops analyzed so far
+  float previousSample_ = 0.0f;
+
+  float previousDb_ = kSilenceDb;  // Energy of the hop before the newest
+  float candidateRise_ = -1000.0f; // Rise of the newest hop, pending decide()
+  std::size_t candidateCount_ = 0;
+  std::vector<uint64_t> onsets_;
+};
+
+/**
+ * @brief Detect the onsets of a WAV file, streaming it through an OnsetDetector
+ * @param onsets Receives the onset frame indices, ascending
+ * @return false if the file cannot be read or its format cannot be decoded (see std::cerr)
+ */
+inline bool detectOnsets(const std::string& path, std::vector<uint64_t>& onsets,
+                         const OnsetOptions& options = OnsetOptions{}) {
+  FrameReader reader;
+  if (!reader.open(path, AccessPattern::Sequential)) {
+    std::cerr << "Error: Cannot open " << path << "\n";
+    return false;
+  }
+  const FmtChunk& fmt = reader.getFmtChunk();
+  if (!isConvertibleFormat(fmt)) {
+    std::cerr << "Error: Unsupported sample format in " << path << "\n";
+    return false;
+  }
+  OnsetDetector detector(fmt.sampleRate, fmt.numChannels, options);
+  const std::size_t blockFrames = 8192;
+  std::vector<uint8_t> raw(blockFrames * fmt.blockAlign);
+  std::vector<float> samples(blockFrames * fmt.numChannels);
+  while (std::size_t frames = reader.read(raw.data(), blockFrames)) {
+    convertToFloat(fmt, raw.data(), frames * fmt.numChannels, samples.data());
+    detector.process(samples.data(), frames);
+  }
+  detector.finish();
+  onsets = detector.getOnsets();
+  return true;
+}
+
+/**
+ * @brief Detect the onsets of a WAV file and store them as its cue points (replacing any existing ones)
+ *
+ * Cue point i (1-based) sits on the i-th onset; with OnsetOptions::writeLabels
+ * it is named labelPrefix + i in a LIST/adtl chunk. Onsets past frame 2^32 - 1
+ * cannot be expressed as cue points and are dropped.
+ *
+ * Usage example:
+ *   if (wav::addOnsetCues("loops/break_120bpm.wav")) {
+ *     // reopen to see the cue points
+ *   }
+ *
+ * @return false if the file cannot be analyzed or rewritten (see std::cerr)
+ */
+inline bool addOnsetCues(const std::string& path, const OnsetOptions& options = OnsetOptions{}) {
+  std::vector<uint64_t> onsets;
+  if (!detectOnsets(path, onsets, options)) {
+    return false;
+  }
+  std::vector<CuePoint> cuePoints;
+  std::vector<LabelChunk> labels;
+  for (uint64_t frame : onsets) {
+    if (frame > 0xFFFFFFFFull) {
+      break;
+    }
+    CuePoint cue;
+    cue.identifier = static_cast<uint32_t>(cuePoints.size() + 1);
+    cue.position = static_cast<uint32_t>(frame);
+    cue.fccChunk = Id::fromChars("data");
+    cue.sampleOffset = static_cast<uint32_t>(frame);
+    cuePoints.push_back(cue);
+    if (options.writeLabels) {
+      LabelChunk label;
+      label.cuePointId = cue.identifier;
+      label.text = options.labelPrefix + std::to_string(cue.identifier);
+      labels.push_back(std::move(label));
+    }
+  }
+  return writeCuePoints(path, cuePoints, labels);
+}
+
+/**
+ * @brief addOnsetCues() for a batch of files, several at a time
+ *
+ * Loops are short, so files rather than blocks are spread over the threads; each
+ * worker streams one file at a time with its own small buffers.
+ *
+ * @return Number of files that were updated (failures are reported on std::cerr)
+ */
+inline std::size_t addOnsetCues(const std::vector<std::string>& paths, const OnsetOptions& options,
+                                unsigned threads = 8) {
+  std::atomic<std::size_t> updated{0};
+  detail::ParallelJobs jobs(threads);
+  jobs.run(paths.size(), [&](std::size_t index) {
+    if (addOnsetCues(paths[index], options)) {
+      updated.fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+  return updated.load();
+}
+
+} // namespace wav
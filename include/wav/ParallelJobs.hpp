@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wav {
+
+namespace detail {
+
+/**
+ * @brief Persistent worker threads that run one job per index and return when all are done
+ * The calling thread takes jobs too, so a pool of 0 threads runs everything inline.
+ */
+class ParallelJobs {
+public:
+  explicit ParallelJobs(unsigned numThreads) {
+    for (unsigned i = 0; i < numThreads; ++i) {
+      threads_.emplace_back([this] { workerLoop(); });
+    }
+  }
+
+  ~ParallelJobs() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  ParallelJobs(const ParallelJobs&) = delete;
+  ParallelJobs& operator=(const ParallelJobs&) = delete;
+
+  /**
+   * @brief Call job(i) for every i in [0, count) and wait for all of them
+   */
+  void run(std::size_t count, const std::function<void(std::size_t)>& job) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      // Workers still leaving the previous batch must not pick up indices of this one
+      done_.wait(lock, [this] { return active_ == 0; });
+      job_ = &job;
+      count_ = count;
+      next_.store(0, std::memory_order_relaxed);
+      finished_ = 0;
+      ++generation_;
+    }
+    wake_.notify_all();
+    drain(job, count);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this] { return finished_ == count_ && active_ == 0; });
+    job_ = nullptr;
+  }
+
+private:
+  void workerLoop() {
+    uint64_t seen = 0;
+    for (;;) {
+      const std::function<void(std::size_t)>* job = nullptr;
+      std::size_t count = 0;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+        if (stop_) {
+          return;
+        }
+        seen = generation_;
+        if (!job_) {
+          continue; // The batch already completed before this worker woke up
+        }
+        job = job_;
+        count = count_;
+        ++active_;
+      }
+      drain(*job, count);
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        --active_;
+      }
+      done_.notify_all();
+    }
+  }
+
+  void drain(const std::function<void(std::size_t)>& job, std::size_t count) {
+    for (std::size_t i = next_.fetch_add(1); i < count; i = next_.fetch_add(1)) {
+      job(i);
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (++finished_ == count) {
+        done_.notify_all();
+      }
+    }
+  }
+
+  std::vector<std::thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+  const std::function<void(std::size_t)>* job_ = nullptr; // Current batch, nullptr when none is running
+  std::size_t count_ = 0;
+  std::size_t finished_ = 0;
+  unsigned active_ = 0; // Workers inside drain()
+  uint64_t generation_ = 0;
+  bool stop_ = false;
+  std::atomic<std::size_t> next_{0};
+};
+
+} // namespace detail
+
+} // namespace wav
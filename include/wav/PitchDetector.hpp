@@ -0,0 +1,334 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <wav/Fft.hpp>
+#include <wav/FrameReader.hpp>
+#include <wav/MetadataWriter.hpp>
+#include <wav/ParallelJobs.hpp>
+#include <wav/SampleConversion.hpp>
+
+namespace wav {
+
+/**
+ * @brief Settings for PitchDetector, detectPitch() and addPitchToSampler()
+ */
+struct PitchOptions {
+  float minFrequency = 27.5f;   // Lowest pitch searched (A0); sets the analysis window length
+  float maxFrequency = 4200.0f; // Highest pitch searched (just above C8)
+  float threshold = 0.15f;      // YIN dip threshold on the normalized difference function
+  float minConfidence = 0.8f;   // addPitchToSampler() leaves files with a less periodic window alone
+  double searchSeconds = 1.0;   // Only this much from the start is scanned for the loudest part
+  double settleSeconds = 0.1;   // The window starts this long after the loudest part, past the attack
+};
+
+/**
+ * @brief Result of a pitch estimate
+ */
+struct PitchEstimate {
+  float frequency = 0.0f;  // Fundamental in Hz
+  float confidence = 0.0f; // 1 - the normalized difference at the chosen period (1 = perfectly periodic)
+  double midiNote = 0.0;   // Fractional MIDI note (69 = A4 = 440 Hz)
+
+  /**
+   * @brief smpl dwMIDIUnityNote: the semitone at or below the pitch
+   */
+  uint32_t unityNote() const {
+    return static_cast<uint32_t>(std::min(127.0, std::max(0.0, std::floor(midiNote + 1e-9))));
+  }
+
+  /**
+   * @brief smpl dwMIDIPitchFraction: how far above unityNote() the pitch is, in units of 2^-32 semitones
+   */
+  uint32_t pitchFraction() const {
+    const double fraction = midiNote - unityNote();
+    return fraction <= 0.0 ? 0u : static_cast<uint32_t>(std::min(4294967295.0, std::round(fraction * 4294967296.0)));
+  }
+};
+
+/**
+ * @brief YIN pitch estimator with the difference function computed through an FFT autocorrelation
+ *
+ * estimate() analyzes getWindowFrames() mono samples: an integration window
+ * of one longest period plus the largest lag. The YIN difference function
+ *   d(t) = sum over j < W of (x[j] - x[j + t])^2 = E(0) + E(t) - 2 r(t)
+ * needs the cross-correlation r(t) for every lag; it comes from one complex
+ * FFT of both real sequences packed together and one inverse FFT, instead of
+ * W multiply-adds per lag. The energies E come from a running sum.
+ *
+ * The period is the first dip of the cumulative-mean-normalized difference
+ * below PitchOptions::threshold (the global minimum if there is none),
+ * refined by parabolic interpolation of the raw difference function.
+ *
+ * Usage example:
+ *   wav::PitchDetector detector(48000);
+ *   std::vector<float> window(detector.getWindowFrames());
+ *   // fill window with mono samples from the steady part of a note...
+ *   wav::PitchEstimate pitch;
+ *   if (detector.estimate(window.data(), pitch)) {
+ *     std::cout << pitch.frequency << " Hz, MIDI " << pitch.midiNote << "\n";
+ *   }
+ */
+class PitchDetector {
+public:
+  explicit PitchDetector(uint32_t sampleRate, const PitchOptions& options = PitchOptions{})
+      : options_(options), sampleRate_(sampleRate),
+        minLag_(std::max<std::size_t>(2, static_cast<std::size_t>(sampleRate / options.maxFrequency))),
+        maxLag_(std::max(minLag_ + 2, static_cast<std::size_t>(std::ceil(sampleRate / options.minFrequency)) + 1)),
+        window_(maxLag_), fft_(fftSize(window_ + maxLag_)) {
+    spectrum_.resize(fft_.size());
+    energy_.resize(window_ + maxLag_ + 1);
+    difference_.resize(maxLag_ + 2);
+  }
+
+  /**
+   * @brief Number of mono samples estimate() reads
+   */
+  std::size_t getWindowFrames() const { return window_ + maxLag_; }
+
+  /**
+   * @brief Estimate the pitch of getWindowFrames() mono samples
+   * @return false for silence
+   */
+  bool estimate(const float* mono, PitchEstimate& result) {
+    const std::size_t length = getWindowFrames();
+    double mean = 0.0;
+    for (std::size_t i = 0; i < length; ++i) {
+      mean += mono[i];
+    }
+    const float dc = static_cast<float>(mean / static_cast<double>(length));
+
+    // Real part: the integration window; imaginary part: window plus lags. One FFT transforms both.
+    std::fill(spectrum_.begin(), spectrum_.end(), std::complex<float>());
+    energy_[0] = 0.0;
+    for (std::size_t i = 0; i < length; ++i) {
+      const float x = mono[i] - dc;
+      spectrum_[i] = std::complex<float>(i < window_ ? x : 0.0f, x);
+      energy_[i + 1] = energy_[i] + static_cast<double>(x) * x;
+    }
+    if (energy_[window_] < 1e-10 * static_cast<double>(window_)) {
+      return false;
+    }
+    fft_.transform(spectrum_.data(), false);
+    const std::size_t n = fft_.size();
+    for (std::size_t k = 0; k <= n / 2; ++k) {
+      const std::complex<float> zk = spectrum_[k];
+      const std::complex<float> zn = std::conj(spectrum_[(n - k) % n]);
+      const std::complex<float> a = 0.5f * (zk + zn);                             // Transform of the window
+      const std::complex<float> b = std::complex<float>(0.0f, -0.5f) * (zk - zn); // Transform of window + lags
+      spectrum_[k] = std::conj(a) * b;
+      if (k > 0 && k < n / 2) {
+        spectrum_[n - k] = std::conj(spectrum_[k]); // Real correlation: Hermitian spectrum
+      }
+    }
+    fft_.transform(spectrum_.data(), true);
+
+    // Cumulative-mean-normalized difference function
+    const double scale = 1.0 / static_cast<double>(n);
+    auto rawDifference = [&](std::size_t lag) {
+      const double correlation = spectrum_[lag].real() * scale;
+      return std::max(0.0, energy_[window_] + (energy_[lag + window_] - energy_[lag]) - 2.0 * correlation);
+    };
+    double runningSum = 0.0;
+    difference_[0] = 1.0f;
+    for (std::size_t lag = 1; lag <= maxLag_; ++lag) {
+      const double d = rawDifference(lag);
+      runningSum += d;
+      difference_[lag] = runningSum > 0.0 ? static_cast<float>(d * static_cast<double>(lag) / runningSum) : 1.0f;
+    }
+
+    std::size_t best = 0;
+    for (std::size_t lag = minLag_; lag < maxLag_; ++lag) {
+      if (difference_[lag] < options_.threshold) {
+        while (lag + 1 < maxLag_ && difference_[lag + 1] < difference_[lag]) {
+          ++lag;
+        }
+        best = lag;
+        break;
+      }
+    }
+    if (best == 0) {
+      best = minLag_;
+      for (std::size_t lag = minLag_; lag < maxLag_; ++lag) {
+        best = difference_[lag] < difference_[best] ? lag : best;
+      }
+    }
+
+    // Parabola through the dip and its neighbours, on the raw difference: normalizing skews it at short periods
+    double period = static_cast<double>(best);
+    const double left = rawDifference(best - 1);
+    const double centre = rawDifference(best);
+    const double right = rawDifference(best + 1);
+    const double curvature = left - 2.0 * centre + right;
+    if (curvature > 0.0) {
+      period += 0.5 * (left - right) / curvature;
+    }
+
+    result.frequency = static_cast<float>(sampleRate_ / period);
+    result.confidence = std::min(1.0f, std::max(0.0f, 1.0f - difference_[best]));
+    result.midiNote = 69.0 + 12.0 * std::log2(result.frequency / 440.0);
+    return true;
+  }
+
+private:
+  static std::size_t fftSize(std::size_t length) {
+    std::size_t size = 1;
+    while (size < length) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+  PitchOptions options_;
+  double sampleRate_;
+  std::size_t minLag_;
+  std::size_t maxLag_;
+  std::size_t window_; // Integration window W, one longest period
+  detail::Fft fft_;
+  std::vector<std::complex<float>> spectrum_;
+  std::vector<double> energy_;    // Running sum of squares: energy_[i] = sum of x[j]^2 for j < i
+  std::vector<float> difference_; // Normalized difference per lag
+};
+
+namespace detail {
+
+/**
+ * @brief Read frames [first, first + count) of a file and mix them to mono
+ */
+inline bool readMono(const FrameReader& reader, uint64_t first, std::size_t count, std::vector<float>& mono) {
+  const FmtChunk& fmt = reader.getFmtChunk();
+  std::vector<uint8_t> raw(count * fmt.blockAlign);
+  std::vector<float> samples(count * fmt.numChannels);
+  if (reader.readAt(first, raw.data(), count) != count) {
+    return false;
+  }
+  convertToFloat(fmt, raw.data(), samples.size(), samples.data());
+  mono.assign(count, 0.0f);
+  const float scale = 1.0f / static_cast<float>(fmt.numChannels);
+  for (std::size_t i = 0; i < count; ++i) {
+    for (unsigned c = 0; c < fmt.numChannels; ++c) {
+      mono[i] += samples[i * fmt.numChannels + c];
+    }
+    mono[i] *= scale;
+  }
+  return true;
+}
+
+} // namespace detail
+
+/**
+ * @brief Estimate the pitch of a WAV file from one window in its steady state
+ *
+ * Only the first PitchOptions::searchSeconds are read to find the loudest
+ * stretch (the end of the attack); the analysis window starts settleSeconds
+ * after it. Nothing past that window is read, so long sustained notes cost
+ * the same as short ones.
+ *
+ * @return false if the file cannot be read, is shorter than one analysis window, or is silent there
+ */
+inline bool detectPitch(const std::string& path, PitchEstimate& result, const PitchOptions& options = PitchOptions{}) {
+  FrameReader reader;
+  if (!reader.open(path, AccessPattern::Random)) {
+    std::cerr << "Error: Cannot open " << path << "\n";
+    return false;
+  }
+  const FmtChunk& fmt = reader.getFmtChunk();
+  if (!isConvertibleFormat(fmt)) {
+    std::cerr << "Error: Unsupported sample format in " << path << "\n";
+    return false;
+  }
+  PitchDetector detector(fmt.sampleRate, options);
+  const uint64_t numFrames = reader.getNumFrames();
+  const std::size_t windowFrames = detector.getWindowFrames();
+  if (numFrames < windowFrames) {
+    std::cerr << "Error: " << path << " is too short for pitch detection\n";
+    return false;
+  }
+
+  // Loudest 1024-frame hop of the search range marks the end of the attack
+  const std::size_t hop = 1024;
+  const uint64_t searchLimit = static_cast<uint64_t>(options.searchSeconds * fmt.sampleRate);
+  const std::size_t searchFrames = static_cast<std::size_t>(std::min(numFrames, std::max<uint64_t>(searchLimit, 1)));
+  std::vector<float> mono;
+  if (!detail::readMono(reader, 0, searchFrames, mono)) {
+    return false;
+  }
+  uint64_t loudest = 0;
+  float loudestEnergy = -1.0f;
+  for (std::size_t start = 0; start < searchFrames; start += hop) {
+    float energy = 0.0f;
+    for (std::size_t i = start; i < std::min(searchFrames, start + hop); ++i) {
+      energy += mono[i] * mono[i];
+    }
+    if (energy > loudestEnergy) {
+      loudestEnergy = energy;
+      loudest = start;
+    }
+  }
+  uint64_t first = loudest + static_cast<uint64_t>(options.settleSeconds * fmt.sampleRate);
+  first = std::min<uint64_t>(first, numFrames - windowFrames);
+
+  if (first + windowFrames <= searchFrames) {
+    mono.erase(mono.begin(), mono.begin() + static_cast<std::ptrdiff_t>(first));
+  } else if (!detail::readMono(reader, first, windowFrames, mono)) {
+    return false;
+  }
+  return detector.estimate(mono.data(), result);
+}
+
+/**
+ * @brief Detect a file's pitch and store it as the unity note and pitch fraction of its smpl chunk
+ *
+ * Files whose estimate is less confident than PitchOptions::minConfidence
+ * (noise, chords, percussion) are left unchanged and reported as failures.
+ * See writeSamplerPitch() for how the smpl chunk is updated or added.
+ *
+ * Usage example:
+ *   wav::PitchEstimate pitch;
+ *   if (wav::addPitchToSampler("strings/violin_A4.wav", wav::PitchOptions{}, &pitch)) {
+ *     // pitch.midiNote is about 69
+ *   }
+ *
+ * @param estimate Optional: receives the estimate that was written
+ * @return false if no confident pitch was found or the file cannot be rewritten (see std::cerr)
+ */
+inline bool addPitchToSampler(const std::string& path, const PitchOptions& options = PitchOptions{},
+                              PitchEstimate* estimate = nullptr) {
+  PitchEstimate pitch;
+  if (!detectPitch(path, pitch, options)) {
+    return false;
+  }
+  if (estimate) {
+    *estimate = pitch;
+  }
+  if (pitch.confidence < options.minConfidence) {
+    std::cerr << "Error: No clear pitch in " << path << " (confidence " << pitch.confidence << ")\n";
+    return false;
+  }
+  return writeSamplerPitch(path, pitch.unityNote(), pitch.pitchFraction());
+}
+
+/**
+ * @brief addPitchToSampler() for a batch of files, several at a time
+ * @return Number of files that were updated (failures are reported on std::cerr)
+ */
+inline std::size_t addPitchToSampler(const std::vector<std::string>& paths, const PitchOptions& options,
+                                     unsigned threads = 8) {
+  std::atomic<std::size_t> updated{0};
+  detail::ParallelJobs jobs(threads);
+  jobs.run(paths.size(), [&](std::size_t index) {
+    if (addPitchToSampler(paths[index], options)) {
+      updated.fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+  return updated.load();
+}
+
+} // namespace wav
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace wav {
+
+/**
+ * @brief Where the pages of large sample buffers come from (Linux only; ignored elsewhere)
+ */
+struct SampleMemoryOptions {
+  bool explicitHugePages = false; // Try MAP_HUGETLB first (needs pages reserved in /proc/sys/vm/nr_hugepages)
+  int numaNode = -1;              // Prefer this NUMA node for the pages (-1 = the node of the thread that reads them)
+};
+
+namespace detail {
+
+constexpr std::size_t kSampleAlignment = 64;                         // Cache line; enough for any SIMD load
+constexpr std::size_t kLargeSampleAllocation = std::size_t(2) << 20; // One x86-64/arm64 huge page
+
+inline std::size_t roundToHugePage(std::size_t bytes) {
+  return (bytes + kLargeSampleAllocation - 1) / kLargeSampleAllocation * kLargeSampleAllocation;
+}
+
+#if defined(__linux__)
+/**
+ * @brief Anonymous mapping of a whole number of huge pages, aligned to one so THP can back all of it
+ * @return nullptr if the kernel refuses
+ */
+inline void* mapSampleMemory(std::size_t bytes, const SampleMemoryOptions& options) {
+  const std::size_t length = roundToHugePage(bytes);
+  void* p = MAP_FAILED;
+#if defined(MAP_HUGETLB)
+  if (options.explicitHugePages) {
+    p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  }
+#endif
+  if (p == MAP_FAILED) {
+    // Over-map by one huge page and trim both ends, leaving a huge-page-aligned range
+    const std::size_t padded = length + kLargeSampleAllocation;
+    void* raw = ::mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+      return nullptr;
+    }
+    const uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned = roundToHugePage(start);
+    if (aligned > start) {
+      ::munmap(raw, aligned - start);
+    }
+    if (const std::size_t tail = start + padded - (aligned + length)) {
+      ::munmap(reinterpret_cast<void*>(aligned + length), tail);
+    }
+    p = reinterpret_cast<void*>(aligned);
+#if defined(MADV_HUGEPAGE)
+    ::madvise(p, length, MADV_HUGEPAGE);
+#endif
+  }
+#if defined(SYS_mbind)
+  if (options.numaNode >= 0 && options.numaNode < 64) {
+    // mbind(MPOL_PREFERRED) before the first touch; a failure just leaves the default policy
+    const unsigned long nodeMask = 1ul << options.numaNode;
+    ::syscall(SYS_mbind, p, length, 1 /* MPOL_PREFERRED */, &nodeMask, 64ul, 0u);
+  }
+#endif
+  return p;
+}
+#endif
+
+} // namespace detail
+
+/**
+ * @brief Allocator for sample storage: 64-byte aligned, huge-page backed when large, never zero-filled
+ *
+ * resize() on a vector using this allocator default-initializes new elements,
+ * so loading a data chunk writes every byte once (the file read) instead of
+ * twice (a memset, then the read). Pages are placed when the read first
+ * touches them, i.e. on the NUMA node of the reading thread unless
+ * SampleMemoryOptions::numaNode says otherwise.
+ *
+ * On Linux, blocks of 2 MiB and more are separate anonymous mappings aligned
+ * to a huge page and marked MADV_HUGEPAGE, so transparent huge pages can back
+ * them (one TLB entry per 2 MiB of samples); smaller blocks, and all blocks
+ * elsewhere, come from aligned operator new.
+ *
+ * All instances can free each other's memory; the options only steer where
+ * new pages come from.
+ */
+template <typename T>
+class SampleAllocator {
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+  using is_always_equal = std::true_type;
+
+  SampleAllocator() = default;
+  explicit SampleAllocator(const SampleMemoryOptions& options) : options_(options) {}
+  template <typename U>
+  SampleAllocator(const SampleAllocator<U>& other) : options_(other.options()) {}
+
+  T* allocate(std::size_t n) {
+    const std::size_t bytes = n * sizeof(T);
+#if defined(__linux__)
+    if (bytes >= detail::kLargeSampleAllocation) {
+      if (void* p = detail::mapSampleMemory(bytes, options_)) {
+        return static_cast<T*>(p);
+      }
+      throw std::bad_alloc();
+    }
+#endif
+    return static_cast<T*>(::operator new(bytes, std::align_val_t(detail::kSampleAlignment)));
+  }
+
+  void deallocate(T* p, std::size_t n) noexcept {
+    const std::size_t bytes = n * sizeof(T);
+#if defined(__linux__)
+    if (bytes >= detail::kLargeSampleAllocation) {
+      ::munmap(p, detail::roundToHugePage(bytes));
+      return;
+    }
+#endif
+    ::operator delete(p, std::align_val_t(detail::kSampleAlignment));
+  }
+
+  // Default-initialize: new elements of resize() keep whatever the allocation holds
+  template <typename U>
+  void construct(U* p) noexcept {
+    ::new (static_cast<void*>(p)) U;
+  }
+  template <typename U, typename... Args>
+  void construct(U* p, Args&&... args) {
+    ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...);
+  }
+
+  const SampleMemoryOptions& options() const { return options_; }
+
+  template <typename U>
+  bool operator==(const SampleAllocator<U>&) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const SampleAllocator<U>&) const noexcept {
+    return false;
+  }
+
+private:
+  SampleMemoryOptions options_;
+};
+
+/**
+ * @brief Byte storage for sample data: a std::vector whose resize() does not zero-fill (see SampleAllocator)
+ *
+ * Usage example:
+ *   wav::SampleBuffer bytes;
+ *   bytes.resize(chunkSize); // No memset
+ *   file.readAt(dataOffset, bytes.data(), bytes.size());
+ *   std::vector<uint8_t> copy(bytes.begin(), bytes.end());
+ */
+using SampleBuffer = std::vector<uint8_t, SampleAllocator<uint8_t>>;
+
+} // namespace wav
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <wav/SampleKernels.hpp>
+#include <wav/WavFileUtils.hpp>
+
+namespace wav {
+
+/**
+ * @brief Conversion of raw data chunk bytes into normalized float samples
+ *
+ * The data chunk stores interleaved samples exactly as they appear on disk.
+ * See wav-resources/WAVE File Format.html — data chunk format:
+ *   - 8-bit PCM is unsigned (0..255, silence = 128)
+ *   - 16/24/32-bit PCM is signed two's complement, little-endian
+ *   - IEEE float is 32-bit or 64-bit, little-endian
+ *   - RIFX files store the same layouts big-endian (FmtChunk::bigEndian)
+ *
+ * Usage example:
+ *   wav::WavFileUtils reader("audio.wav");
+ *   if (reader.open()) {
+ *     const auto& bytes = reader.getDataChunk().sampleDataInBytes;
+ *     std::vector<float> samples(bytes.size() / (reader.getBitsPerSample() / 8));
+ *     wav::convertToFloat(reader.getFmtChunk(), bytes.data(), samples.size(), samples.data());
+ *   }
+ */
+
+/**
+ * @brief Size in bytes of one sample of one channel
+ */
+inline std::size_t bytesPerSample(const FmtChunk& fmt) { return (fmt.bitsPerSample + 7u) / 8u; }
+
+/**
+ * @brief True if convertToFloat() knows how to decode this format
+ */
+inline bool isConvertibleFormat(const FmtChunk& fmt) {
+  if (fmt.audioFormat == AudioFormat::PCM) {
+    return fmt.bitsPerSample == 8 || fmt.bitsPerSample == 16 || fmt.bitsPerSample == 24 || fmt.bitsPerSample == 32;
+  }
+  if (fmt.audioFormat == AudioFormat::IEEE_FLOAT) {
+    return fmt.bitsPerSample == 32 || fmt.bitsPerSample == 64;
+  }
+  return false;
+}
+
+/**
+ * @brief Decode one sample to a float in [-1, 1)
+ * @param src Pointer to the first byte of the sample
+ */
+inline float sampleToFloat(const FmtChunk& fmt, const uint8_t* src) {
+  if (fmt.bigEndian && fmt.bitsPerSample > 8 && fmt.bitsPerSample <= 64) {
+    // Reverse the sample into little-endian order and decode that
+    uint8_t swapped[8];
+    const std::size_t n = bytesPerSample(fmt);
+    for (std::size_t i = 0; i < n; ++i) {
+      swapped[i] = src[n - 1 - i];
+    }
+    FmtChunk littleEndian = fmt;
+    littleEndian.bigEndian = false;
+    return sampleToFloat(littleEndian, swapped);
+  }
+  if (fmt.audioFormat == AudioFormat::IEEE_FLOAT) {
+    if (fmt.bitsPerSample == 64) {
+      uint64_t bits = 0;
+      for (int i = 7; i >= 0; --i) {
+        bits = (bits << 8) | src[i];
+      }
+      double value;
+      std::memcpy(&value, &bits, sizeof(value));
+      return static_cast<float>(value);
+    }
+    uint32_t bits = uint32_t(src[0]) | (uint32_t(src[1]) << 8) | (uint32_t(src[2]) << 16) | (uint32_t(src[3]) << 24);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  switch (fmt.bitsPerSample) {
+  case 8:
+    return (static_cast<int>(src[0]) - 128) * (1.0f / 128.0f);
+  case 16:
+    return static_cast<int16_t>(uint16_t(src[0]) | (uint16_t(src[1]) << 8)) * (1.0f / 32768.0f);
+  case 24: {
+    // Place the 3 bytes in the top of a 32-bit word so the sign bit lands in bit 31
+    const uint32_t bits = (uint32_t(src[0]) << 8) | (uint32_t(src[1]) << 16) | (uint32_t(src[2]) << 24);
+    return static_cast<int32_t>(bits) * (1.0f / 2147483648.0f);
+  }
+  case 32: {
+    const uint32_t bits =
+        uint32_t(src[0]) | (uint32_t(src[1]) << 8) | (uint32_t(src[2]) << 16) | (uint32_t(src[3]) << 24);
+    return static_cast<int32_t>(bits) * (1.0f / 2147483648.0f);
+  }
+  default:
+    return 0.0f;
+  }
+}
+
+/**
+ * @brief Decode numSamples interleaved samples from raw data chunk bytes
+ * Uses the SIMD kernel selected for this CPU (see CpuDispatch.hpp).
+ * @param fmt Format of the source bytes
+ * @param src Raw bytes (at least numSamples * bytesPerSample(fmt) bytes)
+ * @param numSamples Number of individual samples (frames * channels)
+ * @param dst Output buffer with room for numSamples floats
+ * @return false if the format is not supported
+ */
+inline bool convertToFloat(const FmtChunk& fmt, const uint8_t* src, std::size_t numSamples, float* dst) {
+  const DecodeKernel decode = sampleKernels().decoderFor(fmt);
+  if (!decode) {
+    return false;
+  }
+  decode(src, numSamples, dst);
+  return true;
+}
+
+} // namespace wav
@@ -0,0 +1,1329 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <wav/CpuDispatch.hpp>
+#include <wav/WavFileUtils.hpp>
+
+namespace wav {
+
+/**
+ * @brief Decoding of one sample for a format fixed at compile time
+ *
+ * Each specialization is a single branch-free expression; they are the scalar
+ * reference for the SIMD kernels below and are used directly by StaticWavReader.
+ * See wav-resources/WAVE File Format.html — data chunk format for the layouts.
+ */
+template <AudioFormat Format, unsigned Bits>
+struct SampleTraits;
+
+template <>
+struct SampleTraits<AudioFormat::PCM, 8> {
+  static float decode(const uint8_t* p) noexcept { return (static_cast<int>(p[0]) - 128) * (1.0f / 128.0f); }
+};
+
+template <>
+struct SampleTraits<AudioFormat::PCM, 16> {
+  static float decode(const uint8_t* p) noexcept {
+    return static_cast<int16_t>(uint16_t(p[0]) | (uint16_t(p[1]) << 8)) * (1.0f / 32768.0f);
+  }
+};
+
+template <>
+struct SampleTraits<AudioFormat::PCM, 24> {
+  static float decode(const uint8_t* p) noexcept {
+    // Bytes go to the top of a 32-bit word so the sign bit lands in bit 31
+    const uint32_t bits = (uint32_t(p[0]) << 8) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 24);
+    return static_cast<int32_t>(bits) * (1.0f / 2147483648.0f);
+  }
+};
+
+template <>
+struct SampleTraits<AudioFormat::PCM, 32> {
+  static float decode(const uint8_t* p) noexcept {
+    const uint32_t bits = uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    return static_cast<int32_t>(bits) * (1.0f / 2147483648.0f);
+  }
+};
+
+template <>
+struct SampleTraits<AudioFormat::IEEE_FLOAT, 32> {
+  static float decode(const uint8_t* p) noexcept {
+    const uint32_t bits = uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+};
+
+template <>
+struct SampleTraits<AudioFormat::IEEE_FLOAT, 64> {
+  static float decode(const uint8_t* p) noexcept {
+    uint64_t bits = 0;
+    for (int i = 7; i >= 0; --i) {
+      bits = (bits << 8) | p[i];
+    }
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return static_cast<float>(value);
+  }
+};
+
+using DecodeKernel = void (*)(const uint8_t* src, std::size_t numSamples, float* dst);
+using PeakKernel = float (*)(const float* src, std::size_t numSamples);
+using SumSquaresKernel = double (*)(const float* src, std::size_t numSamples);
+using DeinterleaveKernel = void (*)(const float* src, std::size_t numFrames, unsigned numChannels, float* const* dst);
+using InterleaveKernel = void (*)(const float* const* src, std::size_t numFrames, unsigned numChannels, float* dst);
+
+/**
+ * @brief What the float sanitizer writes over bad samples
+ */
+struct SanitizeOptions {
+  float nanReplacement = 0.0f;      // Written over NaN samples
+  float infinityReplacement = 1.0f; // Magnitude written over +-Inf; the sign is kept
+  bool flushDenormals = true;       // Replace subnormal samples with a zero of the same sign
+};
+
+/**
+ * @brief Bad samples found by the float sanitizer (denormals are counted even when not flushed)
+ */
+struct SanitizeStats {
+  uint64_t nans = 0;
+  uint64_t infinities = 0;
+  uint64_t denormals = 0;
+
+  uint64_t total() const { return nans + infinities + denormals; }
+  bool clean() const { return total() == 0; }
+
+  SanitizeStats& operator+=(const SanitizeStats& other) {
+    nans += other.nans;
+    infinities += other.infinities;
+    denormals += other.denormals;
+    return *this;
+  }
+};
+
+/**
+ * @brief In-place scan-and-fix over native-endian float32 or float64 samples
+ */
+using SanitizeKernel = void (*)(void* samples, std::size_t numSamples, const SanitizeOptions& options,
+                                SanitizeStats& stats);
+
+/**
+ * @brief Number of independent generator lanes behind tpdfNoise()
+ * Every variant advances the same 8 xorshift32 lanes, so dither is identical on every instruction set.
+ */
+constexpr std::size_t kDitherLanes = 8;
+
+/**
+ * @brief Fill dst with triangular (TPDF) noise in (-1, 1) LSB; numSamples must be a multiple of kDitherLanes
+ */
+using TpdfKernel = void (*)(uint32_t* lanes, float* dst, std::size_t numSamples);
+
+/**
+ * @brief Scale floats to PCM, add optional noise (in LSB), round to nearest, clamp and pack little-endian bytes
+ */
+using QuantizeKernel = void (*)(const float* src, const float* noise, std::size_t numSamples, uint8_t* dst);
+
+/**
+ * @brief One implementation of every sample kernel, for one instruction set
+ *
+ * All variants produce bit-identical results except sumOfSquares, whose
+ * summation order (and so its last few bits) depends on the vector width.
+ *
+ * Usage example:
+ *   const wav::SampleKernels& k = wav::sampleKernels();
+ *   k.pcm24ToFloat(bytes, numSamples, samples);
+ *   float peak = k.peakAbs(samples, numSamples);
+ */
+struct SampleKernels {
+  Isa isa;
+  DecodeKernel pcm8ToFloat;
+  DecodeKernel pcm16ToFloat;
+  DecodeKernel pcm24ToFloat;
+  DecodeKernel pcm32ToFloat;
+  DecodeKernel float32ToFloat;
+  DecodeKernel float64ToFloat;
+  DecodeKernel pcm16beToFloat; // Big-endian (RIFX) samples: the byte swap is fused into the load
+  DecodeKernel pcm24beToFloat;
+  DecodeKernel pcm32beToFloat;
+  DecodeKernel float32beToFloat;
+  DecodeKernel float64beToFloat;
+  PeakKernel peakAbs;              // Largest |x|; NaN samples are ignored
+  SumSquaresKernel sumOfSquares;   // Sum of x*x, accumulated in double
+  DeinterleaveKernel deinterleave; // Interleaved frames -> one buffer per channel
+  InterleaveKernel interleave;     // One buffer per channel -> interleaved frames
+  SanitizeKernel sanitizeFloat32;  // NaN/Inf/denormal scan-and-fix, see FloatSanitizer.hpp
+  SanitizeKernel sanitizeFloat64;
+  TpdfKernel tpdfNoise;          // Dither source for the quantizers, see Dither.hpp
+  QuantizeKernel quantizeToPcm8; // Float -> PCM with optional dither, see Dither.hpp
+  QuantizeKernel quantizeToPcm16;
+  QuantizeKernel quantizeToPcm24;
+
+  /**
+   * @brief Decoder for the format of a data chunk (nullptr if unsupported)
+   */
+  DecodeKernel decoderFor(const FmtChunk& fmt) const {
+    if (fmt.bigEndian) {
+      return bigEndianDecoderFor(fmt);
+    }
+    if (fmt.audioFormat == AudioFormat::IEEE_FLOAT) {
+      return fmt.bitsPerSample == 32 ? float32ToFloat : fmt.bitsPerSample == 64 ? float64ToFloat : nullptr;
+    }
+    if (fmt.audioFormat == AudioFormat::PCM) {
+      switch (fmt.bitsPerSample) {
+      case 8:
+        return pcm8ToFloat;
+      case 16:
+        return pcm16ToFloat;
+      case 24:
+        return pcm24ToFloat;
+      case 32:
+        return pcm32ToFloat;
+      default:
+        return nullptr;
+      }
+    }
+    return nullptr;
+  }
+
+private:
+  DecodeKernel bigEndianDecoderFor(const FmtChunk& fmt) const {
+    if (fmt.audioFormat == AudioFormat::IEEE_FLOAT) {
+      return fmt.bitsPerSample == 32 ? float32beToFloat : fmt.bitsPerSample == 64 ? float64beToFloat : nullptr;
+    }
+    if (fmt.audioFormat == AudioFormat::PCM) {
+      switch (fmt.bitsPerSample) {
+      case 8:
+        return pcm8ToFloat; // Single bytes have no byte order
+      case 16:
+        return pcm16beToFloat;
+      case 24:
+        return pcm24beToFloat;
+      case 32:
+        return pcm32beToFloat;
+      default:
+        return nullptr;
+      }
+    }
+    return nullptr;
+  }
+};
+
+namespace detail {
+namespace scalar {
+
+template <AudioFormat Format, unsigned Bits>
+inline void decode(const uint8_t* src, std::size_t numSamples, float* dst) {
+  for (std::size_t i = 0; i < numSamples; ++i) {
+    dst[i] = SampleTraits<Format, Bits>::decode(src + i * (Bits / 8));
+  }
+}
+
+/**
+ * @brief Decode big-endian samples by reversing each one into SampleTraits' little-endian layout
+ */
+template <AudioFormat Format, unsigned Bits>
+inline void decodeBigEndian(const uint8_t* src, std::size_t numSamples, float* dst) {
+  constexpr unsigned kBytes = Bits / 8;
+  for (std::size_t i = 0; i < numSamples; ++i) {
+    uint8_t le[kBytes];
+    for (unsigned b = 0; b < kBytes; ++b) {
+      le[b] = src[i * kBytes + kBytes - 1 - b];
+    }
+    dst[i] = SampleTraits<Format, Bits>::decode(le);
+  }
+}
+
+inline void copyFloat32(const uint8_t* src, std::size_t numSamples, float* dst) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  std::memcpy(dst, src, numSamples * sizeof(float));
+#else
+  decode<AudioFormat::IEEE_FLOAT, 32>(src, numSamples, dst);
+#endif
+}
+
+inline float peakAbs(const float* src, std::size_t numSamples) {
+  float peak = 0.0f;
+  for (std::size_t i = 0; i < numSamples; ++i) {
+    const float a = std::fabs(src[i]);
+    peak = a > peak ? a : peak;
+  }
+  return peak;
+}
+
+inline double sumOfSquares(const float* src, std::size_t numSamples) {
+  double sum = 0.0;
+  for (std::size_t i = 0; i < numSamples; ++i) {
+    sum += double(src[i]) * src[i];
+  }
+  return sum;
+}
+
+inline void deinterleave(const float* src, std::size_t numFrames, unsigned numChannels, float* const* dst) {
+  for (std::size_t i = 0; i < numFrames; ++i) {
+    for (unsigned c = 0; c < numChannels; ++c) {
+      dst[c][i] = src[i * numChannels + c];
+    }
+  }
+}
+
+inline void interleave(const float* const* src, std::size_t numFrames, unsigned numChannels, float* dst) {
+  for (std::size_t i = 0; i < numFrames; ++i) {
+    for (unsigned c = 0; c < numChannels; ++c) {
+      dst[i * numChannels + c] = src[c][i];
+    }
+  }
+}
+
+// The sanitizers classify samples by their bit patterns, so they work the same with FTZ/DAZ enabled
+
+inline uint32_t floatBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+inline uint64_t doubleBits(double value) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+inline void sanitizeFloat32(void* samples, std::size_t numSamples, const SanitizeOptions& options,
+                            SanitizeStats& stats) {
+  uint8_t* p = static_cast<uint8_t*>(samples);
+  const uint32_t nanBits = floatBits(options.nanReplacement);
+  const uint32_t infBits = floatBits(options.infinityReplacement) & 0x7fffffffu;
+  for (std::size_t i = 0; i < numSamples; ++i) {
+    uint32_t bits;
+    std::memcpy(&bits, p + 4 * i, sizeof(bits));
+    const uint32_t magnitude = bits & 0x7fffffffu;
+    uint32_t fixed = bits;
+    if (magnitude > 0x7f800000u) {
+      ++stats.nans;
+      fixed = nanBits;
+    } else if (magnitude == 0x7f800000u) {
+      ++stats.infinities;
+      fixed = (bits & 0x80000000u) | infBits;
+    } else if (magnitude != 0 && magnitude < 0x00800000u) {
+      ++stats.denormals;
+      fixed = options.flushDenormals ? bits & 0x80000000u : bits;
+    }
+    if (fixed != bits) {
+      std::memcpy(p + 4 * i, &fixed, sizeof(fixed));
+    }
+  }
+}
+
+inline void sanitizeFloat64(void* samples, std::size_t numSamples, const SanitizeOptions& options,
+                            SanitizeStats& stats) {
+  uint8_t* p = static_cast<uint8_t*>(samples);
+  const uint64_t sign = 0x8000000000000000ull;
+  const uint64_t infinity = 0x7ff0000000000000ull;
+  const uint64_t nanBits = doubleBits(options.nanReplacement);
+  const uint64_t infBits = doubleBits(options.infinityReplacement) & ~sign;
+  for (std::size_t i = 0; i < numSamples; ++i) {
+    uint64_t bits;
+    std::memcpy(&bits, p + 8 * i, sizeof(bits));
+    const uint64_t magnitude = bits & ~sign;
+    uint64_t fixed = bits;
+    if (magnitude > infinity) {
+      ++stats.nans;
+      fixed = nanBits;
+    } else if (magnitude == infinity) {
+      ++stats.infinities;
+      fixed = (bits & sign) | infBits;
+    } else if (magnitude != 0 && magnitude < 0x0010000000000000ull) {
+      ++stats.denormals;
+      fixed = options.flushDenormals ? bits & sign : bits;
+    }
+    if (fixed != bits) {
+      std::memcpy(p + 8 * i, &fixed, sizeof(fixed));
+    }
+  }
+}
+
+inline uint32_t xorshift32(uint32_t x) {
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return x;
+}
+
+inline void tpdfNoise(uint32_t* lanes, float* dst, std::size_t numSamples) {
+  for (std::size_t i = 0; i < numSamples; i += kDitherLanes) {
+    for (std::size_t l = 0; l < kDitherLanes; ++l) {
+      // Two independent uniform 24-bit draws; their difference is triangular and exact in float
+      const uint32_t a = xorshift32(lanes[l]);
+      const uint32_t b = xorshift32(a);
+      lanes[l] = b;
+      dst[i + l] = (int32_t(a >> 8) - int32_t(b >> 8)) * (1.0f / 16777216.0f);
+    }
+  }
+}
+
+/**
+ * @brief Scale, dither, clamp and round one sample exactly like the SIMD quantizers
+ * The comparisons are written like maxps/minps so NaN clamps to the lowest code everywhere.
+ */
+inline int32_t quantizeSample(float sample, float noise, float scale) {
+  float v = sample * scale + noise;
+  const float lo = -scale;
+  const float hi = scale - 1.0f;
+  v = v > lo ? v : lo;
+  v = v < hi ? v : hi;
+  return static_cast<int32_t>(std::nearbyint(v));
+}
+
+template <unsigned Bits>
+inline void quantize(const float* src, const float* noise, std::size_t numSamples, uint8_t* dst) {
+  const float scale = float(1u << (Bits - 1));
+  for (std::size_t i = 0; i < numSamples; ++i) {
+    const int32_t q = quantizeSample(src[i], noise ? noise[i] : 0.0f, scale);
+    const uint32_t bits = Bits == 8 ? uint32_t(q + 128) : uint32_t(q);
+    for (unsigned b = 0; b < Bits / 8; ++b) {
+      dst[i * (Bits / 8) + b] = static_cast<uint8_t>(bits >> (8 * b));
+    }
+  }
+}
+
+inline const SampleKernels& table() {
+  static const SampleKernels kernels{Isa::Scalar,
+                                     decode<AudioFormat::PCM, 8>,
+                                     decode<AudioFormat::PCM, 16>,
+                                     decode<AudioFormat::PCM, 24>,
+                                     decode<AudioFormat::PCM, 32>,
+                                     copyFloat32,
+                                     decode<AudioFormat::IEEE_FLOAT, 64>,
+                                     decodeBigEndian<AudioFormat::PCM, 16>,
+                                     decodeBigEndian<AudioFormat::PCM, 24>,
+                                     decodeBigEndian<AudioFormat::PCM, 32>,
+                                     decodeBigEndian<AudioFormat::IEEE_FLOAT, 32>,
+                                     decodeBigEndian<AudioFormat::IEEE_FLOAT, 64>,
+                                     peakAbs,
+                                     sumOfSquares,
+                                     deinterleave,
+                                     interleave,
+                                     sanitizeFloat32,
+                                     sanitizeFloat64,
+                                     tpdfNoise,
+                                     quantize<8>,
+                                     quantize<16>,
+                                     quantize<24>};
+  return kernels;
+}
+
+} // namespace scalar
+
+#if WAV_HAVE_X86_DISPATCH
+
+// Each kernel handles whole vectors and hands the remainder to the scalar version
+
+namespace sse41 {
+
+#define WAV_TARGET_SSE41 __attribute__((target("sse4.1")))
+
+WAV_TARGET_SSE41 inline void pcm8ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m128i bias = _mm_set1_epi32(128);
+  const __m128 scale = _mm_set1_ps(1.0f / 128.0f);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    int32_t word;
+    std::memcpy(&word, src + i, sizeof(word));
+    const __m128i v = _mm_sub_epi32(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(word)), bias);
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+  }
+  scalar::decode<AudioFormat::PCM, 8>(src + i, n - i, dst + i);
+}
+
+WAV_TARGET_SSE41 inline void pcm16ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i v = _mm_cvtepi16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 2 * i)));
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+  }
+  scalar::decode<AudioFormat::PCM, 16>(src + 2 * i, n - i, dst + i);
+}
+
+WAV_TARGET_SSE41 inline void pcm24ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  // Move each 3-byte sample to the top of a 32-bit lane (low byte zero), as in SampleTraits
+  const __m128i shuffle = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+  const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+  std::size_t i = 0;
+  for (; i + 6 <= n; i += 4) { // The 16-byte load reads 4 bytes past the 4 samples
+    const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+    const __m128i v = _mm_shuffle_epi8(raw, shuffle);
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+  }
+  scalar::decode<AudioFormat::PCM, 24>(src + 3 * i, n - i, dst + i);
+}
+
+WAV_TARGET_SSE41 inline void pcm32ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+  }
+  scalar::decode<AudioFormat::PCM, 32>(src + 4 * i, n - i, dst + i);
+}
+
+WAV_TARGET_SSE41 inline void float64ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const double* in = reinterpret_cast<const double*>(src);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(in + i));
+    const __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(in + i + 2));
+    _mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+  }
+  scalar::decode<AudioFormat::IEEE_FLOAT, 64>(src + 8 * i, n - i, dst + i);
+}
+
+// Big-endian decoders: one pshufb reverses the bytes of every sample, then the little-endian math applies
+
+WAV_TARGET_SSE41 inline void pcm16beToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m128i swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  const __m128 scale = _mm_set1_ps(1.0f / 32768.0f);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i raw = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + 2 * i));
+    const __m128i v = _mm_cvtepi16_epi32(_mm_shuffle_epi8(raw, swap));
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+  }
+  scalar::decodeBigEndian<AudioFormat::PCM, 16>(src + 2 * i, n - i, dst + i);
+}
+
+WAV_TARGET_SSE41 inline void pcm24beToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  // Most significant byte first: reversed into the top three bytes of each 32-bit lane
+  const __m128i shuffle = _mm_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9);
+  const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+  std::size_t i = 0;
+  for (; i + 6 <= n; i += 4) { // The 16-byte load reads 4 bytes past the 4 samples
+    const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+    const __m128i v = _mm_shuffle_epi8(raw, shuffle);
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+  }
+  scalar::decodeBigEndian<AudioFormat::PCM, 24>(src + 3 * i, n - i, dst + i);
+}
+
+WAV_TARGET_SSE41 inline __m128i loadSwapped32(const uint8_t* src) {
+  const __m128i swap = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src)), swap);
+}
+
+WAV_TARGET_SSE41 inline void pcm32beToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m128 scale = _mm_set1_ps(1.0f / 2147483648.0f);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(loadSwapped32(src + 4 * i)), scale));
+  }
+  scalar::decodeBigEndian<AudioFormat::PCM, 32>(src + 4 * i, n - i, dst + i);
+}
+
+WAV_TARGET_SSE41 inline void float32beToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), loadSwapped32(src + 4 * i));
+  }
+  scalar::decodeBigEndian<AudioFormat::IEEE_FLOAT, 32>(src + 4 * i, n - i, dst + i);
+}
+
+WAV_TARGET_SSE41 inline void float64beToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m128i swap = _mm_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i a = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8 * i)), swap);
+    const __m128i b = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 8 * i + 16)), swap);
+    const __m128 lo = _mm_cvtpd_ps(_mm_castsi128_pd(a));
+    const __m128 hi = _mm_cvtpd_ps(_mm_castsi128_pd(b));
+    _mm_storeu_ps(dst + i, _mm_movelh_ps(lo, hi));
+  }
+  scalar::decodeBigEndian<AudioFormat::IEEE_FLOAT, 64>(src + 8 * i, n - i, dst + i);
+}
+
+WAV_TARGET_SSE41 inline float peakAbs(const float* src, std::size_t n) {
+  const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 peak = _mm_setzero_ps();
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    // maxps returns its second operand when the first is NaN, so NaN never enters the accumulator
+    peak = _mm_max_ps(_mm_and_ps(_mm_loadu_ps(src + i), absMask), peak);
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, peak);
+  const float vectorPeak = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+  return std::max(vectorPeak, scalar::peakAbs(src + i, n - i));
+}
+
+WAV_TARGET_SSE41 inline double sumOfSquares(const float* src, std::size_t n) {
+  __m128d sumLo = _mm_setzero_pd();
+  __m128d sumHi = _mm_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128 v = _mm_loadu_ps(src + i);
+    const __m128d lo = _mm_cvtps_pd(v);
+    const __m128d hi = _mm_cvtps_pd(_mm_movehl_ps(v, v));
+    sumLo = _mm_add_pd(sumLo, _mm_mul_pd(lo, lo));
+    sumHi = _mm_add_pd(sumHi, _mm_mul_pd(hi, hi));
+  }
+  double lanes[2];
+  _mm_storeu_pd(lanes, _mm_add_pd(sumLo, sumHi));
+  return lanes[0] + lanes[1] + scalar::sumOfSquares(src + i, n - i);
+}
+
+WAV_TARGET_SSE41 inline void deinterleave(const float* src, std::size_t numFrames, unsigned numChannels,
+                                          float* const* dst) {
+  if (numChannels != 2) {
+    scalar::deinterleave(src, numFrames, numChannels, dst);
+    return;
+  }
+  std::size_t i = 0;
+  for (; i + 4 <= numFrames; i += 4) {
+    const __m128 a = _mm_loadu_ps(src + 2 * i);     // L0 R0 L1 R1
+    const __m128 b = _mm_loadu_ps(src + 2 * i + 4); // L2 R2 L3 R3
+    _mm_storeu_ps(dst[0] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(dst[1] + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+  }
+  float* const rest[] = {dst[0] + i, dst[1] + i};
+  scalar::deinterleave(src + 2 * i, numFrames - i, 2, rest);
+}
+
+WAV_TARGET_SSE41 inline void interleave(const float* const* src, std::size_t numFrames, unsigned numChannels,
+                                        float* dst) {
+  if (numChannels != 2) {
+    scalar::interleave(src, numFrames, numChannels, dst);
+    return;
+  }
+  std::size_t i = 0;
+  for (; i + 4 <= numFrames; i += 4) {
+    const __m128 l = _mm_loadu_ps(src[0] + i);
+    const __m128 r = _mm_loadu_ps(src[1] + i);
+    _mm_storeu_ps(dst + 2 * i, _mm_unpacklo_ps(l, r));
+    _mm_storeu_ps(dst + 2 * i + 4, _mm_unpackhi_ps(l, r));
+  }
+  const float* const rest[] = {src[0] + i, src[1] + i};
+  scalar::interleave(rest, numFrames - i, 2, dst + 2 * i);
+}
+
+WAV_TARGET_SSE41 inline void sanitizeFloat32(void* samples, std::size_t n, const SanitizeOptions& options,
+                                             SanitizeStats& stats) {
+  uint8_t* p = static_cast<uint8_t*>(samples);
+  const __m128i absMask = _mm_set1_epi32(0x7fffffff);
+  const __m128i signMask = _mm_set1_epi32(int32_t(0x80000000u));
+  const __m128i infinity = _mm_set1_epi32(0x7f800000);
+  const __m128i minNormal = _mm_set1_epi32(0x00800000);
+  const __m128i nanFill = _mm_set1_epi32(int32_t(scalar::floatBits(options.nanReplacement)));
+  const __m128i infFill = _mm_set1_epi32(int32_t(scalar::floatBits(options.infinityReplacement) & 0x7fffffffu));
+  const __m128i flush = _mm_set1_epi32(options.flushDenormals ? -1 : 0);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 4 * i));
+    const __m128i magnitude = _mm_and_si128(v, absMask);
+    const __m128i isNan = _mm_cmpgt_epi32(magnitude, infinity);
+    const __m128i isInf = _mm_cmpeq_epi32(magnitude, infinity);
+    const __m128i isDenormal =
+        _mm_andnot_si128(_mm_cmpeq_epi32(magnitude, _mm_setzero_si128()), _mm_cmpgt_epi32(minNormal, magnitude));
+    const __m128i bad = _mm_or_si128(_mm_or_si128(isNan, isInf), isDenormal);
+    if (_mm_testz_si128(bad, bad)) {
+      continue; // The common case: a clean block costs a few compares
+    }
+    stats.nans += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(isNan)));
+    stats.infinities += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(isInf)));
+    stats.denormals += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(isDenormal)));
+    const __m128i sign = _mm_and_si128(v, signMask);
+    __m128i fixed = _mm_blendv_epi8(v, nanFill, isNan);
+    fixed = _mm_blendv_epi8(fixed, _mm_or_si128(sign, infFill), isInf);
+    fixed = _mm_blendv_epi8(fixed, sign, _mm_and_si128(isDenormal, flush));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p + 4 * i), fixed);
+  }
+  scalar::sanitizeFloat32(p + 4 * i, n - i, options, stats);
+}
+
+WAV_TARGET_SSE41 inline __m128i xorshift32(__m128i x) {
+  x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+  x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+  return _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+}
+
+WAV_TARGET_SSE41 inline void tpdfNoise(uint32_t* lanes, float* dst, std::size_t numSamples) {
+  __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+  __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes + 4));
+  const __m128 scale = _mm_set1_ps(1.0f / 16777216.0f);
+  for (std::size_t i = 0; i < numSamples; i += kDitherLanes) {
+    const __m128i aLo = xorshift32(lo);
+    const __m128i aHi = xorshift32(hi);
+    lo = xorshift32(aLo);
+    hi = xorshift32(aHi);
+    const __m128i dLo = _mm_sub_epi32(_mm_srli_epi32(aLo, 8), _mm_srli_epi32(lo, 8));
+    const __m128i dHi = _mm_sub_epi32(_mm_srli_epi32(aHi, 8), _mm_srli_epi32(hi, 8));
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(dLo), scale));
+    _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(dHi), scale));
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), lo);
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes + 4), hi);
+}
+
+/**
+ * @brief Scale, add noise, clamp and round 4 samples; see scalar::quantizeSample
+ */
+WAV_TARGET_SSE41 inline __m128i quantize4(const float* src, const float* noise, __m128 scale) {
+  __m128 v = _mm_mul_ps(_mm_loadu_ps(src), scale);
+  v = _mm_add_ps(v, noise ? _mm_loadu_ps(noise) : _mm_setzero_ps());
+  v = _mm_max_ps(v, _mm_sub_ps(_mm_setzero_ps(), scale));
+  v = _mm_min_ps(v, _mm_sub_ps(scale, _mm_set1_ps(1.0f)));
+  return _mm_cvtps_epi32(v);
+}
+
+WAV_TARGET_SSE41 inline void quantizeToPcm8(const float* src, const float* noise, std::size_t n, uint8_t* dst) {
+  const __m128 scale = _mm_set1_ps(128.0f);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i q = _mm_add_epi32(quantize4(src + i, noise ? noise + i : nullptr, scale), _mm_set1_epi32(128));
+    const __m128i words = _mm_packs_epi32(q, q);
+    const int32_t bytes = _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+    std::memcpy(dst + i, &bytes, sizeof(bytes));
+  }
+  scalar::quantize<8>(src + i, noise ? noise + i : nullptr, n - i, dst + i);
+}
+
+WAV_TARGET_SSE41 inline void quantizeToPcm16(const float* src, const float* noise, std::size_t n, uint8_t* dst) {
+  const __m128 scale = _mm_set1_ps(32768.0f);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m128i q = quantize4(src + i, noise ? noise + i : nullptr, scale);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 2 * i), _mm_packs_epi32(q, q));
+  }
+  scalar::quantize<16>(src + i, noise ? noise + i : nullptr, n - i, dst + 2 * i);
+}
+
+WAV_TARGET_SSE41 inline void quantizeToPcm24(const float* src, const float* noise, std::size_t n, uint8_t* dst) {
+  // Drop the top byte of each 32-bit code: 4 samples become 12 packed bytes
+  const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+  const __m128 scale = _mm_set1_ps(8388608.0f);
+  std::size_t i = 0;
+  for (; i + 6 <= n; i += 4) { // The 16-byte store writes 4 bytes that the next iteration overwrites
+    const __m128i q = quantize4(src + i, noise ? noise + i : nullptr, scale);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 3 * i), _mm_shuffle_epi8(q, pack));
+  }
+  scalar::quantize<24>(src + i, noise ? noise + i : nullptr, n - i, dst + 3 * i);
+}
+
+#undef WAV_TARGET_SSE41
+
+// 64-bit integer compares need SSE4.2, so float64 sanitizing stays scalar here
+inline const SampleKernels& table() {
+  static const SampleKernels kernels{Isa::SSE41,
+                                     pcm8ToFloat,
+                                     pcm16ToFloat,
+                                     pcm24ToFloat,
+                                     pcm32ToFloat,
+                                     scalar::copyFloat32,
+                                     float64ToFloat,
+                                     pcm16beToFloat,
+                                     pcm24beToFloat,
+                                     pcm32beToFloat,
+                                     float32beToFloat,
+                                     float64beToFloat,
+                                     peakAbs,
+                                     sumOfSquares,
+                                     deinterleave,
+                                     interleave,
+                                     sanitizeFloat32,
+                                     scalar::sanitizeFloat64,
+                                     tpdfNoise,
+                                     quantizeToPcm8,
+                                     quantizeToPcm16,
+                                     quantizeToPcm24};
+  return kernels;
+}
+
+} // namespace sse41
+
+namespace avx2 {
+
+#define WAV_TARGET_AVX2 __attribute__((target("avx2,fma")))
+
+WAV_TARGET_AVX2 inline void pcm8ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m256i bias = _mm256_set1_epi32(128);
+  const __m256 scale = _mm256_set1_ps(1.0f / 128.0f);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i v = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i)));
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_sub_epi32(v, bias)), scale));
+  }
+  sse41::pcm8ToFloat(src + i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX2 inline void pcm16ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i)));
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+  }
+  sse41::pcm16ToFloat(src + 2 * i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX2 inline void pcm24ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  // vpshufb works per 128-bit lane, so each lane gets its own 4 samples (12 bytes) loaded
+  const __m256i shuffle = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, //
+                                           -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+  const __m256 scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+  std::size_t i = 0;
+  for (; i + 10 <= n; i += 8) { // The upper load reads 4 bytes past the 8 samples
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i + 12));
+    const __m256i raw = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    const __m256i v = _mm256_shuffle_epi8(raw, shuffle);
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+  }
+  sse41::pcm24ToFloat(src + 3 * i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX2 inline void pcm32ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m256 scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 4 * i));
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+  }
+  sse41::pcm32ToFloat(src + 4 * i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX2 inline void float64ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const double* in = reinterpret_cast<const double*>(src);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm_storeu_ps(dst + i, _mm256_cvtpd_ps(_mm256_loadu_pd(in + i)));
+    _mm_storeu_ps(dst + i + 4, _mm256_cvtpd_ps(_mm256_loadu_pd(in + i + 4)));
+  }
+  sse41::float64ToFloat(src + 8 * i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX2 inline void pcm16beToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m128i swap = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  const __m256 scale = _mm256_set1_ps(1.0f / 32768.0f);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m128i raw = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+    const __m256i v = _mm256_cvtepi16_epi32(_mm_shuffle_epi8(raw, swap));
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+  }
+  sse41::pcm16beToFloat(src + 2 * i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX2 inline void pcm24beToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m256i shuffle = _mm256_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, //
+                                           -1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9);
+  const __m256 scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+  std::size_t i = 0;
+  for (; i + 10 <= n; i += 8) { // The upper load reads 4 bytes past the 8 samples
+    const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i));
+    const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 3 * i + 12));
+    const __m256i raw = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+    const __m256i v = _mm256_shuffle_epi8(raw, shuffle);
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+  }
+  sse41::pcm24beToFloat(src + 3 * i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX2 inline __m256i loadSwapped32(const uint8_t* src) {
+  const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, //
+                                        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  return _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src)), swap);
+}
+
+WAV_TARGET_AVX2 inline void pcm32beToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m256 scale = _mm256_set1_ps(1.0f / 2147483648.0f);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(loadSwapped32(src + 4 * i)), scale));
+  }
+  sse41::pcm32beToFloat(src + 4 * i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX2 inline void float32beToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), loadSwapped32(src + 4 * i));
+  }
+  sse41::float32beToFloat(src + 4 * i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX2 inline void float64beToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m256i swap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, //
+                                        7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i a = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 8 * i)), swap);
+    const __m256i b =
+        _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 8 * i + 32)), swap);
+    _mm_storeu_ps(dst + i, _mm256_cvtpd_ps(_mm256_castsi256_pd(a)));
+    _mm_storeu_ps(dst + i + 4, _mm256_cvtpd_ps(_mm256_castsi256_pd(b)));
+  }
+  sse41::float64beToFloat(src + 8 * i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX2 inline float peakAbs(const float* src, std::size_t n) {
+  const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+  __m256 peak = _mm256_setzero_ps();
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    peak = _mm256_max_ps(_mm256_and_ps(_mm256_loadu_ps(src + i), absMask), peak);
+  }
+  float lanes[8];
+  _mm256_storeu_ps(lanes, peak);
+  return std::max(*std::max_element(lanes, lanes + 8), sse41::peakAbs(src + i, n - i));
+}
+
+WAV_TARGET_AVX2 inline double sumOfSquares(const float* src, std::size_t n) {
+  __m256d sumLo = _mm256_setzero_pd();
+  __m256d sumHi = _mm256_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256d lo = _mm256_cvtps_pd(_mm_loadu_ps(src + i));
+    const __m256d hi = _mm256_cvtps_pd(_mm_loadu_ps(src + i + 4));
+    sumLo = _mm256_fmadd_pd(lo, lo, sumLo);
+    sumHi = _mm256_fmadd_pd(hi, hi, sumHi);
+  }
+  double lanes[4];
+  _mm256_storeu_pd(lanes, _mm256_add_pd(sumLo, sumHi));
+  return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]) + sse41::sumOfSquares(src + i, n - i);
+}
+
+WAV_TARGET_AVX2 inline void deinterleave(const float* src, std::size_t numFrames, unsigned numChannels,
+                                         float* const* dst) {
+  if (numChannels != 2) {
+    scalar::deinterleave(src, numFrames, numChannels, dst);
+    return;
+  }
+  std::size_t i = 0;
+  for (; i + 8 <= numFrames; i += 8) {
+    const __m256 a = _mm256_loadu_ps(src + 2 * i);     // L0 R0 L1 R1 | L2 R2 L3 R3
+    const __m256 b = _mm256_loadu_ps(src + 2 * i + 8); // L4 R4 L5 R5 | L6 R6 L7 R7
+    // shufps gives L0 L1 L4 L5 | L2 L3 L6 L7; swapping the middle 64-bit pairs restores frame order
+    const __m256 l = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    const __m256 r = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    _mm256_storeu_ps(dst[0] + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(l), 0xd8)));
+    _mm256_storeu_ps(dst[1] + i, _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(r), 0xd8)));
+  }
+  float* const rest[] = {dst[0] + i, dst[1] + i};
+  sse41::deinterleave(src + 2 * i, numFrames - i, 2, rest);
+}
+
+WAV_TARGET_AVX2 inline void interleave(const float* const* src, std::size_t numFrames, unsigned numChannels,
+                                       float* dst) {
+  if (numChannels != 2) {
+    scalar::interleave(src, numFrames, numChannels, dst);
+    return;
+  }
+  std::size_t i = 0;
+  for (; i + 8 <= numFrames; i += 8) {
+    const __m256 l = _mm256_loadu_ps(src[0] + i);
+    const __m256 r = _mm256_loadu_ps(src[1] + i);
+    const __m256 lo = _mm256_unpacklo_ps(l, r); // L0 R0 L1 R1 | L4 R4 L5 R5
+    const __m256 hi = _mm256_unpackhi_ps(l, r); // L2 R2 L3 R3 | L6 R6 L7 R7
+    _mm256_storeu_ps(dst + 2 * i, _mm256_permute2f128_ps(lo, hi, 0x20));
+    _mm256_storeu_ps(dst + 2 * i + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+  }
+  const float* const rest[] = {src[0] + i, src[1] + i};
+  sse41::interleave(rest, numFrames - i, 2, dst + 2 * i);
+}
+
+WAV_TARGET_AVX2 inline void sanitizeFloat32(void* samples, std::size_t n, const SanitizeOptions& options,
+                                            SanitizeStats& stats) {
+  uint8_t* p = static_cast<uint8_t*>(samples);
+  const __m256i absMask = _mm256_set1_epi32(0x7fffffff);
+  const __m256i signMask = _mm256_set1_epi32(int32_t(0x80000000u));
+  const __m256i infinity = _mm256_set1_epi32(0x7f800000);
+  const __m256i minNormal = _mm256_set1_epi32(0x00800000);
+  const __m256i nanFill = _mm256_set1_epi32(int32_t(scalar::floatBits(options.nanReplacement)));
+  const __m256i infFill = _mm256_set1_epi32(int32_t(scalar::floatBits(options.infinityReplacement) & 0x7fffffffu));
+  const __m256i flush = _mm256_set1_epi32(options.flushDenormals ? -1 : 0);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 4 * i));
+    const __m256i magnitude = _mm256_and_si256(v, absMask);
+    const __m256i isNan = _mm256_cmpgt_epi32(magnitude, infinity);
+    const __m256i isInf = _mm256_cmpeq_epi32(magnitude, infinity);
+    const __m256i isDenormal = _mm256_andnot_si256(_mm256_cmpeq_epi32(magnitude, _mm256_setzero_si256()),
+                                                   _mm256_cmpgt_epi32(minNormal, magnitude));
+    const __m256i bad = _mm256_or_si256(_mm256_or_si256(isNan, isInf), isDenormal);
+    if (_mm256_testz_si256(bad, bad)) {
+      continue;
+    }
+    stats.nans += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(isNan)));
+    stats.infinities += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(isInf)));
+    stats.denormals += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(isDenormal)));
+    const __m256i sign = _mm256_and_si256(v, signMask);
+    __m256i fixed = _mm256_blendv_epi8(v, nanFill, isNan);
+    fixed = _mm256_blendv_epi8(fixed, _mm256_or_si256(sign, infFill), isInf);
+    fixed = _mm256_blendv_epi8(fixed, sign, _mm256_and_si256(isDenormal, flush));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + 4 * i), fixed);
+  }
+  sse41::sanitizeFloat32(p + 4 * i, n - i, options, stats);
+}
+
+WAV_TARGET_AVX2 inline void sanitizeFloat64(void* samples, std::size_t n, const SanitizeOptions& options,
+                                            SanitizeStats& stats) {
+  uint8_t* p = static_cast<uint8_t*>(samples);
+  const __m256i absMask = _mm256_set1_epi64x(0x7fffffffffffffffll);
+  const __m256i signMask = _mm256_set1_epi64x(int64_t(0x8000000000000000ull));
+  const __m256i infinity = _mm256_set1_epi64x(0x7ff0000000000000ll);
+  const __m256i minNormal = _mm256_set1_epi64x(0x0010000000000000ll);
+  const __m256i nanFill = _mm256_set1_epi64x(int64_t(scalar::doubleBits(options.nanReplacement)));
+  const __m256i infFill =
+      _mm256_set1_epi64x(int64_t(scalar::doubleBits(options.infinityReplacement) & 0x7fffffffffffffffull));
+  const __m256i flush = _mm256_set1_epi64x(options.flushDenormals ? -1 : 0);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 8 * i));
+    const __m256i magnitude = _mm256_and_si256(v, absMask);
+    const __m256i isNan = _mm256_cmpgt_epi64(magnitude, infinity);
+    const __m256i isInf = _mm256_cmpeq_epi64(magnitude, infinity);
+    const __m256i isDenormal = _mm256_andnot_si256(_mm256_cmpeq_epi64(magnitude, _mm256_setzero_si256()),
+                                                   _mm256_cmpgt_epi64(minNormal, magnitude));
+    const __m256i bad = _mm256_or_si256(_mm256_or_si256(isNan, isInf), isDenormal);
+    if (_mm256_testz_si256(bad, bad)) {
+      continue;
+    }
+    stats.nans += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(isNan)));
+    stats.infinities += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(isInf)));
+    stats.denormals += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(isDenormal)));
+    const __m256i sign = _mm256_and_si256(v, signMask);
+    __m256i fixed = _mm256_blendv_epi8(v, nanFill, isNan);
+    fixed = _mm256_blendv_epi8(fixed, _mm256_or_si256(sign, infFill), isInf);
+    fixed = _mm256_blendv_epi8(fixed, sign, _mm256_and_si256(isDenormal, flush));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + 8 * i), fixed);
+  }
+  scalar::sanitizeFloat64(p + 8 * i, n - i, options, stats);
+}
+
+WAV_TARGET_AVX2 inline __m256i xorshift32(__m256i x) {
+  x = _mm256_xor_si256(x, _mm256_slli_epi32(x, 13));
+  x = _mm256_xor_si256(x, _mm256_srli_epi32(x, 17));
+  return _mm256_xor_si256(x, _mm256_slli_epi32(x, 5));
+}
+
+WAV_TARGET_AVX2 inline void tpdfNoise(uint32_t* lanes, float* dst, std::size_t numSamples) {
+  __m256i state = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes));
+  const __m256 scale = _mm256_set1_ps(1.0f / 16777216.0f);
+  for (std::size_t i = 0; i < numSamples; i += kDitherLanes) {
+    const __m256i a = xorshift32(state);
+    state = xorshift32(a);
+    const __m256i d = _mm256_sub_epi32(_mm256_srli_epi32(a, 8), _mm256_srli_epi32(state, 8));
+    _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(d), scale));
+  }
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), state);
+}
+
+/**
+ * @brief Scale, add noise, clamp and round 8 samples; see scalar::quantizeSample
+ * The scale is a power of two, so the product is exact and fusing it into an FMA cannot change the result.
+ */
+WAV_TARGET_AVX2 inline __m256i quantize8(const float* src, const float* noise, __m256 scale) {
+  __m256 v = _mm256_mul_ps(_mm256_loadu_ps(src), scale);
+  v = _mm256_add_ps(v, noise ? _mm256_loadu_ps(noise) : _mm256_setzero_ps());
+  v = _mm256_max_ps(v, _mm256_sub_ps(_mm256_setzero_ps(), scale));
+  v = _mm256_min_ps(v, _mm256_sub_ps(scale, _mm256_set1_ps(1.0f)));
+  return _mm256_cvtps_epi32(v);
+}
+
+WAV_TARGET_AVX2 inline void quantizeToPcm8(const float* src, const float* noise, std::size_t n, uint8_t* dst) {
+  const __m256 scale = _mm256_set1_ps(128.0f);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i q = _mm256_add_epi32(quantize8(src + i, noise ? noise + i : nullptr, scale), _mm256_set1_epi32(128));
+    const __m256i words = _mm256_packs_epi32(q, q);
+    const __m256i bytes = _mm256_packus_epi16(words, words); // 4 codes repeated in each 128-bit lane
+    const __m256i packed = _mm256_permutevar8x32_epi32(bytes, _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm256_castsi256_si128(packed));
+  }
+  sse41::quantizeToPcm8(src + i, noise ? noise + i : nullptr, n - i, dst + i);
+}
+
+WAV_TARGET_AVX2 inline void quantizeToPcm16(const float* src, const float* noise, std::size_t n, uint8_t* dst) {
+  const __m256 scale = _mm256_set1_ps(32768.0f);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i q = quantize8(src + i, noise ? noise + i : nullptr, scale);
+    // packs works per 128-bit lane; gather the two low 64-bit halves
+    const __m256i words = _mm256_permute4x64_epi64(_mm256_packs_epi32(q, q), 0x08);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 2 * i), _mm256_castsi256_si128(words));
+  }
+  sse41::quantizeToPcm16(src + i, noise ? noise + i : nullptr, n - i, dst + 2 * i);
+}
+
+WAV_TARGET_AVX2 inline void quantizeToPcm24(const float* src, const float* noise, std::size_t n, uint8_t* dst) {
+  const __m256i pack = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, //
+                                        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+  const __m256i compact = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+  const __m256 scale = _mm256_set1_ps(8388608.0f);
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m256i q = quantize8(src + i, noise ? noise + i : nullptr, scale);
+    const __m256i packed = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(q, pack), compact); // 24 bytes
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 3 * i), _mm256_castsi256_si128(packed));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + 3 * i + 16), _mm256_extracti128_si256(packed, 1));
+  }
+  sse41::quantizeToPcm24(src + i, noise ? noise + i : nullptr, n - i, dst + 3 * i);
+}
+
+#undef WAV_TARGET_AVX2
+
+inline const SampleKernels& table() {
+  static const SampleKernels kernels{Isa::AVX2,
+                                     pcm8ToFloat,
+                                     pcm16ToFloat,
+                                     pcm24ToFloat,
+                                     pcm32ToFloat,
+                                     scalar::copyFloat32,
+                                     float64ToFloat,
+                                     pcm16beToFloat,
+                                     pcm24beToFloat,
+                                     pcm32beToFloat,
+                                     float32beToFloat,
+                                     float64beToFloat,
+                                     peakAbs,
+                                     sumOfSquares,
+                                     deinterleave,
+                                     interleave,
+                                     sanitizeFloat32,
+                                     sanitizeFloat64,
+                                     tpdfNoise,
+                                     quantizeToPcm8,
+                                     quantizeToPcm16,
+                                     quantizeToPcm24};
+  return kernels;
+}
+
+} // namespace avx2
+
+// GCC's avx512fintrin.h builds many intrinsics on _mm512_undefined_*(), which GCC 12 reports as
+// -W(maybe-)uninitialized in every function they are inlined into
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace avx512 {
+
+#define WAV_TARGET_AVX512 __attribute__((target("avx512f,avx512bw,avx2,fma")))
+
+WAV_TARGET_AVX512 inline void pcm8ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m512i bias = _mm512_set1_epi32(128);
+  const __m512 scale = _mm512_set1_ps(1.0f / 128.0f);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512i v = _mm512_cvtepu8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+    _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_sub_epi32(v, bias)), scale));
+  }
+  avx2::pcm8ToFloat(src + i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX512 inline void pcm16ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m512 scale = _mm512_set1_ps(1.0f / 32768.0f);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512i v = _mm512_cvtepi16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 2 * i)));
+    _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(v), scale));
+  }
+  avx2::pcm16ToFloat(src + 2 * i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX512 inline void pcm24ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  // One 64-byte load holds 16 samples (48 bytes); spread them so each 128-bit lane starts at a 12-byte boundary
+  const __m512i spread = _mm512_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6, 6, 7, 8, 9, 9, 10, 11, 12);
+  const __m512i shuffle = _mm512_broadcast_i32x4(_mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11));
+  const __m512 scale = _mm512_set1_ps(1.0f / 2147483648.0f);
+  std::size_t i = 0;
+  for (; i + 22 <= n; i += 16) { // The 64-byte load reads 16 bytes past the 16 samples
+    const __m512i raw = _mm512_loadu_si512(src + 3 * i);
+    const __m512i v = _mm512_shuffle_epi8(_mm512_permutexvar_epi32(spread, raw), shuffle);
+    _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(v), scale));
+  }
+  avx2::pcm24ToFloat(src + 3 * i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX512 inline void pcm32ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const __m512 scale = _mm512_set1_ps(1.0f / 2147483648.0f);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512i v = _mm512_loadu_si512(src + 4 * i);
+    _mm512_storeu_ps(dst + i, _mm512_mul_ps(_mm512_cvtepi32_ps(v), scale));
+  }
+  avx2::pcm32ToFloat(src + 4 * i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX512 inline void float64ToFloat(const uint8_t* src, std::size_t n, float* dst) {
+  const double* in = reinterpret_cast<const double*>(src);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    _mm256_storeu_ps(dst + i, _mm512_cvtpd_ps(_mm512_loadu_pd(in + i)));
+    _mm256_storeu_ps(dst + i + 8, _mm512_cvtpd_ps(_mm512_loadu_pd(in + i + 8)));
+  }
+  avx2::float64ToFloat(src + 8 * i, n - i, dst + i);
+}
+
+WAV_TARGET_AVX512 inline float peakAbs(const float* src, std::size_t n) {
+  __m512 peak = _mm512_setzero_ps();
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    peak = _mm512_max_ps(_mm512_abs_ps(_mm512_loadu_ps(src + i)), peak);
+  }
+  return std::max(_mm512_reduce_max_ps(peak), avx2::peakAbs(src + i, n - i));
+}
+
+WAV_TARGET_AVX512 inline double sumOfSquares(const float* src, std::size_t n) {
+  __m512d sumLo = _mm512_setzero_pd();
+  __m512d sumHi = _mm512_setzero_pd();
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512d lo = _mm512_cvtps_pd(_mm256_loadu_ps(src + i));
+    const __m512d hi = _mm512_cvtps_pd(_mm256_loadu_ps(src + i + 8));
+    sumLo = _mm512_fmadd_pd(lo, lo, sumLo);
+    sumHi = _mm512_fmadd_pd(hi, hi, sumHi);
+  }
+  return _mm512_reduce_add_pd(_mm512_add_pd(sumLo, sumHi)) + avx2::sumOfSquares(src + i, n - i);
+}
+
+WAV_TARGET_AVX512 inline void sanitizeFloat32(void* samples, std::size_t n, const SanitizeOptions& options,
+                                              SanitizeStats& stats) {
+  uint8_t* p = static_cast<uint8_t*>(samples);
+  const __m512i absMask = _mm512_set1_epi32(0x7fffffff);
+  const __m512i signMask = _mm512_set1_epi32(int32_t(0x80000000u));
+  const __m512i infinity = _mm512_set1_epi32(0x7f800000);
+  const __m512i minNormal = _mm512_set1_epi32(0x00800000);
+  const __m512i nanFill = _mm512_set1_epi32(int32_t(scalar::floatBits(options.nanReplacement)));
+  const __m512i infFill = _mm512_set1_epi32(int32_t(scalar::floatBits(options.infinityReplacement) & 0x7fffffffu));
+  const __mmask16 flush = options.flushDenormals ? 0xffff : 0;
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m512i v = _mm512_loadu_si512(p + 4 * i);
+    const __m512i magnitude = _mm512_and_si512(v, absMask);
+    const __mmask16 isNan = _mm512_cmpgt_epi32_mask(magnitude, infinity);
+    const __mmask16 isInf = _mm512_cmpeq_epi32_mask(magnitude, infinity);
+    const __mmask16 isDenormal =
+        _mm512_cmplt_epi32_mask(magnitude, minNormal) & _mm512_test_epi32_mask(magnitude, magnitude);
+    if ((isNan | isInf | isDenormal) == 0) {
+      continue;
+    }
+    stats.nans += __builtin_popcount(isNan);
+    stats.infinities += __builtin_popcount(isInf);
+    stats.denormals += __builtin_popcount(isDenormal);
+    const __m512i sign = _mm512_and_si512(v, signMask);
+    __m512i fixed = _mm512_mask_blend_epi32(isNan, v, nanFill);
+    fixed = _mm512_mask_blend_epi32(isInf, fixed, _mm512_or_si512(sign, infFill));
+    fixed = _mm512_mask_blend_epi32(isDenormal & flush, fixed, sign);
+    _mm512_storeu_si512(p + 4 * i, fixed);
+  }
+  avx2::sanitizeFloat32(p + 4 * i, n - i, options, stats);
+}
+
+WAV_TARGET_AVX512 inline void sanitizeFloat64(void* samples, std::size_t n, const SanitizeOptions& options,
+                                              SanitizeStats& stats) {
+  uint8_t* p = static_cast<uint8_t*>(samples);
+  const __m512i absMask = _mm512_set1_epi64(0x7fffffffffffffffll);
+  const __m512i signMask = _mm512_set1_epi64(int64_t(0x8000000000000000ull));
+  const __m512i infinity = _mm512_set1_epi64(0x7ff0000000000000ll);
+  const __m512i minNormal = _mm512_set1_epi64(0x0010000000000000ll);
+  const __m512i nanFill = _mm512_set1_epi64(int64_t(scalar::doubleBits(options.nanReplacement)));
+  const __m512i infFill =
+      _mm512_set1_epi64(int64_t(scalar::doubleBits(options.infinityReplacement) & 0x7fffffffffffffffull));
+  const __mmask8 flush = options.flushDenormals ? 0xff : 0;
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    const __m512i v = _mm512_loadu_si512(p + 8 * i);
+    const __m512i magnitude = _mm512_and_si512(v, absMask);
+    const __mmask8 isNan = _mm512_cmpgt_epi64_mask(magnitude, infinity);
+    const __mmask8 isInf = _mm512_cmpeq_epi64_mask(magnitude, infinity);
+    const __mmask8 isDenormal =
+        _mm512_cmplt_epi64_mask(magnitude, minNormal) & _mm512_test_epi64_mask(magnitude, magnitude);
+    if ((isNan | isInf | isDenormal) == 0) {
+      continue;
+    }
+    stats.nans += __builtin_popcount(isNan);
+    stats.infinities += __builtin_popcount(isInf);
+    stats.denormals += __builtin_popcount(isDenormal);
+    const __m512i sign = _mm512_and_si512(v, signMask);
+    __m512i fixed = _mm512_mask_blend_epi64(isNan, v, nanFill);
+    fixed = _mm512_mask_blend_epi64(isInf, fixed, _mm512_or_si512(sign, infFill));
+    fixed = _mm512_mask_blend_epi64(isDenormal & flush, fixed, sign);
+    _mm512_storeu_si512(p + 8 * i, fixed);
+  }
+  avx2::sanitizeFloat64(p + 8 * i, n - i, options, stats);
+}
+
+#undef WAV_TARGET_AVX512
+
+// Stereo (de)interleave, dither, quantizing and the big-endian decoders are memory-bound and reuse the AVX2 versions
+inline const SampleKernels& table() {
+  static const SampleKernels kernels{Isa::AVX512,
+                                     pcm8ToFloat,
+                                     pcm16ToFloat,
+                                     pcm24ToFloat,
+                                     pcm32ToFloat,
+                                     scalar::copyFloat32,
+                                     float64ToFloat,
+                                     avx2::pcm16beToFloat,
+                                     avx2::pcm24beToFloat,
+                                     avx2::pcm32beToFloat,
+                                     avx2::float32beToFloat,
+                                     avx2::float64beToFloat,
+                                     peakAbs,
+                                     sumOfSquares,
+                                     avx2::deinterleave,
+                                     avx2::interleave,
+                                     sanitizeFloat32,
+                                     sanitizeFloat64,
+                                     avx2::tpdfNoise,
+                                     avx2::quantizeToPcm8,
+                                     avx2::quantizeToPcm16,
+                                     avx2::quantizeToPcm24};
+  return kernels;
+}
+
+} // namespace avx512
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // WAV_HAVE_X86_DISPATCH
+
+} // namespace detail
+
+/**
+ * @brief Kernels for one instruction set (for tests and benchmarks)
+ * Falls back to the best supported set below the requested one.
+ */
+inline const SampleKernels& sampleKernelsFor(Isa isa) {
+#if WAV_HAVE_X86_DISPATCH
+  const CpuFeatures& cpu = cpuFeatures();
+  if (isa >= Isa::AVX512 && cpu.supports(Isa::AVX512)) {
+    return detail::avx512::table();
+  }
+  if (isa >= Isa::AVX2 && cpu.supports(Isa::AVX2)) {
+    return detail::avx2::table();
+  }
+  if (isa >= Isa::SSE41 && cpu.supports(Isa::SSE41)) {
+    return detail::sse41::table();
+  }
+#else
+  (void)isa;
+#endif
+  return detail::scalar::table();
+}
+
+/**
+ * @brief Kernels for activeIsa(); this is what convertToFloat() and the analysis code use
+ */
+inline const SampleKernels& sampleKernels() { return sampleKernelsFor(activeIsa()); }
+
+} // namespace wav
@@ -0,0 +1,472 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <wav/ChannelSplitter.hpp>
+#include <wav/FrameReader.hpp>
+#include <wav/SampleConversion.hpp>
+
+namespace wav {
+
+/**
+ * @brief How much of its sample format a file actually uses, see analyzeSampleUsage()
+ *
+ * The bit masks hold every PCM sample left-aligned in 32 bits (a 16-bit sample
+ * in bits 16-31), with 8-bit samples made signed first, so they read the same
+ * for every bit depth. Float files only get the channel comparison.
+ */
+struct SampleUsage {
+  uint64_t numFrames = 0;
+  unsigned numChannels = 0;
+  unsigned bitsPerSample = 0;        // As declared by the fmt chunk
+  unsigned effectiveBits = 0;        // Bits above the low bits that are zero in every sample (0 for digital silence)
+  uint32_t orBits = 0;               // PCM: OR of all samples; a bit that is 0 here is 0 in every sample
+  uint32_t andBits = 0xFFFFFFFFu;    // PCM: AND of all samples; a bit that is 1 here is 1 in every sample
+  bool identicalChannels = false;    // More than one channel, and all are bit-identical to channel 0
+  float maxChannelDifference = 0.0f; // Largest |channel c - channel 0| of any frame, full scale = 1
+
+  /**
+   * @brief True if the low bytes of the PCM samples are padding: the same audio fits a smaller container
+   */
+  bool isPadded() const { return (effectiveBits + 7) / 8 < (bitsPerSample + 7) / 8; }
+
+  /**
+   * @brief True for a multichannel file whose channels all carry the same signal within toleranceDb (dBFS)
+   */
+  bool isNearlyDualMono(double toleranceDb = -90.0) const {
+    return numChannels > 1 && maxChannelDifference <= std::pow(10.0, toleranceDb / 20.0);
+  }
+};
+
+namespace detail {
+
+/**
+ * @brief Little-endian sample of Width bytes as an unsigned integer
+ */
+template <unsigned Width>
+inline uint64_t loadSample(const uint8_t* p) {
+  uint64_t v = 0;
+  for (unsigned b = 0; b < Width; ++b) {
+    v |= uint64_t(p[b]) << (8 * b);
+  }
+  return v;
+}
+
+/**
+ * @brief OR and AND of PCM samples of `width` bytes, left-aligned to 32 bits
+ *
+ * The bytes are combined as whole 64-bit words: 96 bytes hold a whole number of
+ * samples for every width up to 4, so twelve word accumulators keep each byte
+ * position of the samples apart (and vectorize). They are folded per sample
+ * byte at the end.
+ */
+inline void accumulateBits(const uint8_t* src, std::size_t numBytes, std::size_t width, uint32_t& orBits,
+                           uint32_t& andBits) {
+  constexpr std::size_t kWords = 12;
+  uint64_t ors[kWords] = {};
+  uint64_t ands[kWords];
+  std::fill(ands, ands + kWords, ~uint64_t(0));
+  std::size_t i = 0;
+  for (; i + 8 * kWords <= numBytes; i += 8 * kWords) {
+    uint64_t words[kWords];
+    std::memcpy(words, src + i, sizeof(words));
+    for (std::size_t k = 0; k < kWords; ++k) {
+      ors[k] |= words[k];
+      ands[k] &= words[k];
+    }
+  }
+  uint8_t orBytes[8 * kWords];
+  uint8_t andBytes[8 * kWords];
+  std::memcpy(orBytes, ors, sizeof(orBytes));
+  std::memcpy(andBytes, ands, sizeof(andBytes));
+  uint8_t sampleOr[4] = {};
+  uint8_t sampleAnd[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+  for (std::size_t j = 0; j < 8 * kWords; ++j) {
+    sampleOr[j % width] |= orBytes[j];
+    sampleAnd[j % width] &= andBytes[j];
+  }
+  for (; i < numBytes; ++i) {
+    sampleOr[i % width] |= src[i];
+    sampleAnd[i % width] &= src[i];
+  }
+  uint32_t orValue = 0;
+  uint32_t andValue = 0;
+  for (std::size_t b = 0; b < width; ++b) {
+    orValue |= uint32_t(sampleOr[b]) << (8 * (4 - width + b));
+    andValue |= uint32_t(sampleAnd[b]) << (8 * (4 - width + b));
+  }
+  if (width == 1) {
+    // 8-bit PCM is unsigned with 128 as zero: flipping the top bit of every sample swaps its OR and AND
+    const uint32_t top = 0x80000000u;
+    const uint32_t flippedOr = (orValue & ~top) | (~andValue & top);
+    andValue = (andValue & ~top) | (~orValue & top);
+    orValue = flippedOr;
+  }
+  orBits |= orValue;
+  andBits &= andValue;
+}
+
+/**
+ * @brief Nonzero if any channel of any frame differs from channel 0 in any bit
+ */
+template <unsigned Width>
+inline uint64_t channelMismatch(const uint8_t* src, std::size_t numFrames, unsigned numChannels) {
+  const std::size_t frameBytes = std::size_t(numChannels) * Width;
+  uint64_t mismatch = 0;
+  for (std::size_t f = 0; f < numFrames; ++f) {
+    const uint8_t* frame = src + f * frameBytes;
+    const uint64_t first = loadSample<Width>(frame);
+    for (unsigned c = 1; c < numChannels; ++c) {
+      mismatch |= loadSample<Width>(frame + c * Width) ^ first;
+    }
+  }
+  return mismatch;
+}
+
+/**
+ * @brief channelMismatch() for 32- and 64-bit samples, whose decoded floats may round or compare equal (0, -0)
+ */
+inline uint64_t channelMismatch(const uint8_t* src, std::size_t numFrames, unsigned numChannels, std::size_t width) {
+  return width == 8 ? channelMismatch<8>(src, numFrames, numChannels) : channelMismatch<4>(src, numFrames, numChannels);
+}
+
+/**
+ * @brief Copy frames into a format with fewer bytes per sample and/or one channel
+ *
+ * Each output sample is the top Out bytes of the input sample of channel 0..outChannels-1.
+ * @return Nonzero if that lost information: a dropped low byte was not zero, or (for one
+ *         output channel) another input channel differed from channel 0
+ */
+template <unsigned In, unsigned Out>
+inline uint64_t repackFrames(const uint8_t* src, std::size_t numFrames, unsigned numChannels, unsigned outChannels,
+                             uint8_t* dst) {
+  const uint64_t lowMask = (uint64_t(1) << (8 * (In - Out))) - 1;
+  uint64_t lost = 0;
+  for (std::size_t f = 0; f < numFrames; ++f) {
+    const uint8_t* frame = src + f * numChannels * In;
+    for (unsigned c = 0; c < outChannels; ++c) {
+      const uint64_t v = loadSample<In>(frame + c * In);
+      lost |= v & lowMask;
+      for (unsigned b = 0; b < Out; ++b) {
+        dst[b] = static_cast<uint8_t>(v >> (8 * (In - Out + b)));
+      }
+      dst += Out;
+    }
+    if (outChannels == 1) {
+      const uint64_t first = loadSample<In>(frame);
+      for (unsigned c = 1; c < numChannels; ++c) {
+        lost |= loadSample<In>(frame + c * In) ^ first;
+      }
+    }
+  }
+  return lost;
+}
+
+using RepackKernel = uint64_t (*)(const uint8_t*, std::size_t, unsigned, unsigned, uint8_t*);
+
+inline RepackKernel repackKernelFor(std::size_t in, std::size_t out) {
+  switch (in * 16 + out) {
+  case 0x11:
+    return repackFrames<1, 1>;
+  case 0x22:
+    return repackFrames<2, 2>;
+  case 0x32:
+    return repackFrames<3, 2>;
+  case 0x33:
+    return repackFrames<3, 3>;
+  case 0x42:
+    return repackFrames<4, 2>;
+  case 0x43:
+    return repackFrames<4, 3>;
+  case 0x44:
+    return repackFrames<4, 4>;
+  case 0x88:
+    return repackFrames<8, 8>;
+  default:
+    return nullptr;
+  }
+}
+
+} // namespace detail
+
+/**
+ * @brief Streaming bit-depth and channel-identity analysis of raw little-endian samples
+ *
+ * Each block is scanned while it is still in cache: the PCM bytes are ORed
+ * and ANDed together as whole words, and the decoded float samples give the
+ * largest difference between channels. Up to 24 bits a zero difference means
+ * bit-identical channels; wider samples are also compared bit for bit.
+ * Results accumulate until reset().
+ *
+ * Usage example:
+ *   wav::SampleUsageAnalyzer analyzer(reader.getFmtChunk());
+ *   while (std::size_t frames = reader.read(block.data(), 4096)) {
+ *     analyzer.process(block.data(), frames);
+ *   }
+ *   if (analyzer.getUsage().isPadded()) {
+ *     // 24-bit file with 16-bit content
+ *   }
+ */
+class SampleUsageAnalyzer {
+public:
+  explicit SampleUsageAnalyzer(const FmtChunk& fmt) : fmt_(fmt), width_(bytesPerSample(fmt)) { reset(); }
+
+  /**
+   * @brief Analyze numFrames interleaved frames of raw data chunk bytes
+   */
+  void process(const uint8_t* frames, std::size_t numFrames) {
+    const unsigned channels = fmt_.numChannels;
+    const std::size_t numSamples = numFrames * channels;
+    if (fmt_.audioFormat == AudioFormat::PCM) {
+      detail::accumulateBits(frames, numSamples * width_, width_, usage_.orBits, usage_.andBits);
+    }
+    if (channels > 1) {
+      samples_.resize(numSamples);
+      convertToFloat(fmt_, frames, numSamples, samples_.data());
+      float lanes[8] = {};
+      for (unsigned c = 1; c < channels; ++c) {
+        const float* first = samples_.data();
+        const float* other = samples_.data() + c;
+        std::size_t f = 0;
+        for (; f + 8 <= numFrames; f += 8) {
+          for (std::size_t k = 0; k < 8; ++k) {
+            const float d = std::fabs(other[(f + k) * channels] - first[(f + k) * channels]);
+            lanes[k] = d > lanes[k] ? d : lanes[k];
+          }
+        }
+        for (; f < numFrames; ++f) {
+          lanes[0] = std::max(lanes[0], std::fabs(other[f * channels] - first[f * channels]));
+        }
+      }
+      usage_.maxChannelDifference = std::max(usage_.maxChannelDifference, *std::max_element(lanes, lanes + 8));
+      // Up to 24 bits, PCM samples decode to floats exactly; wider ones are compared bit for bit
+      if (fmt_.audioFormat != AudioFormat::PCM || width_ > 3) {
+        mismatch_ |= detail::channelMismatch(frames, numFrames, channels, width_);
+      }
+    }
+    usage_.numFrames += numFrames;
+  }
+
+  /**
+   * @brief Results for everything processed so far
+   */
+  SampleUsage getUsage() const {
+    SampleUsage usage = usage_;
+    if (fmt_.audioFormat == AudioFormat::PCM) {
+      unsigned zeroLowBits = 0;
+      while (zeroLowBits < 32 && !(usage.orBits & (1u << zeroLowBits))) {
+        ++zeroLowBits;
+      }
+      usage.effectiveBits = std::min(usage.bitsPerSample, 32 - zeroLowBits);
+    } else {
+      usage.effectiveBits = usage.bitsPerSample;
+    }
+    usage.identicalChannels =
+        usage.numChannels > 1 && usage.numFrames > 0 && mismatch_ == 0 && usage.maxChannelDifference == 0.0f;
+    return usage;
+  }
+
+  void reset() {
+    usage_ = SampleUsage{};
+    usage_.numChannels = fmt_.numChannels;
+    usage_.bitsPerSample = fmt_.bitsPerSample;
+    mismatch_ = 0;
+  }
+
+private:
+  FmtChunk fmt_;
+  std::size_t width_;
+  SampleUsage usage_;
+  uint64_t mismatch_ = 0;
+  std::vector<float> samples_;
+};
+
+/**
+ * @brief Find out in one streaming pass whether a WAV file wastes space on padded samples or duplicate channels
+ *
+ * Reports the effective bit depth of PCM files (a "24-bit" file whose low byte
+ * is always zero has 16 effective bits) and whether the channels are
+ * identical bit for bit (dual mono) or nearly so. See repackWav() to act on it.
+ *
+ * Usage example:
+ *   wav::SampleUsage usage;
+ *   if (wav::analyzeSampleUsage("take.wav", usage) && (usage.isPadded() || usage.identicalChannels)) {
+ *     wav::repackWav("take.wav", "take_small.wav", usage);
+ *   }
+ *
+ * @return false if the file cannot be read or its format is not little-endian PCM/IEEE_FLOAT (see std::cerr)
+ */
+inline bool analyzeSampleUsage(const std::string& path, SampleUsage& usage) {
+  FrameReader reader;
+  if (!reader.open(path, AccessPattern::Sequential)) {
+    std::cerr << "Error: Cannot open " << path << "\n";
+    return false;
+  }
+  const FmtChunk& fmt = reader.getFmtChunk();
+  if (!isConvertibleFormat(fmt) || fmt.bigEndian || fmt.blockAlign != fmt.numChannels * bytesPerSample(fmt)) {
+    std::cerr << "Error: Unsupported sample format in " << path << "\n";
+    return false;
+  }
+  SampleUsageAnalyzer analyzer(fmt);
+  const std::size_t blockFrames = std::max<std::size_t>(1, (256u << 10) / fmt.blockAlign);
+  std::vector<uint8_t> raw(blockFrames * fmt.blockAlign);
+  while (std::size_t frames = reader.read(raw.data(), blockFrames)) {
+    analyzer.process(raw.data(), frames);
+  }
+  usage = analyzer.getUsage();
+  if (usage.numFrames != reader.getNumFrames()) {
+    std::cerr << "Error: Read of " << path << " stopped after " << usage.numFrames << " frames\n";
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Settings for repackWav()
+ */
+struct RepackOptions {
+  bool reduceBitDepth = true;         // Drop low bytes that are zero in every PCM sample
+  unsigned minBitsPerSample = 16;     // Never repack below this; 8-bit PCM is unsigned, so lower values count as 16
+  bool mergeIdenticalChannels = true; // Keep one channel when all channels are bit-identical
+  bool copyMetadata = true;           // Copy the other chunks (cue, LIST, smpl, bext, ...) of RIFF inputs
+  std::size_t blockBytes = 4u << 20;  // Input read per block
+};
+
+/**
+ * @brief The smallest format that holds the samples described by usage without loss
+ */
+inline FmtChunk repackedFormat(const FmtChunk& fmt, const SampleUsage& usage,
+                               const RepackOptions& options = RepackOptions{}) {
+  FmtChunk target = fmt;
+  if (options.reduceBitDepth && fmt.audioFormat == AudioFormat::PCM) {
+    // Dropping low bytes keeps samples signed, which 8-bit PCM is not
+    const unsigned minBytes = std::max(2u, (options.minBitsPerSample + 7) / 8);
+    const unsigned bytes = std::max(minBytes, (usage.effectiveBits + 7) / 8);
+    if (bytes < bytesPerSample(fmt)) {
+      target.bitsPerSample = static_cast<unsigned short>(8 * bytes);
+    }
+  }
+  if (options.mergeIdenticalChannels && usage.identicalChannels) {
+    target.numChannels = 1;
+  }
+  target.blockAlign = static_cast<unsigned short>(target.numChannels * bytesPerSample(target));
+  target.avgBytesPerSec = target.sampleRate * target.blockAlign;
+  return target;
+}
+
+/**
+ * @brief Losslessly rewrite a WAV file in the smaller format found by analyzeSampleUsage()
+ *
+ * Padded PCM samples lose their zero low bytes (24-bit to 16-bit, 32-bit to 24
+ * or 16-bit) and identical channels are written once, as decided by
+ * repackedFormat(). The output is streamed block by block through an
+ * OutputFile; nothing is held in memory beyond two blocks. Every dropped byte
+ * and channel is checked while writing, so a file that changed since it was
+ * analyzed fails (and the output is removed) rather than losing audio.
+ *
+ * With copyMetadata, the chunks other than fmt, fact, data and JUNK of a RIFF
+ * input are copied ahead of the fmt chunk; IEEE float output gets a new fact
+ * chunk with the frame count. Cue points and loops count frames,
+ * so they stay valid in the smaller format.
+ *
+ * Usage example:
+ *   wav::SampleUsage usage;
+ *   if (wav::analyzeSampleUsage("pad.wav", usage) && usage.isPadded()) {
+ *     wav::repackWav("pad.wav", "pad_16bit.wav", usage);
+ *   }
+ *
+ * @return false if the input cannot be read, does not match usage, the output would exceed 4 GiB,
+ *         or a write fails (see std::cerr)
+ */
+inline bool repackWav(const std::string& inputPath, const std::string& outputPath, const SampleUsage& usage,
+                      const RepackOptions& options = RepackOptions{}) {
+  FrameReader reader;
+  if (!reader.open(inputPath, AccessPattern::Sequential, StreamingHints{2 * options.blockBytes, true})) {
+    std::cerr << "Error: Cannot open " << inputPath << "\n";
+    return false;
+  }
+  const FmtChunk& fmt = reader.getFmtChunk();
+  const std::size_t width = bytesPerSample(fmt);
+  if (!isConvertibleFormat(fmt) || fmt.bigEndian || fmt.blockAlign != fmt.numChannels * width) {
+    std::cerr << "Error: Unsupported sample format in " << inputPath << "\n";
+    return false;
+  }
+  if (usage.numFrames != reader.getNumFrames() || usage.numChannels != fmt.numChannels ||
+      usage.bitsPerSample != fmt.bitsPerSample) {
+    std::cerr << "Error: The sample usage given for " << inputPath << " belongs to a different file\n";
+    return false;
+  }
+  const FmtChunk target = repackedFormat(fmt, usage, options);
+  const detail::RepackKernel repack = detail::repackKernelFor(width, bytesPerSample(target));
+  if (!repack) {
+    std::cerr << "Error: Unsupported sample format in " << inputPath << "\n";
+    return false;
+  }
+  const uint64_t numFrames = reader.getNumFrames();
+  const uint64_t dataBytes = numFrames * target.blockAlign;
+
+  std::vector<ChunkInfo> extraChunks;
+  std::vector<std::vector<uint8_t>> payloads;
+  const WavFileUtils& metadata = reader.getMetadata();
+  if (options.copyMetadata && metadata.getContainer() == Container::Riff) {
+    for (const ChunkInfo& chunk : metadata.getChunkList()) {
+      if (chunk.id == Id::fromChars("fmt ") || chunk.id == Id::fromChars("data") ||
+          chunk.id == Id::fromChars("fact") || chunk.id == Id::fromChars("JUNK")) {
+        continue;
+      }
+      std::vector<uint8_t> payload(static_cast<std::size_t>(chunk.chunkSize));
+      if (reader.getFileHandle().readAt(chunk.offset + 8, payload.data(), payload.size()) != payload.size()) {
+        std::cerr << "Error: Cannot read the " << chunk.id.toString() << " chunk of " << inputPath << "\n";
+        return false;
+      }
+      extraChunks.push_back(chunk);
+      payloads.push_back(std::move(payload));
+    }
+  }
+  const std::vector<uint8_t> header = detail::wavHeader(target, extraChunks, payloads, dataBytes);
+  if (header.size() + dataBytes > 0xFFFFFFFFull) {
+    std::cerr << "Error: " << outputPath << " would exceed 4 GiB\n";
+    return false;
+  }
+
+  OutputFile out;
+  if (!out.open(outputPath) || !out.write(header.data(), header.size())) {
+    std::cerr << "Error: Cannot write " << outputPath << "\n";
+    return false;
+  }
+  const std::size_t blockFrames = std::max<std::size_t>(1, options.blockBytes / fmt.blockAlign);
+  std::vector<uint8_t> raw(blockFrames * fmt.blockAlign);
+  std::vector<uint8_t> packed(blockFrames * target.blockAlign);
+  uint64_t written = 0;
+  uint64_t lost = 0;
+  bool ok = true;
+  while (std::size_t frames = reader.read(raw.data(), blockFrames)) {
+    lost |= repack(raw.data(), frames, fmt.numChannels, target.numChannels, packed.data());
+    if (lost != 0 || !out.write(packed.data(), frames * target.blockAlign)) {
+      ok = false;
+      break;
+    }
+    written += frames;
+  }
+  const uint8_t pad = 0;
+  ok = ok && written == numFrames && (!(dataBytes & 1) || out.write(&pad, 1));
+  ok = out.close() && ok;
+  if (!ok) {
+    if (lost != 0) {
+      std::cerr << "Error: " << inputPath << " no longer matches its sample usage; nothing was written\n";
+    } else {
+      std::cerr << "Error: Cannot write " << outputPath << "\n";
+    }
+    std::remove(outputPath.c_str());
+  }
+  return ok;
+}
+
+} // namespace wav
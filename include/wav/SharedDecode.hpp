@@ -0,0 +1,636 @@
+#pragma once
+
+#include <wav/FrameReader.hpp>
+
+#if WAV_HAVE_POSIX_IO
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <wav/SampleConversion.hpp>
+
+namespace wav {
+
+/**
+ * @brief Settings for SharedDecodedWav
+ */
+struct SharedDecodeOptions {
+  uint64_t memoryBudget = 4ull << 30; // Upper bound on all published segments with namePrefix, in bytes
+  std::string namePrefix = "wav-";    // Segments are named "/" + namePrefix + 16 hex digits of the file identity
+  unsigned attachTimeoutMs = 30000;   // How long to wait for another process that is still decoding the file
+  mode_t mode = 0600;                 // Permissions of new segments; other users need 0660 or 0666 and a shared group
+                                      // (sample segments keep only the read bits once they are published)
+};
+
+namespace detail {
+
+enum SharedSegmentState : uint32_t { SharedDecoding = 0, SharedReady = 1, SharedFailed = 2 };
+constexpr uint32_t kSharedMagic = 0x4D485357; // "WSHM"
+constexpr uint32_t kSharedVersion = 2;
+constexpr std::size_t kSharedMaxHolders = 64;
+constexpr int64_t kSharedClaimGraceNs = 5000000000;  // A segment not yet sized or claimed counts as in use this long
+constexpr const char* kSharedControlSuffix = ".ctl"; // Control segment name = sample segment name + suffix
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<int32_t>::is_always_lock_free &&
+                  std::atomic<int64_t>::is_always_lock_free,
+              "Segment headers need address-free atomics");
+
+/**
+ * @brief Contents of a control segment, which sits next to the sample segment it describes
+ *
+ * ftruncate() zero-fills the segment, so a new header reads as SharedDecoding with no holders.
+ * Every field except state, publisherPid, lastReleaseNs and holders is written once before state
+ * becomes SharedReady (release) and read only after an attacher has seen it (acquire).
+ */
+struct SharedSegmentHeader {
+  uint32_t magic;
+  uint32_t version;
+  std::atomic<uint32_t> state;
+  std::atomic<int32_t> publisherPid; // 0 until the publisher has claimed the segment
+  uint64_t samplesSize;              // Bytes in the sample segment
+  uint64_t numFrames;
+  uint32_t numChannels;
+  uint32_t sampleRate;
+  uint64_t sourceSize;
+  int64_t sourceMtimeNs;
+  uint64_t sourceDevice;
+  uint64_t sourceInode;
+  std::atomic<int64_t> lastReleaseNs;              // Wall clock of the last detach, for eviction order
+  std::atomic<int32_t> holders[kSharedMaxHolders]; // Pids of attached readers (0 = free slot)
+};
+
+inline bool processAlive(int32_t pid) { return pid > 0 && (::kill(pid, 0) == 0 || errno == EPERM); }
+
+inline int64_t wallClockNs() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+inline int64_t modificationTimeNs(const struct stat& st) {
+#if defined(__APPLE__)
+  return static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#else
+  return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+}
+
+/**
+ * @brief Segment name for one version of one file: FNV-1a over device, inode, size and mtime
+ *
+ * Rewriting the file changes size or mtime and so the name; the stale segment is left for eviction.
+ */
+inline std::string sharedSegmentName(const std::string& prefix, const struct stat& st) {
+  const uint64_t fields[4] = {static_cast<uint64_t>(st.st_dev), static_cast<uint64_t>(st.st_ino),
+                              static_cast<uint64_t>(st.st_size), static_cast<uint64_t>(modificationTimeNs(st))};
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (uint64_t field : fields) {
+    for (int i = 0; i < 8; ++i) {
+      hash = (hash ^ ((field >> (8 * i)) & 0xFF)) * 0x100000001b3ull;
+    }
+  }
+  char hex[17];
+  std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+  return "/" + prefix + hex;
+}
+
+/**
+ * @brief What the budget and purge logic needs to know about one published segment
+ */
+struct SharedSegmentInfo {
+  std::string name;  // Sample segment name; the control segment adds kSharedControlSuffix
+  uint64_t size = 0; // Both segments together
+  int64_t lastReleaseNs = 0;
+  bool inUse = false; // A live process holds it, or a live publisher is still decoding it
+};
+
+/**
+ * @brief Size of a shared memory object, 0 if it does not exist or cannot be read
+ */
+inline uint64_t sharedObjectSize(const std::string& name) {
+  const int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return 0;
+  }
+  struct stat st;
+  const uint64_t size = ::fstat(fd, &st) == 0 ? static_cast<uint64_t>(st.st_size) : 0;
+  ::close(fd);
+  return size;
+}
+
+/**
+ * @brief Inspect a segment pair without attaching to it
+ * @return false if neither segment can be opened (e.g. they were unlinked meanwhile)
+ */
+inline bool inspectSharedSegment(const std::string& name, SharedSegmentInfo& info) {
+  info = SharedSegmentInfo{};
+  info.name = name;
+  const uint64_t samplesSize = sharedObjectSize(name);
+  const int fd = ::shm_open((name + kSharedControlSuffix).c_str(), O_RDWR, 0);
+  if (fd < 0) {
+    // Samples whose control segment is gone (a purge was interrupted) only wait to be unlinked
+    info.size = samplesSize;
+    return samplesSize > 0;
+  }
+  struct stat st;
+  const bool statOk = ::fstat(fd, &st) == 0;
+  info.size = (statOk ? static_cast<uint64_t>(st.st_size) : 0) + samplesSize;
+  // Creation, ftruncate() and the publisherPid store are not atomic; until the grace period has passed
+  // an unclaimed segment is assumed to belong to a publisher between those steps
+  const bool claimPending = statOk && wallClockNs() - modificationTimeNs(st) < kSharedClaimGraceNs;
+  if (!statOk || static_cast<uint64_t>(st.st_size) < sizeof(SharedSegmentHeader)) {
+    ::close(fd);
+    info.inUse = claimPending; // Afterwards the publisher must have died; purge can reclaim the name
+    return true;
+  }
+  void* map = ::mmap(nullptr, sizeof(SharedSegmentHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (map == MAP_FAILED) {
+    return false;
+  }
+  const auto* header = static_cast<const SharedSegmentHeader*>(map);
+  info.lastReleaseNs = header->lastReleaseNs.load(std::memory_order_relaxed);
+  const uint32_t state = header->state.load(std::memory_order_acquire);
+  const int32_t publisherPid = header->publisherPid.load(std::memory_order_relaxed);
+  info.inUse = state == SharedDecoding && (publisherPid == 0 ? claimPending : processAlive(publisherPid));
+  for (std::size_t i = 0; i < kSharedMaxHolders && !info.inUse; ++i) {
+    info.inUse = processAlive(header->holders[i].load(std::memory_order_relaxed));
+  }
+  ::munmap(map, sizeof(SharedSegmentHeader));
+  return true;
+}
+
+/**
+ * @brief Unlink a segment pair, samples first so that a sample segment never outlives its control segment
+ * @return true if anything was unlinked
+ */
+inline bool unlinkSharedSegment(const std::string& name) {
+  const bool samples = ::shm_unlink(name.c_str()) == 0;
+  const bool control = ::shm_unlink((name + kSharedControlSuffix).c_str()) == 0;
+  return samples || control;
+}
+
+/**
+ * @brief All segments with the given prefix; only Linux exposes the shm namespace (as /dev/shm)
+ */
+inline std::vector<SharedSegmentInfo> listSharedSegments(const std::string& prefix) {
+  std::vector<SharedSegmentInfo> segments;
+#if defined(__linux__)
+  const std::string suffix = kSharedControlSuffix;
+  std::set<std::string> names;
+  std::error_code ec;
+  for (const auto& entry : std::filesystem::directory_iterator("/dev/shm", ec)) {
+    std::string file = entry.path().filename().string();
+    if (file.compare(0, prefix.size(), prefix) != 0) {
+      continue;
+    }
+    if (file.size() >= suffix.size() && file.compare(file.size() - suffix.size(), suffix.size(), suffix) == 0) {
+      file.resize(file.size() - suffix.size());
+    }
+    names.insert("/" + file);
+  }
+  for (const std::string& name : names) {
+    SharedSegmentInfo info;
+    if (inspectSharedSegment(name, info)) {
+      segments.push_back(std::move(info));
+    }
+  }
+#else
+  (void)prefix;
+#endif
+  return segments;
+}
+
+/**
+ * @brief Unlink unused segments, least recently released first, until `needed` more bytes fit the budget
+ * @return false if the segments still in use leave too little room
+ */
+inline bool makeRoomForSegment(const SharedDecodeOptions& options, const std::string& self, uint64_t needed) {
+  std::vector<SharedSegmentInfo> segments = listSharedSegments(options.namePrefix);
+  uint64_t total = 0;
+  for (const SharedSegmentInfo& segment : segments) {
+    total += segment.name == self ? 0 : segment.size;
+  }
+  std::sort(segments.begin(), segments.end(),
+            [](const SharedSegmentInfo& a, const SharedSegmentInfo& b) { return a.lastReleaseNs < b.lastReleaseNs; });
+  for (const SharedSegmentInfo& segment : segments) {
+    if (total + needed <= options.memoryBudget) {
+      break;
+    }
+    // Unlinking only drops the name: processes still mapping it keep their pages until they detach
+    if (!segment.inUse && segment.name != self && unlinkSharedSegment(segment.name)) {
+      total -= segment.size;
+    }
+  }
+  return total + needed <= options.memoryBudget;
+}
+
+} // namespace detail
+
+/**
+ * @brief A WAV file decoded once to interleaved floats in shared memory and mapped read-only by every process
+ *
+ * The first process to open a file decodes it into a POSIX shared memory
+ * segment named after the file's identity (device, inode, size, mtime); every
+ * other process that opens the same file finds the segment by that name and
+ * maps the finished samples instead of decoding them again. A render farm
+ * node or a plugin host with many sandboxed workers keeps one decoded copy per
+ * file rather than one per process.
+ *
+ * Each file has two segments. The control segment (the sample segment's name
+ * plus ".ctl") holds the format, frames, channels, state and a table of
+ * attached pids, and is writable by every process that uses it. The sample
+ * segment holds only the samples. Once decoding is done its publisher drops
+ * the write bits from its mode and every process, the publisher included,
+ * opens it O_RDONLY and maps it PROT_READ, so the mapping cannot be made
+ * writable with mprotect() and the segment cannot be reopened for writing.
+ * Only its owner (or root) could undo that, by changing the mode back. A
+ * sealed memfd was not used: it has no name, so unrelated processes could
+ * only receive it over a socket from a broker process.
+ *
+ * A process that opens a file while another is still decoding it waits up to
+ * attachTimeoutMs for the samples; if that publisher has died, the half-written
+ * segments are discarded and the file is decoded again.
+ *
+ * Attached processes are recorded by pid in the control segment, so a crashed
+ * reader does not pin a segment forever. Publishing a new segment first evicts
+ * segments no live process holds, least recently released first, until all
+ * segments with namePrefix fit memoryBudget; if they cannot, open() fails
+ * rather than exceed it. Eviction only removes the names: processes that
+ * still map an evicted segment keep reading it until they close. Enumerating
+ * segments needs the Linux /dev/shm view of the namespace; elsewhere only the
+ * new segment's own size is checked against the budget.
+ *
+ * Usage example:
+ *   wav::SharedDecodedWav shared;
+ *   if (shared.open("stems/vocals.wav")) {
+ *     const float* samples = shared.getSamples(); // getNumFrames() * getNumChannels() floats
+ *     // render...
+ *   }
+ */
+class SharedDecodedWav {
+public:
+  SharedDecodedWav() = default;
+  ~SharedDecodedWav() { close(); }
+
+  SharedDecodedWav(const SharedDecodedWav&) = delete;
+  SharedDecodedWav& operator=(const SharedDecodedWav&) = delete;
+
+  /**
+   * @brief Attach to the shared samples of a file, decoding and publishing them if no process has yet
+   * @return false if the file cannot be read or decoded, the segment would exceed the memory budget,
+   *         or another process is still decoding it after attachTimeoutMs (see std::cerr)
+   */
+  bool open(const std::string& path, const SharedDecodeOptions& options = SharedDecodeOptions{}) {
+    close();
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+      std::cerr << "Error: Cannot open " << path << "\n";
+      return false;
+    }
+    name_ = detail::sharedSegmentName(options.namePrefix, st);
+    // Second round: a dead publisher's segment was unlinked in the first one
+    for (int attempt = 0; attempt < 2; ++attempt) {
+      const int fd = ::shm_open(controlName().c_str(), O_RDWR, 0);
+      if (fd >= 0) {
+        const AttachResult result = attach(fd, st, options);
+        if (result == AttachResult::Attached) {
+          return true;
+        }
+        if (result == AttachResult::Failed) {
+          std::cerr << "Error: Cannot attach to the shared samples of " << path << "\n";
+          name_.clear();
+          return false;
+        }
+        detail::unlinkSharedSegment(name_); // Stale
+        continue;
+      }
+      if (errno != ENOENT) {
+        break;
+      }
+      switch (publish(path, st, options)) {
+      case PublishResult::Published:
+        return true;
+      case PublishResult::Exists:
+        continue; // Another process created it first; attach to theirs
+      case PublishResult::Failed:
+        name_.clear();
+        return false;
+      }
+    }
+    std::cerr << "Error: Cannot open the shared samples of " << path << "\n";
+    name_.clear();
+    return false;
+  }
+
+  /**
+   * @brief Detach; the segment stays published for other processes until it is evicted or purged
+   */
+  void close() {
+    if (header_) {
+      if (holderSlot_ >= 0) {
+        header_->holders[holderSlot_].store(0, std::memory_order_relaxed);
+      }
+      header_->lastReleaseNs.store(detail::wallClockNs(), std::memory_order_relaxed);
+    }
+    unmap();
+    holderSlot_ = -1;
+    publisher_ = false;
+    name_.clear();
+  }
+
+  bool isOpen() const { return samples_ != nullptr; }
+
+  /**
+   * @brief Interleaved samples, getNumFrames() * getNumChannels() floats in [-1, 1]
+   */
+  const float* getSamples() const { return static_cast<const float*>(samples_); }
+
+  uint64_t getNumFrames() const { return samples_ ? header_->numFrames : 0; }
+  unsigned getNumChannels() const { return samples_ ? header_->numChannels : 0; }
+  uint32_t getSampleRate() const { return samples_ ? header_->sampleRate : 0; }
+
+  /**
+   * @brief True if this object decoded the file, false if it attached to another process's samples
+   */
+  bool isPublisher() const { return publisher_; }
+
+  /**
+   * @brief The shm_open() name of the sample segment, e.g. "/wav-0123456789abcdef"
+   */
+  const std::string& getSegmentName() const { return name_; }
+
+  /**
+   * @brief Bytes held by all segments with the options' namePrefix (Linux only; 0 elsewhere)
+   */
+  static uint64_t getPublishedBytes(const SharedDecodeOptions& options = SharedDecodeOptions{}) {
+    uint64_t total = 0;
+    for (const detail::SharedSegmentInfo& segment : detail::listSharedSegments(options.namePrefix)) {
+      total += segment.size;
+    }
+    return total;
+  }
+
+  /**
+   * @brief Unlink every segment with the options' namePrefix that no live process holds (Linux only)
+   * @return Number of segments removed
+   */
+  static std::size_t purgeUnused(const SharedDecodeOptions& options = SharedDecodeOptions{}) {
+    std::size_t removed = 0;
+    for (const detail::SharedSegmentInfo& segment : detail::listSharedSegments(options.namePrefix)) {
+      removed += !segment.inUse && detail::unlinkSharedSegment(segment.name);
+    }
+    return removed;
+  }
+
+private:
+  enum class AttachResult { Attached, Stale, Failed };
+  enum class PublishResult { Published, Exists, Failed };
+
+  static constexpr std::size_t kDecodeBlockFrames = 1 << 16;
+
+  std::string controlName() const { return name_ + detail::kSharedControlSuffix; }
+
+  /**
+   * @brief Map an existing control segment, wait for its publisher to finish decoding, then map the samples
+   */
+  AttachResult attach(int fd, const struct stat& source, const SharedDecodeOptions& options) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(options.attachTimeoutMs);
+    struct stat st;
+    // The publisher sizes the segment right after creating it
+    while (::fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_size) < sizeof(detail::SharedSegmentHeader)) {
+      if (std::chrono::steady_clock::now() > deadline) {
+        ::close(fd);
+        return AttachResult::Stale;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (!mapControl(fd)) {
+      return AttachResult::Failed;
+    }
+
+    detail::SharedSegmentHeader* h = header_;
+    uint32_t state;
+    while ((state = h->state.load(std::memory_order_acquire)) == detail::SharedDecoding) {
+      const int32_t pid = h->publisherPid.load(std::memory_order_relaxed);
+      if ((pid != 0 && !detail::processAlive(pid)) || std::chrono::steady_clock::now() > deadline) {
+        unmap();
+        return pid != 0 && !detail::processAlive(pid) ? AttachResult::Stale : AttachResult::Failed;
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    if (state != detail::SharedReady || h->magic != detail::kSharedMagic || h->version != detail::kSharedVersion ||
+        h->sourceSize != static_cast<uint64_t>(source.st_size) ||
+        h->sourceMtimeNs != detail::modificationTimeNs(source) ||
+        h->sourceInode != static_cast<uint64_t>(source.st_ino) ||
+        h->numFrames * h->numChannels * sizeof(float) > h->samplesSize) {
+      unmap();
+      return AttachResult::Stale;
+    }
+    const AttachResult result = mapSamples(h->samplesSize);
+    if (result != AttachResult::Attached) {
+      unmap();
+      return result;
+    }
+    claimHolderSlot();
+    return AttachResult::Attached;
+  }
+
+  /**
+   * @brief Create the control segment, decode the file into a new sample segment and mark it ready
+   */
+  PublishResult publish(const std::string& path, const struct stat& source, const SharedDecodeOptions& options) {
+    FrameReader reader;
+    if (!reader.open(path, AccessPattern::Sequential)) {
+      std::cerr << "Error: Cannot open " << path << "\n";
+      return PublishResult::Failed;
+    }
+    const FmtChunk& fmt = reader.getFmtChunk();
+    if (!isConvertibleFormat(fmt)) {
+      std::cerr << "Error: Unsupported sample format in " << path << "\n";
+      return PublishResult::Failed;
+    }
+    const uint64_t controlBytes = static_cast<uint64_t>(::sysconf(_SC_PAGESIZE));
+    const uint64_t samplesBytes = std::max<uint64_t>(reader.getNumFrames() * fmt.numChannels, 1) * sizeof(float);
+    const uint64_t total = controlBytes + samplesBytes;
+    if (total > options.memoryBudget) {
+      std::cerr << "Error: The decoded samples of " << path << " exceed the shared memory budget\n";
+      return PublishResult::Failed;
+    }
+
+    // Creating the control segment claims the name; the sample segment only ever exists next to it
+    const int fd = ::shm_open(controlName().c_str(), O_RDWR | O_CREAT | O_EXCL, options.mode);
+    if (fd < 0) {
+      return errno == EEXIST ? PublishResult::Exists : PublishResult::Failed;
+    }
+    // Size and claim the segment before anything slow (the eviction scan, decoding), so that other
+    // processes see a live publisher rather than an abandoned segment they may unlink
+    const bool sized = ::ftruncate(fd, static_cast<off_t>(controlBytes)) == 0;
+    if (!sized) {
+      ::close(fd);
+    }
+    if (!sized || !mapControl(fd)) {
+      std::cerr << "Error: Cannot allocate shared memory for " << path << "\n";
+      ::shm_unlink(controlName().c_str());
+      return PublishResult::Failed;
+    }
+    detail::SharedSegmentHeader* h = header_;
+    h->publisherPid.store(static_cast<int32_t>(::getpid()), std::memory_order_relaxed);
+
+    auto fail = [&]() {
+      h->state.store(detail::SharedFailed, std::memory_order_release);
+      detail::unlinkSharedSegment(name_);
+      unmap();
+      return PublishResult::Failed;
+    };
+    if (!detail::makeRoomForSegment(options, name_, total)) {
+      std::cerr << "Error: Shared segments in use leave no room for " << path << " within the memory budget\n";
+      return fail();
+    }
+
+    // A sample segment without a control segment is left over from an interrupted purge
+    ::shm_unlink(name_.c_str());
+    const int samplesFd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL, options.mode);
+    void* map = samplesFd >= 0 && ::ftruncate(samplesFd, static_cast<off_t>(samplesBytes)) == 0
+                    ? ::mmap(nullptr, static_cast<std::size_t>(samplesBytes), PROT_READ | PROT_WRITE, MAP_SHARED,
+                             samplesFd, 0)
+                    : MAP_FAILED;
+    if (map == MAP_FAILED) {
+      std::cerr << "Error: Cannot allocate " << total << " bytes of shared memory for " << path << "\n";
+      if (samplesFd >= 0) {
+        ::close(samplesFd);
+      }
+      return fail();
+    }
+
+    float* samples = static_cast<float*>(map);
+    std::vector<uint8_t> raw(kDecodeBlockFrames * fmt.blockAlign);
+    uint64_t decoded = 0;
+    while (std::size_t frames = reader.read(raw.data(), kDecodeBlockFrames)) {
+      convertToFloat(fmt, raw.data(), frames * fmt.numChannels, samples + decoded * fmt.numChannels);
+      decoded += frames;
+    }
+    ::munmap(map, static_cast<std::size_t>(samplesBytes));
+    // From here on nobody can write the samples: the mode keeps only the read bits, and every process
+    // (this one too) maps them from an O_RDONLY descriptor
+    const bool sealed = ::fchmod(samplesFd, options.mode & 0444) == 0;
+    ::close(samplesFd);
+    if (decoded != reader.getNumFrames()) {
+      std::cerr << "Error: Read of " << path << " stopped after " << decoded << " of " << reader.getNumFrames()
+                << " frames\n";
+      return fail();
+    }
+    if (!sealed || mapSamples(samplesBytes) != AttachResult::Attached) {
+      std::cerr << "Error: Cannot make the shared samples of " << path << " read-only\n";
+      return fail();
+    }
+
+    h->magic = detail::kSharedMagic;
+    h->version = detail::kSharedVersion;
+    h->samplesSize = samplesBytes;
+    h->numFrames = decoded;
+    h->numChannels = fmt.numChannels;
+    h->sampleRate = fmt.sampleRate;
+    h->sourceSize = static_cast<uint64_t>(source.st_size);
+    h->sourceMtimeNs = detail::modificationTimeNs(source);
+    h->sourceDevice = static_cast<uint64_t>(source.st_dev);
+    h->sourceInode = static_cast<uint64_t>(source.st_ino);
+    h->state.store(detail::SharedReady, std::memory_order_release);
+    claimHolderSlot();
+    publisher_ = true;
+    return PublishResult::Published;
+  }
+
+  /**
+   * @brief Map the header of a control segment read-write; closes fd
+   */
+  bool mapControl(int fd) {
+    void* map = ::mmap(nullptr, sizeof(detail::SharedSegmentHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+      return false;
+    }
+    header_ = static_cast<detail::SharedSegmentHeader*>(map);
+    return true;
+  }
+
+  /**
+   * @brief Map the sample segment read-only, refusing one that is still writable by anyone
+   */
+  AttachResult mapSamples(uint64_t expectedSize) {
+    const int fd = ::shm_open(name_.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+      return errno == ENOENT ? AttachResult::Stale : AttachResult::Failed;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) != expectedSize) {
+      ::close(fd);
+      return AttachResult::Stale;
+    }
+    if ((st.st_mode & 0222) != 0) {
+      ::close(fd);
+      return AttachResult::Failed;
+    }
+    void* map = ::mmap(nullptr, static_cast<std::size_t>(expectedSize), PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+      return AttachResult::Failed;
+    }
+    samples_ = map;
+    samplesSize_ = static_cast<std::size_t>(expectedSize);
+    return AttachResult::Attached;
+  }
+
+  /**
+   * @brief Record this process in a free pid slot, reusing the slot of a dead process if none is free
+   *
+   * With all slots held by live processes the attachment is simply not counted.
+   */
+  void claimHolderSlot() {
+    const int32_t self = static_cast<int32_t>(::getpid());
+    detail::SharedSegmentHeader* h = header_;
+    for (int pass = 0; pass < 2 && holderSlot_ < 0; ++pass) {
+      for (std::size_t i = 0; i < detail::kSharedMaxHolders; ++i) {
+        int32_t expected = h->holders[i].load(std::memory_order_relaxed);
+        const bool claimable = pass == 0 ? expected == 0 : !detail::processAlive(expected);
+        if (claimable && h->holders[i].compare_exchange_strong(expected, self, std::memory_order_relaxed)) {
+          holderSlot_ = static_cast<int>(i);
+          break;
+        }
+      }
+    }
+  }
+
+  void unmap() {
+    if (samples_) {
+      ::munmap(samples_, samplesSize_);
+    }
+    if (header_) {
+      ::munmap(header_, sizeof(detail::SharedSegmentHeader));
+    }
+    samples_ = nullptr;
+    samplesSize_ = 0;
+    header_ = nullptr;
+  }
+
+  detail::SharedSegmentHeader* header_ = nullptr; // Control segment
+  void* samples_ = nullptr;                       // Sample segment, mapped read-only
+  std::size_t samplesSize_ = 0;
+  int holderSlot_ = -1;
+  bool publisher_ = false;
+  std::string name_;
+};
+
+} // namespace wav
+
+#endif // WAV_HAVE_POSIX_IO
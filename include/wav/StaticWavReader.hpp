@@ -0,0 +1,173 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <wav/SampleKernels.hpp>
+#include <wav/WavFileUtils.hpp>
+
+namespace wav {
+
+/**
+ * @brief WAV reader for a sample format known at compile time
+ *
+ * The fmt chunk is checked against the template parameters once, in open() or
+ * attach(). After that every accessor is a fixed-stride load plus a
+ * SampleTraits::decode, with no per-sample switch on format or bit depth as in
+ * the runtime-generic convertToFloat().
+ *
+ * Usage example:
+ *   wav::StaticWavReader<wav::AudioFormat::IEEE_FLOAT, 2, 32> reader("stereo48k.wav");
+ *   if (reader.open()) {
+ *     std::vector<float> block(512 * 2);
+ *     reader.readFrames(0, 512, block.data());
+ *     float right = reader.sample(100, 1);
+ *   }
+ */
+template <AudioFormat Format, unsigned Channels, unsigned Bits>
+class StaticWavReader {
+  static_assert(Channels > 0, "StaticWavReader needs at least one channel");
+  static_assert(Bits % 8 == 0, "StaticWavReader only supports byte-aligned samples");
+
+public:
+  using Traits = SampleTraits<Format, Bits>;
+  using Frame = std::array<float, Channels>;
+
+  static constexpr AudioFormat kFormat = Format;
+  static constexpr unsigned kChannels = Channels;
+  static constexpr unsigned kBitsPerSample = Bits;
+  static constexpr std::size_t kBytesPerSample = Bits / 8;
+  static constexpr std::size_t kFrameSize = Channels * kBytesPerSample;
+
+  StaticWavReader() = default;
+
+  explicit StaticWavReader(const std::string& filename) : filename_(filename) {}
+
+  // Sample pointers refer into reader_, so a copy would dangle
+  StaticWavReader(const StaticWavReader&) = delete;
+  StaticWavReader& operator=(const StaticWavReader&) = delete;
+
+  /**
+   * @brief True if a fmt chunk has exactly the layout this reader was compiled for
+   * SampleTraits decode little-endian samples, so big-endian (RIFX) data only matches 8-bit layouts.
+   */
+  static bool matches(const FmtChunk& fmt) {
+    return fmt.audioFormat == Format && fmt.numChannels == Channels && fmt.bitsPerSample == Bits &&
+           fmt.blockAlign == kFrameSize && (!fmt.bigEndian || Bits == 8);
+  }
+
+  bool open(const std::string& filename) {
+    filename_ = filename;
+    return open();
+  }
+
+  /**
+   * @brief Load the file and validate its format against the template parameters
+   * @return false if the file cannot be read or its format differs
+   */
+  bool open() {
+    open_ = false;
+    OpenOptions options;
+    options.verbose = false;
+    reader_.setOpenOptions(options);
+    if (!reader_.open(filename_)) {
+      return false;
+    }
+    const auto& bytes = reader_.getDataChunk().sampleDataInBytes;
+    return attach(reader_.getFmtChunk(), bytes.data(), bytes.size());
+  }
+
+  /**
+   * @brief Use sample bytes owned elsewhere (e.g. a CachedWav or a memory map)
+   * The bytes must outlive this reader.
+   * @return false if fmt does not match the template parameters
+   */
+  bool attach(const FmtChunk& fmt, const uint8_t* data, std::size_t sizeInBytes) {
+    open_ = false;
+    data_ = nullptr;
+    numFrames_ = 0;
+    if (!matches(fmt)) {
+      return false;
+    }
+    fmt_ = fmt;
+    data_ = data;
+    numFrames_ = sizeInBytes / kFrameSize;
+    open_ = true;
+    return true;
+  }
+
+  bool isOpen() const { return open_; }
+
+  std::size_t getNumFrames() const { return numFrames_; }
+  uint32_t getSampleRate() const { return static_cast<uint32_t>(fmt_.sampleRate); }
+
+  /**
+   * @brief The full reader used by open() (cue points, loops, chunk list, ...)
+   */
+  const WavFileUtils& getMetadata() const { return reader_; }
+
+  /**
+   * @brief One sample as float; no bounds checking
+   */
+  float sample(std::size_t frame, unsigned channel) const noexcept {
+    return Traits::decode(data_ + frame * kFrameSize + channel * kBytesPerSample);
+  }
+
+  /**
+   * @brief All channels of one frame; no bounds checking
+   */
+  Frame frame(std::size_t index) const noexcept {
+    Frame out;
+    const uint8_t* p = data_ + index * kFrameSize;
+    for (unsigned c = 0; c < Channels; ++c) {
+      out[c] = Traits::decode(p + c * kBytesPerSample);
+    }
+    return out;
+  }
+
+  /**
+   * @brief Decode count frames from first into interleaved floats
+   * @return Frames written (clamped to the end of the data)
+   */
+  std::size_t readFrames(std::size_t first, std::size_t count, float* out) const noexcept {
+    const std::size_t n = first >= numFrames_ ? 0 : (count < numFrames_ - first ? count : numFrames_ - first);
+    const uint8_t* p = data_ + first * kFrameSize;
+    const std::size_t samples = n * Channels;
+    for (std::size_t i = 0; i < samples; ++i) {
+      out[i] = Traits::decode(p + i * kBytesPerSample);
+    }
+    return n;
+  }
+
+  /**
+   * @brief Decode count frames from first into one buffer per channel
+   * @return Frames written (clamped to the end of the data)
+   */
+  std::size_t readPlanar(std::size_t first, std::size_t count, float* const* channels) const noexcept {
+    const std::size_t n = first >= numFrames_ ? 0 : (count < numFrames_ - first ? count : numFrames_ - first);
+    const uint8_t* p = data_ + first * kFrameSize;
+    for (std::size_t i = 0; i < n; ++i) {
+      for (unsigned c = 0; c < Channels; ++c) {
+        channels[c][i] = Traits::decode(p + i * kFrameSize + c * kBytesPerSample);
+      }
+    }
+    return n;
+  }
+
+private:
+  std::string filename_;
+  WavFileUtils reader_;
+  FmtChunk fmt_;
+  const uint8_t* data_ = nullptr;
+  std::size_t numFrames_ = 0;
+  bool open_ = false;
+};
+
+// Common fixed layouts
+using Float32MonoReader = StaticWavReader<AudioFormat::IEEE_FLOAT, 1, 32>;
+using Float32StereoReader = StaticWavReader<AudioFormat::IEEE_FLOAT, 2, 32>;
+using Pcm16StereoReader = StaticWavReader<AudioFormat::PCM, 2, 16>;
+using Pcm24StereoReader = StaticWavReader<AudioFormat::PCM, 2, 24>;
+
+} // namespace wav
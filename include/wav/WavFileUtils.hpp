@@ -1,12 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstring>
 #include <filesystem>
-#include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <string>
 #include <vector>
+#include <wav/FileHandle.hpp>
+#include <wav/Instrumentation.hpp>
+#include <wav/SampleBuffer.hpp>
 
 namespace wav {
 
@@ -29,6 +34,91 @@ struct Id {
   friend bool operator!=(Id x, Id y) noexcept { return !(x == y); }
 };
 
+namespace detail {
+
+/**
+ * @brief Little-endian loads from a byte buffer (chunk payloads are decoded from memory)
+ */
+inline uint16_t loadLE16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | (p[1] << 8)); }
+inline uint32_t loadLE32(const uint8_t* p) {
+  return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+inline uint64_t loadLE64(const uint8_t* p) { return uint64_t(loadLE32(p)) | (uint64_t(loadLE32(p + 4)) << 32); }
+
+/**
+ * @brief Little-endian appends, for building headers in memory before one write
+ */
+inline void putLE16(std::vector<uint8_t>& out, uint16_t v) {
+  out.push_back(static_cast<uint8_t>(v));
+  out.push_back(static_cast<uint8_t>(v >> 8));
+}
+inline void putLE32(std::vector<uint8_t>& out, uint32_t v) {
+  putLE16(out, static_cast<uint16_t>(v));
+  putLE16(out, static_cast<uint16_t>(v >> 16));
+}
+inline void putLE64(std::vector<uint8_t>& out, uint64_t v) {
+  putLE32(out, static_cast<uint32_t>(v));
+  putLE32(out, static_cast<uint32_t>(v >> 32));
+}
+
+/**
+ * @brief Append a RIFF chunk (ID, 32-bit size, payload and pad byte)
+ */
+inline void putChunk(std::vector<uint8_t>& out, Id id, const std::vector<uint8_t>& payload) {
+  out.insert(out.end(), id.b.begin(), id.b.end());
+  putLE32(out, static_cast<uint32_t>(payload.size()));
+  out.insert(out.end(), payload.begin(), payload.end());
+  if (payload.size() & 1) {
+    out.push_back(0);
+  }
+}
+
+/**
+ * @brief Big-endian loads, for RIFX files
+ */
+inline uint16_t loadBE16(const uint8_t* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+inline uint32_t loadBE32(const uint8_t* p) {
+  return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+}
+
+/**
+ * @brief Wave64 chunk GUIDs, as stored on disk
+ * Sony Wave64 names every chunk with a 16-byte GUID. Apart from the outer riff/list
+ * GUIDs, standard chunks use their RIFF FourCC followed by one common 12-byte suffix
+ * (e.g. "fmt " + F3AC D311 8CD1 00C0 4F8E DB8A), which is how they map onto Id.
+ */
+constexpr uint8_t kW64RiffGuid[16] = {'r', 'i', 'f', 'f', 0x2E, 0x91, 0xCF, 0x11,
+                                      0xA5, 0xD6, 0x28, 0xDB, 0x04, 0xC1, 0x00, 0x00};
+constexpr uint8_t kW64WaveGuid[16] = {'w', 'a', 'v', 'e', 0xF3, 0xAC, 0xD3, 0x11,
+                                      0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+constexpr std::size_t kW64ChunkHeaderSize = 24; // GUID + 64-bit size (which includes this header)
+
+inline bool equalBytes(const uint8_t* a, const uint8_t* b, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    if (a[i] != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/**
+ * @brief Id of a Wave64 chunk: the FourCC at the start of its GUID ("fmt ", "data", "list", ...)
+ * GUIDs outside the FourCC scheme (e.g. Sony's marker GUIDs) end up as unknown chunks and are skipped.
+ */
+inline Id w64ChunkId(const uint8_t* guid) { return Id{{guid[0], guid[1], guid[2], guid[3]}}; }
+
+} // namespace detail
+
+/**
+ * @brief Container a file was parsed from
+ */
+enum class Container {
+  Riff,  // RIFF/WAVE: 32-bit chunk sizes, chunks aligned to 2 bytes
+  Rifx,  // RIFX/WAVE: RIFF with every header field and sample stored big-endian
+  Wave64 // Sony Wave64: GUID chunk IDs, 64-bit chunk sizes, chunks aligned to 8 bytes
+};
+
 /**
  * @brief Audio format codes (see wav-resources/WAVE File Format.html — "fmt " chunk)
  */
@@ -46,6 +136,7 @@ struct FmtChunk {
   unsigned long avgBytesPerSec = 0;           // Byte rate
   unsigned short blockAlign = 0;              // Block align
   unsigned short bitsPerSample = 0;           // Bits per sample
+  bool bigEndian = false;                     // Samples are big-endian (RIFX); set by the reader, not on disk
 };
 
 /**
@@ -63,8 +154,8 @@ struct FactChunk {
  * Stores raw sample data as read from file in a byte vector
  */
 struct DataChunk {
-  chunkSize_t chunkSize = 0;              // Size of data in bytes
-  std::vector<uint8_t> sampleDataInBytes; // This is NOT framed samples, just raw bytes
+  uint64_t chunkSize = 0;         // Size of data in bytes (64-bit for Wave64 files)
+  SampleBuffer sampleDataInBytes; // This is NOT framed samples, just raw bytes (64-byte aligned)
 };
 
 /**
@@ -166,12 +257,63 @@ struct SamplerChunk {
   std::vector<SampleLoop> sampleLoops;
 };
 
+/**
+ * @brief One entry of the chunk list recorded while walking the file
+ * See wav-resources/WAVE File Format.html — chunk structure
+ */
+struct ChunkInfo {
+  Id id;                  // Chunk ID (e.g. "fmt ", "data", "LIST")
+  uint64_t offset = 0;    // Byte offset of the chunk header (ID field) from the start of the file
+  uint64_t chunkSize = 0; // Size of the chunk payload, not counting header or padding
+};
+
+/**
+ * @brief How much of the file open() should read
+ */
+enum class ReadMode {
+  Full,        // Parse every chunk and load the sample data into memory
+  MetadataOnly // Parse every chunk but skip over the sample data (only its size and offset are recorded)
+};
+
+/**
+ * @brief Options controlling how open() reads a file
+ */
+struct OpenOptions {
+  ReadMode mode = ReadMode::Full;
+  bool verbose = true;                                 // Print "Opening file: ..." to std::cout
+  AccessPattern accessPattern = AccessPattern::Normal; // Kernel caching hint (see FileHandle.hpp)
+  bool growingFile = false;                            // Still recording: data runs to end of file (refresh())
+  std::size_t readAheadBytes = 64 * 1024;              // Window for chunk headers and metadata after the first 4 KiB
+  SampleMemoryOptions sampleMemory = {};               // Huge pages / NUMA node for the loaded sample data
+};
+
+/**
+ * @brief Frames added to the data chunk by WavFileUtils::refresh()
+ */
+struct AppendedRange {
+  uint64_t firstFrame = 0; // Index of the first new frame
+  uint64_t numFrames = 0;  // Number of new frames (0 if nothing was appended)
+};
+
 /**
  * @brief Basic WAV file reader for parsing RIFF/WAVE format files
  *
  * This is a minimal header-only implementation that reads WAV file headers
  * and provides access to audio metadata and sample data.
  *
+ * Sony Wave64 (.w64) files are read through the same chunk readers: only the
+ * chunk headers differ (16-byte GUIDs and 64-bit sizes, see getContainer()), so
+ * data chunks over 4 GiB keep their full size and offset.
+ *
+ * RIFX files (big-endian RIFF) have their header fields swapped while parsing.
+ * The sample bytes are kept as stored and FmtChunk::bigEndian is set, so
+ * convertToFloat() picks decoders that swap bytes as part of the conversion.
+ *
+ * A WavFileUtils holds no open file between calls and is not synchronized:
+ * open() and refresh() rewrite it, while its const getters may be shared by
+ * any number of threads once it is open. To read samples from one open file
+ * on several threads, use FrameReader::readAt().
+ *
  * Reference: wav-resources/WAVE File Format.html
  * Also see: riff-specs.pdf pages 56-65
  *
@@ -188,6 +330,15 @@ public:
 
   explicit WavFileUtils(const std::string& filename) : filename_(filename), isOpen_(false) {}
 
+  WavFileUtils(const std::string& filename, const OpenOptions& options)
+      : filename_(filename), isOpen_(false), options_(options) {}
+
+  /**
+   * @brief Set the options used by the next call to open()
+   */
+  void setOpenOptions(const OpenOptions& options) { options_ = options; }
+  const OpenOptions& getOpenOptions() const { return options_; }
+
   /**
    * @brief Open and parse a WAV file
    * @return true if file was successfully opened and parsed
@@ -202,6 +353,9 @@ public:
    * @return true if file was successfully opened and parsed
    */
   bool open() {
+    // Forget anything parsed by a previous call so re-opening does not accumulate chunks
+    resetChunks();
+
     if (filename_.empty()) {
       return false;
     }
@@ -218,29 +372,208 @@ public:
       // to the user-provided filename instead of throwing.
       absPath = filename_;
     }
-    std::cout << "Opening file: " << absPath << std::endl;
+    if (options_.verbose) {
+      std::cout << "Opening file: " << absPath << std::endl;
+    }
+
+    FileHandle file;
+    if (!file.open(filename_)) {
+      return false;
+    }
+    return parseFile(file);
+  }
 
-    std::ifstream file(filename_, std::ios::binary);
-    if (!file.is_open()) {
+  /**
+   * @brief Parse a WAV file through an already opened handle
+   * Lets callers that keep the handle for later sample reads (e.g. FrameReader)
+   * parse the headers through the same file descriptor, so access hints apply to both.
+   * @return true if file was successfully parsed
+   */
+  bool open(const FileHandle& handle) {
+    resetChunks();
+    if (!handle.isOpen()) {
       return false;
     }
+    filename_ = handle.path();
+    return parseFile(handle);
+  }
 
-    // Read and verify RIFF header (12 bytes)
-    // See wav-resources/WAVE File Format.html — RIFF chunk descriptor
-    char riffHeader[12];
-    file.read(riffHeader, sizeof(riffHeader));
+  bool isOpen() const { return isOpen_; }
+
+  /**
+   * @brief Whether the file is RIFF/WAVE, RIFX or Wave64 (chunk structures are the same for all of them)
+   */
+  Container getContainer() const { return container_; }
 
-    if (file.gcount() != 12) {
+  uint16_t getNumChannels() const { return fmt_.numChannels; }
+  uint32_t getSampleRate() const { return fmt_.sampleRate; }
+  uint16_t getBitsPerSample() const { return fmt_.bitsPerSample; }
+  AudioFormat getAudioFormat() const { return fmt_.audioFormat; }
+
+  /**
+   * @brief Number of sample frames in the data chunk (one frame = one sample for every channel)
+   * Available in both Full and MetadataOnly modes since it only needs the data chunk size.
+   */
+  uint64_t getNumFrames() const { return fmt_.blockAlign == 0 ? 0 : data_.chunkSize / fmt_.blockAlign; }
+
+  /**
+   * @brief Duration of the sample data in seconds
+   */
+  double getDurationSeconds() const {
+    return fmt_.sampleRate == 0 ? 0.0 : static_cast<double>(getNumFrames()) / static_cast<double>(fmt_.sampleRate);
+  }
+
+  /**
+   * @brief Byte offset of the first sample in the data chunk, from the start of the file
+   * Zero if no data chunk was found.
+   */
+  uint64_t getDataOffset() const { return dataOffset_; }
+
+  /**
+   * @brief Pick up frames appended to the file since open() or the previous refresh()
+   *
+   * Only the RIFF header and the data chunk size field are re-read, plus the new
+   * sample bytes themselves, so the cost is proportional to what was appended.
+   * How much data exists is decided by:
+   *   - OpenOptions::growingFile: everything from the data chunk to the end of the file
+   *     (for recorders that only fix up the size fields when they finish)
+   *   - otherwise: the data chunk size field, capped at the end of the RIFF (or Wave64)
+   *     chunk given by its size field, and at the bytes actually on disk
+   * Only whole frames are taken; a partially written frame is picked up next time.
+   * open() counts the frames it found the same way, so a data chunk that ends in a
+   * partial frame, or a header pre-sized beyond the end of the file, is not mistaken
+   * for shrinking data.
+   * In ReadMode::Full the new bytes are appended to DataChunk::sampleDataInBytes.
+   *
+   * Usage example:
+   *   wav::OpenOptions options;
+   *   options.growingFile = true;
+   *   wav::WavFileUtils reader("recording.wav", options);
+   *   reader.open();
+   *   wav::AppendedRange delta;
+   *   while (reader.refresh(delta)) {
+   *     // process frames [delta.firstFrame, delta.firstFrame + delta.numFrames)
+   *   }
+   *
+   * @param appended Receives the range of new frames
+   * @return false if the reader is not open or the file no longer matches what was parsed
+   *         (not a WAV file any more, or the data shrank); open() it again in that case
+   */
+  bool refresh(AppendedRange& appended) {
+    appended = AppendedRange{};
+    if (!isOpen_ || dataOffset_ == 0 || fmt_.blockAlign == 0) {
+      return false;
+    }
+
+    FileHandle file;
+    if (!file.open(filename_)) {
+      return false;
+    }
+    const uint64_t fileSize = file.size();
+
+    // The container must still be the one we parsed
+    uint8_t header[40];
+    const std::size_t headerLength = container_ == Container::Wave64 ? 40 : 12;
+    if (file.readAt(0, header, headerLength) != headerLength || !isExpectedHeader(header)) {
       return false;
     }
 
-    // Verify "RIFF" chunk ID
-    if (std::string(riffHeader, 4) != "RIFF") {
+    uint64_t headerSize = 0;
+    if (!options_.growingFile) {
+      // RIFF: 32-bit payload size; Wave64: 64-bit size that includes the 24-byte chunk header
+      uint8_t sizeField[8];
+      const std::size_t fieldLength = container_ == Container::Wave64 ? 8 : 4;
+      if (file.readAt(dataOffset_ - fieldLength, sizeField, fieldLength) != fieldLength) {
+        return false;
+      }
+      headerSize = load32(sizeField);
+      if (container_ == Container::Wave64) {
+        headerSize = detail::loadLE64(sizeField);
+        headerSize = headerSize > detail::kW64ChunkHeaderSize ? headerSize - detail::kW64ChunkHeaderSize : 0;
+      }
+    }
+    const uint64_t newSize = availableDataSize(headerSize, containerEnd(header), fileSize);
+
+    const uint64_t oldSize = availableData_;
+    if (newSize < oldSize) {
       return false;
     }
+    if (newSize == oldSize) {
+      return true;
+    }
+
+    // Read only the appended bytes
+    if (options_.mode == ReadMode::Full) {
+      const std::size_t previous = data_.sampleDataInBytes.size();
+      data_.sampleDataInBytes.resize(static_cast<std::size_t>(newSize));
+      const std::size_t wanted = static_cast<std::size_t>(newSize - oldSize);
+      if (file.readAt(dataOffset_ + oldSize, data_.sampleDataInBytes.data() + oldSize, wanted) != wanted) {
+        data_.sampleDataInBytes.resize(previous);
+        return false;
+      }
+    }
+
+    availableData_ = newSize;
+    data_.chunkSize = newSize;
+    for (ChunkInfo& chunk : chunks_) {
+      if (chunk.id == Id::fromChars("data")) {
+        chunk.chunkSize = data_.chunkSize;
+      }
+    }
+    appended.firstFrame = oldSize / fmt_.blockAlign;
+    appended.numFrames = (newSize - oldSize) / fmt_.blockAlign;
+    return true;
+  }
+
+  /**
+   * @brief Get raw sample data as a byte vector exactly as read from the file
+   */
+  std::vector<uint8_t> getRawSampleData() const {
+    return std::vector<uint8_t>(data_.sampleDataInBytes.begin(), data_.sampleDataInBytes.end());
+  }
+
+  const FmtChunk& getFmtChunk() const { return fmt_; }
+  const DataChunk& getDataChunk() const { return data_; }
+  const FactChunk& getFactChunk() const { return fact_; }
+  const CueChunk& getCueChunk() const { return cue_; }
+  const SamplerChunk& getSamplerChunk() const { return sampler_; }
+
+  /**
+   * @brief Cue point names from the labl entries of a LIST/adtl chunk
+   */
+  const std::vector<LabelChunk>& getLabels() const { return labels_; }
+
+  /**
+   * @brief Every chunk found in the file, in file order (including skipped ones)
+   */
+  const std::vector<ChunkInfo>& getChunkList() const { return chunks_; }
+
+  /**
+   * @brief Timers and I/O counters from the last open()
+   * All zero unless built with WAV_ENABLE_INSTRUMENTATION=1 (see Instrumentation.hpp).
+   */
+  const ReadStats& getReadStats() const { return stats_; }
+
+private:
+  /**
+   * @brief Walk every chunk of an opened file (shared by both open() overloads)
+   */
+  bool parseFile(const FileHandle& handle) {
+    // Timed phases only exist when built with WAV_ENABLE_INSTRUMENTATION (see Instrumentation.hpp)
+    detail::ScopedPhase openPhase(stats_, ReadPhase::Open, filename_);
+
+    // Tell the kernel how the file will be read before the first byte is requested.
+    // Metadata-only parsing disables readahead so sample data is not pulled into the page cache.
+    if (options_.mode == ReadMode::MetadataOnly) {
+      handle.advise(AccessPattern::MetadataOnly, 0, 0);
+    } else if (options_.accessPattern != AccessPattern::Normal) {
+      handle.advise(options_.accessPattern, 0, 0);
+    }
 
-    // Verify "WAVE" format
-    if (std::string(riffHeader + 8, 4) != "WAVE") {
+    // The first 4 KiB holds the header chunks of most files; anything further
+    // (e.g. cue/LIST/smpl after the samples) is fetched in readAheadBytes windows
+    detail::FileCursor file(handle, &stats_, 4096, options_.readAheadBytes);
+    if (!readRiffHeader(file)) {
       return false;
     }
 
@@ -248,49 +581,53 @@ public:
     // WAV files may contain various chunks in any order (JUNK, fmt, data, fact, LIST, etc.)
     // See wav-resources/WAVE File Format.html — chunk structure
     bool foundFmtChunk = false;
+    detail::ScopedPhase walkPhase(stats_, ReadPhase::ChunkWalk, filename_);
 
     while (file.good()) {
-      // Read chunk ID (4 bytes)
-      char chunkIdChars[4];
-      file.read(chunkIdChars, sizeof(chunkIdChars));
-
-      if (file.gcount() != 4) {
-        break; // End of file or read error
+      wav::Id chunkId;
+      uint64_t chunkSize = 0;
+      if (!readChunkHeader(file, chunkId, chunkSize)) {
+        break; // End of file, read error or truncated chunk header
       }
+      recordChunk(file, chunkId, chunkSize);
 
       // Use string comparisons for chunk dispatch (simpler and clearer)
-      wav::Id chunkId = wav::Id::fromChars(chunkIdChars);
-
       if (chunkId == wav::Id::fromChars("fmt ")) {
-        if (!readFmtChunk(file)) {
+        if (!readFmtChunk(file, chunkSize)) {
           return false;
         }
         foundFmtChunk = true;
       } else if (chunkId == wav::Id::fromChars("data")) {
-        if (!readDataChunk(file)) {
+        if (!readDataChunk(file, chunkSize)) {
           return false;
         }
+        if (options_.growingFile) {
+          break; // The data chunk runs to the end of a file that is still being written
+        }
       } else if (chunkId == wav::Id::fromChars("fact")) {
-        if (!readFactChunk(file)) {
+        if (!readFactChunk(file, chunkSize)) {
           return false;
         }
       } else if (chunkId == wav::Id::fromChars("cue ")) {
-        if (!readCueChunk(file)) {
+        if (!readCueChunk(file, chunkSize)) {
           return false;
         }
-      } else if (chunkId == wav::Id::fromChars("JUNK") || chunkId == wav::Id::fromChars("LIST") ||
-                 chunkId == wav::Id::fromChars("INFO") || chunkId == wav::Id::fromChars("smpl") ||
-                 chunkId == wav::Id::fromChars("inst") || chunkId == wav::Id::fromChars("bext") ||
-                 chunkId == wav::Id::fromChars("iXML")) {
-        // Known-but-not-actively-parsed chunks: skip their data
-        if (!skipChunk(file)) {
+      } else if (chunkId == wav::Id::fromChars("smpl")) {
+        if (!readSamplerChunk(file, chunkSize)) {
           return false;
         }
-      } else {
-        // Unknown/vendor-specific chunk: skip
-        if (!skipChunk(file)) {
+      } else if (chunkId == wav::Id::fromChars("LIST") && container_ != Container::Wave64) {
+        if (!readListChunk(file, chunkSize)) {
           return false;
         }
+      } else if (chunkId == wav::Id::fromChars("JUNK") || chunkId == wav::Id::fromChars("LIST") ||
+                 chunkId == wav::Id::fromChars("INFO") || chunkId == wav::Id::fromChars("inst") ||
+                 chunkId == wav::Id::fromChars("bext") || chunkId == wav::Id::fromChars("iXML")) {
+        // Known-but-not-actively-parsed chunks: skip their data
+        skipChunk(file, chunkSize);
+      } else {
+        // Unknown/vendor-specific chunk: skip
+        skipChunk(file, chunkSize);
       }
     }
 
@@ -303,73 +640,171 @@ public:
     return true;
   }
 
-  bool isOpen() const { return isOpen_; }
-
-  uint16_t getNumChannels() const { return fmt_.numChannels; }
-  uint32_t getSampleRate() const { return fmt_.sampleRate; }
-  uint16_t getBitsPerSample() const { return fmt_.bitsPerSample; }
-  AudioFormat getAudioFormat() const { return fmt_.audioFormat; }
   /**
-   * @brief Get raw sample data as a byte vector exactly as read from the file
+   * @brief Read and verify the RIFF/RIFX header (12 bytes) or Wave64 header (40 bytes), setting container_
+   * See wav-resources/WAVE File Format.html — RIFF chunk descriptor
    */
-  std::vector<uint8_t> getRawSampleData() const { return data_.sampleDataInBytes; }
+  bool readRiffHeader(detail::FileCursor& file) {
+    detail::ScopedPhase phase(stats_, ReadPhase::Header, filename_);
 
-  const FmtChunk& getFmtChunk() const { return fmt_; }
-  const DataChunk& getDataChunk() const { return data_; }
-  const FactChunk& getFactChunk() const { return fact_; }
-  const CueChunk& getCueChunk() const { return cue_; }
+    uint8_t header[40];
+    if (readBytes(file, header, 12) != 12) {
+      return false;
+    }
+
+    // Wave64 starts with the riff GUID, whose first four bytes are "riff" in lower case;
+    // RIFX is RIFF with big-endian fields
+    container_ = header[0] == 'r' ? Container::Wave64 : header[3] == 'X' ? Container::Rifx : Container::Riff;
+    if (container_ == Container::Wave64 && readBytes(file, header + 12, 28) != 28) {
+      return false;
+    }
+    containerEnd_ = containerEnd(header);
+    return isExpectedHeader(header);
+  }
 
-private:
   /**
-   * @brief Read fmt chunk data
-   * @param file Input stream positioned right after the fmt chunk ID (at chunk size field)
-   * See wav-resources/WAVE File Format.html — fmt chunk format (minimum 16 bytes)
-   * Bytes are stored in little-endian format
+   * @brief File offset where the RIFF (or Wave64) chunk ends according to its size field
+   */
+  uint64_t containerEnd(const uint8_t* header) const {
+    return container_ == Container::Wave64 ? detail::loadLE64(header + 16) : uint64_t{load32(header + 4)} + 8;
+  }
+
+  /**
+   * @brief Check the file header against container_
+   * RIFF: "RIFF" + size + "WAVE" (RIFX: "RIFX"); Wave64: riff GUID + 64-bit size + wave GUID
    */
-  bool readFmtChunk(std::ifstream& file) {
-    chunkSize_t chunkSize;
-    file.read(reinterpret_cast<char*>(&chunkSize), 4);
+  bool isExpectedHeader(const uint8_t* header) const {
+    if (container_ == Container::Wave64) {
+      return detail::equalBytes(header, detail::kW64RiffGuid, 16) &&
+             detail::equalBytes(header + 24, detail::kW64WaveGuid, 16);
+    }
+    const char* riff = container_ == Container::Rifx ? "RIFX" : "RIFF";
+    return detail::equalBytes(header, reinterpret_cast<const uint8_t*>(riff), 4) &&
+           detail::equalBytes(header + 8, reinterpret_cast<const uint8_t*>("WAVE"), 4);
+  }
 
-    if (file.gcount() != 4) {
+  /**
+   * @brief Read the next chunk header and return its Id and payload size
+   * RIFF/RIFX: 4-byte FourCC + 32-bit payload size. Wave64: 16-byte GUID + 64-bit size including the header.
+   * @return false at end of file or on a truncated or malformed header
+   */
+  bool readChunkHeader(detail::FileCursor& file, Id& chunkId, uint64_t& chunkSize) {
+    uint8_t header[detail::kW64ChunkHeaderSize];
+    if (container_ != Container::Wave64) {
+      if (readBytes(file, header, 8) != 8) {
+        return false;
+      }
+      chunkId = Id::fromChars(reinterpret_cast<const char*>(header));
+      chunkSize = load32(header + 4);
+      return true;
+    }
+    if (readBytes(file, header, sizeof(header)) != static_cast<std::streamsize>(sizeof(header))) {
       return false;
     }
+    chunkId = detail::w64ChunkId(header);
+    const uint64_t size = detail::loadLE64(header + 16);
+    if (size < detail::kW64ChunkHeaderSize) {
+      return false;
+    }
+    chunkSize = size - detail::kW64ChunkHeaderSize;
+    return true;
+  }
 
-    // Read fmt chunk fields
-    file.read(reinterpret_cast<char*>(&fmt_.audioFormat), 2);
-    file.read(reinterpret_cast<char*>(&fmt_.numChannels), 2);
-    file.read(reinterpret_cast<char*>(&fmt_.sampleRate), 4);
-    file.read(reinterpret_cast<char*>(&fmt_.avgBytesPerSec), 4);
-    file.read(reinterpret_cast<char*>(&fmt_.blockAlign), 2);
-    file.read(reinterpret_cast<char*>(&fmt_.bitsPerSample), 2);
+  /**
+   * @brief Bytes between the end of a payload and the next chunk header
+   * RIFF pads chunks to 2 bytes (one pad byte after an odd size), Wave64 to 8 bytes.
+   */
+  uint64_t paddingAfter(uint64_t chunkSize) const {
+    return container_ == Container::Wave64 ? (8 - chunkSize % 8) % 8 : chunkSize & 1;
+  }
+
+  /**
+   * @brief Header fields in the byte order of the container (big-endian for RIFX)
+   */
+  uint16_t load16(const uint8_t* p) const {
+    return container_ == Container::Rifx ? detail::loadBE16(p) : detail::loadLE16(p);
+  }
+  uint32_t load32(const uint8_t* p) const {
+    return container_ == Container::Rifx ? detail::loadBE32(p) : detail::loadLE32(p);
+  }
+
+  /**
+   * @brief Read bytes at the cursor (the cursor counts the underlying file reads for ReadStats)
+   * @return Number of bytes actually read (same as file.gcount())
+   */
+  static std::streamsize readBytes(detail::FileCursor& file, void* dst, std::streamsize count) {
+    file.read(reinterpret_cast<char*>(dst), count);
+    return file.gcount();
+  }
+
+  /**
+   * @brief Seek relative to the current position, counting the call for ReadStats
+   */
+  void seekBy(detail::FileCursor& file, std::streamoff offset) {
+    file.seekg(offset, std::ios::cur);
+    detail::countSeek(stats_);
+  }
 
-    if (file.gcount() != 2) {
+  /**
+   * @brief Read a whole chunk payload into payload_ with one read, then step over the padding
+   * @param file Input stream positioned at the first payload byte
+   * Metadata chunks are small, so they are decoded from memory rather than field by field.
+   */
+  bool readPayload(detail::FileCursor& file, uint64_t chunkSize) {
+    if (chunkSize > file.size() - std::min(file.size(), file.tellg())) {
+      return false; // Truncated chunk (or a size field that is not to be trusted)
+    }
+    payload_.resize(static_cast<std::size_t>(chunkSize));
+    if (readBytes(file, payload_.data(), static_cast<std::streamsize>(chunkSize)) !=
+        static_cast<std::streamsize>(chunkSize)) {
       return false;
     }
+    // Skip the pad byte (or Wave64 alignment) so the cursor lands on the next chunk header
+    if (const uint64_t padding = paddingAfter(chunkSize)) {
+      seekBy(file, static_cast<std::streamoff>(padding));
+    }
+    return true;
+  }
+
+  /**
+   * @brief Read fmt chunk data
+   * @param file Input stream positioned at the first byte of the fmt chunk payload
+   * See wav-resources/WAVE File Format.html — fmt chunk format (minimum 16 bytes)
+   * Fields are little-endian (big-endian in RIFX files); any extension (e.g. cbSize for non-PCM formats) is ignored.
+   */
+  bool readFmtChunk(detail::FileCursor& file, uint64_t chunkSize) {
+    detail::ScopedPhase phase(stats_, ReadPhase::Fmt, filename_);
 
-    // Skip any extra fmt chunk data (e.g., extension for non-PCM formats)
-    if (chunkSize > 16) {
-      file.seekg(chunkSize - 16, std::ios::cur);
+    if (chunkSize < 16 || !readPayload(file, chunkSize)) {
+      return false;
     }
 
+    const uint8_t* p = payload_.data();
+    fmt_.chunkSize = static_cast<chunkSize_t>(chunkSize);
+    fmt_.audioFormat = static_cast<AudioFormat>(load16(p));
+    fmt_.numChannels = load16(p + 2);
+    fmt_.sampleRate = load32(p + 4);
+    fmt_.avgBytesPerSec = load32(p + 8);
+    fmt_.blockAlign = load16(p + 12);
+    fmt_.bitsPerSample = load16(p + 14);
+    fmt_.bigEndian = container_ == Container::Rifx;
     return true;
   }
 
   /**
    * @brief Read data chunk and sample data
-   * @param file Input stream positioned right after the data chunk ID
+   * @param file Input stream positioned at the first sample byte
    * See wav-resources/WAVE File Format.html — data chunk format
    * Validates audio format before reading samples.
    *
    * Note: chunkSize is the actual sample data bytes, not counting any pad byte.
    * If chunkSize is odd, a pad byte follows the data (to maintain even alignment).
-   * Actual bytes to skip to next chunk = chunkSize + (chunkSize & 1)
+   * Actual bytes to skip to next chunk = chunkSize + paddingAfter(chunkSize)
    */
-  bool readDataChunk(std::ifstream& file) {
-    file.read(reinterpret_cast<char*>(&data_.chunkSize), sizeof(chunkSize_t));
+  bool readDataChunk(detail::FileCursor& file, uint64_t chunkSize) {
+    detail::ScopedPhase phase(stats_, ReadPhase::Data, filename_);
 
-    if (file.gcount() != 4) {
-      return false;
-    }
+    data_.chunkSize = chunkSize;
 
     // Validate audio format (only PCM and IEEE float supported for now)
     if (fmt_.audioFormat != AudioFormat::PCM && fmt_.audioFormat != AudioFormat::IEEE_FLOAT) {
@@ -378,10 +813,32 @@ private:
       return false;
     }
 
+    dataOffset_ = file.tellg();
+
+    // Only whole frames that are on disk count as data (see refresh()): a header pre-sized for the
+    // final length, or a size field left stale by a recorder (often 0 or 0xFFFFFFFF), does not
+    // announce frames that are not there yet
+    availableData_ = availableDataSize(chunkSize, containerEnd_, file.size());
+    data_.chunkSize = availableData_;
+    const uint64_t skipSize = options_.growingFile ? availableData_ : chunkSize; // To the next chunk
+
+    // In metadata-only mode the samples are skipped; only the size and offset are kept
+    if (options_.mode == ReadMode::MetadataOnly) {
+      seekBy(file, static_cast<std::streamoff>(skipSize + paddingAfter(skipSize)));
+      return true;
+    }
+
+    // Streaming through the whole chunk: start pulling it into the page cache right away
+    if (options_.accessPattern == AccessPattern::Sequential) {
+      file.handle().willNeed(dataOffset_, data_.chunkSize);
+    }
+
     // Read sample data into the appropriate typed container based on bitsPerSample
     if (data_.chunkSize > 0) {
-      data_.sampleDataInBytes.resize(data_.chunkSize);
-      file.read(reinterpret_cast<char*>(data_.sampleDataInBytes.data()), data_.chunkSize);
+      data_.sampleDataInBytes = SampleBuffer(SampleAllocator<uint8_t>(options_.sampleMemory));
+      data_.sampleDataInBytes.resize(static_cast<std::size_t>(data_.chunkSize));
+      detail::countAllocation(stats_, data_.chunkSize);
+      readBytes(file, data_.sampleDataInBytes.data(), static_cast<std::streamsize>(data_.chunkSize));
 
       if (file.gcount() != static_cast<std::streamsize>(data_.chunkSize)) {
         std::cerr << "Error: Failed to read complete data chunk. Expected " << data_.chunkSize << " bytes, got "
@@ -390,56 +847,75 @@ private:
       }
     }
 
-    // Skip any pad byte if chunkSize is odd (maintains even alignment per RIFF spec)
-    if (data_.chunkSize & 1) {
-      file.seekg(1, std::ios::cur);
+    // Skip a trailing partial frame and any pad byte if chunkSize is odd (maintains even alignment per
+    // RIFF spec; 8-byte alignment in Wave64)
+    if (const uint64_t rest = skipSize - data_.chunkSize + paddingAfter(skipSize)) {
+      seekBy(file, static_cast<std::streamoff>(rest));
     }
 
     return true;
   }
 
   /**
-   * @brief Read fact chunk
-   * @param file Input stream positioned right after the fact chunk ID
-   * See wav-resources/WAVE File Format.html — fact chunk (for non-PCM formats)
+   * @brief Bytes of whole frames in the data chunk that are on disk (see refresh())
+   * @param chunkSize Data chunk size field (ignored for a growing file)
+   * @param containerEnd End of the RIFF/Wave64 chunk from its size field (ignored for a growing file,
+   *                     and while it does not yet reach the data chunk, e.g. a writer that leaves it 0)
    */
-  bool readFactChunk(std::ifstream& file) {
-    chunkSize_t chunkSize;
-    file.read(reinterpret_cast<char*>(&chunkSize), sizeof(chunkSize_t));
-
-    if (file.gcount() != 4) {
-      return false;
+  uint64_t availableDataSize(uint64_t chunkSize, uint64_t containerEnd, uint64_t fileSize) const {
+    uint64_t size = fileSize > dataOffset_ ? fileSize - dataOffset_ : 0;
+    if (options_.growingFile) {
+      if (container_ != Container::Wave64) {
+        size = std::min<uint64_t>(size, 0xFFFFFFFFu); // RIFF sizes are 32-bit
+      }
+    } else {
+      size = std::min(size, chunkSize);
+      if (containerEnd > dataOffset_) {
+        size = std::min(size, containerEnd - dataOffset_);
+      }
     }
+    return fmt_.blockAlign == 0 ? size : size - size % fmt_.blockAlign;
+  }
 
-    file.read(reinterpret_cast<char*>(&fact_.numSamplesPerChannel), 4);
+  /**
+   * @brief Read fact chunk
+   * @param file Input stream positioned at the first byte of the fact chunk payload
+   * See wav-resources/WAVE File Format.html — fact chunk (for non-PCM formats)
+   */
+  bool readFactChunk(detail::FileCursor& file, uint64_t chunkSize) {
+    detail::ScopedPhase phase(stats_, ReadPhase::Fact, filename_);
 
-    if (file.gcount() != 4) {
+    if (chunkSize < 4 || !readPayload(file, chunkSize)) {
       return false;
     }
-
+    fact_.chunkSize = static_cast<chunkSize_t>(chunkSize);
+    fact_.numSamplesPerChannel = load32(payload_.data());
     return true;
   }
 
   /**
    * @brief Read cue chunk
-   * @param file Input stream positioned right after the cue chunk ID
-   * See wav-resources/WAVE File Format.html — cue chunk
+   * @param file Input stream positioned at the first byte of the cue chunk payload
+   * See wav-resources/WAVE File Format.html — cue chunk (4 bytes + 24 bytes per cue point)
    */
-  bool readCueChunk(std::ifstream& file) {
-    chunkSize_t chunkSize;
-    file.read(reinterpret_cast<char*>(&chunkSize), 4);
+  bool readCueChunk(detail::FileCursor& file, uint64_t chunkSize) {
+    detail::ScopedPhase phase(stats_, ReadPhase::Cue, filename_);
 
-    if (file.gcount() != 4) {
+    if (chunkSize < 4 || !readPayload(file, chunkSize)) {
       return false;
     }
+    cue_.chunkSize = static_cast<chunkSize_t>(chunkSize);
+    cue_.numCuePoints = static_cast<long>(load32(payload_.data()));
 
-    // Read number of cue points
-    file.read(reinterpret_cast<char*>(&cue_.numCuePoints), 4);
+    // Never trust numCuePoints beyond what the chunk can actually hold
+    const std::size_t maxCues = static_cast<std::size_t>((chunkSize - 4) / 24);
+    const std::size_t numCues = std::min(static_cast<std::size_t>(cue_.numCuePoints), maxCues);
+    cue_.cuePoints.reserve(numCues);
+    detail::countAllocation(stats_, numCues * sizeof(CuePoint));
 
-    // Read each cue point
-    for (long i = 0; i < cue_.numCuePoints; ++i) {
+    for (std::size_t i = 0; i < numCues; ++i) {
       CuePoint cuePoint;
-      if (!readCuePoint(file, cuePoint)) {
+      if (!decodeCuePoint(payload_.data() + 4 + 24 * i, cuePoint)) {
         return false;
       }
       cue_.cuePoints.push_back(cuePoint);
@@ -449,78 +925,170 @@ private:
   }
 
   /**
-   * @brief Read individual cue point
-   * @param file Input stream positioned right after a cue point ID
+   * @brief Decode one 24-byte cue point entry
+   * @param p First byte of the entry (its identifier field)
    * @param cuePoint CuePoint structure to fill
    */
-  bool readCuePoint(std::ifstream& file, CuePoint& cuePoint) {
-    file.read(reinterpret_cast<char*>(&cuePoint.identifier), 4);
-    file.read(reinterpret_cast<char*>(&cuePoint.position), 4);
-
-    char fccChunk[4];
-    file.read(fccChunk, 4);
-    cuePoint.fccChunk = Id::fromChars(fccChunk);
+  bool decodeCuePoint(const uint8_t* p, CuePoint& cuePoint) const {
+    cuePoint.identifier = load32(p);
+    cuePoint.position = load32(p + 4);
+    cuePoint.fccChunk = Id::fromChars(reinterpret_cast<const char*>(p + 8));
 
     // We do not currently support cue points for other chunks than "data"
     if (cuePoint.fccChunk != Id::fromChars("data")) {
       return false;
     }
 
-    file.read(reinterpret_cast<char*>(&cuePoint.chunkStart), 4);
-    file.read(reinterpret_cast<char*>(&cuePoint.blockStart), 4);
-    file.read(reinterpret_cast<char*>(&cuePoint.sampleOffset), 4);
-
-    if (file.gcount() != 4) {
-      return false;
-    }
-
+    cuePoint.chunkStart = load32(p + 12);
+    cuePoint.blockStart = load32(p + 16);
+    cuePoint.sampleOffset = load32(p + 20);
     return true;
   }
 
-  bool readAdtlChunk(std::ifstream& file) {
-    chunkSize_t chunkSize;
-    file.read(reinterpret_cast<char*>(&chunkSize), 4);
+  /**
+   * @brief Read sampler chunk and its sample loops
+   * @param file Input stream positioned at the first byte of the smpl chunk payload
+   * See wav-resources/WAVE File Format.html — sampler chunk (36 bytes + 24 bytes per loop)
+   */
+  bool readSamplerChunk(detail::FileCursor& file, uint64_t chunkSize) {
+    detail::ScopedPhase phase(stats_, ReadPhase::Sampler, filename_);
 
-    if (file.gcount() != 4) {
+    if (chunkSize < 36 || !readPayload(file, chunkSize)) {
       return false;
     }
+    sampler_.chunkSize = static_cast<chunkSize_t>(chunkSize);
+
+    // Every field is a 32-bit value in the container's byte order
+    const uint8_t* p = payload_.data();
+    long* fields[] = {&sampler_.manufacturer,  &sampler_.product,           &sampler_.samplePeriod,
+                      &sampler_.midiUnityNote, &sampler_.midiPitchFraction, &sampler_.smpteFormat,
+                      &sampler_.smpteOffset,   &sampler_.numSampleLoops,    &sampler_.samplerData};
+    for (long* field : fields) {
+      *field = static_cast<long>(load32(p));
+      p += 4;
+    }
+
+    // Never trust numSampleLoops beyond what the chunk can actually hold; sampler-specific
+    // data after the loops is ignored
+    const std::size_t maxLoops = static_cast<std::size_t>((chunkSize - 36) / 24);
+    const std::size_t numLoops = std::min(static_cast<std::size_t>(sampler_.numSampleLoops), maxLoops);
+    sampler_.sampleLoops.reserve(numLoops);
+    detail::countAllocation(stats_, numLoops * sizeof(SampleLoop));
+    for (std::size_t i = 0; i < numLoops; ++i) {
+      SampleLoop loop;
+      long* loopFields[] = {&loop.cuePointId, &loop.type, &loop.start, &loop.end, &loop.fraction, &loop.playCount};
+      for (long* field : loopFields) {
+        *field = static_cast<long>(load32(p));
+        p += 4;
+      }
+      sampler_.sampleLoops.push_back(loop);
+    }
 
     return true;
   }
 
   /**
-   * @brief Skip unknown chunk
-   * @param file Input stream positioned right after an unknown chunk ID
-   * Note: Accounts for pad byte if chunkSize is odd (maintains even alignment).
-   * Bytes to skip = chunkSize + (chunkSize & 1)
+   * @brief Read the labl entries of an associated data list; other LIST types (e.g. INFO) are skipped
+   * @param file Input stream positioned at the first byte of the LIST chunk payload
+   * See wav-resources/WAVE File Format.html — Associated Data List chunk
    */
-  bool skipChunk(std::ifstream& file) {
-    chunkSize_t chunkSize;
-    file.read(reinterpret_cast<char*>(&chunkSize), 4);
-
-    if (file.gcount() != 4) {
+  bool readListChunk(detail::FileCursor& file, uint64_t chunkSize) {
+    const uint8_t adtl[4] = {'a', 'd', 't', 'l'};
+    if (chunkSize < 4 || chunkSize > (1u << 24)) {
+      skipChunk(file, chunkSize);
+      return true;
+    }
+    detail::ScopedPhase phase(stats_, ReadPhase::Cue, filename_);
+    if (!readPayload(file, chunkSize)) {
       return false;
     }
+    if (std::memcmp(payload_.data(), adtl, 4) != 0) {
+      return true;
+    }
+    // Sub-chunks: ID, size, then (for labl and note) a cue point ID and a null-terminated string
+    std::size_t pos = 4;
+    while (pos + 8 <= payload_.size()) {
+      const Id id = Id::fromChars(reinterpret_cast<const char*>(payload_.data() + pos));
+      const std::size_t size = load32(payload_.data() + pos + 4);
+      const std::size_t begin = pos + 8;
+      if (size > payload_.size() - begin) {
+        break;
+      }
+      if (id == Id::fromChars("labl") && size >= 4) {
+        LabelChunk label;
+        label.chunkSize = static_cast<chunkSize_t>(size);
+        label.cuePointId = static_cast<long>(load32(payload_.data() + begin));
+        const char* text = reinterpret_cast<const char*>(payload_.data() + begin + 4);
+        label.text.assign(text, std::find(text, text + (size - 4), '\0'));
+        labels_.push_back(std::move(label));
+      }
+      pos = begin + size + (size & 1);
+    }
+    return true;
+  }
 
-    // Skip the chunk data
-    file.seekg(chunkSize, std::ios::cur);
+  /**
+   * @brief Record a chunk in the chunk list
+   * @param file Input stream positioned right after the chunk header (at the first payload byte)
+   */
+  void recordChunk(const detail::FileCursor& file, Id chunkId, uint64_t chunkSize) {
+    ChunkInfo info;
+    info.id = chunkId;
+    info.offset = file.tellg() - (container_ == Container::Wave64 ? detail::kW64ChunkHeaderSize : 8);
+    info.chunkSize = chunkSize;
+    chunks_.push_back(info);
+  }
 
-    // Skip pad byte if chunkSize is odd (maintains even alignment per RIFF spec)
-    if (chunkSize & 1) {
-      file.seekg(1, std::ios::cur);
-    }
+  /**
+   * @brief Clear all parsed chunk data (called at the start of every open())
+   */
+  void resetChunks() {
+    isOpen_ = false;
+    container_ = Container::Riff;
+    fmt_ = FmtChunk{};
+    data_ = DataChunk{};
+    fact_ = FactChunk{};
+    cue_ = CueChunk{};
+    sampler_ = SamplerChunk{};
+    labels_.clear();
+    chunks_.clear();
+    dataOffset_ = 0;
+    containerEnd_ = 0;
+    availableData_ = 0;
+    stats_.reset();
+  }
 
-    return true;
+  /**
+   * @brief Skip unknown chunk
+   * @param file Input stream positioned at the first byte of the chunk payload
+   * Note: Accounts for padding (one pad byte after an odd RIFF chunk, 8-byte alignment in Wave64).
+   * Bytes to skip = chunkSize + paddingAfter(chunkSize)
+   */
+  void skipChunk(detail::FileCursor& file, uint64_t chunkSize) {
+    detail::ScopedPhase phase(stats_, ReadPhase::Skip, filename_);
+    seekBy(file, static_cast<std::streamoff>(chunkSize + paddingAfter(chunkSize)));
   }
 
   std::string filename_;
   bool isOpen_;
+  OpenOptions options_;
+  Container container_ = Container::Riff;
 
   // Chunk data
   FmtChunk fmt_;
   DataChunk data_;
   FactChunk fact_;
   CueChunk cue_;
+  SamplerChunk sampler_;
+  std::vector<LabelChunk> labels_;
+  std::vector<ChunkInfo> chunks_;
+  uint64_t dataOffset_ = 0;
+  uint64_t containerEnd_ = 0;    // From the RIFF/Wave64 size field
+  uint64_t availableData_ = 0;   // Whole-frame data bytes on disk when last checked (refresh())
+  std::vector<uint8_t> payload_; // Scratch buffer for metadata chunk payloads, reused across chunks
+
+  // Instrumentation (see Instrumentation.hpp)
+  ReadStats stats_;
 };
 
 } // namespace wav
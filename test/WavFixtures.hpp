@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <wav/WavFileUtils.hpp>
+
+/**
+ * @brief Test fixtures: WAV files assembled in memory with the library's own little-endian helpers
+ *
+ * Usage example:
+ *   std::vector<uint8_t> data;
+ *   wavtest::putS16(data, 1234);
+ *   wavtest::writeFile("tone.wav", wavtest::wavFile(wavtest::kPcm, 1, 48000, 16, data));
+ */
+namespace wavtest {
+
+constexpr uint16_t kPcm = 1;
+constexpr uint16_t kFloat = 3;
+
+/**
+ * @brief A chunk to place in a RIFF file (payload without header or pad byte)
+ */
+struct Chunk {
+  const char* id;
+  std::vector<uint8_t> payload;
+};
+
+/**
+ * @brief 16-byte fmt chunk payload; byte rate and block align follow from channels and bits
+ */
+inline std::vector<uint8_t> fmtPayload(uint16_t audioFormat, uint16_t channels, uint32_t sampleRate,
+                                       uint16_t bitsPerSample) {
+  const uint16_t blockAlign = static_cast<uint16_t>(channels * ((bitsPerSample + 7) / 8));
+  std::vector<uint8_t> fmt;
+  wav::detail::putLE16(fmt, audioFormat);
+  wav::detail::putLE16(fmt, channels);
+  wav::detail::putLE32(fmt, sampleRate);
+  wav::detail::putLE32(fmt, sampleRate * blockAlign);
+  wav::detail::putLE16(fmt, blockAlign);
+  wav::detail::putLE16(fmt, bitsPerSample);
+  return fmt;
+}
+
+/**
+ * @brief RIFF/WAVE file holding chunks in the given order, with a matching RIFF size
+ */
+inline std::vector<uint8_t> riffFile(const std::vector<Chunk>& chunks) {
+  std::vector<uint8_t> body = {'W', 'A', 'V', 'E'};
+  for (const Chunk& chunk : chunks) {
+    wav::detail::putChunk(body, wav::Id::fromChars(chunk.id), chunk.payload);
+  }
+  std::vector<uint8_t> file = {'R', 'I', 'F', 'F'};
+  wav::detail::putLE32(file, static_cast<uint32_t>(body.size()));
+  file.insert(file.end(), body.begin(), body.end());
+  return file;
+}
+
+/**
+ * @brief fmt chunk, data chunk, then any trailing chunks
+ */
+inline std::vector<uint8_t> wavFile(uint16_t audioFormat, uint16_t channels, uint32_t sampleRate,
+                                    uint16_t bitsPerSample, const std::vector<uint8_t>& data,
+                                    const std::vector<Chunk>& trailing = {}) {
+  std::vector<Chunk> chunks = {{"fmt ", fmtPayload(audioFormat, channels, sampleRate, bitsPerSample)}, {"data", data}};
+  chunks.insert(chunks.end(), trailing.begin(), trailing.end());
+  return riffFile(chunks);
+}
+
+/**
+ * @brief fmt chunk and data chunk header of a file whose size fields announce dataBytes of samples
+ * The samples themselves are left to the caller, e.g. to append them later like a recorder would.
+ */
+inline std::vector<uint8_t> wavHeader(uint16_t audioFormat, uint16_t channels, uint32_t sampleRate,
+                                      uint16_t bitsPerSample, uint32_t dataBytes) {
+  std::vector<uint8_t> header = riffFile({{"fmt ", fmtPayload(audioFormat, channels, sampleRate, bitsPerSample)}});
+  header.insert(header.end(), {'d', 'a', 't', 'a'});
+  wav::detail::putLE32(header, dataBytes);
+  const uint32_t riffSize = static_cast<uint32_t>(header.size() - 8 + dataBytes);
+  for (int i = 0; i < 4; ++i) {
+    header[4 + i] = static_cast<uint8_t>(riffSize >> (8 * i));
+  }
+  return header;
+}
+
+/**
+ * @brief Append one little-endian sample
+ */
+inline void putS16(std::vector<uint8_t>& out, int16_t v) { wav::detail::putLE16(out, static_cast<uint16_t>(v)); }
+inline void putS24(std::vector<uint8_t>& out, int32_t v) {
+  const uint32_t u = static_cast<uint32_t>(v);
+  out.insert(out.end(), {static_cast<uint8_t>(u), static_cast<uint8_t>(u >> 8), static_cast<uint8_t>(u >> 16)});
+}
+inline void putS32(std::vector<uint8_t>& out, int32_t v) { wav::detail::putLE32(out, static_cast<uint32_t>(v)); }
+inline void putF32(std::vector<uint8_t>& out, float v) {
+  uint32_t bits;
+  std::memcpy(&bits, &v, 4);
+  wav::detail::putLE32(out, bits);
+}
+
+inline std::string writeFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+  std::ofstream out(path, std::ios::binary);
+  out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+  return path;
+}
+
+inline std::vector<uint8_t> readFile(const std::string& path) {
+  std::ifstream in(path, std::ios::binary);
+  return std::vector<uint8_t>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+} // namespace wavtest
@@ -0,0 +1,116 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include "WavFixtures.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <wav/BandwidthAnalyzer.hpp>
+
+/**
+ * @brief 24-bit stereo noise at sampleRate with a flat spectrum up to cutoffHz and nothing above it
+ *
+ * The spectrum is built directly (random phases) and turned into samples with an inverse FFT, then
+ * repeated to fill `seconds`.
+ */
+static std::string writeNoise(const std::string& path, uint32_t sampleRate, double cutoffHz, double seconds) {
+  const std::size_t n = 1 << 16;
+  std::mt19937 rng(21);
+  std::uniform_real_distribution<float> phase(0.0f, 6.2831853f);
+  std::vector<float> channels[2];
+  for (auto& samples : channels) {
+    std::vector<std::complex<float>> spectrum(n);
+    for (std::size_t k = 1; k < n / 2; ++k) {
+      if (k * double(sampleRate) / n < cutoffHz) {
+        spectrum[k] = std::polar(1.0f, phase(rng));
+        spectrum[n - k] = std::conj(spectrum[k]);
+      }
+    }
+    wav::detail::Fft(n).transform(spectrum.data(), true);
+    float peak = 0.0f;
+    for (const auto& s : spectrum) {
+      peak = std::max(peak, std::fabs(s.real()));
+    }
+    for (const auto& s : spectrum) {
+      samples.push_back(0.5f * s.real() / peak);
+    }
+  }
+
+  const uint32_t frames = static_cast<uint32_t>(seconds * sampleRate);
+  std::vector<uint8_t> data;
+  for (uint32_t i = 0; i < frames; ++i) {
+    for (const auto& samples : channels) {
+      wavtest::putS24(data, static_cast<int32_t>(std::lround(samples[i % n] * 8388607.0f)));
+    }
+  }
+  return wavtest::writeFile(path, wavtest::wavFile(wavtest::kPcm, 2, sampleRate, 24, data));
+}
+
+TEST_CASE("96 kHz files holding 44.1 and 48 kHz material are flagged") {
+  const std::string from44 = writeNoise("bandwidth_44.wav", 96000, 20500.0, 3.0);
+  wav::BandwidthEstimate estimate;
+  REQUIRE(wav::analyzeBandwidth(from44, estimate));
+  CHECK(estimate.sampleRate == 96000);
+  CHECK(estimate.cutoffHz > 20000.0);
+  CHECK(estimate.cutoffHz < 21500.0);
+  CHECK(estimate.cliffDb > 30.0);
+  CHECK(estimate.effectiveRate == 44100);
+  CHECK(estimate.isUpsampled());
+  CHECK(estimate.numWindows == 2 * 48);
+
+  const std::string from48 = writeNoise("bandwidth_48.wav", 96000, 22800.0, 3.0);
+  REQUIRE(wav::analyzeBandwidth(from48, estimate));
+  CHECK(estimate.effectiveRate == 48000);
+  std::remove(from44.c_str());
+  std::remove(from48.c_str());
+}
+
+TEST_CASE("Full-band high-resolution content is not flagged") {
+  const std::string path = writeNoise("bandwidth_full.wav", 96000, 48000.0, 3.0);
+  wav::BandwidthEstimate estimate;
+  REQUIRE(wav::analyzeBandwidth(path, estimate));
+  CHECK(estimate.cutoffHz == 48000.0);
+  CHECK(estimate.effectiveRate == 96000);
+  CHECK_FALSE(estimate.isUpsampled());
+
+  // A native 96 kHz converter's own filter sits near 46 kHz, above the 88.2 kHz edge
+  const std::string filtered = writeNoise("bandwidth_native.wav", 96000, 46000.0, 3.0);
+  REQUIRE(wav::analyzeBandwidth(filtered, estimate));
+  CHECK(estimate.cutoffHz > 45000.0);
+  CHECK_FALSE(estimate.isUpsampled());
+  std::remove(path.c_str());
+  std::remove(filtered.c_str());
+}
+
+TEST_CASE("Band-limited content that matches no standard rate is reported but not flagged") {
+  const std::string path = writeNoise("bandwidth_low.wav", 96000, 3000.0, 2.0);
+  wav::BandwidthEstimate estimate;
+  REQUIRE(wav::analyzeBandwidth(path, estimate));
+  CHECK(estimate.cutoffHz < 3500.0);
+  CHECK_FALSE(estimate.isUpsampled());
+  std::remove(path.c_str());
+}
+
+TEST_CASE("Files shorter than a window use a smaller FFT") {
+  wav::BandwidthEstimate estimate;
+  REQUIRE(wav::analyzeBandwidth("resources/24b96khz128samples.wav", estimate));
+  CHECK(estimate.sampleRate == 96000);
+  CHECK(estimate.numWindows > 0);
+}
+
+TEST_CASE("A catalog is analyzed in parallel") {
+  std::vector<std::string> paths;
+  for (int i = 0; i < 6; ++i) {
+    paths.push_back(writeNoise("bandwidth_batch" + std::to_string(i) + ".wav", 96000, i % 2 ? 20500.0 : 48000.0, 1.0));
+  }
+  paths.push_back("does_not_exist.wav");
+  std::vector<wav::BandwidthEstimate> estimates;
+  CHECK(wav::analyzeBandwidth(paths, estimates, wav::BandwidthOptions{}, 4) == 6);
+  REQUIRE(estimates.size() == paths.size());
+  for (int i = 0; i < 6; ++i) {
+    CHECK(estimates[i].isUpsampled() == (i % 2 == 1));
+    std::remove(paths[i].c_str());
+  }
+  CHECK(estimates[6].sampleRate == 0);
+}
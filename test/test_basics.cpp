@@ -1,5 +1,6 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include "doctest/doctest.h"
+#include <fstream>
 #include <wav/WavFileUtils.hpp>
 
 TEST_CASE("valid file") {
@@ -68,4 +69,55 @@ TEST_CASE("test fact chunk") {
   // Verify fact chunk
   CHECK_EQ(factWavWavFileUtilsFloat.getFactChunk().numSamplesPerChannel, 458505);
   CHECK_EQ(factWavWavFileUtils24B.getFactChunk().numSamplesPerChannel, 0);
-}
\ No newline at end of file
+}
+
+TEST_CASE("metadata only mode") {
+  wav::OpenOptions options;
+  options.mode = wav::ReadMode::MetadataOnly;
+  options.verbose = false;
+  wav::WavFileUtils reader("resources/loop-cue.wav", options);
+  REQUIRE(reader.open());
+
+  // Sizes and offsets are known, but no sample bytes are loaded
+  CHECK_EQ(reader.getDataChunk().chunkSize, 1834020);
+  CHECK(reader.getDataChunk().sampleDataInBytes.empty());
+  CHECK_EQ(reader.getDataOffset(), 428);
+  CHECK_EQ(reader.getNumFrames(), 458505);
+  CHECK(reader.getDurationSeconds() == doctest::Approx(458505.0 / 96000.0));
+  CHECK_EQ(reader.getCueChunk().numCuePoints, 1);
+}
+
+TEST_CASE("chunk list") {
+  wav::WavFileUtils reader("resources/loop-cue.wav", wav::OpenOptions{wav::ReadMode::MetadataOnly, false});
+  REQUIRE(reader.open());
+
+  const auto& chunks = reader.getChunkList();
+  REQUIRE_EQ(chunks.size(), 7);
+  CHECK_EQ(chunks[0].id.toString(), "fmt ");
+  CHECK_EQ(chunks[0].offset, 12);
+  CHECK_EQ(chunks[0].chunkSize, 16);
+  CHECK_EQ(chunks[5].id.toString(), "smpl");
+  CHECK_EQ(chunks[6].id.toString(), "data");
+  CHECK_EQ(chunks[6].offset, 420);
+}
+
+TEST_CASE("sampler chunk") {
+  wav::WavFileUtils reader("resources/loop-cue.wav", wav::OpenOptions{wav::ReadMode::MetadataOnly, false});
+  REQUIRE(reader.open());
+
+  const wav::SamplerChunk& smpl = reader.getSamplerChunk();
+  CHECK_EQ(smpl.chunkSize, 228);
+  CHECK_EQ(smpl.midiUnityNote, 68);
+  REQUIRE_EQ(smpl.numSampleLoops, 8);
+  REQUIRE_EQ(smpl.sampleLoops.size(), 8);
+  CHECK_EQ(smpl.sampleLoops[0].start, 256421);
+  CHECK_EQ(smpl.sampleLoops[0].end, 407962);
+}
+
+TEST_CASE("reopen does not accumulate chunks") {
+  wav::WavFileUtils reader("resources/loop-cue.wav", wav::OpenOptions{wav::ReadMode::MetadataOnly, false});
+  REQUIRE(reader.open());
+  REQUIRE(reader.open());
+  CHECK_EQ(reader.getCueChunk().cuePoints.size(), 1);
+  CHECK_EQ(reader.getChunkList().size(), 7);
+}
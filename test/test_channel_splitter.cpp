@@ -0,0 +1,133 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include "WavFixtures.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <wav/ChannelSplitter.hpp>
+
+// Interleaved file whose byte b of the sample at (frame, channel) is (frame * 7 + channel * 31 + b) & 0xff
+static std::vector<uint8_t> makePoly(uint16_t format, uint16_t channels, uint16_t bits, uint32_t frames,
+                                     const std::vector<uint8_t>& bext, const std::vector<uint8_t>& ixml) {
+  const uint16_t width = bits / 8;
+  std::vector<uint8_t> data;
+  for (uint32_t f = 0; f < frames; ++f) {
+    for (uint16_t c = 0; c < channels; ++c) {
+      for (uint16_t b = 0; b < width; ++b) {
+        data.push_back(static_cast<uint8_t>(f * 7 + c * 31 + b));
+      }
+    }
+  }
+
+  std::vector<wavtest::Chunk> chunks = {{"fmt ", wavtest::fmtPayload(format, channels, 48000, bits)}};
+  if (!bext.empty()) {
+    chunks.push_back({"bext", bext});
+  }
+  chunks.push_back({"data", data});
+  if (!ixml.empty()) {
+    chunks.push_back({"iXML", ixml});
+  }
+  return wavtest::riffFile(chunks);
+}
+
+static std::vector<uint8_t> chunkPayload(const std::string& path, const wav::ChunkInfo& chunk) {
+  const std::vector<uint8_t> bytes = wavtest::readFile(path);
+  return std::vector<uint8_t>(bytes.begin() + long(chunk.offset) + 8,
+                              bytes.begin() + long(chunk.offset + 8 + chunk.chunkSize));
+}
+
+static std::vector<std::string> outputNames(unsigned channels) {
+  std::vector<std::string> paths;
+  for (unsigned c = 0; c < channels; ++c) {
+    paths.push_back("split_" + std::to_string(c + 1) + ".wav");
+  }
+  return paths;
+}
+
+TEST_CASE("every channel is split bit-exactly") {
+  struct Layout {
+    uint16_t format;
+    uint16_t channels;
+    uint16_t bits;
+  };
+  const Layout layouts[] = {{1, 8, 24}, {1, 12, 16}, {3, 2, 32}, {3, 3, 64}, {1, 1, 8}, {1, 5, 32}};
+  for (const Layout& layout : layouts) {
+    for (unsigned threads : {0u, 4u}) {
+      CAPTURE(layout.channels);
+      CAPTURE(layout.bits);
+      const uint32_t frames = 10001; // Odd, so 8-bit mono outputs need a pad byte
+      wavtest::writeFile("poly.wav", makePoly(layout.format, layout.channels, layout.bits, frames, {}, {}));
+      const std::vector<std::string> paths = outputNames(layout.channels);
+      wav::SplitOptions options;
+      options.blockBytes = 3000; // Many blocks, frames split unevenly between slices
+      options.ioThreads = threads;
+      REQUIRE(wav::splitChannels("poly.wav", paths, options));
+
+      const unsigned width = layout.bits / 8;
+      for (uint16_t c = 0; c < layout.channels; ++c) {
+        wav::WavFileUtils mono(paths[c], wav::OpenOptions{wav::ReadMode::Full, false});
+        REQUIRE(mono.open());
+        CHECK_EQ(mono.getNumChannels(), 1);
+        CHECK_EQ(mono.getSampleRate(), 48000);
+        CHECK_EQ(mono.getFmtChunk().bitsPerSample, layout.bits);
+        CHECK_EQ(static_cast<uint16_t>(mono.getFmtChunk().audioFormat), layout.format);
+        CHECK_EQ(mono.getFmtChunk().blockAlign, width);
+        const wav::SampleBuffer& bytes = mono.getDataChunk().sampleDataInBytes;
+        REQUIRE_EQ(bytes.size(), std::size_t(frames) * width);
+        bool match = true;
+        for (uint32_t f = 0; f < frames; ++f) {
+          for (unsigned b = 0; b < width; ++b) {
+            match = match && bytes[f * width + b] == static_cast<uint8_t>(f * 7 + c * 31 + b);
+          }
+        }
+        CHECK(match);
+        std::remove(paths[c].c_str());
+      }
+    }
+  }
+  std::remove("poly.wav");
+}
+
+TEST_CASE("bext and iXML are copied into every output") {
+  std::vector<uint8_t> bext(602, 0);
+  const std::string description = "Scene 12 take 3";
+  std::copy(description.begin(), description.end(), bext.begin());
+  const std::string xml = "<BWFXML><PROJECT>Test</PROJECT></BWFXML>!"; // Odd size
+  const std::vector<uint8_t> ixml(xml.begin(), xml.end());
+  wavtest::writeFile("poly.wav", makePoly(1, 4, 24, 500, bext, ixml));
+  const std::vector<std::string> paths = outputNames(4);
+  REQUIRE(wav::splitChannels("poly.wav", paths));
+
+  for (const std::string& path : paths) {
+    wav::WavFileUtils mono(path, wav::OpenOptions{wav::ReadMode::MetadataOnly, false});
+    REQUIRE(mono.open());
+    const auto& chunks = mono.getChunkList();
+    REQUIRE_EQ(chunks.size(), 4);
+    CHECK(chunks[0].id == wav::Id::fromChars("bext"));
+    CHECK(chunks[1].id == wav::Id::fromChars("iXML"));
+    CHECK(chunks[2].id == wav::Id::fromChars("fmt "));
+    CHECK(chunks[3].id == wav::Id::fromChars("data"));
+    CHECK(chunkPayload(path, chunks[0]) == bext);
+    CHECK(chunkPayload(path, chunks[1]) == ixml);
+    CHECK_EQ(mono.getNumFrames(), 500);
+    std::remove(path.c_str());
+  }
+
+  wav::SplitOptions options;
+  options.copyMetadata = false;
+  REQUIRE(wav::splitChannels("poly.wav", paths, options));
+  wav::WavFileUtils mono(paths[0], wav::OpenOptions{wav::ReadMode::MetadataOnly, false});
+  REQUIRE(mono.open());
+  CHECK_EQ(mono.getChunkList().size(), 2);
+  for (const std::string& path : paths) {
+    std::remove(path.c_str());
+  }
+  std::remove("poly.wav");
+}
+
+TEST_CASE("split rejects a wrong number of outputs") {
+  wavtest::writeFile("poly.wav", makePoly(1, 4, 16, 100, {}, {}));
+  CHECK_FALSE(wav::splitChannels("poly.wav", outputNames(3)));
+  CHECK_FALSE(wav::splitChannels("missing.wav", outputNames(4)));
+  std::remove("poly.wav");
+}
@@ -0,0 +1,153 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include "WavFixtures.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <wav/Compare.hpp>
+
+static constexpr uint32_t kFrames = 200000;
+
+/**
+ * @brief The same 16-bit stereo program as 16- or 24-bit PCM, with optional leading silence and edits
+ *
+ * Sample i of channel c is program(i, c); `leading` zero frames go first, and `edit` is added to
+ * left sample `editFrame` (in 16-bit LSBs).
+ */
+static std::string writeProgram(const std::string& path, unsigned bits, uint32_t leading = 0, uint32_t editFrame = 0,
+                                int edit = 0) {
+  std::mt19937 rng(4);
+  std::vector<int16_t> program(2 * kFrames);
+  for (uint32_t i = 0; i < kFrames; ++i) {
+    const double t = double(i) / 44100.0;
+    program[2 * i] = static_cast<int16_t>(std::lround(9000.0 * std::sin(2.0 * 3.14159265 * 220.0 * t)) + rng() % 64);
+    program[2 * i + 1] = static_cast<int16_t>(std::lround(7000.0 * std::sin(2.0 * 3.14159265 * 330.0 * t)));
+  }
+  program[2 * editFrame] = static_cast<int16_t>(program[2 * editFrame] + edit);
+
+  std::vector<uint8_t> data(leading * 2 * (bits / 8), 0);
+  for (int16_t sample : program) {
+    const int32_t v = int32_t(sample) * (1 << (bits - 16));
+    if (bits == 16) {
+      wavtest::putS16(data, static_cast<int16_t>(v));
+    } else {
+      wavtest::putS24(data, v);
+    }
+  }
+  return wavtest::writeFile(path, wavtest::wavFile(wavtest::kPcm, 2, 44100, static_cast<uint16_t>(bits), data));
+}
+
+TEST_CASE("Identical files take the memcmp fast path") {
+  const std::string a = writeProgram("compare_a.wav", 16);
+  const std::string b = writeProgram("compare_b.wav", 16);
+  wav::CompareResult result;
+  REQUIRE(wav::compare(a, b, result));
+  CHECK(result.matches());
+  CHECK(result.framesCompared == kFrames);
+  CHECK(result.bitExactFrames == kFrames);
+  CHECK(result.maxError == 0.0);
+  CHECK(result.maxErrorDb() == -INFINITY);
+  std::remove(a.c_str());
+  std::remove(b.c_str());
+}
+
+TEST_CASE("A 16-bit file and its 24-bit transcode null out") {
+  const std::string a = writeProgram("compare_16.wav", 16);
+  const std::string b = writeProgram("compare_24.wav", 24);
+  wav::CompareResult result;
+  REQUIRE(wav::compare(a, b, result));
+  CHECK(result.matches());
+  CHECK(result.bitExactFrames == 0);
+  CHECK(result.framesCompared == kFrames);
+  CHECK(result.residualRms == 0.0);
+  std::remove(a.c_str());
+  std::remove(b.c_str());
+}
+
+TEST_CASE("The first difference stops the comparison unless a full summary is asked for") {
+  const std::string a = writeProgram("compare_orig.wav", 16);
+  const std::string b = writeProgram("compare_edit.wav", 24, 0, 70001, 3);
+  wav::CompareResult result;
+  REQUIRE(wav::compare(a, b, result));
+  CHECK_FALSE(result.matches());
+  CHECK(result.differingSamples == 1);
+  CHECK(result.firstDifferenceFrame == 70001);
+  CHECK(result.firstDifferenceChannel == 0);
+  CHECK(result.framesCompared < kFrames);
+  CHECK(result.maxError == doctest::Approx(3.0 / 32768.0));
+
+  wav::CompareOptions options;
+  options.stopAtFirstDifference = false;
+  REQUIRE(wav::compare(a, b, result, options));
+  CHECK(result.framesCompared == kFrames);
+  CHECK(result.residualRms == doctest::Approx(3.0 / 32768.0 / std::sqrt(2.0 * kFrames)));
+
+  options.toleranceLsb = 3.0;
+  REQUIRE(wav::compare(a, b, result, options));
+  CHECK(result.matches());
+  options.toleranceLsb = 0.0;
+  options.toleranceDb = -80.0; // 3 LSB of 16-bit is about -81 dBFS
+  REQUIRE(wav::compare(a, b, result, options));
+  CHECK(result.matches());
+  std::remove(a.c_str());
+  std::remove(b.c_str());
+}
+
+TEST_CASE("Same-format files must match bit for bit by default") {
+  const std::string a = writeProgram("compare_bits_a.wav", 24);
+  const std::string b = writeProgram("compare_bits_b.wav", 24);
+  {
+    std::fstream file(b, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(44 + 6 * 1234);
+    file.put(1); // Lowest byte of a 24-bit sample: below 16-bit precision, but still a difference
+  }
+  wav::CompareResult result;
+  REQUIRE(wav::compare(a, b, result));
+  CHECK_FALSE(result.matches());
+  CHECK(result.firstDifferenceFrame == 1234);
+  wav::CompareOptions options;
+  options.toleranceLsb = 1.0;
+  REQUIRE(wav::compare(a, b, result, options));
+  CHECK(result.matches());
+  std::remove(a.c_str());
+  std::remove(b.c_str());
+}
+
+TEST_CASE("Offsets line up delayed files, and the search finds them") {
+  const std::string a = writeProgram("compare_early.wav", 16);
+  const std::string b = writeProgram("compare_late.wav", 16, 1105);
+  wav::CompareResult result;
+  REQUIRE(wav::compare(a, b, result));
+  CHECK_FALSE(result.matches());
+
+  wav::CompareOptions options;
+  options.frameOffset = 1105;
+  REQUIRE(wav::compare(a, b, result, options));
+  CHECK(result.differingSamples == 0);
+  CHECK(result.framesCompared == kFrames);
+  CHECK(result.framesOnlyInB == 1105);
+  CHECK_FALSE(result.matches());
+
+  options.frameOffset = 0;
+  options.alignSearchFrames = 2048;
+  REQUIRE(wav::compare(a, b, result, options));
+  CHECK(result.frameOffset == 1105);
+  CHECK(result.differingSamples == 0);
+
+  REQUIRE(wav::compare(b, a, result, options));
+  CHECK(result.frameOffset == -1105);
+  CHECK(result.differingSamples == 0);
+  CHECK(result.framesOnlyInA == 1105);
+  std::remove(a.c_str());
+  std::remove(b.c_str());
+}
+
+TEST_CASE("Files with different channel counts are not compared") {
+  wav::CompareResult result;
+  const std::string a = writeProgram("compare_stereo.wav", 16);
+  CHECK_FALSE(wav::compare(a, "resources/loop-cue.wav", result));
+  CHECK_FALSE(wav::compare(a, "does_not_exist.wav", result));
+  std::remove(a.c_str());
+}
@@ -0,0 +1,116 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include "WavFixtures.hpp"
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <wav/FrameReader.hpp>
+
+static constexpr uint32_t kFrames = 1 << 18;
+static constexpr uint16_t kChannels = 2;
+
+// Every sample is unique, so a torn or misplaced read cannot go unnoticed
+static uint32_t sampleValue(uint32_t frame, uint16_t channel) { return (frame * kChannels + channel) * 2654435761u; }
+
+static std::string writeStressFile() {
+  std::vector<uint8_t> data;
+  for (uint32_t f = 0; f < kFrames; ++f) {
+    for (uint16_t c = 0; c < kChannels; ++c) {
+      wav::detail::putLE32(data, sampleValue(f, c));
+    }
+  }
+  return wavtest::writeFile("concurrent_reads.wav", wavtest::wavFile(wavtest::kPcm, kChannels, 48000, 32, data));
+}
+
+/**
+ * @brief Hammer one reader with readAt() from many threads while the owner streams with read()
+ * @return Number of frames that came back wrong (torn, shifted or short)
+ */
+static uint64_t stress(const wav::FrameReader& shared, wav::FrameReader& owner) {
+  const unsigned numThreads = 8;
+  std::atomic<uint64_t> errors{0};
+  std::vector<std::thread> threads;
+  for (unsigned t = 0; t < numThreads; ++t) {
+    threads.emplace_back([&, t] {
+      std::mt19937 rng(t + 1);
+      std::vector<uint32_t> block(4096 * kChannels);
+      for (int i = 0; i < 2000; ++i) {
+        const uint32_t first = rng() % kFrames;
+        const std::size_t count = 1 + rng() % 4096;
+        const std::size_t got = shared.readAt(first, block.data(), count);
+        if (got != std::min<uint64_t>(count, kFrames - first)) {
+          ++errors;
+        }
+        for (std::size_t f = 0; f < got; ++f) {
+          for (uint16_t c = 0; c < kChannels; ++c) {
+            errors += block[f * kChannels + c] != sampleValue(first + static_cast<uint32_t>(f), c);
+          }
+        }
+        shared.prefetch(rng() % kFrames, 1024);
+      }
+    });
+  }
+
+  // The cursor belongs to this thread alone
+  std::vector<uint32_t> block(1000 * kChannels);
+  uint32_t frame = 0;
+  while (std::size_t got = owner.read(block.data(), 1000)) {
+    for (std::size_t f = 0; f < got; ++f, ++frame) {
+      errors += block[f * kChannels] != sampleValue(frame, 0);
+    }
+  }
+  errors += frame != kFrames;
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  return errors.load();
+}
+
+TEST_CASE("Concurrent readAt() through positional reads") {
+  const std::string path = writeStressFile();
+  wav::FrameReader reader;
+  REQUIRE(reader.open(path, wav::AccessPattern::Random));
+  REQUIRE(reader.getNumFrames() == kFrames);
+  CHECK(stress(reader, reader) == 0);
+  std::remove(path.c_str());
+}
+
+TEST_CASE("Concurrent readAt() from the mapped data chunk") {
+  const std::string path = writeStressFile();
+  wav::FrameReader reader;
+  REQUIRE(reader.open(path, wav::AccessPattern::Random));
+#if WAV_HAVE_POSIX_IO
+  REQUIRE(reader.mapData());
+  CHECK(reader.isDataMapped());
+#endif
+  CHECK(stress(reader, reader) == 0);
+
+  std::vector<uint32_t> last(kChannels);
+  CHECK(reader.readAt(kFrames - 1, last.data(), 10) == 1);
+  CHECK(last[1] == sampleValue(kFrames - 1, 1));
+  CHECK(reader.readAt(kFrames, last.data(), 1) == 0);
+
+  reader.close();
+  CHECK_FALSE(reader.isDataMapped());
+  std::remove(path.c_str());
+}
+
+TEST_CASE("Mapping starts at the data chunk, not a page boundary") {
+  wav::FrameReader mapped;
+  wav::FrameReader plain;
+  REQUIRE(mapped.open("resources/24b.wav"));
+  REQUIRE(plain.open("resources/24b.wav"));
+#if WAV_HAVE_POSIX_IO
+  REQUIRE(mapped.mapData());
+#endif
+  const std::size_t frames = static_cast<std::size_t>(std::min<uint64_t>(plain.getNumFrames(), 10000));
+  std::vector<uint8_t> a(frames * plain.getFrameSize());
+  std::vector<uint8_t> b(a.size());
+  CHECK(mapped.readAt(0, a.data(), frames) == frames);
+  CHECK(plain.readAt(0, b.data(), frames) == frames);
+  CHECK(a == b);
+}
@@ -0,0 +1,139 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+#include <wav/SampleConversion.hpp>
+
+// Odd lengths exercise both the vector loops and the scalar tails
+static const std::size_t kLengths[] = {0, 1, 3, 7, 15, 17, 33, 64, 1001};
+
+static std::vector<uint8_t> randomBytes(std::size_t count, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<uint8_t> bytes(count);
+  for (uint8_t& b : bytes) {
+    b = static_cast<uint8_t>(rng());
+  }
+  return bytes;
+}
+
+static std::vector<float> randomFloats(std::size_t count, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> values(count);
+  for (float& v : values) {
+    v = dist(rng);
+  }
+  return values;
+}
+
+static std::vector<wav::Isa> supportedIsas() {
+  std::vector<wav::Isa> isas;
+  for (int i = 0; i < static_cast<int>(wav::Isa::Count); ++i) {
+    if (wav::cpuFeatures().supports(static_cast<wav::Isa>(i))) {
+      isas.push_back(static_cast<wav::Isa>(i));
+    }
+  }
+  return isas;
+}
+
+TEST_CASE("decode kernels match the scalar reference") {
+  const wav::SampleKernels& reference = wav::sampleKernelsFor(wav::Isa::Scalar);
+  const std::vector<uint8_t> bytes = randomBytes(1001 * 8, 1);
+
+  for (wav::Isa isa : supportedIsas()) {
+    const wav::SampleKernels& k = wav::sampleKernelsFor(isa);
+    CHECK_EQ(k.isa, isa);
+    for (std::size_t n : kLengths) {
+      CAPTURE(wav::isaName(isa));
+      CAPTURE(n);
+      const std::pair<wav::DecodeKernel, wav::DecodeKernel> pairs[] = {
+          {k.pcm8ToFloat, reference.pcm8ToFloat},   {k.pcm16ToFloat, reference.pcm16ToFloat},
+          {k.pcm24ToFloat, reference.pcm24ToFloat}, {k.pcm32ToFloat, reference.pcm32ToFloat},
+          {k.float64ToFloat, reference.float64ToFloat},
+          {k.pcm16beToFloat, reference.pcm16beToFloat},
+          {k.pcm24beToFloat, reference.pcm24beToFloat},
+          {k.pcm32beToFloat, reference.pcm32beToFloat},
+          {k.float32beToFloat, reference.float32beToFloat},
+          {k.float64beToFloat, reference.float64beToFloat}};
+      for (const auto& pair : pairs) {
+        std::vector<float> expected(n + 1, -7.0f);
+        std::vector<float> actual(n + 1, -7.0f);
+        pair.second(bytes.data(), n, expected.data());
+        pair.first(bytes.data(), n, actual.data());
+        // Compare bit patterns so NaNs from random float64 input are checked too
+        CHECK(std::memcmp(expected.data(), actual.data(), (n + 1) * sizeof(float)) == 0);
+      }
+    }
+  }
+}
+
+TEST_CASE("analysis and interleave kernels match the scalar reference") {
+  const wav::SampleKernels& reference = wav::sampleKernelsFor(wav::Isa::Scalar);
+  std::vector<float> samples = randomFloats(3 * 1001, 2);
+  samples[1500] = std::numeric_limits<float>::quiet_NaN();
+  samples[1501] = -3.0f;
+
+  for (wav::Isa isa : supportedIsas()) {
+    const wav::SampleKernels& k = wav::sampleKernelsFor(isa);
+    for (std::size_t n : kLengths) {
+      CAPTURE(wav::isaName(isa));
+      CAPTURE(n);
+      CHECK_EQ(k.peakAbs(samples.data(), n), reference.peakAbs(samples.data(), n));
+      CHECK(k.sumOfSquares(samples.data(), n) == doctest::Approx(reference.sumOfSquares(samples.data(), n)));
+
+      for (unsigned channels : {1u, 2u, 3u}) {
+        std::vector<float> planar(channels * n);
+        std::vector<float*> planes;
+        for (unsigned c = 0; c < channels; ++c) {
+          planes.push_back(planar.data() + c * n);
+        }
+        k.deinterleave(samples.data(), n, channels, planes.data());
+        std::vector<float> expected(channels * n);
+        std::vector<float*> expectedPlanes;
+        for (unsigned c = 0; c < channels; ++c) {
+          expectedPlanes.push_back(expected.data() + c * n);
+        }
+        reference.deinterleave(samples.data(), n, channels, expectedPlanes.data());
+        CHECK(std::memcmp(planar.data(), expected.data(), planar.size() * sizeof(float)) == 0);
+
+        std::vector<float> interleaved(channels * n);
+        k.interleave(planes.data(), n, channels, interleaved.data());
+        CHECK(std::memcmp(interleaved.data(), samples.data(), interleaved.size() * sizeof(float)) == 0);
+      }
+    }
+    CHECK_EQ(k.peakAbs(samples.data(), samples.size()), 3.0f);
+  }
+}
+
+TEST_CASE("forced instruction set") {
+  const wav::Isa automatic = wav::activeIsa();
+  CHECK(wav::cpuFeatures().supports(automatic));
+
+  REQUIRE(wav::forceIsa(wav::Isa::Scalar));
+  CHECK_EQ(wav::activeIsa(), wav::Isa::Scalar);
+  CHECK_EQ(wav::sampleKernels().isa, wav::Isa::Scalar);
+
+  wav::FmtChunk fmt;
+  fmt.audioFormat = wav::AudioFormat::PCM;
+  fmt.bitsPerSample = 16;
+  const uint8_t pcm16[] = {0x00, 0x80, 0xff, 0x7f};
+  float out[2];
+  REQUIRE(wav::convertToFloat(fmt, pcm16, 2, out));
+  CHECK_EQ(out[0], -1.0f);
+
+  for (int i = 0; i < static_cast<int>(wav::Isa::Count); ++i) {
+    const wav::Isa isa = static_cast<wav::Isa>(i);
+    CHECK_EQ(wav::forceIsa(isa), wav::cpuFeatures().supports(isa));
+  }
+
+  wav::clearForcedIsa();
+  CHECK_EQ(wav::activeIsa(), automatic);
+
+  wav::Isa parsed;
+  CHECK(wav::parseIsa("avx2", parsed));
+  CHECK_EQ(parsed, wav::Isa::AVX2);
+  CHECK_FALSE(wav::parseIsa("neon", parsed));
+}
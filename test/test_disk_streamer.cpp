@@ -0,0 +1,180 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include <vector>
+#include <wav/DiskStreamer.hpp>
+
+static std::vector<float> decodeAll(const std::string& path) {
+  wav::WavFileUtils reader(path, wav::OpenOptions{wav::ReadMode::Full, false});
+  REQUIRE(reader.open());
+  const auto& bytes = reader.getDataChunk().sampleDataInBytes;
+  std::vector<float> samples(bytes.size() / wav::bytesPerSample(reader.getFmtChunk()));
+  REQUIRE(wav::convertToFloat(reader.getFmtChunk(), bytes.data(), samples.size(), samples.data()));
+  return samples;
+}
+
+static wav::DiskStreamerOptions manualOptions() {
+  wav::DiskStreamerOptions options;
+  options.preloadFrames = 1024;
+  options.ringFrames = 4096;
+  options.ioBlockFrames = 1024;
+  options.maxVoices = 4;
+  options.backgroundThread = false; // Drive I/O from the test for deterministic results
+  return options;
+}
+
+TEST_CASE("preload covers sample head and loop starts") {
+  wav::DiskStreamer streamer(manualOptions());
+  const int id = streamer.addSample("resources/loop-cue.wav");
+  REQUIRE_GE(id, 0);
+  const wav::StreamedSample& sample = streamer.getSample(id);
+  CHECK_EQ(sample.head.samples.size(), 1024);
+  REQUIRE_EQ(sample.loops.size(), 8);
+  REQUIRE_EQ(sample.loopHeads.size(), 8);
+  CHECK_EQ(sample.loopHeads[0].startFrame, 256421);
+
+  const std::vector<float> all = decodeAll("resources/loop-cue.wav");
+  CHECK_EQ(sample.loopHeads[0].samples[0], all[256421]);
+}
+
+TEST_CASE("streamed voice matches the file") {
+  const std::vector<float> all = decodeAll("resources/24b.wav");
+  wav::DiskStreamer streamer(manualOptions());
+  const int id = streamer.addSample("resources/24b.wav");
+  REQUIRE_GE(id, 0);
+
+  const int voice = streamer.noteOn(id, -1, false);
+  REQUIRE_GE(voice, 0);
+  std::vector<float> out;
+  std::vector<float> block(512);
+  while (streamer.isVoiceActive(voice)) {
+    streamer.serviceIo();
+    const std::size_t frames = streamer.render(voice, block.data(), block.size());
+    out.insert(out.end(), block.begin(), block.begin() + frames);
+  }
+  CHECK_EQ(streamer.getUnderrunCount(), 0);
+  REQUIRE_EQ(out.size(), all.size());
+  CHECK(out == all);
+}
+
+TEST_CASE("looping voice wraps at the loop end") {
+  const std::vector<float> all = decodeAll("resources/loop-cue.wav");
+  wav::DiskStreamer streamer(manualOptions());
+  const int id = streamer.addSample("resources/loop-cue.wav");
+  const wav::SampleLoop loop = streamer.getSample(id).loops[7];
+  const std::size_t loopLength = static_cast<std::size_t>(loop.end - loop.start + 1);
+
+  // Start at the loop and play it twice
+  const int voice = streamer.noteOn(id, 7);
+  REQUIRE_GE(voice, 0);
+  std::vector<float> out;
+  std::vector<float> block(700);
+  while (out.size() < 2 * loopLength) {
+    streamer.serviceIo();
+    REQUIRE_EQ(streamer.render(voice, block.data(), block.size()), block.size());
+    out.insert(out.end(), block.begin(), block.end());
+  }
+  CHECK_EQ(streamer.getUnderrunCount(), 0);
+  for (std::size_t i = 0; i < 2 * loopLength; i += 997) {
+    CHECK_EQ(out[i], all[static_cast<std::size_t>(loop.start) + i % loopLength]);
+  }
+}
+
+TEST_CASE("underruns are counted when I/O falls behind") {
+  wav::DiskStreamer streamer(manualOptions());
+  const int id = streamer.addSample("resources/24b.wav");
+  const int voice = streamer.noteOn(id);
+  std::vector<float> block(4096);
+
+  // Preload is only 1024 frames and nobody services I/O
+  CHECK_EQ(streamer.render(voice, block.data(), block.size()), block.size());
+  CHECK_EQ(streamer.getUnderrunCount(), 1);
+  CHECK_EQ(streamer.getVoiceUnderrunCount(voice), 1);
+  CHECK_EQ(block.back(), 0.0f);
+  streamer.noteOff(voice);
+  CHECK_FALSE(streamer.isVoiceActive(voice));
+}
+
+TEST_CASE("background I/O thread keeps voices fed") {
+  wav::DiskStreamerOptions options = manualOptions();
+  options.backgroundThread = true;
+  options.preloadFrames = 8192;
+  options.ringFrames = 65536;
+  wav::DiskStreamer streamer(options);
+  const int id = streamer.addSample("resources/24b.wav");
+  const int voice = streamer.noteOn(id, -1, false);
+
+  std::vector<float> block(256);
+  std::size_t total = 0;
+  while (streamer.isVoiceActive(voice)) {
+    total += streamer.render(voice, block.data(), block.size());
+    std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+  CHECK_GE(total, 458505);
+}
+
+TEST_CASE("voice pool exhaustion and bad ids") {
+  wav::DiskStreamer streamer(manualOptions());
+  const int id = streamer.addSample("resources/24b96khz128samples.wav");
+  REQUIRE_GE(id, 0);
+  for (int i = 0; i < 4; ++i) {
+    CHECK_GE(streamer.noteOn(id), 0);
+  }
+  CHECK_EQ(streamer.noteOn(id), -1);
+  CHECK_EQ(streamer.noteOn(42), -1);
+  CHECK_EQ(streamer.addSample("non_existent_file.wav"), -1);
+}
+
+TEST_CASE("voices reused in quick succession never play another note's frames") {
+  const std::vector<float> plain = decodeAll("resources/24b.wav");
+  const std::vector<float> looped = decodeAll("resources/loop-cue.wav");
+  wav::DiskStreamerOptions options = manualOptions();
+  options.backgroundThread = true;
+  options.preloadFrames = 256;
+  options.ioBlockFrames = 128;
+  options.ringFrames = 1024;
+  options.maxVoices = 2;
+  wav::DiskStreamer streamer(options);
+  const int plainId = streamer.addSample("resources/24b.wav");
+  const int loopId = streamer.addSample("resources/loop-cue.wav");
+  REQUIRE_GE(plainId, 0);
+  REQUIRE_GE(loopId, 0);
+  const std::vector<wav::SampleLoop> loops = streamer.getSample(loopId).loops;
+
+  // Start, render a few blocks, stop and restart as fast as the pool allows; check every
+  // block rendered before the note's first underrun against the file it should come from
+  std::vector<float> block(64);
+  std::size_t notes = 0;
+  std::size_t mismatches = 0;
+  for (int i = 0; notes < 2000 && i < 1000000; ++i) {
+    const bool looping = i % 2 == 1;
+    const int loopIndex = looping ? i % static_cast<int>(loops.size()) : -1;
+    const int voice = looping ? streamer.noteOn(loopId, loopIndex) : streamer.noteOn(plainId, -1, false);
+    if (voice < 0) {
+      std::this_thread::yield(); // Both voices still waiting for the I/O thread to acknowledge noteOff()
+      continue;
+    }
+    ++notes;
+    const uint64_t underrunsBefore = streamer.getVoiceUnderrunCount(voice);
+    std::size_t position = 0;
+    for (int b = 0; b < 1 + i % 12; ++b) {
+      REQUIRE_EQ(streamer.render(voice, block.data(), block.size()), block.size());
+      if (streamer.getVoiceUnderrunCount(voice) != underrunsBefore) {
+        break;
+      }
+      for (std::size_t f = 0; f < block.size(); ++f, ++position) {
+        float expected = 0.0f;
+        if (looping) {
+          const wav::SampleLoop& loop = loops[static_cast<std::size_t>(loopIndex)];
+          const std::size_t length = static_cast<std::size_t>(loop.end - loop.start + 1);
+          expected = looped[static_cast<std::size_t>(loop.start) + position % length];
+        } else {
+          expected = plain[position];
+        }
+        mismatches += block[f] != expected;
+      }
+    }
+    streamer.noteOff(voice);
+  }
+  CHECK_EQ(notes, 2000);
+  CHECK_EQ(mismatches, 0);
+}
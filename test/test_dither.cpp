@@ -0,0 +1,212 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <wav/Dither.hpp>
+#include <wav/SampleConversion.hpp>
+
+static wav::FmtChunk pcmFormat(unsigned short channels, unsigned short bits) {
+  wav::FmtChunk fmt;
+  fmt.audioFormat = wav::AudioFormat::PCM;
+  fmt.numChannels = channels;
+  fmt.bitsPerSample = bits;
+  fmt.blockAlign = static_cast<unsigned short>(channels * bits / 8);
+  fmt.sampleRate = 44100;
+  return fmt;
+}
+
+static std::vector<float> sine(std::size_t count, double amplitude) {
+  std::vector<float> samples(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    samples[i] = float(amplitude * std::sin(2.0 * M_PI * 997.0 * double(i) / 44100.0));
+  }
+  return samples;
+}
+
+static std::vector<int32_t> decodePcm(const wav::FmtChunk& fmt, const std::vector<uint8_t>& bytes) {
+  const std::size_t stride = fmt.bitsPerSample / 8;
+  std::vector<float> floats(bytes.size() / stride);
+  REQUIRE(wav::convertToFloat(fmt, bytes.data(), floats.size(), floats.data()));
+  std::vector<int32_t> codes(floats.size());
+  for (std::size_t i = 0; i < floats.size(); ++i) {
+    codes[i] = static_cast<int32_t>(std::lround(floats[i] * float(1u << (fmt.bitsPerSample - 1))));
+  }
+  return codes;
+}
+
+TEST_CASE("quantizer kernels agree on every instruction set") {
+  std::vector<float> samples = sine(1003, 1.2); // Overdriven so clamping is exercised
+  samples[5] = std::nanf("");
+  std::vector<float> noise(1008);
+  uint32_t lanes[wav::kDitherLanes] = {1, 2, 3, 4, 5, 6, 7, 8};
+  wav::sampleKernelsFor(wav::Isa::Scalar).tpdfNoise(lanes, noise.data(), noise.size());
+
+  for (int i = 0; i < static_cast<int>(wav::Isa::Count); ++i) {
+    const wav::Isa isa = static_cast<wav::Isa>(i);
+    if (!wav::cpuFeatures().supports(isa)) {
+      continue;
+    }
+    const wav::SampleKernels& k = wav::sampleKernelsFor(isa);
+    const wav::SampleKernels& reference = wav::sampleKernelsFor(wav::Isa::Scalar);
+
+    std::vector<float> generated(noise.size());
+    uint32_t laneCopy[wav::kDitherLanes] = {1, 2, 3, 4, 5, 6, 7, 8};
+    k.tpdfNoise(laneCopy, generated.data(), generated.size());
+    CHECK(generated == noise);
+
+    const std::pair<wav::QuantizeKernel, wav::QuantizeKernel> pairs[] = {
+        {k.quantizeToPcm8, reference.quantizeToPcm8},
+        {k.quantizeToPcm16, reference.quantizeToPcm16},
+        {k.quantizeToPcm24, reference.quantizeToPcm24}};
+    std::size_t bytesPerSample = 1;
+    for (const auto& pair : pairs) {
+      for (const float* dither : {static_cast<const float*>(nullptr), static_cast<const float*>(noise.data())}) {
+        std::vector<uint8_t> expected(samples.size() * bytesPerSample + 1, 0xaa);
+        std::vector<uint8_t> actual(samples.size() * bytesPerSample + 1, 0xaa);
+        pair.second(samples.data(), dither, samples.size(), expected.data());
+        pair.first(samples.data(), dither, samples.size(), actual.data());
+        CHECK(expected == actual);
+      }
+      bytesPerSample = bytesPerSample == 1 ? 2 : 3;
+    }
+  }
+}
+
+TEST_CASE("TPDF noise is triangular within one LSB") {
+  std::vector<float> noise(1 << 16);
+  uint32_t lanes[wav::kDitherLanes] = {11, 22, 33, 44, 55, 66, 77, 88};
+  wav::sampleKernels().tpdfNoise(lanes, noise.data(), noise.size());
+  double sum = 0.0;
+  double sumSquares = 0.0;
+  for (float n : noise) {
+    REQUIRE(n > -1.0f);
+    REQUIRE(n < 1.0f);
+    sum += n;
+    sumSquares += double(n) * n;
+  }
+  CHECK(std::fabs(sum / noise.size()) < 0.01);
+  CHECK(sumSquares / noise.size() == doctest::Approx(1.0 / 6.0).epsilon(0.02)); // Variance of TPDF(-1, 1)
+}
+
+TEST_CASE("plain rounding without dither") {
+  const wav::FmtChunk fmt = pcmFormat(1, 16);
+  wav::DitherOptions options;
+  options.type = wav::DitherType::None;
+  wav::Ditherer ditherer(fmt, options);
+  const float samples[] = {0.0f, 0.5f, -1.0f, 1.0f, 100.5f / 32768.0f, -2.0f};
+  uint8_t pcm[sizeof(samples) / sizeof(float) * 2];
+  REQUIRE(ditherer.quantize(samples, 6, pcm));
+  const std::vector<int32_t> codes = decodePcm(fmt, std::vector<uint8_t>(pcm, pcm + sizeof(pcm)));
+  CHECK_EQ(codes[0], 0);
+  CHECK_EQ(codes[1], 16384);
+  CHECK_EQ(codes[2], -32768);
+  CHECK_EQ(codes[3], 32767);
+  CHECK_EQ(codes[4], 100); // Ties round to even
+  CHECK_EQ(codes[5], -32768);
+}
+
+TEST_CASE("dithered output is reproducible from the seed") {
+  const wav::FmtChunk fmt = pcmFormat(2, 24);
+  const std::vector<float> samples = sine(2 * 5000, 0.25);
+  std::vector<uint8_t> whole(samples.size() * 3);
+  wav::Ditherer a(fmt);
+  REQUIRE(a.quantize(samples.data(), 5000, whole.data()));
+
+  // Odd block sizes consume the same noise sequence
+  std::vector<uint8_t> blocks(samples.size() * 3);
+  wav::Ditherer b(fmt);
+  std::size_t frame = 0;
+  for (std::size_t size : {1u, 7u, 500u, 1023u, 3469u}) {
+    REQUIRE(b.quantize(samples.data() + 2 * frame, size, blocks.data() + 6 * frame));
+    frame += size;
+  }
+  REQUIRE_EQ(frame, 5000);
+  CHECK(whole == blocks);
+
+  // Every instruction set renders the same bytes
+  for (int i = 0; i < static_cast<int>(wav::Isa::Count); ++i) {
+    if (!wav::forceIsa(static_cast<wav::Isa>(i))) {
+      continue;
+    }
+    std::vector<uint8_t> forced(samples.size() * 3);
+    wav::Ditherer c(fmt);
+    REQUIRE(c.quantize(samples.data(), 5000, forced.data()));
+    CHECK(forced == whole);
+  }
+  wav::clearForcedIsa();
+
+  wav::DitherOptions otherSeed;
+  otherSeed.seed = 42;
+  wav::Ditherer d(fmt, otherSeed);
+  std::vector<uint8_t> different(samples.size() * 3);
+  REQUIRE(d.quantize(samples.data(), 5000, different.data()));
+  CHECK(different != whole);
+
+  b.reset();
+  REQUIRE(b.quantize(samples.data(), 5000, blocks.data()));
+  CHECK(whole == blocks);
+}
+
+TEST_CASE("TPDF dither decorrelates the error of a quiet signal") {
+  // A sine of 0.4 LSB rounds to silence without dither but survives as noise-modulated codes with it
+  const wav::FmtChunk fmt = pcmFormat(1, 16);
+  const std::vector<float> samples = sine(44100, 0.4 / 32768.0);
+  std::vector<uint8_t> pcm(samples.size() * 2);
+  wav::Ditherer ditherer(fmt);
+  REQUIRE(ditherer.quantize(samples.data(), samples.size(), pcm.data()));
+  const std::vector<int32_t> codes = decodePcm(fmt, pcm);
+  double correlation = 0.0;
+  for (std::size_t i = 0; i < codes.size(); ++i) {
+    CHECK(std::abs(codes[i]) <= 2);
+    correlation += codes[i] * double(samples[i]) * 32768.0;
+  }
+  CHECK(correlation / codes.size() == doctest::Approx(0.08).epsilon(0.2)); // E[q*x] = E[x^2] = 0.4^2 / 2
+}
+
+TEST_CASE("first-order noise shaping pushes the error to high frequencies") {
+  const wav::FmtChunk fmt = pcmFormat(2, 16);
+  const std::vector<float> samples = sine(2 * 44100, 0.3);
+
+  auto lagOneCorrelation = [&](wav::NoiseShaping shaping) {
+    wav::DitherOptions options;
+    options.shaping = shaping;
+    wav::Ditherer ditherer(fmt, options);
+    std::vector<uint8_t> pcm(samples.size() * 2);
+    REQUIRE(ditherer.quantize(samples.data(), 44100, pcm.data()));
+    const std::vector<int32_t> codes = decodePcm(fmt, pcm);
+    // Error of the left channel only: shaping runs per channel
+    std::vector<double> error;
+    for (std::size_t i = 0; i < codes.size(); i += 2) {
+      error.push_back(codes[i] - double(samples[i]) * 32768.0);
+    }
+    double c0 = 0.0;
+    double c1 = 0.0;
+    for (std::size_t i = 1; i < error.size(); ++i) {
+      c0 += error[i] * error[i];
+      c1 += error[i] * error[i - 1];
+    }
+    return c1 / c0;
+  };
+
+  CHECK(std::fabs(lagOneCorrelation(wav::NoiseShaping::None)) < 0.05);                           // White
+  CHECK(lagOneCorrelation(wav::NoiseShaping::FirstOrder) == doctest::Approx(-0.5).epsilon(0.1)); // 1 - z^-1
+  CHECK(lagOneCorrelation(wav::NoiseShaping::SecondOrder) < -0.6);
+}
+
+TEST_CASE("unsupported targets and 32-bit PCM") {
+  wav::FmtChunk floatTarget = pcmFormat(1, 32);
+  floatTarget.audioFormat = wav::AudioFormat::IEEE_FLOAT;
+  wav::Ditherer invalid(floatTarget);
+  const float samples[] = {0.5f, -1.0f, 1.0f};
+  uint8_t pcm[12];
+  CHECK_FALSE(invalid.quantize(samples, 3, pcm));
+
+  wav::Ditherer pcm32(pcmFormat(1, 32));
+  REQUIRE(pcm32.quantize(samples, 3, pcm));
+  int32_t codes[3];
+  std::memcpy(codes, pcm, sizeof(codes));
+  CHECK_EQ(codes[0], 1 << 30);
+  CHECK_EQ(codes[1], INT32_MIN);
+  CHECK_EQ(codes[2], INT32_MAX);
+}
@@ -0,0 +1,118 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include <cstring>
+#include <filesystem>
+#include <thread>
+#include <vector>
+#include <wav/FileCache.hpp>
+
+static std::vector<uint8_t> loadAll(const std::string& path) {
+  wav::WavFileUtils reader(path, wav::OpenOptions{wav::ReadMode::Full, false});
+  REQUIRE(reader.open());
+  return reader.getRawSampleData();
+}
+
+TEST_CASE("same file is loaded once") {
+  wav::FileCache cache;
+  auto first = cache.acquire("resources/loop-cue.wav");
+  auto second = cache.acquire("resources/loop-cue.wav");
+  REQUIRE(first);
+  CHECK_EQ(first.get(), second.get());
+  CHECK_EQ(cache.getStats().misses, 1);
+  CHECK_EQ(cache.getStats().hits, 1);
+
+  const std::vector<uint8_t> expected = loadAll("resources/loop-cue.wav");
+  REQUIRE_EQ(first->getSampleDataSize(), expected.size());
+  CHECK(std::memcmp(first->getSampleData(), expected.data(), expected.size()) == 0);
+  CHECK_EQ(first->getMetadata().getCueChunk().numCuePoints, 1);
+  CHECK_EQ(cache.memoryUsage(), expected.size());
+}
+
+TEST_CASE("heap buffer mode") {
+  wav::FileCacheOptions options;
+  options.useMmap = false;
+  wav::FileCache cache(options);
+  auto wav = cache.acquire("resources/24b96khz128samples.wav");
+  REQUIRE(wav);
+  CHECK_FALSE(wav->isMemoryMapped());
+  CHECK(std::memcmp(wav->getSampleData(), loadAll("resources/24b96khz128samples.wav").data(), 837) == 0);
+}
+
+TEST_CASE("lru eviction under memory budget") {
+  wav::FileCacheOptions options;
+  options.memoryBudgetBytes = 2000000; // Room for loop-cue.wav or 24b.wav, not both
+  wav::FileCache cache(options);
+
+  cache.acquire("resources/loop-cue.wav"); // Released right away
+  auto held = cache.acquire("resources/24b.wav");
+  REQUIRE(held);
+  CHECK_EQ(cache.size(), 1);
+  CHECK_EQ(cache.getStats().evictions, 1);
+  CHECK_EQ(cache.memoryUsage(), 1375515);
+
+  // Entries still in use are never evicted, even over budget
+  auto other = cache.acquire("resources/loop-cue.wav");
+  CHECK_EQ(cache.size(), 2);
+  CHECK_EQ(held->getSampleDataSize(), 1375515);
+
+  // Once released, an entry over budget goes without waiting for another acquire()
+  auto copy = other;
+  other.reset();
+  CHECK_EQ(cache.size(), 2);
+  copy.reset();
+  CHECK_EQ(cache.size(), 1);
+  CHECK_EQ(cache.getStats().evictions, 2);
+  CHECK_EQ(cache.memoryUsage(), 1375515);
+}
+
+TEST_CASE("files outlive the cache") {
+  std::shared_ptr<const wav::CachedWav> wav;
+  {
+    wav::FileCacheOptions options;
+    options.memoryBudgetBytes = 1;
+    wav::FileCache cache(options);
+    wav = cache.acquire("resources/24b.wav");
+  }
+  REQUIRE(wav);
+  CHECK_EQ(wav->getSampleDataSize(), 1375515);
+  wav.reset();
+}
+
+TEST_CASE("modified file is reloaded") {
+  const std::string copy = "cache_copy.wav";
+  std::filesystem::copy_file("resources/24b96khz128samples.wav", copy,
+                             std::filesystem::copy_options::overwrite_existing);
+  wav::FileCache cache;
+  auto before = cache.acquire(copy);
+  REQUIRE(before);
+
+  std::filesystem::copy_file("resources/loop-cue.wav", copy, std::filesystem::copy_options::overwrite_existing);
+  auto after = cache.acquire(copy);
+  REQUIRE(after);
+  CHECK_NE(before.get(), after.get());
+  CHECK_EQ(after->getFmtChunk().audioFormat, wav::AudioFormat::IEEE_FLOAT);
+  CHECK_EQ(before->getFmtChunk().audioFormat, wav::AudioFormat::PCM);
+  std::filesystem::remove(copy);
+}
+
+TEST_CASE("concurrent acquire shares one load") {
+  wav::FileCache cache;
+  std::vector<std::thread> threads;
+  std::vector<const wav::CachedWav*> seen(8);
+  for (std::size_t i = 0; i < seen.size(); ++i) {
+    threads.emplace_back([&, i] { seen[i] = cache.acquire("resources/loop-cue.wav").get(); });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (const auto* p : seen) {
+    CHECK_EQ(p, seen[0]);
+  }
+  CHECK_EQ(cache.getStats().misses, 1);
+}
+
+TEST_CASE("missing file") {
+  wav::FileCache cache;
+  CHECK_FALSE(cache.acquire("non_existent_file.wav"));
+  CHECK_EQ(cache.size(), 0);
+}
@@ -0,0 +1,147 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <wav/FloatSanitizer.hpp>
+#include <wav/FrameReader.hpp>
+
+static std::vector<wav::Isa> supportedIsas() {
+  std::vector<wav::Isa> isas;
+  for (int i = 0; i < static_cast<int>(wav::Isa::Count); ++i) {
+    if (wav::cpuFeatures().supports(static_cast<wav::Isa>(i))) {
+      isas.push_back(static_cast<wav::Isa>(i));
+    }
+  }
+  return isas;
+}
+
+/**
+ * @brief 1001 clean samples with bad values sprinkled over vector bodies and the scalar tail
+ */
+template <typename T>
+static std::vector<T> dirtySamples() {
+  std::vector<T> samples(1001);
+  for (std::size_t i = 0; i < samples.size(); ++i) {
+    samples[i] = T(std::sin(0.01 * double(i)) * 0.5);
+  }
+  samples[0] = std::numeric_limits<T>::quiet_NaN();
+  samples[17] = std::numeric_limits<T>::infinity();
+  samples[18] = -std::numeric_limits<T>::infinity();
+  samples[300] = std::numeric_limits<T>::denorm_min();
+  samples[301] = -std::numeric_limits<T>::denorm_min() * 3;
+  samples[999] = -std::numeric_limits<T>::quiet_NaN();
+  samples[1000] = std::numeric_limits<T>::min() / 2;
+  return samples;
+}
+
+template <typename T>
+static void checkSanitized(const std::vector<T>& samples, const std::vector<T>& original) {
+  CHECK_EQ(samples[0], T(0));
+  CHECK_EQ(samples[17], T(1));
+  CHECK_EQ(samples[18], T(-1));
+  CHECK_EQ(samples[300], T(0));
+  CHECK(std::signbit(samples[301]));
+  CHECK_EQ(samples[301], T(0));
+  CHECK_EQ(samples[999], T(0));
+  CHECK_EQ(samples[1000], T(0));
+  CHECK_EQ(samples[500], original[500]);
+}
+
+TEST_CASE("float32 scan-and-fix on every instruction set") {
+  const std::vector<float> original = dirtySamples<float>();
+  for (wav::Isa isa : supportedIsas()) {
+    std::vector<float> samples = original;
+    wav::SanitizeStats stats;
+    wav::sampleKernelsFor(isa).sanitizeFloat32(samples.data(), samples.size(), wav::SanitizeOptions{}, stats);
+    CHECK_EQ(stats.nans, 2);
+    CHECK_EQ(stats.infinities, 2);
+    CHECK_EQ(stats.denormals, 3);
+    checkSanitized(samples, original);
+  }
+}
+
+TEST_CASE("float64 scan-and-fix on every instruction set") {
+  const std::vector<double> original = dirtySamples<double>();
+  for (wav::Isa isa : supportedIsas()) {
+    std::vector<double> samples = original;
+    wav::SanitizeStats stats;
+    wav::sampleKernelsFor(isa).sanitizeFloat64(samples.data(), samples.size(), wav::SanitizeOptions{}, stats);
+    CHECK_EQ(stats.total(), 7);
+    checkSanitized(samples, original);
+  }
+}
+
+TEST_CASE("denormals are counted but kept when flushing is off") {
+  std::vector<float> samples = dirtySamples<float>();
+  wav::SanitizeOptions options;
+  options.flushDenormals = false;
+  options.nanReplacement = 0.25f;
+  wav::FloatSanitizer sanitizer(options);
+  sanitizer.process(samples.data(), samples.size());
+  CHECK_EQ(sanitizer.getStats().denormals, 3);
+  CHECK_EQ(samples[300], std::numeric_limits<float>::denorm_min());
+  CHECK_EQ(samples[0], 0.25f);
+
+  // A second pass finds nothing left to fix except the denormals
+  sanitizer.reset();
+  sanitizer.process(samples.data(), samples.size());
+  CHECK_EQ(sanitizer.getStats().total(), 3);
+}
+
+TEST_CASE("fused decode matches convertToFloat on clean files") {
+  wav::WavFileUtils reader("resources/loop-cue.wav", wav::OpenOptions{wav::ReadMode::Full, false});
+  REQUIRE(reader.open());
+  const auto& bytes = reader.getDataChunk().sampleDataInBytes;
+  const std::size_t numSamples = bytes.size() / 4;
+
+  std::vector<float> expected(numSamples);
+  std::vector<float> fused(numSamples);
+  REQUIRE(wav::convertToFloat(reader.getFmtChunk(), bytes.data(), numSamples, expected.data()));
+  wav::SanitizeStats stats;
+  REQUIRE(wav::convertToFloatSanitized(reader.getFmtChunk(), bytes.data(), numSamples, fused.data(),
+                                       wav::SanitizeOptions{}, stats));
+  CHECK(stats.clean());
+  CHECK(fused == expected);
+
+  // float64 values that do not fit in float become Inf / denormal when narrowed and are caught too
+  wav::FmtChunk fmt64;
+  fmt64.audioFormat = wav::AudioFormat::IEEE_FLOAT;
+  fmt64.bitsPerSample = 64;
+  const double wide[] = {1e300, 1e-40, 0.5};
+  float narrowed[3];
+  stats = wav::SanitizeStats{};
+  REQUIRE(wav::convertToFloatSanitized(fmt64, reinterpret_cast<const uint8_t*>(wide), 3, narrowed,
+                                       wav::SanitizeOptions{}, stats));
+  CHECK_EQ(stats.infinities, 1);
+  CHECK_EQ(stats.denormals, 1);
+  CHECK_EQ(narrowed[0], 1.0f);
+  CHECK_EQ(narrowed[1], 0.0f);
+  CHECK_EQ(narrowed[2], 0.5f);
+}
+
+TEST_CASE("streaming stage over raw frames") {
+  wav::FrameReader stream;
+  REQUIRE(stream.open("resources/loop-cue.wav"));
+  wav::FloatSanitizer sanitizer;
+  std::vector<uint8_t> block(1000 * stream.getFrameSize());
+  std::size_t total = 0;
+  while (std::size_t frames = stream.read(block.data(), 1000)) {
+    const std::size_t samples = frames * stream.getFmtChunk().numChannels;
+    // Poison one sample per block to check the counts add up across blocks
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    std::memcpy(block.data(), &nan, sizeof(nan));
+    REQUIRE(sanitizer.process(stream.getFmtChunk(), block.data(), samples));
+    float first;
+    std::memcpy(&first, block.data(), sizeof(first));
+    CHECK_EQ(first, 0.0f);
+    ++total;
+  }
+  CHECK_EQ(sanitizer.getStats().nans, total);
+
+  wav::FmtChunk pcm;
+  pcm.audioFormat = wav::AudioFormat::PCM;
+  pcm.bitsPerSample = 24;
+  CHECK_FALSE(sanitizer.process(pcm, block.data(), 1));
+}
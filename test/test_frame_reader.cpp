@@ -0,0 +1,76 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include <cstring>
+#include <vector>
+#include <wav/FrameReader.hpp>
+
+static std::vector<uint8_t> loadAll(const std::string& path) {
+  wav::WavFileUtils reader(path, wav::OpenOptions{wav::ReadMode::Full, false});
+  REQUIRE(reader.open());
+  return reader.getRawSampleData();
+}
+
+TEST_CASE("sequential stream matches full load") {
+  const std::vector<uint8_t> expected = loadAll("resources/24b.wav");
+
+  wav::StreamingHints hints;
+  hints.readAheadBytes = 64 * 1024;
+  wav::FrameReader stream;
+  REQUIRE(stream.open("resources/24b.wav", wav::AccessPattern::Sequential, hints));
+  CHECK_EQ(stream.getNumFrames(), 458505);
+  CHECK_EQ(stream.getFrameSize(), 3);
+  CHECK_EQ(stream.getDataOffset(), 44);
+
+  std::vector<uint8_t> streamed;
+  std::vector<uint8_t> block(1000 * stream.getFrameSize());
+  while (std::size_t frames = stream.read(block.data(), 1000)) {
+    streamed.insert(streamed.end(), block.begin(), block.begin() + frames * stream.getFrameSize());
+  }
+  CHECK_EQ(stream.tell(), stream.getNumFrames());
+  CHECK(streamed == expected);
+}
+
+TEST_CASE("random access reads") {
+  const std::vector<uint8_t> expected = loadAll("resources/loop-cue.wav");
+
+  wav::FrameReader reader;
+  REQUIRE(reader.open("resources/loop-cue.wav", wav::AccessPattern::Random));
+  const uint32_t cueFrame = reader.getMetadata().getCueChunk().cuePoints[0].sampleOffset;
+  reader.prefetch(cueFrame, 256);
+
+  std::vector<uint8_t> block(256 * reader.getFrameSize());
+  REQUIRE_EQ(reader.readAt(cueFrame, block.data(), 256), 256);
+  CHECK(std::memcmp(block.data(), expected.data() + cueFrame * 4, block.size()) == 0);
+  CHECK_EQ(reader.tell(), 0);
+
+  // Reads are clamped at the end of the data chunk
+  CHECK_EQ(reader.readAt(reader.getNumFrames() - 10, block.data(), 256), 10);
+  CHECK_EQ(reader.readAt(reader.getNumFrames(), block.data(), 256), 0);
+
+  REQUIRE(reader.seek(cueFrame));
+  REQUIRE_EQ(reader.read(block.data(), 16), 16);
+  CHECK(std::memcmp(block.data(), expected.data() + cueFrame * 4, 16 * 4) == 0);
+  CHECK_FALSE(reader.seek(reader.getNumFrames() + 1));
+}
+
+TEST_CASE("metadata only pattern") {
+  wav::FrameReader reader;
+  REQUIRE(reader.open("resources/loop-cue.wav", wav::AccessPattern::MetadataOnly));
+  CHECK_EQ(reader.getMetadata().getSampleRate(), 96000);
+  CHECK(reader.getMetadata().getDataChunk().sampleDataInBytes.empty());
+}
+
+TEST_CASE("invalid files") {
+  wav::FrameReader reader;
+  CHECK_FALSE(reader.open("non_existent_file.wav"));
+  CHECK_FALSE(reader.isOpen());
+}
+
+TEST_CASE("reader open options with access pattern") {
+  wav::OpenOptions options;
+  options.verbose = false;
+  options.accessPattern = wav::AccessPattern::Sequential;
+  wav::WavFileUtils reader("resources/24b.wav", options);
+  REQUIRE(reader.open());
+  CHECK_EQ(reader.getDataChunk().sampleDataInBytes.size(), 1375515);
+}
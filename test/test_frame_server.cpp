@@ -0,0 +1,134 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include <thread>
+#include <vector>
+#include <wav/FrameServer.hpp>
+
+#if WAV_HAVE_POSIX_IO
+
+static std::string socketPath() { return "/tmp/wav-frame-server-" + std::to_string(::getpid()) + ".sock"; }
+
+TEST_CASE("remote reads match local reads") {
+  wav::FrameServer server;
+  REQUIRE(server.start(socketPath()));
+
+  wav::FrameReader local;
+  REQUIRE(local.open("resources/24b.wav"));
+  wav::RemoteFrameReader remote(socketPath());
+  REQUIRE(remote.open("resources/24b.wav"));
+  CHECK_EQ(remote.getNumFrames(), local.getNumFrames());
+  CHECK_EQ(remote.getFrameSize(), local.getFrameSize());
+  CHECK_EQ(remote.getFmtChunk().sampleRate, local.getFmtChunk().sampleRate);
+  CHECK_EQ(remote.getFmtChunk().bitsPerSample, local.getFmtChunk().bitsPerSample);
+  CHECK_EQ(remote.getFmtChunk().numChannels, local.getFmtChunk().numChannels);
+
+  const std::size_t frameSize = local.getFrameSize();
+  std::vector<uint8_t> expected(1000 * frameSize);
+  std::vector<uint8_t> actual(1000 * frameSize);
+  bool match = true;
+  std::size_t total = 0;
+  while (std::size_t got = remote.read(actual.data(), 1000)) {
+    REQUIRE_EQ(local.read(expected.data(), 1000), got);
+    match = match && std::memcmp(actual.data(), expected.data(), got * frameSize) == 0;
+    total += got;
+  }
+  CHECK(match);
+  CHECK_EQ(total, local.getNumFrames());
+  CHECK_EQ(remote.tell(), local.getNumFrames());
+
+  // Ranges that run past the end are clamped, like FrameReader::readAt()
+  const uint64_t tail = local.getNumFrames() - 10;
+  CHECK_EQ(remote.readAt(tail, actual.data(), 1000), 10);
+  CHECK_EQ(local.readAt(tail, expected.data(), 1000), 10);
+  CHECK(std::memcmp(actual.data(), expected.data(), 10 * frameSize) == 0);
+  CHECK_EQ(remote.readAt(local.getNumFrames() + 5, actual.data(), 10), 0);
+  CHECK(remote.seek(5));
+  CHECK_FALSE(remote.seek(local.getNumFrames() + 1));
+  CHECK(remote.isOpen());
+}
+
+TEST_CASE("concurrent clients share the server") {
+  wav::FrameServer server;
+  REQUIRE(server.start(socketPath()));
+  wav::FrameReader local;
+  REQUIRE(local.open("resources/loop-cue.wav"));
+  std::vector<uint8_t> whole(local.getNumFrames() * local.getFrameSize());
+  REQUIRE_EQ(local.readAt(0, whole.data(), local.getNumFrames()), local.getNumFrames());
+
+  std::vector<int> matches(8, 0);
+  std::vector<std::thread> clients;
+  for (int t = 0; t < 8; ++t) {
+    clients.emplace_back([&, t] {
+      wav::RemoteFrameReader remote(socketPath());
+      if (!remote.open(t % 2 ? "resources/loop-cue.wav" : "./resources/loop-cue.wav")) {
+        return;
+      }
+      std::vector<uint8_t> frames(whole.size());
+      const std::size_t got = remote.readAt(0, frames.data(), remote.getNumFrames());
+      matches[t] = got == local.getNumFrames() && frames == whole;
+    });
+  }
+  for (std::thread& client : clients) {
+    client.join();
+  }
+  CHECK(std::count(matches.begin(), matches.end(), 1) == 8);
+}
+
+TEST_CASE("server refuses files it should not serve") {
+  wav::FrameServerOptions options;
+  options.libraryRoot = "resources";
+  wav::FrameServer server;
+  REQUIRE(server.start(socketPath(), options));
+
+  wav::RemoteFrameReader remote(socketPath());
+  CHECK(remote.open("24b.wav"));
+  CHECK(remote.open("/24b.wav")); // Absolute paths are taken relative to the library
+  CHECK_FALSE(remote.open("../CMakeLists.txt"));
+  CHECK_FALSE(remote.open("missing.wav"));
+  CHECK_FALSE(remote.isOpen());
+
+  // A client left connected does not block shutdown; its next read fails cleanly
+  REQUIRE(remote.open("24b.wav"));
+  server.stop();
+  std::vector<uint8_t> frames(16 * remote.getFrameSize());
+  CHECK_EQ(remote.readAt(0, frames.data(), 16), 0);
+  CHECK_FALSE(remote.isOpen());
+  CHECK_FALSE(wav::RemoteFrameReader(socketPath()).open("24b.wav"));
+}
+
+TEST_CASE("a file that is slow to open does not hold up other clients") {
+  wav::FrameServer server;
+  REQUIRE(server.start(socketPath()));
+  const std::string fifo = "slow-" + std::to_string(::getpid()) + ".wav";
+  REQUIRE(::mkfifo(fifo.c_str(), 0600) == 0);
+
+  // Opening a FIFO blocks until a writer shows up, like a file on a stalled network mount
+  std::thread slowClient([&] { CHECK_FALSE(wav::RemoteFrameReader(socketPath()).open(fifo)); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  std::atomic<bool> done{false};
+  std::thread watchdog([&] {
+    for (int i = 0; i < 500 && !done; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    ::close(::open(fifo.c_str(), O_WRONLY)); // Release the slow open; an empty file is not a WAV file
+  });
+  const auto start = std::chrono::steady_clock::now();
+  wav::RemoteFrameReader remote(socketPath());
+  CHECK(remote.open("resources/24b.wav"));
+  CHECK(wav::RemoteFrameReader(socketPath()).open("resources/24b.wav"));     // A new connection is accepted too
+  CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(2)); // Without waiting for the watchdog
+  done = true;
+  watchdog.join();
+  slowClient.join();
+  std::remove(fifo.c_str());
+}
+
+#endif
@@ -0,0 +1,102 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#define WAV_ENABLE_INSTRUMENTATION 1
+#include "doctest/doctest.h"
+#include "WavFixtures.hpp"
+#include <cstdio>
+#include <sstream>
+#include <wav/WavFileUtils.hpp>
+
+TEST_CASE("read stats are collected") {
+  wav::WavFileUtils reader("resources/loop-cue.wav", wav::OpenOptions{wav::ReadMode::Full, false});
+  REQUIRE(reader.open());
+
+  const wav::ReadStats& stats = reader.getReadStats();
+  CHECK_GT(stats.readCalls, 0);
+  CHECK_GE(stats.bytesRead, 1834020);
+  CHECK_GT(stats.seekCalls, 0);
+  CHECK_GE(stats.allocatedBytes, 1834020);
+  CHECK_GT(stats.nanos(wav::ReadPhase::Open), 0);
+  CHECK_GE(stats.nanos(wav::ReadPhase::Open), stats.nanos(wav::ReadPhase::Data));
+}
+
+TEST_CASE("metadata only reads fewer bytes") {
+  wav::WavFileUtils reader("resources/loop-cue.wav", wav::OpenOptions{wav::ReadMode::MetadataOnly, false});
+  REQUIRE(reader.open());
+  CHECK_LE(reader.getReadStats().bytesRead, 4096);
+  CHECK_LE(reader.getReadStats().readCalls, 2);
+}
+
+// 16-bit mono PCM file with numCues cue points and a LIST chunk after 64 KiB of samples
+static void writeCueHeavyFile(const std::string& path, uint32_t numCues) {
+  std::vector<uint8_t> cue;
+  wav::detail::putLE32(cue, numCues);
+  for (uint32_t i = 0; i < numCues; ++i) {
+    wav::detail::putLE32(cue, i + 1); // identifier
+    wav::detail::putLE32(cue, 0);     // position
+    cue.insert(cue.end(), {'d', 'a', 't', 'a'});
+    wav::detail::putLE32(cue, 0);     // chunk start
+    wav::detail::putLE32(cue, 0);     // block start
+    wav::detail::putLE32(cue, i * 7); // sample offset
+  }
+  const std::vector<uint8_t> list = {'a', 'd', 't', 'l', 'a', 'b', 'c', 'd', 'e', 'f'};
+  wavtest::writeFile(path, wavtest::wavFile(wavtest::kPcm, 1, 48000, 16, std::vector<uint8_t>(65536),
+                                            {{"cue ", cue}, {"LIST", list}}));
+}
+
+TEST_CASE("metadata chunks after the samples are read in one window") {
+  const std::string path = "cue-heavy.wav";
+  writeCueHeavyFile(path, 2000);
+
+  wav::WavFileUtils reader(path, wav::OpenOptions{wav::ReadMode::MetadataOnly, false});
+  REQUIRE(reader.open());
+  const wav::CueChunk& cue = reader.getCueChunk();
+  CHECK_EQ(cue.chunkSize, 4 + 24 * 2000);
+  REQUIRE_EQ(cue.cuePoints.size(), 2000);
+  CHECK_EQ(cue.cuePoints[1999].identifier, 2000);
+  CHECK_EQ(cue.cuePoints[1999].sampleOffset, 1999 * 7);
+  REQUIRE_EQ(reader.getChunkList().size(), 4);
+  CHECK(reader.getChunkList()[3].id == wav::Id::fromChars("LIST"));
+
+  // Header probe, then one window holding the whole cue chunk and the LIST chunk behind it
+  CHECK_LE(reader.getReadStats().readCalls, 2);
+  CHECK_LE(reader.getReadStats().bytesRead, 4096 + 4 + 24 * 2000 + 8 + 8 + 10);
+  std::remove(path.c_str());
+}
+
+TEST_CASE("chrome trace output") {
+  wav::TraceRecorder& recorder = wav::TraceRecorder::instance();
+  recorder.clear();
+  recorder.setEnabled(true);
+
+  wav::WavFileUtils reader("resources/24b96khz128samples.wav", wav::OpenOptions{wav::ReadMode::Full, false});
+  REQUIRE(reader.open());
+  recorder.setEnabled(false);
+
+  const auto events = recorder.events();
+  REQUIRE_GE(events.size(), 4);
+
+  std::ostringstream json;
+  recorder.writeChromeTrace(json);
+  CHECK_NE(json.str().find("\"traceEvents\""), std::string::npos);
+  CHECK_NE(json.str().find("\"name\":\"data\""), std::string::npos);
+  CHECK_NE(json.str().find("\"ph\":\"X\""), std::string::npos);
+  recorder.clear();
+}
+
+TEST_CASE("chrome trace escapes file paths") {
+  wav::TraceRecorder& recorder = wav::TraceRecorder::instance();
+  recorder.clear();
+  recorder.setEnabled(true);
+  wav::TraceEvent event;
+  event.name = "open";
+  event.file = std::string("take \"1\"\\a\nb\tc\x01.wav");
+  recorder.record(event);
+  recorder.setEnabled(false);
+
+  std::ostringstream json;
+  recorder.writeChromeTrace(json);
+  CHECK_NE(json.str().find("\"file\":\"take \\\"1\\\"\\\\a\\nb\\tc\\u0001.wav\""), std::string::npos);
+  CHECK_EQ(json.str().find('\t'), std::string::npos); // No raw control characters inside the strings
+  CHECK_EQ(json.str().find('\x01'), std::string::npos);
+  recorder.clear();
+}
@@ -0,0 +1,172 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include "WavFixtures.hpp"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <wav/LosslessCodec.hpp>
+
+// Noisy sine per channel; extraBytes appends a partial frame to the data chunk, followed by a LIST chunk
+static std::vector<uint8_t> makeWav(uint16_t format, uint16_t channels, uint16_t bits, uint32_t frames,
+                                    uint32_t extraBytes = 0) {
+  const uint16_t width = bits / 8;
+  std::mt19937 rng(7);
+  std::normal_distribution<double> noise(0.0, 1.0);
+  std::vector<uint8_t> data;
+  for (uint32_t f = 0; f < frames; ++f) {
+    for (uint16_t c = 0; c < channels; ++c) {
+      const double v = 0.5 * std::sin(0.01 * f * (c + 1)) + 0.3 * std::sin(0.137 * f + c);
+      if (format == 3) {
+        const float sample = static_cast<float>(v);
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&sample);
+        data.insert(data.end(), p, p + 4);
+        continue;
+      }
+      const double scale = std::ldexp(1.0, bits - 1) - 1.0;
+      const int64_t q = std::llround(v * scale + noise(rng) * 4.0);
+      const uint32_t code = bits == 8 ? static_cast<uint32_t>(q + 128) : static_cast<uint32_t>(q);
+      for (uint16_t b = 0; b < width; ++b) {
+        data.push_back(static_cast<uint8_t>(code >> (8 * b)));
+      }
+    }
+  }
+  for (uint32_t i = 0; i < extraBytes; ++i) {
+    data.push_back(static_cast<uint8_t>(i + 1));
+  }
+
+  return wavtest::wavFile(format, channels, 48000, bits, data, {{"LIST", {'I', 'N', 'F', 'O'}}});
+}
+
+static void checkRoundTrip(const std::string& path, const wav::CodecOptions& options) {
+  REQUIRE(wav::compressWav(path, "archive.wlpc", options));
+  REQUIRE(wav::decompressWav("archive.wlpc", "restored.wav", options.threads));
+  CHECK(wavtest::readFile("restored.wav") == wavtest::readFile(path));
+  std::remove("archive.wlpc");
+  std::remove("restored.wav");
+}
+
+TEST_CASE("resource files round-trip bit-exactly") {
+  for (const char* path : {"resources/24b.wav", "resources/24b96khz128samples.wav", "resources/loop-cue.wav"}) {
+    CAPTURE(path);
+    checkRoundTrip(path, wav::CodecOptions{});
+  }
+}
+
+TEST_CASE("every PCM width and odd layouts round-trip") {
+  struct Layout {
+    uint16_t format;
+    uint16_t channels;
+    uint16_t bits;
+    uint32_t frames;
+    uint32_t extraBytes;
+  };
+  const Layout layouts[] = {{1, 2, 16, 20000, 0}, {1, 1, 8, 9999, 1}, {1, 3, 24, 5000, 5},
+                            {1, 2, 32, 7000, 0},  {3, 2, 32, 3000, 0}, {1, 6, 16, 1, 0}};
+  for (const Layout& layout : layouts) {
+    for (unsigned threads : {0u, 3u}) {
+      CAPTURE(layout.bits);
+      CAPTURE(layout.channels);
+      wavtest::writeFile("codec.wav",
+                         makeWav(layout.format, layout.channels, layout.bits, layout.frames, layout.extraBytes));
+      wav::CodecOptions options;
+      options.threads = threads;
+      options.blockFrames = 1000; // Several blocks and a short last one
+      checkRoundTrip("codec.wav", options);
+    }
+  }
+  std::remove("codec.wav");
+}
+
+TEST_CASE("PCM compresses and float is stored raw") {
+  wavtest::writeFile("codec.wav", makeWav(1, 2, 16, 48000));
+  REQUIRE(wav::compressWav("codec.wav", "archive.wlpc"));
+  CHECK(wavtest::readFile("archive.wlpc").size() < wavtest::readFile("codec.wav").size() * 6 / 10);
+
+  wavtest::writeFile("codec.wav", makeWav(3, 2, 32, 4096));
+  REQUIRE(wav::compressWav("codec.wav", "archive.wlpc"));
+  CHECK(wavtest::readFile("archive.wlpc").size() > wavtest::readFile("codec.wav").size());
+  std::remove("archive.wlpc");
+  std::remove("codec.wav");
+}
+
+TEST_CASE("archive frames are readable at any position") {
+  const std::vector<uint8_t> original = makeWav(1, 2, 24, 30000);
+  wavtest::writeFile("codec.wav", original);
+  wav::CodecOptions options;
+  options.blockFrames = 4096;
+  REQUIRE(wav::compressWav("codec.wav", "archive.wlpc", options));
+
+  wav::CompressedWavReader archive;
+  REQUIRE(archive.open("archive.wlpc"));
+  CHECK_EQ(archive.getNumFrames(), 30000);
+  CHECK_EQ(archive.getNumBlocks(), 8);
+  CHECK_EQ(archive.getFmtChunk().bitsPerSample, 24);
+  CHECK_EQ(archive.getFmtChunk().numChannels, 2);
+  CHECK_EQ(archive.getHeaderBytes().size(), 44);
+  CHECK_EQ(archive.getTrailerBytes().size(), 12);
+
+  const std::size_t frameSize = archive.getFrameSize();
+  for (uint64_t frame : {0ull, 4095ull, 12000ull, 29990ull}) {
+    std::vector<uint8_t> frames(5000 * frameSize);
+    const std::size_t got = archive.readAt(frame, frames.data(), 5000);
+    CHECK_EQ(got, std::min<uint64_t>(5000, 30000 - frame));
+    CHECK(std::equal(frames.begin(), frames.begin() + long(got * frameSize),
+                     original.begin() + 44 + long(frame * frameSize)));
+  }
+  std::remove("archive.wlpc");
+  std::remove("codec.wav");
+}
+
+TEST_CASE("damaged archives are rejected") {
+  wavtest::writeFile("codec.wav", makeWav(1, 2, 16, 10000));
+  REQUIRE(wav::compressWav("codec.wav", "archive.wlpc"));
+  std::vector<uint8_t> bytes = wavtest::readFile("archive.wlpc");
+
+  std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 100);
+  wavtest::writeFile("damaged.wlpc", truncated);
+  CHECK_FALSE(wav::decompressWav("damaged.wlpc", "restored.wav"));
+
+  bytes[0] = 'X';
+  wavtest::writeFile("damaged.wlpc", bytes);
+  wav::CompressedWavReader archive;
+  CHECK_FALSE(archive.open("damaged.wlpc"));
+  for (const char* path : {"archive.wlpc", "damaged.wlpc", "restored.wav", "codec.wav"}) {
+    std::remove(path);
+  }
+}
+
+TEST_CASE("archives with a damaged header are rejected") {
+  wavtest::writeFile("codec.wav", wavtest::wavFile(wavtest::kPcm, 2, 48000, 16, std::vector<uint8_t>(4096 * 4)));
+  REQUIRE(wav::compressWav("codec.wav", "archive.wlpc"));
+  const std::vector<uint8_t> original = wavtest::readFile("archive.wlpc");
+
+  // Overwrite the header field at offset, then open and read the first block
+  auto damage = [&](std::size_t offset, const std::vector<uint8_t>& field) {
+    std::vector<uint8_t> bytes = original;
+    std::copy(field.begin(), field.end(), bytes.begin() + long(offset));
+    wavtest::writeFile("damaged.wlpc", bytes);
+    wav::CompressedWavReader archive;
+    std::vector<uint8_t> frames(4096 * 4);
+    return archive.open("damaged.wlpc") && archive.readAt(0, frames.data(), 4096) == 4096;
+  };
+  auto le64 = [](uint64_t v) {
+    std::vector<uint8_t> out;
+    wav::detail::putLE64(out, v);
+    return out;
+  };
+  CHECK(damage(0, {}));
+  CHECK_FALSE(damage(10, {0, 0}));                  // No channels
+  CHECK_FALSE(damage(16, {32, 0}));                 // Bit depth disagrees with blockAlign
+  CHECK_FALSE(damage(16, {12, 0}));                 // Bit depth the coder cannot produce
+  CHECK_FALSE(damage(18, {0, 0}));                  // No blockAlign
+  CHECK_FALSE(damage(21, {2}));                     // Unknown coded flag
+  CHECK_FALSE(damage(21, {0}));                     // Coded block in an archive that says it holds raw blocks only
+  CHECK_FALSE(damage(40, le64(~uint64_t(0) - 63))); // Prefix size wraps the seek table offset
+  CHECK_FALSE(damage(56, le64(uint64_t(1) << 61))); // Seek table size wraps
+  CHECK_FALSE(damage(24, {1, 0, 0, 0}));            // Block count does not match the frames
+  for (const char* path : {"archive.wlpc", "damaged.wlpc", "codec.wav"}) {
+    std::remove(path);
+  }
+}
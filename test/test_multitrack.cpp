@@ -0,0 +1,97 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include "WavFixtures.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <wav/MultitrackReader.hpp>
+
+// 16-bit PCM track whose sample for (frame, channel) is track * 1000 + frame % 500 + channel * 100
+static std::string writeTrack(unsigned track, uint16_t channels, uint32_t frames, uint32_t sampleRate = 48000) {
+  std::vector<uint8_t> data;
+  for (uint32_t f = 0; f < frames; ++f) {
+    for (uint16_t c = 0; c < channels; ++c) {
+      wavtest::putS16(data, static_cast<int16_t>(track * 1000 + f % 500 + c * 100));
+    }
+  }
+  return wavtest::writeFile("track" + std::to_string(track) + ".wav",
+                            wavtest::wavFile(wavtest::kPcm, channels, sampleRate, 16, data));
+}
+
+static float expected(unsigned track, uint32_t frame, unsigned channel) {
+  return float(track * 1000 + frame % 500 + channel * 100) / 32768.0f;
+}
+
+TEST_CASE("mono tracks stream in lockstep") {
+  for (unsigned threads : {0u, 3u, 8u}) {
+    CAPTURE(threads);
+    std::vector<std::string> paths;
+    for (unsigned t = 0; t < 16; ++t) {
+      paths.push_back(writeTrack(t, 1, 10000));
+    }
+    wav::MultitrackOptions options;
+    options.ioThreads = threads;
+    wav::MultitrackReader session(options);
+    REQUIRE(session.open(paths));
+    CHECK_EQ(session.getNumTracks(), 16);
+    CHECK_EQ(session.getNumChannels(), 16);
+    CHECK_EQ(session.getNumFrames(), 10000);
+    CHECK_EQ(session.getSampleRate(), 48000);
+
+    std::vector<float> block(777 * 16);
+    uint32_t frame = 0;
+    bool match = true;
+    while (std::size_t got = session.readInterleaved(block.data(), 777)) {
+      for (std::size_t f = 0; f < got; ++f) {
+        for (unsigned t = 0; t < 16; ++t) {
+          match = match && block[f * 16 + t] == expected(t, frame + f, 0);
+        }
+      }
+      frame += static_cast<uint32_t>(got);
+    }
+    CHECK(match);
+    CHECK_EQ(frame, 10000);
+    CHECK_EQ(session.tell(), 10000);
+    for (const std::string& path : paths) {
+      std::remove(path.c_str());
+    }
+  }
+}
+
+TEST_CASE("planar output, mixed channel counts and lengths") {
+  const std::vector<std::string> paths = {writeTrack(0, 1, 3000), writeTrack(1, 2, 5000), writeTrack(2, 1, 4000)};
+  wav::MultitrackReader session;
+  REQUIRE(session.open(paths));
+  REQUIRE_EQ(session.getNumChannels(), 4);
+  CHECK_EQ(session.getNumFrames(), 5000);
+
+  REQUIRE(session.seek(2900));
+  std::vector<std::vector<float>> planes(4, std::vector<float>(2500, -1.0f));
+  float* const dst[] = {planes[0].data(), planes[1].data(), planes[2].data(), planes[3].data()};
+  REQUIRE_EQ(session.readPlanar(dst, 2500), 2100);
+
+  CHECK_EQ(planes[0][0], expected(0, 2900, 0));
+  CHECK_EQ(planes[0][99], expected(0, 2999, 0));
+  CHECK_EQ(planes[0][100], 0.0f); // Track 0 ended at frame 3000
+  CHECK_EQ(planes[1][0], expected(1, 2900, 0));
+  CHECK_EQ(planes[2][0], expected(1, 2900, 1));
+  CHECK_EQ(planes[2][2099], expected(1, 4999, 1));
+  CHECK_EQ(planes[3][1099], expected(2, 3999, 0));
+  CHECK_EQ(planes[3][1100], 0.0f);
+  CHECK_EQ(session.readPlanar(dst, 2500), 0);
+  for (const std::string& path : paths) {
+    std::remove(path.c_str());
+  }
+}
+
+TEST_CASE("incompatible tracks are rejected") {
+  const std::vector<std::string> paths = {writeTrack(0, 1, 100), writeTrack(1, 1, 100, 44100)};
+  wav::MultitrackReader session;
+  CHECK_FALSE(session.open(paths));
+  CHECK_FALSE(session.isOpen());
+  CHECK_FALSE(session.open({paths[0], "does-not-exist.wav"}));
+  CHECK_FALSE(session.open({}));
+  for (const std::string& path : paths) {
+    std::remove(path.c_str());
+  }
+}
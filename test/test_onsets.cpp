@@ -0,0 +1,158 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include "WavFixtures.hpp"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include <wav/OnsetDetector.hpp>
+
+static const std::vector<uint32_t> kHits = {0, 11025, 22050, 27563, 33075, 60000};
+static constexpr uint32_t kFrames = 88200;
+
+// 16-bit stereo drum-like loop: decaying noise bursts at kHits over a -70 dB noise bed
+static std::string writeLoop(const std::string& path) {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+  std::vector<float> mono(kFrames);
+  for (float& s : mono) {
+    s = 0.0003f * noise(rng);
+  }
+  for (uint32_t hit : kHits) {
+    for (uint32_t i = 0; hit + i < kFrames && i < 8000; ++i) {
+      mono[hit + i] += 0.8f * std::exp(-float(i) / 1300.0f) * noise(rng);
+    }
+  }
+
+  std::vector<uint8_t> data;
+  for (float s : mono) {
+    const int16_t v = static_cast<int16_t>(std::lround(std::max(-1.0f, std::min(1.0f, s)) * 32767.0f));
+    wavtest::putS16(data, v);
+    wavtest::putS16(data, v);
+  }
+  return wavtest::writeFile(path, wavtest::wavFile(wavtest::kPcm, 2, 44100, 16, data));
+}
+
+static bool matchesHits(const std::vector<uint64_t>& onsets) {
+  if (onsets.size() != kHits.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < onsets.size(); ++i) {
+    if (onsets[i] < kHits[i] || onsets[i] > kHits[i] + 32) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST_CASE("Onsets land on the attacks of a drum loop") {
+  const std::string path = writeLoop("onset_loop.wav");
+  std::vector<uint64_t> onsets;
+  REQUIRE(wav::detectOnsets(path, onsets));
+  CAPTURE(onsets.size());
+  CHECK(matchesHits(onsets));
+  std::remove(path.c_str());
+}
+
+TEST_CASE("Block size does not change the result") {
+  const std::string path = writeLoop("onset_blocks.wav");
+  wav::FrameReader reader;
+  REQUIRE(reader.open(path));
+  std::vector<uint8_t> raw(kFrames * reader.getFrameSize());
+  REQUIRE(reader.read(raw.data(), kFrames) == kFrames);
+  std::vector<float> samples(kFrames * 2);
+  wav::convertToFloat(reader.getFmtChunk(), raw.data(), samples.size(), samples.data());
+
+  wav::OnsetDetector whole(44100, 2);
+  whole.process(samples.data(), kFrames);
+  whole.finish();
+
+  wav::OnsetDetector pieces(44100, 2);
+  std::mt19937 rng(3);
+  for (std::size_t frame = 0; frame < kFrames;) {
+    const std::size_t count = std::min<std::size_t>(1 + rng() % 700, kFrames - frame);
+    pieces.process(samples.data() + frame * 2, count);
+    frame += count;
+  }
+  pieces.finish();
+  CHECK(whole.getOnsets() == pieces.getOnsets());
+  CHECK(matchesHits(pieces.getOnsets()));
+  std::remove(path.c_str());
+}
+
+TEST_CASE("Onsets are written back as labelled cue points") {
+  const std::string path = writeLoop("onset_cues.wav");
+  const uint64_t sizeBefore = std::filesystem::file_size(path);
+  REQUIRE(wav::addOnsetCues(path));
+
+  wav::OpenOptions options;
+  options.verbose = false;
+  wav::WavFileUtils reader(path, options);
+  REQUIRE(reader.open());
+  const auto& cues = reader.getCueChunk().cuePoints;
+  REQUIRE(cues.size() == kHits.size());
+  REQUIRE(reader.getLabels().size() == kHits.size());
+  for (std::size_t i = 0; i < cues.size(); ++i) {
+    CHECK(cues[i].identifier == i + 1);
+    CHECK(cues[i].sampleOffset >= kHits[i]);
+    CHECK(cues[i].sampleOffset <= kHits[i] + 32);
+    CHECK(reader.getLabels()[i].cuePointId == long(i + 1));
+    CHECK(reader.getLabels()[i].text == "Onset " + std::to_string(i + 1));
+  }
+  CHECK(reader.getDataChunk().chunkSize == kFrames * 4);
+
+  // Running again replaces the trailing chunks instead of appending more
+  const uint64_t sizeAfter = std::filesystem::file_size(path);
+  CHECK(sizeAfter > sizeBefore);
+  REQUIRE(wav::addOnsetCues(path));
+  CHECK(std::filesystem::file_size(path) == sizeAfter);
+  std::remove(path.c_str());
+}
+
+TEST_CASE("Cue chunks in front of the samples are turned into JUNK") {
+  const std::string path = "onset_loop_cue.wav";
+  std::filesystem::copy_file("resources/loop-cue.wav", path, std::filesystem::copy_options::overwrite_existing);
+  wav::OpenOptions options;
+  options.verbose = false;
+  wav::WavFileUtils original("resources/loop-cue.wav", options);
+  REQUIRE(original.open());
+
+  wav::CuePoint cue;
+  cue.identifier = 9;
+  cue.position = cue.sampleOffset = 123;
+  cue.fccChunk = wav::Id::fromChars("data");
+  wav::LabelChunk label;
+  label.cuePointId = 9;
+  label.text = "Kick";
+  REQUIRE(wav::writeCuePoints(path, {cue}, {label}));
+
+  wav::WavFileUtils edited(path, options);
+  REQUIRE(edited.open());
+  REQUIRE(edited.getCueChunk().cuePoints.size() == 1);
+  CHECK(edited.getCueChunk().cuePoints[0].sampleOffset == 123);
+  REQUIRE(edited.getLabels().size() == 1);
+  CHECK(edited.getLabels()[0].text == "Kick");
+  CHECK(edited.getRawSampleData() == original.getRawSampleData());
+  CHECK(edited.getSamplerChunk().numSampleLoops == original.getSamplerChunk().numSampleLoops);
+  std::remove(path.c_str());
+}
+
+TEST_CASE("A batch of loops is processed in parallel") {
+  std::vector<std::string> paths;
+  for (int i = 0; i < 24; ++i) {
+    paths.push_back(writeLoop("onset_batch" + std::to_string(i) + ".wav"));
+  }
+  paths.push_back("does_not_exist.wav");
+  CHECK(wav::addOnsetCues(paths, wav::OnsetOptions{}, 4) == 24);
+
+  wav::OpenOptions options;
+  options.verbose = false;
+  for (int i = 0; i < 24; ++i) {
+    wav::WavFileUtils reader(paths[i], options);
+    REQUIRE(reader.open());
+    CHECK(reader.getCueChunk().cuePoints.size() == kHits.size());
+    std::remove(paths[i].c_str());
+  }
+}
@@ -0,0 +1,139 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include "WavFixtures.hpp"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+#include <wav/PitchDetector.hpp>
+
+static double midiFrequency(double note) { return 440.0 * std::pow(2.0, (note - 69.0) / 12.0); }
+
+/**
+ * @brief 16-bit mono note: a noisy attack, then a harmonic tone at the given MIDI pitch, decaying slowly
+ */
+static std::string writeNote(const std::string& path, double note, uint32_t sampleRate = 48000, double seconds = 2.0) {
+  const uint32_t frames = static_cast<uint32_t>(seconds * sampleRate);
+  const double f0 = midiFrequency(note);
+  std::mt19937 rng(11);
+  std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+
+  std::vector<uint8_t> data;
+  for (uint32_t i = 0; i < frames; ++i) {
+    const double t = double(i) / sampleRate;
+    double s = 0.0;
+    for (int h = 1; h <= 6; ++h) {
+      s += std::sin(2.0 * 3.141592653589793 * f0 * h * t) / h;
+    }
+    s *= 0.4 * std::exp(-t / 1.5);
+    s += i < sampleRate / 50 ? 0.5 * noise(rng) : 0.0; // 20 ms hammer noise
+    wavtest::putS16(data, static_cast<int16_t>(std::lround(std::max(-1.0, std::min(1.0, s)) * 32767.0)));
+  }
+  return wavtest::writeFile(path, wavtest::wavFile(wavtest::kPcm, 1, sampleRate, 16, data));
+}
+
+TEST_CASE("Harmonic notes are tuned to within 2 cents") {
+  for (double note : {33.0, 45.3, 60.0, 69.0, 81.7, 93.0}) {
+    const std::string path = writeNote("pitch_note.wav", note);
+    wav::PitchEstimate pitch;
+    REQUIRE(wav::detectPitch(path, pitch));
+    CAPTURE(note);
+    CAPTURE(pitch.midiNote);
+    CHECK(std::fabs(pitch.midiNote - note) < 0.02); // 2 cents
+    CHECK(pitch.confidence > 0.9f);
+    std::remove(path.c_str());
+  }
+}
+
+TEST_CASE("Unity note and pitch fraction follow the smpl definitions") {
+  wav::PitchEstimate pitch;
+  pitch.midiNote = 60.25;
+  CHECK(pitch.unityNote() == 60);
+  CHECK(pitch.pitchFraction() == 0x40000000u);
+  pitch.midiNote = 69.0;
+  CHECK(pitch.unityNote() == 69);
+  CHECK(pitch.pitchFraction() == 0);
+}
+
+TEST_CASE("Silence and noise are not given a pitch") {
+  const uint32_t frames = 48000;
+  std::vector<float> noise(frames);
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<float> uniform(-0.5f, 0.5f);
+  for (float& s : noise) {
+    s = uniform(rng);
+  }
+  wav::PitchDetector detector(48000);
+  REQUIRE(detector.getWindowFrames() < frames);
+  wav::PitchEstimate pitch;
+  if (detector.estimate(noise.data(), pitch)) {
+    CHECK(pitch.confidence < 0.8f);
+  }
+  std::vector<float> silence(frames, 0.0f);
+  CHECK_FALSE(detector.estimate(silence.data(), pitch));
+}
+
+TEST_CASE("A smpl chunk is added to files without one") {
+  const std::string path = writeNote("pitch_new_smpl.wav", 57.3);
+  wav::PitchEstimate pitch;
+  REQUIRE(wav::addPitchToSampler(path, wav::PitchOptions{}, &pitch));
+
+  wav::OpenOptions options;
+  options.verbose = false;
+  wav::WavFileUtils reader(path, options);
+  REQUIRE(reader.open());
+  const wav::SamplerChunk& smpl = reader.getSamplerChunk();
+  CHECK(smpl.midiUnityNote == 57);
+  CHECK(std::fabs(double(uint32_t(smpl.midiPitchFraction)) / 4294967296.0 - 0.3) < 0.02);
+  CHECK(smpl.samplePeriod == 20833); // 1e9 / 48000 ns
+  CHECK(smpl.numSampleLoops == 0);
+  CHECK(reader.getDataChunk().chunkSize == 2 * 96000);
+  std::remove(path.c_str());
+}
+
+TEST_CASE("An existing smpl chunk keeps its loops") {
+  const std::string path = "pitch_loop_cue.wav";
+  std::filesystem::copy_file("resources/loop-cue.wav", path, std::filesystem::copy_options::overwrite_existing);
+  wav::OpenOptions options;
+  options.verbose = false;
+  wav::WavFileUtils original("resources/loop-cue.wav", options);
+  REQUIRE(original.open());
+  REQUIRE(wav::writeSamplerPitch(path, 72, 0x80000000u));
+
+  wav::WavFileUtils edited(path, options);
+  REQUIRE(edited.open());
+  const wav::SamplerChunk& before = original.getSamplerChunk();
+  const wav::SamplerChunk& after = edited.getSamplerChunk();
+  CHECK(after.midiUnityNote == 72);
+  CHECK(uint32_t(after.midiPitchFraction) == 0x80000000u);
+  CHECK(after.manufacturer == before.manufacturer);
+  REQUIRE(after.sampleLoops.size() == before.sampleLoops.size());
+  for (std::size_t i = 0; i < after.sampleLoops.size(); ++i) {
+    CHECK(after.sampleLoops[i].start == before.sampleLoops[i].start);
+    CHECK(after.sampleLoops[i].end == before.sampleLoops[i].end);
+  }
+  CHECK(edited.getRawSampleData() == original.getRawSampleData());
+  CHECK(edited.getCueChunk().cuePoints.size() == original.getCueChunk().cuePoints.size());
+  std::remove(path.c_str());
+}
+
+TEST_CASE("A batch of notes is tagged in parallel") {
+  std::vector<std::string> paths;
+  for (int i = 0; i < 12; ++i) {
+    paths.push_back(writeNote("pitch_batch" + std::to_string(i) + ".wav", 48 + i, 44100, 1.0));
+  }
+  CHECK(wav::addPitchToSampler(paths, wav::PitchOptions{}, 4) == paths.size());
+  wav::OpenOptions options;
+  options.verbose = false;
+  for (int i = 0; i < 12; ++i) {
+    wav::WavFileUtils reader(paths[i], options);
+    REQUIRE(reader.open());
+    const wav::SamplerChunk& smpl = reader.getSamplerChunk();
+    // Exactly on a semitone: either the note with a tiny fraction or the one below with a fraction near 1
+    const double note = smpl.midiUnityNote + double(uint32_t(smpl.midiPitchFraction)) / 4294967296.0;
+    CHECK(std::fabs(note - (48 + i)) < 0.02);
+    std::remove(paths[i].c_str());
+  }
+}
@@ -0,0 +1,198 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include "WavFixtures.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <wav/WavFileUtils.hpp>
+
+// Minimal 16-bit mono PCM file whose header sizes can be left stale, like a recorder mid-take
+static void writeHeader(const std::string& path, uint32_t dataSize) {
+  wavtest::writeFile(path, wavtest::wavHeader(wavtest::kPcm, 1, 48000, 16, dataSize));
+}
+
+static void appendFrames(const std::string& path, int16_t first, std::size_t count) {
+  std::ofstream out(path, std::ios::binary | std::ios::app);
+  for (std::size_t i = 0; i < count; ++i) {
+    const int16_t v = static_cast<int16_t>(first + i);
+    out.write(reinterpret_cast<const char*>(&v), 2);
+  }
+}
+
+static void rewriteDataSize(const std::string& path, uint32_t dataSize) {
+  std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+  file.seekp(40);
+  file.write(reinterpret_cast<const char*>(&dataSize), 4);
+}
+
+static void rewriteRiffSize(const std::string& path, uint32_t dataSize) {
+  std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+  const uint32_t riffSize = 36 + dataSize;
+  file.seekp(4);
+  file.write(reinterpret_cast<const char*>(&riffSize), 4);
+}
+
+TEST_CASE("growing file picks up appended frames") {
+  const std::string path = "growing.wav";
+  writeHeader(path, 0); // Recorder has not written the size yet
+  appendFrames(path, 0, 100);
+
+  wav::OpenOptions options;
+  options.verbose = false;
+  options.growingFile = true;
+  wav::WavFileUtils reader(path, options);
+  REQUIRE(reader.open());
+  CHECK_EQ(reader.getNumFrames(), 100);
+
+  wav::AppendedRange delta;
+  REQUIRE(reader.refresh(delta));
+  CHECK_EQ(delta.numFrames, 0);
+
+  appendFrames(path, 100, 50);
+  REQUIRE(reader.refresh(delta));
+  CHECK_EQ(delta.firstFrame, 100);
+  CHECK_EQ(delta.numFrames, 50);
+  CHECK_EQ(reader.getNumFrames(), 150);
+
+  const auto& bytes = reader.getDataChunk().sampleDataInBytes;
+  REQUIRE_EQ(bytes.size(), 300);
+  int16_t last;
+  std::memcpy(&last, bytes.data() + 298, 2);
+  CHECK_EQ(last, 149);
+
+  // A half-written frame is left for the next refresh
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    out.put(0x7f);
+  }
+  REQUIRE(reader.refresh(delta));
+  CHECK_EQ(delta.numFrames, 0);
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("size field driven refresh") {
+  const std::string path = "updated.wav";
+  writeHeader(path, 20);
+  appendFrames(path, 0, 10);
+
+  wav::WavFileUtils reader(path, wav::OpenOptions{wav::ReadMode::MetadataOnly, false});
+  REQUIRE(reader.open());
+  CHECK_EQ(reader.getNumFrames(), 10);
+
+  // Bytes on disk beyond the size field are ignored until the writer updates it
+  appendFrames(path, 10, 30);
+  wav::AppendedRange delta;
+  REQUIRE(reader.refresh(delta));
+  CHECK_EQ(delta.numFrames, 0);
+
+  // Frames count once both the data and the RIFF size fields cover them
+  rewriteDataSize(path, 80);
+  REQUIRE(reader.refresh(delta));
+  CHECK_EQ(delta.numFrames, 0);
+  rewriteRiffSize(path, 80);
+  REQUIRE(reader.refresh(delta));
+  CHECK_EQ(delta.firstFrame, 10);
+  CHECK_EQ(delta.numFrames, 30);
+  CHECK(reader.getDataChunk().sampleDataInBytes.empty()); // Metadata-only readers just track sizes
+
+  // A shrinking data chunk means the file was replaced
+  rewriteDataSize(path, 40);
+  CHECK_FALSE(reader.refresh(delta));
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("data chunk ending in a partial frame") {
+  const std::string path = "partial.wav";
+  writeHeader(path, 21);
+  appendFrames(path, 0, 10);
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::app);
+    out.put(0x11);
+  }
+
+  wav::WavFileUtils reader(path, wav::OpenOptions{wav::ReadMode::Full, false});
+  REQUIRE(reader.open());
+  wav::AppendedRange delta;
+  REQUIRE(reader.refresh(delta));
+  CHECK_EQ(delta.numFrames, 0);
+
+  // The writer completes the frame and appends more; the half frame is read again in full
+  {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(64);
+    const int16_t v = 10;
+    file.write(reinterpret_cast<const char*>(&v), 2);
+  }
+  appendFrames(path, 11, 4);
+  rewriteDataSize(path, 30);
+  rewriteRiffSize(path, 30);
+  REQUIRE(reader.refresh(delta));
+  CHECK_EQ(delta.firstFrame, 10);
+  CHECK_EQ(delta.numFrames, 5);
+  const auto& bytes = reader.getDataChunk().sampleDataInBytes;
+  REQUIRE_EQ(bytes.size(), 30);
+  int16_t frame10;
+  std::memcpy(&frame10, bytes.data() + 20, 2);
+  CHECK_EQ(frame10, 10);
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("chunks after a partial frame are still found") {
+  const std::string path = "partial_list.wav";
+  const std::vector<uint8_t> list = {'I', 'N', 'F', 'O', 'I', 'N', 'A', 'M', 2, 0, 0, 0, 'A', 0};
+  wavtest::writeFile(path, wavtest::wavFile(wavtest::kPcm, 1, 48000, 16, std::vector<uint8_t>(21), {{"LIST", list}}));
+  for (wav::ReadMode mode : {wav::ReadMode::MetadataOnly, wav::ReadMode::Full}) {
+    wav::WavFileUtils reader(path, wav::OpenOptions{mode, false});
+    REQUIRE(reader.open());
+    CHECK_EQ(reader.getNumFrames(), 10);
+    REQUIRE_EQ(reader.getChunkList().size(), 3);
+    CHECK(reader.getChunkList()[2].id == wav::Id::fromChars("LIST"));
+  }
+  std::remove(path.c_str());
+}
+
+TEST_CASE("header pre-sized beyond the end of the file") {
+  const std::string path = "presized.wav";
+  writeHeader(path, 2000); // Sizes written for the final length up front
+  appendFrames(path, 0, 100);
+
+  wav::WavFileUtils reader(path, wav::OpenOptions{wav::ReadMode::MetadataOnly, false});
+  REQUIRE(reader.open());
+  CHECK_EQ(reader.getNumFrames(), 100);
+  wav::AppendedRange delta;
+  REQUIRE(reader.refresh(delta));
+  CHECK_EQ(delta.numFrames, 0);
+  CHECK_EQ(reader.getNumFrames(), 100);
+
+  wav::WavFileUtils full(path, wav::OpenOptions{wav::ReadMode::Full, false});
+  REQUIRE(full.open());
+  CHECK_EQ(full.getNumFrames(), 100);
+  CHECK_EQ(full.getRawSampleData().size(), 100 * 2);
+
+  appendFrames(path, 100, 300);
+  REQUIRE(reader.refresh(delta));
+  CHECK_EQ(delta.firstFrame, 100);
+  CHECK_EQ(delta.numFrames, 300);
+  CHECK_EQ(reader.getNumFrames(), 400);
+  REQUIRE(full.refresh(delta));
+  CHECK_EQ(delta.numFrames, 300);
+  CHECK_EQ(full.getRawSampleData().size(), 400 * 2);
+
+  appendFrames(path, 400, 900); // Past the 1000 frames the header declares
+  REQUIRE(reader.refresh(delta));
+  CHECK_EQ(delta.firstFrame, 400);
+  CHECK_EQ(delta.numFrames, 600);
+  CHECK_EQ(reader.getNumFrames(), 1000);
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("refresh requires an open reader") {
+  wav::WavFileUtils reader;
+  wav::AppendedRange delta;
+  CHECK_FALSE(reader.refresh(delta));
+}
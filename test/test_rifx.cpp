@@ -0,0 +1,98 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include "WavFixtures.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <wav/FloatSanitizer.hpp>
+
+static void swapFields(uint8_t* p, std::size_t bytes, std::size_t fieldSize) {
+  for (std::size_t i = 0; i + fieldSize <= bytes; i += fieldSize) {
+    std::reverse(p + i, p + i + fieldSize);
+  }
+}
+
+// Rewrite a RIFF/WAVE file as RIFX: every size, header field and sample byte-swapped
+static std::vector<uint8_t> toRifx(const std::string& path) {
+  std::vector<uint8_t> bytes = wavtest::readFile(path);
+  bytes[3] = 'X';
+  swapFields(bytes.data() + 4, 4, 4);
+
+  std::size_t sampleSize = 1;
+  std::size_t pos = 12;
+  while (pos + 8 <= bytes.size()) {
+    const uint32_t size = wav::detail::loadLE32(bytes.data() + pos + 4);
+    const std::string id(reinterpret_cast<const char*>(bytes.data() + pos), 4);
+    uint8_t* payload = bytes.data() + pos + 8;
+    swapFields(bytes.data() + pos + 4, 4, 4);
+    if (id == "fmt ") {
+      sampleSize = (wav::detail::loadLE16(payload + 14) + 7) / 8;
+      swapFields(payload, 4, 2);      // format, channels
+      swapFields(payload + 4, 8, 4);  // sample rate, byte rate
+      swapFields(payload + 12, 4, 2); // block align, bits per sample
+    } else if (id == "data") {
+      swapFields(payload, size, sampleSize);
+    } else if (id == "cue ") {
+      swapFields(payload, size, 4);
+      for (std::size_t c = 4; c + 24 <= size; c += 24) {
+        std::reverse(payload + c + 8, payload + c + 12); // fccChunk stays "data"
+      }
+    } else if (id == "smpl") {
+      swapFields(payload, size, 4);
+    }
+    pos += 8 + size + (size & 1);
+  }
+  return bytes;
+}
+
+static std::vector<float> decodeAll(const wav::WavFileUtils& reader) {
+  const auto& bytes = reader.getDataChunk().sampleDataInBytes;
+  std::vector<float> samples(bytes.size() / wav::bytesPerSample(reader.getFmtChunk()));
+  REQUIRE(wav::convertToFloat(reader.getFmtChunk(), bytes.data(), samples.size(), samples.data()));
+  return samples;
+}
+
+TEST_CASE("RIFX file decodes like its RIFF original") {
+  for (const char* name : {"loop-cue.wav", "24b.wav", "24b96khz128samples.wav"}) {
+    CAPTURE(name);
+    wav::WavFileUtils original(std::string("resources/") + name, wav::OpenOptions{wav::ReadMode::Full, false});
+    REQUIRE(original.open());
+    const std::string path = wavtest::writeFile("swapped.wav", toRifx(std::string("resources/") + name));
+
+    wav::WavFileUtils reader(path, wav::OpenOptions{wav::ReadMode::Full, false});
+    REQUIRE(reader.open());
+    CHECK(reader.getContainer() == wav::Container::Rifx);
+    CHECK(reader.getFmtChunk().bigEndian);
+    CHECK_EQ(reader.getSampleRate(), original.getSampleRate());
+    CHECK_EQ(reader.getNumChannels(), original.getNumChannels());
+    CHECK_EQ(reader.getBitsPerSample(), original.getBitsPerSample());
+    CHECK_EQ(reader.getNumFrames(), original.getNumFrames());
+    CHECK_EQ(reader.getCueChunk().cuePoints.size(), original.getCueChunk().cuePoints.size());
+    CHECK_EQ(reader.getSamplerChunk().sampleLoops.size(), original.getSamplerChunk().sampleLoops.size());
+    if (!original.getCueChunk().cuePoints.empty()) {
+      CHECK_EQ(reader.getCueChunk().cuePoints[0].sampleOffset, original.getCueChunk().cuePoints[0].sampleOffset);
+    }
+
+    // The raw bytes differ, the decoded samples must not
+    CHECK(reader.getDataChunk().sampleDataInBytes != original.getDataChunk().sampleDataInBytes);
+    CHECK(decodeAll(reader) == decodeAll(original));
+    std::remove(path.c_str());
+  }
+}
+
+TEST_CASE("little-endian only paths reject RIFX data") {
+  wav::FmtChunk fmt;
+  fmt.audioFormat = wav::AudioFormat::IEEE_FLOAT;
+  fmt.bitsPerSample = 32;
+  fmt.bigEndian = true;
+  uint8_t bytes[4] = {0x7f, 0xc0, 0x00, 0x00}; // NaN, big-endian
+  wav::SanitizeStats stats;
+  CHECK_FALSE(wav::sanitizeFloatSamples(fmt, bytes, 1, wav::SanitizeOptions{}, stats));
+
+  // Decoding first and sanitizing the floats works for either byte order
+  float out = 1.0f;
+  REQUIRE(wav::convertToFloatSanitized(fmt, bytes, 1, &out, wav::SanitizeOptions{}, stats));
+  CHECK_EQ(out, 0.0f);
+  CHECK_EQ(stats.nans, 1);
+}
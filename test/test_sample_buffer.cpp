@@ -0,0 +1,67 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include <cstdint>
+#include <vector>
+#include <wav/FrameReader.hpp>
+#include <wav/WavFileUtils.hpp>
+
+static bool alignedTo(const void* p, std::size_t alignment) { return reinterpret_cast<uintptr_t>(p) % alignment == 0; }
+
+TEST_CASE("Sample buffers are 64-byte aligned at every size") {
+  for (std::size_t size : {1u, 100u, 4096u, 1u << 20, 3u << 20, 64u << 20}) {
+    wav::SampleBuffer bytes;
+    bytes.resize(size);
+    CAPTURE(size);
+    CHECK(alignedTo(bytes.data(), 64));
+#if defined(__linux__)
+    if (size >= (2u << 20)) {
+      CHECK(alignedTo(bytes.data(), 2u << 20)); // Whole huge pages
+    }
+#endif
+    REQUIRE(bytes.size() == size);
+    uint8_t* last = bytes.data() + (size - 1);
+    *last = 0x5a;
+    CHECK(*last == 0x5a);
+  }
+}
+
+TEST_CASE("Growing a sample buffer keeps its contents") {
+  wav::SampleMemoryOptions memory;
+  memory.explicitHugePages = true; // Falls back to THP when no huge pages are reserved
+  memory.numaNode = 0;
+  wav::SampleBuffer bytes{wav::SampleAllocator<uint8_t>(memory)};
+  bytes.resize(1000);
+  for (std::size_t i = 0; i < bytes.size(); ++i) {
+    bytes[i] = static_cast<uint8_t>(i * 7);
+  }
+  bytes.resize(5u << 20);
+  bytes.resize(9u << 20, 0xff);
+  bool same = true;
+  for (std::size_t i = 0; i < 1000; ++i) {
+    same = same && bytes[i] == static_cast<uint8_t>(i * 7);
+  }
+  CHECK(same);
+  CHECK(bytes[(5u << 20) + 1] == 0xff);
+  CHECK(bytes.back() == 0xff);
+
+  wav::SampleBuffer copy = bytes;
+  CHECK(copy == bytes);
+  CHECK(copy.get_allocator().options().numaNode == 0);
+}
+
+TEST_CASE("Loaded data chunks match the file and honour the memory options") {
+  wav::OpenOptions options;
+  options.verbose = false;
+  options.sampleMemory.explicitHugePages = true;
+  wav::WavFileUtils reader("resources/24b.wav", options);
+  REQUIRE(reader.open());
+  const wav::SampleBuffer& bytes = reader.getDataChunk().sampleDataInBytes;
+  CHECK(alignedTo(bytes.data(), 64));
+  CHECK(bytes.get_allocator().options().explicitHugePages);
+
+  wav::FrameReader frames;
+  REQUIRE(frames.open("resources/24b.wav"));
+  std::vector<uint8_t> expected(frames.getNumFrames() * frames.getFrameSize());
+  REQUIRE(frames.read(expected.data(), frames.getNumFrames()) == frames.getNumFrames());
+  CHECK(reader.getRawSampleData() == expected);
+}
@@ -0,0 +1,76 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include <wav/SampleConversion.hpp>
+
+TEST_CASE("pcm conversion") {
+  wav::FmtChunk fmt;
+  fmt.audioFormat = wav::AudioFormat::PCM;
+
+  fmt.bitsPerSample = 8;
+  const uint8_t pcm8[] = {0, 128, 255};
+  float out[3];
+  REQUIRE(wav::convertToFloat(fmt, pcm8, 3, out));
+  CHECK_EQ(out[0], -1.0f);
+  CHECK_EQ(out[1], 0.0f);
+  CHECK(out[2] == doctest::Approx(127.0 / 128.0));
+
+  fmt.bitsPerSample = 16;
+  const uint8_t pcm16[] = {0x00, 0x80, 0xff, 0x7f};
+  REQUIRE(wav::convertToFloat(fmt, pcm16, 2, out));
+  CHECK_EQ(out[0], -1.0f);
+  CHECK(out[1] == doctest::Approx(32767.0 / 32768.0));
+
+  fmt.bitsPerSample = 24;
+  const uint8_t pcm24[] = {0x00, 0x00, 0x80, 0x00, 0x00, 0x40};
+  REQUIRE(wav::convertToFloat(fmt, pcm24, 2, out));
+  CHECK_EQ(out[0], -1.0f);
+  CHECK_EQ(out[1], 0.5f);
+}
+
+TEST_CASE("float conversion") {
+  wav::FmtChunk fmt;
+  fmt.audioFormat = wav::AudioFormat::IEEE_FLOAT;
+  fmt.bitsPerSample = 32;
+  const float in = -0.25f;
+  uint8_t bytes[4];
+  std::memcpy(bytes, &in, 4);
+  float out = 0.0f;
+  REQUIRE(wav::convertToFloat(fmt, bytes, 1, &out));
+  CHECK_EQ(out, -0.25f);
+}
+
+TEST_CASE("big-endian conversion") {
+  wav::FmtChunk fmt;
+  fmt.audioFormat = wav::AudioFormat::PCM;
+  fmt.bigEndian = true;
+  float out[2];
+
+  fmt.bitsPerSample = 16;
+  const uint8_t pcm16[] = {0x80, 0x00, 0x40, 0x00};
+  REQUIRE(wav::convertToFloat(fmt, pcm16, 2, out));
+  CHECK_EQ(out[0], -1.0f);
+  CHECK_EQ(out[1], 0.5f);
+  CHECK_EQ(wav::sampleToFloat(fmt, pcm16 + 2), 0.5f);
+
+  fmt.bitsPerSample = 24;
+  const uint8_t pcm24[] = {0x80, 0x00, 0x00, 0xc0, 0x00, 0x00};
+  REQUIRE(wav::convertToFloat(fmt, pcm24, 2, out));
+  CHECK_EQ(out[0], -1.0f);
+  CHECK_EQ(out[1], -0.5f);
+
+  fmt.audioFormat = wav::AudioFormat::IEEE_FLOAT;
+  fmt.bitsPerSample = 32;
+  const uint8_t float32[] = {0xbe, 0x80, 0x00, 0x00}; // -0.25f
+  REQUIRE(wav::convertToFloat(fmt, float32, 1, out));
+  CHECK_EQ(out[0], -0.25f);
+  CHECK_EQ(wav::sampleToFloat(fmt, float32), -0.25f);
+}
+
+TEST_CASE("unsupported format") {
+  wav::FmtChunk fmt;
+  fmt.audioFormat = wav::AudioFormat::PCM;
+  fmt.bitsPerSample = 12;
+  float out = 0.0f;
+  const uint8_t bytes[2] = {};
+  CHECK_FALSE(wav::convertToFloat(fmt, bytes, 1, &out));
+}
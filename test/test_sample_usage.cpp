@@ -0,0 +1,197 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include "WavFixtures.hpp"
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include <wav/SampleUsage.hpp>
+
+/**
+ * @brief 24-bit stereo PCM; each sample is a 16-bit value shifted up by lowBits bits, right = left + offset(frame)
+ */
+static std::string writeStereo24(const std::string& path, unsigned lowBits, int (*offset)(uint32_t frame)) {
+  const uint32_t frames = 30000;
+  std::mt19937 rng(9);
+  std::vector<uint8_t> data;
+  for (uint32_t i = 0; i < frames; ++i) {
+    const int32_t left = static_cast<int32_t>(rng() % 60000) - 30000;
+    wavtest::putS24(data, left * (1 << lowBits));
+    wavtest::putS24(data, (left + offset(i)) * (1 << lowBits));
+  }
+  return wavtest::writeFile(path, wavtest::wavFile(wavtest::kPcm, 2, 48000, 24, data));
+}
+
+static int same(uint32_t) { return 0; }
+static int rarelyOff(uint32_t frame) { return frame % 1000 == 17 ? 1 : 0; }
+
+static std::vector<float> decode(const std::string& path, wav::FmtChunk* fmt = nullptr) {
+  wav::FrameReader reader;
+  REQUIRE(reader.open(path));
+  std::vector<uint8_t> raw(reader.getNumFrames() * reader.getFrameSize());
+  REQUIRE(reader.read(raw.data(), reader.getNumFrames()) == reader.getNumFrames());
+  std::vector<float> samples(reader.getNumFrames() * reader.getFmtChunk().numChannels);
+  wav::convertToFloat(reader.getFmtChunk(), raw.data(), samples.size(), samples.data());
+  if (fmt) {
+    *fmt = reader.getFmtChunk();
+  }
+  return samples;
+}
+
+TEST_CASE("Padded dual-mono 24-bit audio is found and repacked to 16-bit mono") {
+  const std::string path = writeStereo24("usage_padded.wav", 8, same);
+  wav::SampleUsage usage;
+  REQUIRE(wav::analyzeSampleUsage(path, usage));
+  CHECK(usage.numFrames == 30000);
+  CHECK(usage.bitsPerSample == 24);
+  CHECK(usage.effectiveBits == 16);
+  CHECK((usage.orBits & 0xFFFFu) == 0);
+  CHECK(usage.isPadded());
+  CHECK(usage.identicalChannels);
+  CHECK(usage.maxChannelDifference == 0.0f);
+
+  const std::string packed = "usage_padded_small.wav";
+  REQUIRE(wav::repackWav(path, packed, usage));
+  wav::FmtChunk fmt;
+  const std::vector<float> original = decode(path);
+  const std::vector<float> repacked = decode(packed, &fmt);
+  CHECK(fmt.bitsPerSample == 16);
+  CHECK(fmt.numChannels == 1);
+  REQUIRE(repacked.size() * 2 == original.size());
+  bool equal = true;
+  for (std::size_t i = 0; i < repacked.size(); ++i) {
+    equal = equal && repacked[i] == original[2 * i];
+  }
+  CHECK(equal);
+  CHECK(std::filesystem::file_size(packed) == 44 + 30000 * 2);
+  std::remove(path.c_str());
+  std::remove(packed.c_str());
+}
+
+TEST_CASE("Options can keep the bit depth or the channels") {
+  const std::string path = writeStereo24("usage_options.wav", 8, same);
+  wav::SampleUsage usage;
+  REQUIRE(wav::analyzeSampleUsage(path, usage));
+  wav::FrameReader reader;
+  REQUIRE(reader.open(path));
+  wav::RepackOptions options;
+  options.mergeIdenticalChannels = false;
+  wav::FmtChunk target = wav::repackedFormat(reader.getFmtChunk(), usage, options);
+  CHECK(target.numChannels == 2);
+  CHECK(target.bitsPerSample == 16);
+  CHECK(target.blockAlign == 4);
+  options.mergeIdenticalChannels = true;
+  options.reduceBitDepth = false;
+  target = wav::repackedFormat(reader.getFmtChunk(), usage, options);
+  CHECK(target.numChannels == 1);
+  CHECK(target.bitsPerSample == 24);
+  options.reduceBitDepth = true;
+  options.minBitsPerSample = 8; // 8-bit PCM is unsigned, so 16 stays the floor
+  target = wav::repackedFormat(reader.getFmtChunk(), usage, options);
+  CHECK(target.bitsPerSample == 16);
+  CHECK(wav::repackWav(path, "usage_options_small.wav", usage, options));
+  std::remove("usage_options_small.wav");
+  std::remove(path.c_str());
+}
+
+TEST_CASE("Full 24-bit audio with nearly identical channels is left alone") {
+  const std::string path = writeStereo24("usage_near.wav", 0, rarelyOff);
+  wav::SampleUsage usage;
+  REQUIRE(wav::analyzeSampleUsage(path, usage));
+  CHECK(usage.effectiveBits == 24);
+  CHECK_FALSE(usage.isPadded());
+  CHECK_FALSE(usage.identicalChannels);
+  CHECK(usage.maxChannelDifference == doctest::Approx(1.0 / 8388608.0));
+  CHECK(usage.isNearlyDualMono());
+  CHECK_FALSE(usage.isNearlyDualMono(-160.0));
+
+  wav::FrameReader reader;
+  REQUIRE(reader.open(path));
+  const wav::FmtChunk target = wav::repackedFormat(reader.getFmtChunk(), usage);
+  CHECK(target.numChannels == 2);
+  CHECK(target.bitsPerSample == 24);
+  std::remove(path.c_str());
+}
+
+TEST_CASE("Repacking refuses a file that no longer matches its analysis") {
+  const std::string path = writeStereo24("usage_stale.wav", 8, same);
+  wav::SampleUsage usage;
+  REQUIRE(wav::analyzeSampleUsage(path, usage));
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(44 + 6 * 20000);
+    file.put(1); // A low byte that is no longer zero
+  }
+  const std::string packed = "usage_stale_small.wav";
+  CHECK_FALSE(wav::repackWav(path, packed, usage));
+  CHECK_FALSE(std::filesystem::exists(packed));
+  std::remove(path.c_str());
+}
+
+TEST_CASE("Metadata chunks are copied and float files keep their format") {
+  wav::SampleUsage usage;
+  REQUIRE(wav::analyzeSampleUsage("resources/loop-cue.wav", usage));
+  CHECK(usage.numChannels == 1);
+  CHECK(usage.effectiveBits == 32);
+  CHECK_FALSE(usage.isPadded());
+  CHECK_FALSE(usage.identicalChannels);
+
+  const std::string packed = "usage_loop_cue.wav";
+  REQUIRE(wav::repackWav("resources/loop-cue.wav", packed, usage));
+  wav::OpenOptions options;
+  options.verbose = false;
+  wav::WavFileUtils original("resources/loop-cue.wav", options);
+  wav::WavFileUtils copy(packed, options);
+  REQUIRE(original.open());
+  REQUIRE(copy.open());
+  CHECK(copy.getFmtChunk().audioFormat == wav::AudioFormat::IEEE_FLOAT);
+  CHECK(copy.getRawSampleData() == original.getRawSampleData());
+  CHECK(copy.getSamplerChunk().numSampleLoops == original.getSamplerChunk().numSampleLoops);
+  CHECK(copy.getCueChunk().cuePoints.size() == original.getCueChunk().cuePoints.size());
+  CHECK(copy.getFactChunk().numSamplesPerChannel == usage.numFrames);
+  std::remove(packed.c_str());
+}
+
+TEST_CASE("Dual-mono float files become mono float files with a fact chunk") {
+  std::vector<uint8_t> data;
+  for (uint32_t i = 0; i < 1000; ++i) {
+    const float v = 0.001f * static_cast<float>(i % 700) - 0.3f;
+    wavtest::putF32(data, v);
+    wavtest::putF32(data, v);
+  }
+  const std::string path = wavtest::writeFile("usage_float.wav", wavtest::wavFile(wavtest::kFloat, 2, 48000, 32, data));
+  wav::SampleUsage usage;
+  REQUIRE(wav::analyzeSampleUsage(path, usage));
+  CHECK(usage.identicalChannels);
+
+  const std::string packed = "usage_float_mono.wav";
+  REQUIRE(wav::repackWav(path, packed, usage));
+  wav::WavFileUtils copy(packed, wav::OpenOptions{wav::ReadMode::Full, false});
+  REQUIRE(copy.open());
+  CHECK(copy.getFmtChunk().audioFormat == wav::AudioFormat::IEEE_FLOAT);
+  CHECK(copy.getFmtChunk().numChannels == 1);
+  CHECK(copy.getFactChunk().numSamplesPerChannel == 1000);
+  CHECK(copy.getNumFrames() == 1000);
+  std::remove(path.c_str());
+  std::remove(packed.c_str());
+}
+
+TEST_CASE("8-bit silence has no effective bits") {
+  wav::FmtChunk fmt;
+  fmt.audioFormat = wav::AudioFormat::PCM;
+  fmt.numChannels = 1;
+  fmt.sampleRate = 8000;
+  fmt.bitsPerSample = 8;
+  fmt.blockAlign = 1;
+  std::vector<uint8_t> silence(1000, 128);
+  wav::SampleUsageAnalyzer analyzer(fmt);
+  analyzer.process(silence.data(), silence.size());
+  CHECK(analyzer.getUsage().effectiveBits == 0);
+  silence[500] = 129;
+  analyzer.process(silence.data(), silence.size());
+  CHECK(analyzer.getUsage().effectiveBits == 8);
+  CHECK(analyzer.getUsage().numFrames == 2000);
+}
@@ -0,0 +1,157 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <vector>
+#include <wav/SharedDecode.hpp>
+
+// Keeps test segments apart from real ones and from concurrent test runs
+static wav::SharedDecodeOptions testOptions() {
+  wav::SharedDecodeOptions options;
+  options.namePrefix = "wavtest" + std::to_string(::getpid()) + "-";
+  return options;
+}
+
+static std::vector<float> decodePrivately(const std::string& path) {
+  wav::FrameReader reader;
+  REQUIRE(reader.open(path));
+  std::vector<uint8_t> raw(reader.getNumFrames() * reader.getFrameSize());
+  REQUIRE(reader.read(raw.data(), reader.getNumFrames()) == reader.getNumFrames());
+  std::vector<float> samples(reader.getNumFrames() * reader.getFmtChunk().numChannels);
+  wav::convertToFloat(reader.getFmtChunk(), raw.data(), samples.size(), samples.data());
+  return samples;
+}
+
+static bool sameSamples(const wav::SharedDecodedWav& shared, const std::vector<float>& expected) {
+  return shared.getNumFrames() * shared.getNumChannels() == expected.size() &&
+         std::memcmp(shared.getSamples(), expected.data(), expected.size() * sizeof(float)) == 0;
+}
+
+TEST_CASE("The first open decodes, later opens attach to the same samples") {
+  const wav::SharedDecodeOptions options = testOptions();
+  const std::vector<float> expected = decodePrivately("resources/24b.wav");
+
+  wav::SharedDecodedWav first;
+  REQUIRE(first.open("resources/24b.wav", options));
+  CHECK(first.isPublisher());
+  CHECK(first.getSampleRate() > 0);
+  CHECK(sameSamples(first, expected));
+
+  wav::SharedDecodedWav second;
+  REQUIRE(second.open("resources/24b.wav", options));
+  CHECK_FALSE(second.isPublisher());
+  CHECK(second.getSegmentName() == first.getSegmentName());
+  CHECK(second.getSamples() != first.getSamples()); // Separate mappings of the same pages
+  CHECK(sameSamples(second, expected));
+
+  first.close();
+  wav::SharedDecodedWav third;
+  REQUIRE(third.open("resources/24b.wav", options));
+  CHECK_FALSE(third.isPublisher()); // Closing the publisher does not withdraw the samples
+  third.close();
+  second.close();
+  wav::SharedDecodedWav::purgeUnused(options);
+}
+
+TEST_CASE("Another process attaches read-only to published samples") {
+  const wav::SharedDecodeOptions options = testOptions();
+  wav::SharedDecodedWav shared;
+  REQUIRE(shared.open("resources/24b96khz128samples.wav", options));
+  const std::vector<float> expected = decodePrivately("resources/24b96khz128samples.wav");
+
+  const pid_t child = ::fork();
+  REQUIRE(child >= 0);
+  if (child == 0) {
+    wav::SharedDecodedWav attached;
+    const bool ok = attached.open("resources/24b96khz128samples.wav", options) && !attached.isPublisher() &&
+                    sameSamples(attached, expected);
+    ::_exit(ok ? 0 : 1);
+  }
+  int status = 0;
+  REQUIRE(::waitpid(child, &status, 0) == child);
+  CHECK(WIFEXITED(status));
+  CHECK(WEXITSTATUS(status) == 0);
+
+  shared.close();
+  wav::SharedDecodedWav::purgeUnused(options);
+}
+
+TEST_CASE("Published samples cannot be made writable") {
+  const wav::SharedDecodeOptions options = testOptions();
+  wav::SharedDecodedWav publisher;
+  REQUIRE(publisher.open("resources/24b.wav", options));
+  wav::SharedDecodedWav attached;
+  REQUIRE(attached.open("resources/24b.wav", options));
+
+  const int fd = ::shm_open(publisher.getSegmentName().c_str(), O_RDONLY, 0);
+  REQUIRE(fd >= 0);
+  struct stat st;
+  REQUIRE(::fstat(fd, &st) == 0);
+  ::close(fd);
+  CHECK((st.st_mode & 0222) == 0);
+  for (const wav::SharedDecodedWav* shared : {&publisher, &attached}) {
+    void* page = const_cast<float*>(shared->getSamples());
+    const std::size_t pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    CHECK(::mprotect(page, pageSize, PROT_READ | PROT_WRITE) != 0); // Mapped from an O_RDONLY descriptor
+  }
+
+  attached.close();
+  publisher.close();
+  wav::SharedDecodedWav::purgeUnused(options);
+}
+
+TEST_CASE("Segments beyond the memory budget are refused") {
+  wav::SharedDecodeOptions options = testOptions();
+  options.memoryBudget = 1024;
+  wav::SharedDecodedWav shared;
+  CHECK_FALSE(shared.open("resources/24b.wav", options));
+  CHECK_FALSE(shared.isOpen());
+}
+
+#if defined(__linux__)
+TEST_CASE("Publishing evicts unused segments to stay within the budget") {
+  wav::SharedDecodeOptions options = testOptions();
+  uint64_t firstBytes = 0;
+  {
+    wav::SharedDecodedWav first;
+    REQUIRE(first.open("resources/24b.wav", options));
+    firstBytes = wav::SharedDecodedWav::getPublishedBytes(options);
+    CHECK(firstBytes > 0);
+  }
+
+  // Room for the second file only: the first one, released, has to go
+  options.memoryBudget = firstBytes;
+  wav::SharedDecodedWav second;
+  REQUIRE(second.open("resources/24b96khz128samples.wav", options));
+  const uint64_t secondBytes = wav::SharedDecodedWav::getPublishedBytes(options);
+  CHECK(secondBytes < firstBytes);
+
+  // A held segment is never evicted; publishing the first file again cannot fit next to it
+  wav::SharedDecodeOptions tight = options;
+  tight.memoryBudget = firstBytes + secondBytes - 1;
+  wav::SharedDecodedWav again;
+  CHECK_FALSE(again.open("resources/24b.wav", tight));
+  CHECK(wav::SharedDecodedWav::getPublishedBytes(options) == secondBytes);
+
+  CHECK(wav::SharedDecodedWav::purgeUnused(options) == 0);
+  second.close();
+  CHECK(wav::SharedDecodedWav::purgeUnused(options) == 1);
+  CHECK(wav::SharedDecodedWav::getPublishedBytes(options) == 0);
+}
+
+TEST_CASE("A segment that has just been created is not purged before its publisher sizes it") {
+  const wav::SharedDecodeOptions options = testOptions();
+  const std::string name = "/" + options.namePrefix + "0000000000000000" + wav::detail::kSharedControlSuffix;
+  const int fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  REQUIRE(fd >= 0);
+  CHECK(wav::SharedDecodedWav::purgeUnused(options) == 0);
+
+  // Once the grace period has passed, the publisher is taken to have died
+  const struct timespec old[2] = {{0, UTIME_OMIT}, {::time(nullptr) - 60, 0}};
+  REQUIRE(::futimens(fd, old) == 0);
+  ::close(fd);
+  CHECK(wav::SharedDecodedWav::purgeUnused(options) == 1);
+}
+#endif
@@ -0,0 +1,68 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include <vector>
+#include <wav/SampleConversion.hpp>
+#include <wav/StaticWavReader.hpp>
+
+static std::vector<float> decodeAll(const std::string& path) {
+  wav::WavFileUtils reader(path, wav::OpenOptions{wav::ReadMode::Full, false});
+  REQUIRE(reader.open());
+  const std::vector<uint8_t>& bytes = reader.getRawSampleData();
+  const std::size_t samples = bytes.size() / wav::bytesPerSample(reader.getFmtChunk());
+  std::vector<float> out(samples);
+  REQUIRE(wav::convertToFloat(reader.getFmtChunk(), bytes.data(), samples, out.data()));
+  return out;
+}
+
+TEST_CASE("static reader matches runtime conversion") {
+  const std::vector<float> expected = decodeAll("resources/24b.wav");
+
+  wav::StaticWavReader<wav::AudioFormat::PCM, 1, 24> reader("resources/24b.wav");
+  REQUIRE(reader.open());
+  REQUIRE_EQ(reader.getNumFrames(), expected.size());
+  CHECK_EQ(reader.getSampleRate(), 96000);
+
+  std::vector<float> decoded(expected.size());
+  CHECK_EQ(reader.readFrames(0, decoded.size() + 10, decoded.data()), expected.size());
+  CHECK(decoded == expected);
+  CHECK_EQ(reader.sample(1234, 0), expected[1234]);
+  CHECK_EQ(reader.frame(4321)[0], expected[4321]);
+  CHECK_EQ(reader.readFrames(expected.size(), 1, decoded.data()), 0);
+}
+
+TEST_CASE("static float reader and planar output") {
+  const std::vector<float> expected = decodeAll("resources/loop-cue.wav");
+
+  wav::Float32MonoReader reader;
+  REQUIRE(reader.open("resources/loop-cue.wav"));
+  CHECK_FALSE(reader.getMetadata().getCueChunk().cuePoints.empty());
+
+  std::vector<float> mono(256);
+  float* channels[] = {mono.data()};
+  REQUIRE_EQ(reader.readPlanar(100, mono.size(), channels), mono.size());
+  for (std::size_t i = 0; i < mono.size(); ++i) {
+    CHECK_EQ(mono[i], expected[100 + i]);
+  }
+}
+
+TEST_CASE("format mismatch is rejected once at open") {
+  wav::Pcm16StereoReader wrongLayout("resources/24b.wav");
+  CHECK_FALSE(wrongLayout.open());
+  CHECK_FALSE(wrongLayout.isOpen());
+
+  wav::FmtChunk fmt;
+  fmt.audioFormat = wav::AudioFormat::PCM;
+  fmt.numChannels = 2;
+  fmt.bitsPerSample = 16;
+  fmt.blockAlign = 4;
+  const uint8_t bytes[] = {0x00, 0x80, 0xff, 0x7f, 0x00, 0x40, 0x00, 0x00};
+  wav::Pcm16StereoReader attached;
+  REQUIRE(attached.attach(fmt, bytes, sizeof(bytes)));
+  CHECK_EQ(attached.getNumFrames(), 2);
+  CHECK_EQ(attached.frame(0)[0], -1.0f);
+  CHECK_EQ(attached.sample(1, 0), 0.5f);
+  CHECK_EQ(attached.sample(1, 1), 0.0f);
+
+  fmt.blockAlign = 6;
+  CHECK_FALSE(attached.attach(fmt, bytes, sizeof(bytes)));
+}
@@ -0,0 +1,120 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include "doctest/doctest.h"
+#include "WavFixtures.hpp"
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <wav/FrameReader.hpp>
+
+static const uint8_t kFourccSuffix[12] = {0xF3, 0xAC, 0xD3, 0x11, 0x8C, 0xD1, 0x00, 0xC0, 0x4F, 0x8E, 0xDB, 0x8A};
+
+static void putChunk(std::vector<uint8_t>& out, const char* fourcc, const uint8_t* payload, uint64_t size) {
+  out.insert(out.end(), fourcc, fourcc + 4);
+  out.insert(out.end(), kFourccSuffix, kFourccSuffix + 12);
+  wav::detail::putLE64(out, size + 24);
+  out.insert(out.end(), payload, payload + size);
+  out.resize((out.size() + 7) & ~std::size_t(7), 0); // 8-byte alignment
+}
+
+// Rewrite a RIFF/WAVE file as Wave64, chunk for chunk, with an odd-sized junk chunk in front
+static std::vector<uint8_t> toWave64(const std::string& path) {
+  const std::vector<uint8_t> riff = wavtest::readFile(path);
+
+  std::vector<uint8_t> out(wav::detail::kW64RiffGuid, wav::detail::kW64RiffGuid + 16);
+  wav::detail::putLE64(out, 0); // Patched below
+  out.insert(out.end(), wav::detail::kW64WaveGuid, wav::detail::kW64WaveGuid + 16);
+  const uint8_t junk[5] = {1, 2, 3, 4, 5};
+  putChunk(out, "junk", junk, sizeof(junk));
+
+  std::size_t pos = 12;
+  while (pos + 8 <= riff.size()) {
+    const uint32_t size = wav::detail::loadLE32(riff.data() + pos + 4);
+    putChunk(out, reinterpret_cast<const char*>(riff.data() + pos), riff.data() + pos + 8, size);
+    pos += 8 + size + (size & 1);
+  }
+  for (int i = 0; i < 8; ++i) {
+    out[16 + i] = static_cast<uint8_t>(uint64_t(out.size()) >> (8 * i));
+  }
+  return out;
+}
+
+TEST_CASE("wave64 file parses like its RIFF original") {
+  wav::WavFileUtils original("resources/loop-cue.wav", wav::OpenOptions{wav::ReadMode::Full, false});
+  REQUIRE(original.open());
+  const std::string path = wavtest::writeFile("loop-cue.w64", toWave64("resources/loop-cue.wav"));
+
+  wav::WavFileUtils reader(path, wav::OpenOptions{wav::ReadMode::Full, false});
+  REQUIRE(reader.open());
+  CHECK(reader.getContainer() == wav::Container::Wave64);
+  CHECK(original.getContainer() == wav::Container::Riff);
+  CHECK_EQ(reader.getSampleRate(), original.getSampleRate());
+  CHECK_EQ(reader.getNumChannels(), original.getNumChannels());
+  CHECK_EQ(reader.getNumFrames(), original.getNumFrames());
+  CHECK(reader.getDataChunk().sampleDataInBytes == original.getDataChunk().sampleDataInBytes);
+
+  REQUIRE_EQ(reader.getCueChunk().cuePoints.size(), original.getCueChunk().cuePoints.size());
+  CHECK_EQ(reader.getCueChunk().cuePoints[0].sampleOffset, original.getCueChunk().cuePoints[0].sampleOffset);
+  REQUIRE_EQ(reader.getSamplerChunk().sampleLoops.size(), original.getSamplerChunk().sampleLoops.size());
+  CHECK_EQ(reader.getSamplerChunk().sampleLoops[0].end, original.getSamplerChunk().sampleLoops[0].end);
+
+  // Chunk list offsets point at the GUIDs, sizes exclude the 24-byte headers and alignment
+  const auto& chunks = reader.getChunkList();
+  REQUIRE_EQ(chunks.size(), original.getChunkList().size() + 1);
+  CHECK(chunks[0].id == wav::Id::fromChars("junk"));
+  CHECK_EQ(chunks[0].offset, 40);
+  CHECK_EQ(chunks[0].chunkSize, 5);
+  CHECK_EQ(chunks[1].offset, 72);
+  CHECK(chunks[1].id == wav::Id::fromChars("fmt "));
+  CHECK_EQ(reader.getDataOffset() % 8, 0);
+  std::remove(path.c_str());
+}
+
+TEST_CASE("wave64 streams through FrameReader") {
+  wav::WavFileUtils original("resources/24b.wav", wav::OpenOptions{wav::ReadMode::Full, false});
+  REQUIRE(original.open());
+  const std::string path = wavtest::writeFile("24b.w64", toWave64("resources/24b.wav"));
+
+  wav::FrameReader stream;
+  REQUIRE(stream.open(path, wav::AccessPattern::Sequential));
+  CHECK_EQ(stream.getNumFrames(), original.getNumFrames());
+  std::vector<uint8_t> block(1000 * stream.getFrameSize());
+  REQUIRE_EQ(stream.readAt(1234, block.data(), 1000), 1000);
+  CHECK(std::memcmp(block.data(), original.getDataChunk().sampleDataInBytes.data() + 1234 * stream.getFrameSize(),
+                    block.size()) == 0);
+  std::remove(path.c_str());
+}
+
+TEST_CASE("wave64 refresh reads the 64-bit data size") {
+  std::vector<uint8_t> bytes = toWave64("resources/24b96khz128samples.wav");
+  const std::string path = wavtest::writeFile("grow.w64", bytes);
+  wav::WavFileUtils reader(path, wav::OpenOptions{wav::ReadMode::Full, false});
+  REQUIRE(reader.open());
+  const uint64_t frames = reader.getNumFrames();
+  const uint64_t dataOffset = reader.getDataOffset();
+  const std::size_t frameSize = reader.getFmtChunk().blockAlign;
+
+  // Append ten frames to the (last) data chunk and bump its 64-bit size field
+  bytes.resize(static_cast<std::size_t>(dataOffset + frames * frameSize));
+  bytes.insert(bytes.end(), 10 * frameSize, uint8_t(0x7f));
+  const uint64_t chunkSize = 24 + (frames + 10) * frameSize;
+  for (int i = 0; i < 8; ++i) {
+    bytes[static_cast<std::size_t>(dataOffset) - 8 + i] = static_cast<uint8_t>(chunkSize >> (8 * i));
+  }
+  wavtest::writeFile(path, bytes);
+
+  wav::AppendedRange delta;
+  REQUIRE(reader.refresh(delta));
+  CHECK_EQ(delta.firstFrame, frames);
+  CHECK_EQ(delta.numFrames, 10);
+  CHECK_EQ(reader.getDataChunk().sampleDataInBytes.back(), 0x7f);
+  std::remove(path.c_str());
+}
+
+TEST_CASE("truncated wave64 header is rejected") {
+  std::vector<uint8_t> bytes = toWave64("resources/24b96khz128samples.wav");
+  bytes.resize(30);
+  const std::string path = wavtest::writeFile("short.w64", bytes);
+  wav::WavFileUtils reader(path, wav::OpenOptions{wav::ReadMode::Full, false});
+  CHECK_FALSE(reader.open());
+  std::remove(path.c_str());
+}
@@ -0,0 +1,193 @@
+/**
+ * @file wavbench.cpp
+ * @brief Compare the throughput of every sample kernel across instruction sets
+ *
+ * Each kernel from SampleKernels.hpp is run on the same random buffer for every
+ * instruction set this CPU supports (see CpuDispatch.hpp), and the best of
+ * several repetitions is reported in millions of samples per second together
+ * with the speedup over the scalar reference.
+ *
+ * Usage:
+ *   wavbench [--samples N] [--repeat N] [--isa scalar|sse4.1|avx2|avx512]
+ *
+ * Output is one tab-separated line per kernel and instruction set.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <wav/SampleKernels.hpp>
+
+struct Settings {
+  std::size_t samples = 1u << 20;
+  unsigned repeat = 20;
+  bool onlyOneIsa = false;
+  wav::Isa isa = wav::Isa::Scalar;
+};
+
+struct Benchmark {
+  const char* name;
+  std::function<void(const wav::SampleKernels&)> run;
+};
+
+/**
+ * @brief Best wall time of settings.repeat runs, in seconds
+ */
+static double bestSeconds(const Settings& settings, const std::function<void()>& run) {
+  run(); // Warm caches and page in the buffers
+  double best = 1e30;
+  for (unsigned r = 0; r < settings.repeat; ++r) {
+    const auto start = std::chrono::steady_clock::now();
+    run();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+static void printUsage(const char* argv0) {
+  std::cerr << "Usage: " << argv0 << " [--samples N] [--repeat N] [--isa scalar|sse4.1|avx2|avx512]\n";
+}
+
+// The largest buffer is 8 bytes per sample; 2^30 samples already needs well over 16 GiB in total
+static constexpr unsigned long long kMaxSamples = 1ull << 30;
+static constexpr unsigned long long kMaxRepeat = 1000000;
+
+/**
+ * @brief Parse a whole decimal argument in [1, max]; throws std::invalid_argument / std::out_of_range
+ */
+static bool parseCount(const std::string& value, unsigned long long max, unsigned long long& count) {
+  std::size_t used = 0;
+  count = std::stoull(value, &used);
+  return used == value.size() && value[0] != '-' && count >= 1 && count <= max;
+}
+
+static bool parseArgs(int argc, const char* argv[], Settings& settings) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    unsigned long long count = 0;
+    if (arg == "--samples" && i + 1 < argc) {
+      if (!parseCount(argv[++i], kMaxSamples, count)) {
+        return false;
+      }
+      settings.samples = static_cast<std::size_t>(count);
+    } else if (arg == "--repeat" && i + 1 < argc) {
+      if (!parseCount(argv[++i], kMaxRepeat, count)) {
+        return false;
+      }
+      settings.repeat = static_cast<unsigned>(count);
+    } else if (arg == "--isa" && i + 1 < argc) {
+      if (!wav::parseIsa(argv[++i], settings.isa)) {
+        return false;
+      }
+      settings.onlyOneIsa = true;
+    } else {
+      return false;
+    }
+  }
+  // Stereo (de)interleave works on frames
+  settings.samples &= ~std::size_t(1);
+  return settings.samples > 0;
+}
+
+int main(int argc, const char* argv[]) {
+  Settings settings;
+  try {
+    if (!parseArgs(argc, argv, settings)) {
+      printUsage(argv[0]);
+      return 2;
+    }
+  } catch (const std::exception&) { // std::stoull on malformed numbers
+    printUsage(argv[0]);
+    return 2;
+  }
+
+  const std::size_t n = settings.samples;
+  std::mt19937 rng(1234);
+  std::vector<uint8_t> bytes(n * 8);
+  for (uint8_t& b : bytes) {
+    b = static_cast<uint8_t>(rng());
+  }
+  // Well-formed doubles for the float64 kernel, so NaN handling does not skew timings
+  std::uniform_real_distribution<double> dist(-1.0, 1.0);
+  std::vector<double> doubles(n);
+  for (double& d : doubles) {
+    d = dist(rng);
+  }
+  std::vector<float> floats(n);
+  std::vector<float> out(n);
+  std::vector<float> left(n / 2);
+  std::vector<float> right(n / 2);
+  float* const planes[] = {left.data(), right.data()};
+  const float* const constPlanes[] = {left.data(), right.data()};
+  wav::sampleKernelsFor(wav::Isa::Scalar).pcm24ToFloat(bytes.data(), n, floats.data());
+
+  volatile double sink = 0.0;
+  const Benchmark benchmarks[] = {
+      {"pcm8ToFloat", [&](const wav::SampleKernels& k) { k.pcm8ToFloat(bytes.data(), n, out.data()); }},
+      {"pcm16ToFloat", [&](const wav::SampleKernels& k) { k.pcm16ToFloat(bytes.data(), n, out.data()); }},
+      {"pcm24ToFloat", [&](const wav::SampleKernels& k) { k.pcm24ToFloat(bytes.data(), n, out.data()); }},
+      {"pcm32ToFloat", [&](const wav::SampleKernels& k) { k.pcm32ToFloat(bytes.data(), n, out.data()); }},
+      {"pcm24beToFloat", [&](const wav::SampleKernels& k) { k.pcm24beToFloat(bytes.data(), n, out.data()); }},
+      {"float64ToFloat",
+       [&](const wav::SampleKernels& k) {
+         k.float64ToFloat(reinterpret_cast<const uint8_t*>(doubles.data()), n, out.data());
+       }},
+      {"peakAbs", [&](const wav::SampleKernels& k) { sink = sink + k.peakAbs(floats.data(), n); }},
+      {"sumOfSquares", [&](const wav::SampleKernels& k) { sink = sink + k.sumOfSquares(floats.data(), n); }},
+      {"sanitizeFloat32",
+       [&](const wav::SampleKernels& k) {
+         wav::SanitizeStats stats;
+         k.sanitizeFloat32(floats.data(), n, wav::SanitizeOptions{}, stats);
+       }},
+      {"sanitizeFloat64",
+       [&](const wav::SampleKernels& k) {
+         wav::SanitizeStats stats;
+         k.sanitizeFloat64(doubles.data(), n, wav::SanitizeOptions{}, stats);
+       }},
+      {"tpdfNoise",
+       [&](const wav::SampleKernels& k) {
+         uint32_t lanes[wav::kDitherLanes] = {1, 2, 3, 4, 5, 6, 7, 8};
+         k.tpdfNoise(lanes, out.data(), n & ~(wav::kDitherLanes - 1));
+       }},
+      {"quantizeToPcm16",
+       [&](const wav::SampleKernels& k) { k.quantizeToPcm16(floats.data(), out.data(), n, bytes.data()); }},
+      {"quantizeToPcm24",
+       [&](const wav::SampleKernels& k) { k.quantizeToPcm24(floats.data(), out.data(), n, bytes.data()); }},
+      {"deinterleave2", [&](const wav::SampleKernels& k) { k.deinterleave(floats.data(), n / 2, 2, planes); }},
+      {"interleave2", [&](const wav::SampleKernels& k) { k.interleave(constPlanes, n / 2, 2, out.data()); }},
+  };
+
+  std::vector<wav::Isa> isas;
+  for (int i = 0; i < static_cast<int>(wav::Isa::Count); ++i) {
+    const wav::Isa isa = static_cast<wav::Isa>(i);
+    if (wav::cpuFeatures().supports(isa) && (!settings.onlyOneIsa || isa == settings.isa || isa == wav::Isa::Scalar)) {
+      isas.push_back(isa);
+    }
+  }
+
+  std::cout << "# default kernels: " << wav::isaName(wav::activeIsa()) << ", " << n << " samples, best of "
+            << settings.repeat << "\n";
+  std::cout << "kernel\tisa\tmsamples_per_s\tspeedup\n";
+  for (const Benchmark& benchmark : benchmarks) {
+    double scalarSeconds = 0.0;
+    for (wav::Isa isa : isas) {
+      const wav::SampleKernels& kernels = wav::sampleKernelsFor(isa);
+      const double seconds = bestSeconds(settings, [&] { benchmark.run(kernels); });
+      if (isa == wav::Isa::Scalar) {
+        scalarSeconds = seconds;
+      }
+      char line[128];
+      std::snprintf(line, sizeof(line), "%s\t%s\t%.1f\t%.2fx\n", benchmark.name, wav::isaName(isa),
+                    n / seconds / 1e6, scalarSeconds / seconds);
+      std::cout << line;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,358 @@
+/**
+ * @file wavinfo.cpp
+ * @brief Print WAV metadata for files and directory trees as JSON Lines or CSV
+ *
+ * Directories are walked recursively by a pool of worker threads. Each worker
+ * takes a directory or file from a shared queue; directories push their
+ * children back onto the queue, files are opened with wav::ReadMode::MetadataOnly
+ * so the sample data is never read (unless --loudness is requested). Symlinks to
+ * files are read; symlinks to directories below the inputs are not followed.
+ *
+ * Usage:
+ *   wavinfo [--format jsonl|csv] [--threads N] [--loudness] <file-or-directory>...
+ *
+ * Output order follows completion order, not directory order.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <wav/SampleConversion.hpp>
+#include <wav/WavFileUtils.hpp>
+
+namespace fs = std::filesystem;
+
+enum class OutputFormat { JsonLines, Csv };
+
+struct Settings {
+  OutputFormat format = OutputFormat::JsonLines;
+  unsigned threads = 0; // 0 = hardware concurrency
+  bool loudness = false;
+  std::vector<std::string> inputs;
+};
+
+/**
+ * @brief Peak and RMS level of the whole data chunk, in dBFS
+ */
+struct Loudness {
+  double peakDbfs = -INFINITY;
+  double rmsDbfs = -INFINITY;
+};
+
+static double toDbfs(double linear) { return linear > 0.0 ? 20.0 * std::log10(linear) : -INFINITY; }
+
+static Loudness measureLoudness(const wav::WavFileUtils& reader) {
+  Loudness result;
+  const wav::FmtChunk& fmt = reader.getFmtChunk();
+  const auto& bytes = reader.getDataChunk().sampleDataInBytes;
+  if (!wav::isConvertibleFormat(fmt)) {
+    return result;
+  }
+
+  // Convert in fixed-size blocks so huge files do not need a second full-size buffer
+  const std::size_t stride = wav::bytesPerSample(fmt);
+  const std::size_t totalSamples = bytes.size() / stride;
+  const wav::SampleKernels& kernels = wav::sampleKernels();
+  std::vector<float> block(65536);
+  double peak = 0.0;
+  double sumSquares = 0.0;
+  for (std::size_t first = 0; first < totalSamples; first += block.size()) {
+    const std::size_t count = std::min(block.size(), totalSamples - first);
+    wav::convertToFloat(fmt, bytes.data() + first * stride, count, block.data());
+    peak = std::max(peak, double(kernels.peakAbs(block.data(), count)));
+    sumSquares += kernels.sumOfSquares(block.data(), count);
+  }
+  result.peakDbfs = toDbfs(peak);
+  if (totalSamples > 0) {
+    result.rmsDbfs = toDbfs(std::sqrt(sumSquares / static_cast<double>(totalSamples)));
+  }
+  return result;
+}
+
+static std::string formatName(wav::AudioFormat format) {
+  switch (format) {
+  case wav::AudioFormat::PCM:
+    return "PCM";
+  case wav::AudioFormat::IEEE_FLOAT:
+    return "IEEE_FLOAT";
+  }
+  return "UNKNOWN";
+}
+
+static std::string csvEscape(const std::string& text) {
+  if (text.find_first_of(",\"\n") == std::string::npos) {
+    return text;
+  }
+  std::string out = "\"";
+  for (char c : text) {
+    out += c;
+    if (c == '"') {
+      out += '"';
+    }
+  }
+  return out + "\"";
+}
+
+static std::string formatNumber(double value) {
+  if (!std::isfinite(value)) {
+    return "null";
+  }
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "%.6g", value);
+  return buf;
+}
+
+static std::string describeJson(const std::string& path, const wav::WavFileUtils& reader, const Loudness* loudness) {
+  std::ostringstream out;
+  out << "{\"path\":\"" << wav::detail::jsonEscape(path) << "\"";
+  out << ",\"format\":\"" << formatName(reader.getAudioFormat()) << "\"";
+  out << ",\"channels\":" << reader.getNumChannels();
+  out << ",\"sample_rate\":" << reader.getSampleRate();
+  out << ",\"bits_per_sample\":" << reader.getBitsPerSample();
+  out << ",\"frames\":" << reader.getNumFrames();
+  out << ",\"duration_s\":" << formatNumber(reader.getDurationSeconds());
+
+  out << ",\"chunks\":[";
+  const auto& chunks = reader.getChunkList();
+  for (std::size_t i = 0; i < chunks.size(); ++i) {
+    out << (i ? "," : "") << "{\"id\":\"" << wav::detail::jsonEscape(chunks[i].id.toString())
+        << "\",\"offset\":" << chunks[i].offset << ",\"size\":" << chunks[i].chunkSize << "}";
+  }
+  out << "]";
+
+  out << ",\"cues\":[";
+  const auto& cues = reader.getCueChunk().cuePoints;
+  for (std::size_t i = 0; i < cues.size(); ++i) {
+    out << (i ? "," : "") << "{\"id\":" << cues[i].identifier << ",\"sample_offset\":" << cues[i].sampleOffset << "}";
+  }
+  out << "]";
+
+  out << ",\"loops\":[";
+  const auto& loops = reader.getSamplerChunk().sampleLoops;
+  for (std::size_t i = 0; i < loops.size(); ++i) {
+    out << (i ? "," : "") << "{\"cue_id\":" << loops[i].cuePointId << ",\"type\":" << loops[i].type
+        << ",\"start\":" << loops[i].start << ",\"end\":" << loops[i].end << ",\"play_count\":" << loops[i].playCount
+        << "}";
+  }
+  out << "]";
+
+  if (loudness) {
+    out << ",\"peak_dbfs\":" << formatNumber(loudness->peakDbfs);
+    out << ",\"rms_dbfs\":" << formatNumber(loudness->rmsDbfs);
+  }
+  out << "}\n";
+  return out.str();
+}
+
+static std::string csvHeader(bool loudness) {
+  std::string header = "path,format,channels,sample_rate,bits_per_sample,frames,duration_s,chunks,cues,loops";
+  if (loudness) {
+    header += ",peak_dbfs,rms_dbfs";
+  }
+  return header + "\n";
+}
+
+static std::string describeCsv(const std::string& path, const wav::WavFileUtils& reader, const Loudness* loudness) {
+  // List-valued columns use ';' between entries so each file stays on one CSV row
+  std::ostringstream chunks;
+  for (const auto& chunk : reader.getChunkList()) {
+    chunks << (chunks.tellp() > 0 ? ";" : "") << chunk.id.toString() << ":" << chunk.chunkSize;
+  }
+  std::ostringstream cues;
+  for (const auto& cue : reader.getCueChunk().cuePoints) {
+    cues << (cues.tellp() > 0 ? ";" : "") << cue.sampleOffset;
+  }
+  std::ostringstream loops;
+  for (const auto& loop : reader.getSamplerChunk().sampleLoops) {
+    loops << (loops.tellp() > 0 ? ";" : "") << loop.start << "-" << loop.end;
+  }
+
+  std::ostringstream out;
+  out << csvEscape(path) << "," << formatName(reader.getAudioFormat()) << "," << reader.getNumChannels() << ","
+      << reader.getSampleRate() << "," << reader.getBitsPerSample() << "," << reader.getNumFrames() << ","
+      << formatNumber(reader.getDurationSeconds()) << "," << csvEscape(chunks.str()) << "," << cues.str() << ","
+      << loops.str();
+  if (loudness) {
+    out << "," << formatNumber(loudness->peakDbfs) << "," << formatNumber(loudness->rmsDbfs);
+  }
+  out << "\n";
+  return out.str();
+}
+
+static bool hasWavExtension(const fs::path& path) {
+  std::string ext = path.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+  return ext == ".wav";
+}
+
+/**
+ * @brief Shared work queue of paths still to visit
+ *
+ * `pending` counts items that are queued or being processed; the walk is
+ * finished once it drops to zero, which wakes up every idle worker.
+ */
+class WorkQueue {
+public:
+  void push(fs::path path) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      items_.push_back(std::move(path));
+      ++pending_;
+    }
+    cv_.notify_one();
+  }
+
+  bool pop(fs::path& path) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !items_.empty() || pending_ == 0; });
+    if (items_.empty()) {
+      return false;
+    }
+    path = std::move(items_.front());
+    items_.pop_front();
+    return true;
+  }
+
+  void done() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--pending_ == 0) {
+      cv_.notify_all();
+    }
+  }
+
+private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<fs::path> items_;
+  std::size_t pending_ = 0;
+};
+
+static void printUsage(const char* argv0) {
+  std::cerr << "Usage: " << argv0 << " [--format jsonl|csv] [--threads N] [--loudness] <file-or-directory>...\n";
+}
+
+// More workers than this only add contention on the queue
+static constexpr unsigned long kMaxThreads = 1024;
+
+static bool parseArgs(int argc, const char* argv[], Settings& settings) {
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--format" && i + 1 < argc) {
+      const std::string value = argv[++i];
+      if (value == "jsonl" || value == "json") {
+        settings.format = OutputFormat::JsonLines;
+      } else if (value == "csv") {
+        settings.format = OutputFormat::Csv;
+      } else {
+        return false;
+      }
+    } else if (arg == "--threads" && i + 1 < argc) {
+      const std::string value = argv[++i];
+      std::size_t used = 0;
+      const unsigned long threads = std::stoul(value, &used);
+      if (used != value.size() || threads == 0 || threads > kMaxThreads) {
+        return false;
+      }
+      settings.threads = static_cast<unsigned>(threads);
+    } else if (arg == "--loudness") {
+      settings.loudness = true;
+    } else if (!arg.empty() && arg[0] == '-') {
+      return false;
+    } else {
+      settings.inputs.push_back(arg);
+    }
+  }
+  return !settings.inputs.empty();
+}
+
+int main(int argc, const char* argv[]) {
+  Settings settings;
+  try {
+    if (!parseArgs(argc, argv, settings)) {
+      printUsage(argv[0]);
+      return 2;
+    }
+  } catch (const std::exception&) { // std::stoul on malformed numbers
+    printUsage(argv[0]);
+    return 2;
+  }
+
+  const unsigned threadCount =
+      settings.threads > 0 ? settings.threads : std::max(1u, std::thread::hardware_concurrency());
+
+  WorkQueue queue;
+  for (const auto& input : settings.inputs) {
+    queue.push(input);
+  }
+
+  std::mutex outputMutex;
+  std::atomic<std::size_t> failures{0};
+  if (settings.format == OutputFormat::Csv) {
+    std::cout << csvHeader(settings.loudness);
+  }
+
+  auto worker = [&]() {
+    wav::OpenOptions options;
+    options.mode = settings.loudness ? wav::ReadMode::Full : wav::ReadMode::MetadataOnly;
+    options.verbose = false;
+    wav::WavFileUtils reader;
+    reader.setOpenOptions(options);
+
+    fs::path path;
+    while (queue.pop(path)) {
+      std::error_code ec;
+      if (fs::is_directory(path, ec)) {
+        for (fs::directory_iterator it(path, ec), end; !ec && it != end; it.increment(ec)) {
+          // Symlinks to directories are not followed (like find without -L): a link back up the
+          // tree would otherwise make the walk revisit it until the kernel's symlink limit
+          const fs::path& child = it->path();
+          std::error_code statusError;
+          const fs::file_status status = it->symlink_status(statusError);
+          if (fs::is_directory(status) ||
+              (hasWavExtension(child) && !(fs::is_symlink(status) && fs::is_directory(child, statusError)))) {
+            queue.push(child);
+          }
+        }
+      } else if (!reader.open(path.string())) {
+        ++failures;
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cerr << "wavinfo: could not read " << path.string() << "\n";
+      } else {
+        Loudness loudness;
+        if (settings.loudness) {
+          loudness = measureLoudness(reader);
+        }
+        const Loudness* loudnessPtr = settings.loudness ? &loudness : nullptr;
+        const std::string line = settings.format == OutputFormat::Csv
+                                     ? describeCsv(path.string(), reader, loudnessPtr)
+                                     : describeJson(path.string(), reader, loudnessPtr);
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout << line;
+      }
+      queue.done();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (unsigned i = 0; i < threadCount; ++i) {
+    workers.emplace_back(worker);
+  }
+  for (auto& t : workers) {
+    t.join();
+  }
+
+  std::cout.flush();
+  return failures == 0 ? 0 : 1;
+}